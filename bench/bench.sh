@@ -0,0 +1,21 @@
+#!/bin/bash
+set -e
+
+# 切换到脚本所在的目录
+cd "$(dirname "$0")"
+make -C .. release
+make clean
+
+# 如果没有传入 benchmark 名参数
+if [ $# -eq 0 ]; then
+    # 遍历 bench_src 目录下的所有 benchmark 文件
+    for f in bench_src/bench_*.cpp; do
+        name=$(basename "$f" .cpp)
+        name=${name#bench_}
+        echo ">>> Running bench: $name"
+        make bench BENCH="$name"
+    done
+else
+    name="$1"
+    make bench BENCH="$name"
+fi
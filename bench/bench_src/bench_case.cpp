@@ -0,0 +1,127 @@
+// 大小写转换: 逐字符解码 + 简单映射 + 编码 vs to_lowercase (ASCII 整块 SIMD, 其余查表)
+// 以及 HTTP 头字段名的忽略大小写比较: 先转小写副本再比较 vs eq_ignore_ascii_case
+#include <cctype>
+#include "bench_util.hpp"
+#include "kastring.hpp"
+#include "kstring.hpp"
+
+using kstring::KAStr;
+using kstring::KAString;
+using kstring::KStr;
+
+namespace {
+// 逐字符的做法: 解码, KChar::to_lower, 编码后追加
+std::string per_char_lower(KStr s) {
+    std::string out;
+    out.reserve(s.byte_size());
+    for (const auto& ch : s.iter_chars()) out += ch.to_lower().to_utf8string();
+    return out;
+}
+
+std::vector<std::string> make_keys(std::size_t n, bool cjk, bench::Rng& rng) {
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string key = "User/Profile/Settings/Key-" + std::to_string(rng.below(1000000));
+        if (cjk) key += "/" + bench::make_cjk_text(4, rng) + "/ПРИВЕТ";
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+void run(const char* name, const std::vector<std::string>& keys) {
+    std::size_t bytes = 0;
+    for (const auto& k : keys) bytes += k.size();
+    std::size_t avg = bytes / keys.size();
+    double n = static_cast<double>(keys.size());
+    std::printf(" %s keys, avg %zu bytes\n", name, avg);
+
+    double t_ascii = bench::time_ns(20, [&](std::size_t) {
+        std::size_t total = 0;
+        for (const auto& k : keys) {
+            std::string out(k);
+            for (auto& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            total += out.size();
+        }
+        bench::do_not_optimize(total);
+    });
+    double t_per_char = bench::time_ns(20, [&](std::size_t) {
+        std::size_t total = 0;
+        for (const auto& k : keys) total += per_char_lower(KStr(k.data(), k.size())).size();
+        bench::do_not_optimize(total);
+    });
+    double t_bulk = bench::time_ns(20, [&](std::size_t) {
+        std::size_t total = 0;
+        for (const auto& k : keys) total += KStr(k.data(), k.size()).to_lowercase().byte_size();
+        bench::do_not_optimize(total);
+    });
+    bench::report_throughput("std::tolower copy (ASCII only)", t_ascii / n, avg);
+    bench::report_throughput("per-char KChar::to_lower", t_per_char / n, avg);
+    bench::report_throughput("KStr::to_lowercase", t_bulk / n, avg);
+}
+
+// 先把两边转成小写的 KAString 再比较, 即原来的做法
+KAString lowered(KAStr s) {
+    KAString out(s);
+    for (std::size_t i = 0; i < out.byte_size(); ++i) {
+        out[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(out[i])));
+    }
+    return out;
+}
+
+bool lower_then_compare(KAStr a, KAStr b) {
+    return lowered(a) == lowered(b);
+}
+
+void run_headers(bench::Rng& rng) {
+    static const char* const names[] = {"Content-Type", "Content-Length", "Accept-Encoding", "X-Forwarded-For",
+                                        "Access-Control-Allow-Credentials", "If-None-Match"};
+    std::vector<std::string> headers;
+    for (std::size_t i = 0; i < 4096; ++i) {
+        std::string h = names[rng.below(6)];
+        for (auto& c : h) {
+            if (rng.below(2) == 0) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        headers.push_back(h);
+    }
+    const KAStr wanted("content-length");
+    double n = static_cast<double>(headers.size());
+    double t_lower = bench::time_ns(50, [&](std::size_t) {
+        std::size_t hits = 0;
+        for (const auto& h : headers) hits += lower_then_compare(KAStr(h), wanted);
+        bench::do_not_optimize(hits);
+    });
+    double t_fold = bench::time_ns(50, [&](std::size_t) {
+        std::size_t hits = 0;
+        for (const auto& h : headers) hits += KAStr(h).eq_ignore_ascii_case(wanted);
+        bench::do_not_optimize(hits);
+    });
+    std::printf(" header name lookup\n");
+    bench::report("lowercase copies + operator==", t_lower / n);
+    bench::report("eq_ignore_ascii_case", t_fold / n);
+
+    std::string doc;
+    while (doc.size() < (1u << 20)) doc += "accept-encoding: gzip\r\nuser-agent: curl/8.0\r\n";
+    doc += "X-Request-ID: 42\r\n";
+    KAStr big(doc);
+    double t_find =
+        bench::time_ns(50, [&](std::size_t) { bench::do_not_optimize(big.find_ignore_ascii_case("x-request-id")); });
+    bench::report_throughput("find_ignore_ascii_case 1 MiB", t_find, doc.size());
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::printf("backend = %s\n", kstring::unicode::case_simd_backend());
+    run("ascii", make_keys(20000, false, rng));
+    run("mixed", make_keys(20000, true, rng));
+
+    std::string doc;
+    while (doc.size() < (1u << 20)) doc += "The Quick Brown Fox Jumps Over The Lazy Dog. ";
+    KStr big(doc.data(), doc.size());
+    double t_doc = bench::time_ns(50, [&](std::size_t) { bench::do_not_optimize(big.to_uppercase().byte_size()); });
+    bench::report_throughput("KStr::to_uppercase 1 MiB ascii", t_doc, doc.size());
+
+    run_headers(rng);
+    return 0;
+}
@@ -0,0 +1,55 @@
+// 随机按字符下标访问: 未挂载索引 (每次从头解码) vs 挂载 CharOffsetIndex
+#include "bench_util.hpp"
+#include "kstr.hpp"
+
+using kstring::CharOffsetIndex;
+using kstring::KStr;
+
+namespace {
+void run(std::size_t chars) {
+    bench::Rng rng;
+    std::string text = bench::make_cjk_text(chars, rng);
+    KStr plain(text.data(), text.size());
+
+    const std::size_t kQueries = 4096;
+    std::vector<std::size_t> queries(kQueries);
+    for (auto& q : queries) q = rng.below(chars);
+
+    std::printf("CJK text: %zu chars, %.1f MB\n", chars, static_cast<double>(text.size()) / (1024.0 * 1024.0));
+
+    // 未索引的访问是 O(N), 只取少量样本
+    const std::size_t plain_iters = 64;
+    double t_plain = bench::time_ns(plain_iters, [&](std::size_t i) {
+        bench::do_not_optimize(plain.char_at(queries[i % kQueries]));
+    });
+    bench::report("char_at (no index)", t_plain);
+
+    for (std::size_t stride : {64, 256}) {
+        double t_build = bench::time_ns(4, [&](std::size_t) {
+            CharOffsetIndex idx = plain.build_index(stride);
+            bench::do_not_optimize(idx.sample_count());
+        });
+        CharOffsetIndex idx = plain.build_index(stride);
+        KStr indexed = plain.with_index(idx);
+
+        double t_idx = bench::time_ns(kQueries * 64, [&](std::size_t i) {
+            bench::do_not_optimize(indexed.char_at(queries[i % kQueries]));
+        });
+        double t_sub = bench::time_ns(kQueries * 64, [&](std::size_t i) {
+            bench::do_not_optimize(indexed.substr(queries[i % kQueries], 16));
+        });
+
+        std::printf(" stride=%zu\n", stride);
+        bench::report_throughput("build_index", t_build, text.size());
+        bench::report("char_at (indexed)", t_idx);
+        bench::report("substr(i, 16) (indexed)", t_sub);
+        std::printf("  speedup vs no index: %.0fx\n", t_plain / t_idx);
+    }
+}
+} // namespace
+
+int main() {
+    run(1u << 20); // 1M chars, 3 MB
+    run(4u << 20); // 4M chars, 12 MB
+    return 0;
+}
@@ -0,0 +1,61 @@
+// 字符遍历: iter_chars (逐字符 decode_one) vs iter_chars_chunked (simdutf 按块转换为 UTF-32) vs iter_chars_rev,
+// 以及基于它们的谓词扫描
+#include "bench_util.hpp"
+#include "kstr.hpp"
+
+using kstring::KChar;
+using kstring::KStr;
+
+namespace {
+template <typename Range>
+std::size_t sum(const Range& range) {
+    std::size_t total = 0;
+    for (KChar ch : range) total += ch.value();
+    return total;
+}
+
+void run(const char* name, const std::string& text) {
+    KStr s(text.data(), text.size());
+    std::size_t bytes = text.size();
+    std::printf(" %s text, %zu bytes\n", name, bytes);
+
+    double t_iter = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(sum(s.iter_chars())); });
+    double t_chunk = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(sum(s.iter_chars_chunked())); });
+    double t_match = bench::time_ns(20, [&](std::size_t) {
+        bench::do_not_optimize(s.match([](KChar c) { return c.is_ascii_digit(); }).size());
+    });
+    double t_rev = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(sum(s.iter_chars_rev())); });
+    double t_trim = bench::time_ns(20, [&](std::size_t) {
+        bench::do_not_optimize(s.trim_start_matches([](KChar c) { return c.value() != '#'; }).byte_size());
+    });
+    double t_trim_end = bench::time_ns(20, [&](std::size_t) {
+        bench::do_not_optimize(s.trim_end_matches([](KChar c) { return c.value() != '#'; }).byte_size());
+    });
+    bench::report_throughput("iter_chars", t_iter, bytes);
+    bench::report_throughput("iter_chars_chunked", t_chunk, bytes);
+    bench::report_throughput("iter_chars_rev", t_rev, bytes);
+    bench::report_throughput("match(is_ascii_digit)", t_match, bytes);
+    bench::report_throughput("trim_start_matches (whole string)", t_trim, bytes);
+    bench::report_throughput("trim_end_matches (whole string)", t_trim_end, bytes);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::string ascii;
+    std::string cjk;
+    std::string mixed;
+    std::string log; // 夹杂截断序列与孤立续字节的日志
+    while (mixed.size() < (1u << 20)) {
+        std::string num = std::to_string(rng.below(100000));
+        ascii += "The quick brown fox jumps over " + num + " lazy dogs. ";
+        cjk += bench::make_cjk_text(16, rng);
+        mixed += "caf\xc3\xa9 " + num + " " + bench::make_cjk_text(4, rng) + " \xf0\x9f\x98\x81 ";
+        log += "[worker " + num + "] \xe4\xbd recv " + bench::make_cjk_text(3, rng) + " \x80\x80 ok\n";
+    }
+    run("ascii", ascii);
+    run("cjk", cjk);
+    run("mixed", mixed);
+    run("log (invalid bytes)", log);
+    return 0;
+}
@@ -0,0 +1,88 @@
+// 单字符解码: 逐步检查的旧 decode_one vs 表驱动 DFA 的 decode_one, 以及 replace_all 的逐字符路径
+#include "bench_util.hpp"
+#include "utf8.hpp"
+
+using kstring::Byte;
+using kstring::ByteSpan;
+using kstring::ByteVec;
+using kstring::CodePoint;
+using utf8::UTF8Decoded;
+
+namespace {
+// 改动前的 decode_one: 按首字节求长度, 逐个检查续字节, 再用 utf8_size 与代理区判断过长编码
+UTF8Decoded old_decode_one(const ByteSpan& data, std::size_t pos) {
+    if (pos >= data.size()) return UTF8Decoded::ill(data.size());
+    Byte lead = data[pos];
+    std::size_t len = utf8::lead_utf8_length(lead);
+    if (len == 0) return UTF8Decoded::ill(pos + 1);
+    if (pos + len > data.size()) return UTF8Decoded::ill(data.size());
+    for (std::size_t i = 1; i < len; ++i) {
+        if ((data[pos + i] & 0xC0) != 0x80) return UTF8Decoded::ill(pos + i);
+    }
+    CodePoint cp = 0;
+    if (len == 1) {
+        cp = lead;
+    } else if (len == 2) {
+        cp = CodePoint(((lead & 0x1F) << 6) | (data[pos + 1] & 0x3F));
+    } else if (len == 3) {
+        cp = CodePoint(((lead & 0x0F) << 12) | ((data[pos + 1] & 0x3F) << 6) | (data[pos + 2] & 0x3F));
+    } else {
+        cp = CodePoint(((lead & 0x07) << 18) | ((data[pos + 1] & 0x3F) << 12) | ((data[pos + 2] & 0x3F) << 6) |
+                       (data[pos + 3] & 0x3F));
+    }
+    if (utf8::utf8_size(cp) != len) return UTF8Decoded::ill(pos + len);
+    if (utf8::is_surrogate_codepoint(cp)) return UTF8Decoded::ill(pos + len);
+    if (utf8::is_overflow_codepoint(cp)) return UTF8Decoded::ill(pos + len);
+    return UTF8Decoded(cp, pos + len);
+}
+
+template <typename Decode>
+std::size_t decode_loop(const ByteSpan& data, Decode decode) {
+    std::size_t sum = 0;
+    for (std::size_t pos = 0; pos < data.size();) {
+        UTF8Decoded dec = decode(data, pos);
+        sum += dec.codepoint;
+        pos = dec.next_pos;
+    }
+    return sum;
+}
+
+void run(const char* name, const std::string& text) {
+    ByteSpan data(reinterpret_cast<const Byte*>(text.data()), text.size());
+    std::size_t bytes = text.size();
+    std::printf(" %s input, %zu bytes\n", name, bytes);
+    double t_old = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(decode_loop(data, old_decode_one)); });
+    double t_new =
+        bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(decode_loop(data, utf8::decode_one)); });
+    bench::report_throughput("old decode_one loop", t_old, bytes);
+    bench::report_throughput("DFA decode_one loop", t_new, bytes);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::string valid;
+    std::string invalid;
+    std::string mixed;
+    const char* garbage[] = {"\xff", "\xc0\x80", "\xed\xa0\x80", "\xe4\xbd", "\xf4\x90\x80\x80", "\x80"};
+    while (valid.size() < (1u << 20)) {
+        std::string words = "caf\xc3\xa9 " + bench::make_cjk_text(6, rng) + " \xf0\x9f\x98\x81 ok ";
+        valid += words;
+        invalid += garbage[rng.below(6)];
+        mixed += words + garbage[rng.below(6)];
+    }
+    while (invalid.size() < (1u << 20)) invalid += garbage[rng.below(6)];
+    run("valid", valid);
+    run("invalid", invalid);
+    run("mixed", mixed);
+
+    // replace_all 逐字符走 DFA; find_codepoint 见 bench_find_codepoint
+    ByteVec vec(valid.begin(), valid.end());
+    double t_replace = bench::time_ns(5, [&](std::size_t) {
+        ByteVec copy = vec;
+        utf8::replace_all(copy, 0x1F601, 0x1F602);
+        bench::do_not_optimize(copy.size());
+    });
+    bench::report_throughput("replace_all same length", t_replace, vec.size());
+    return 0;
+}
@@ -0,0 +1,50 @@
+// find_codepoint 非 ASCII 目标: 改动前的逐字符解码 vs 预编码后 SIMD 子串查找 + simdutf 计数
+#include "bench_util.hpp"
+#include "utf8.hpp"
+
+using kstring::Byte;
+using kstring::ByteSpan;
+using kstring::CodePoint;
+using utf8::UTF8Decoded;
+
+namespace {
+// 改动前的实现: 逐字符 decode_one 比较, 遇到非法字节即放弃
+std::size_t old_find_codepoint(const ByteSpan& data, CodePoint target) {
+    std::size_t index = 0;
+    for (std::size_t pos = 0; pos < data.size();) {
+        UTF8Decoded dec = utf8::decode_one(data, pos);
+        if (! dec.ok) break;
+        if (dec.codepoint == target) return index;
+        pos = dec.next_pos;
+        ++index;
+    }
+    return kstring::knpos;
+}
+
+void run(const char* name, const std::string& text, CodePoint target) {
+    ByteSpan data(reinterpret_cast<const Byte*>(text.data()), text.size());
+    std::size_t bytes = text.size();
+    std::printf(" %s, %zu bytes\n", name, bytes);
+    double t_old =
+        bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(old_find_codepoint(data, target)); });
+    double t_new =
+        bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(utf8::find_codepoint(data, target)); });
+    bench::report_throughput("old find_codepoint (per char)", t_old, bytes);
+    bench::report_throughput("find_codepoint (SIMD)", t_new, bytes);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::string cjk;
+    std::string mixed;
+    while (cjk.size() < (1u << 20)) {
+        cjk += bench::make_cjk_text(32, rng);
+        mixed += "id=" + std::to_string(rng.below(100000)) + " " + bench::make_cjk_text(8, rng) + " ";
+    }
+    // 分隔符只出现在末尾, 相当于扫描整个文档
+    run("cjk, '\xef\xbc\x8c' at end", cjk + "\xef\xbc\x8c", 0xFF0C);
+    run("mixed, '\xe3\x80\x81' at end", mixed + "\xe3\x80\x81", 0x3001);
+    run("cjk, not found", cjk, 0x3001);
+    return 0;
+}
@@ -0,0 +1,52 @@
+// 启动加载词典: ifstream 读进 std::string 再校验、按行切分 vs MappedText 映射 + 并行校验 + lines_iter
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include "bench_util.hpp"
+#include "kstr.hpp"
+#include "mapped_text.hpp"
+#include "utf8.hpp"
+
+int main() {
+    bench::Rng rng;
+    char path[] = "/tmp/kstring_bench_dict_XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd < 0) return 1;
+    ::close(fd);
+    {
+        std::ofstream out(path, std::ios::binary);
+        std::string text;
+        while (text.size() < (64u << 20)) {
+            text += std::to_string(rng.below(1000000)) + "\t" + bench::make_cjk_text(6, rng) + "\n";
+        }
+        out << text;
+    }
+
+    std::size_t bytes = 0;
+    double t_read = bench::time_ns(5, [&](std::size_t) {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        std::string text = ss.str();
+        bytes = text.size();
+        kstring::KStr view(text.data(), text.size());
+        std::size_t lines = 0;
+        if (utf8::is_valid(view.as_bytes())) {
+            for (kstring::KStr line : view.lines_iter()) lines += line.byte_size() > 0;
+        }
+        bench::do_not_optimize(lines);
+    });
+    double t_mapped = bench::time_ns(5, [&](std::size_t) {
+        kstring::MappedText text(path);
+        std::size_t lines = 0;
+        if (text.is_valid_utf8(0)) {
+            for (kstring::KStr line : text.lines_iter()) lines += line.byte_size() > 0;
+        }
+        bench::do_not_optimize(lines);
+    });
+    std::printf(" dictionary file, %zu bytes (page cache warm)\n", bytes);
+    bench::report_throughput("ifstream -> std::string + validate + lines", t_read, bytes);
+    bench::report_throughput("MappedText + is_valid_utf8(0) + lines_iter", t_mapped, bytes);
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// 多个关键词扫描同一批记录: 对每个关键词循环调用 KStr::contains vs 一次扫描的 KMultiSearcher
+#include "bench_util.hpp"
+#include "ksearcher.hpp"
+
+using kstring::KMultiSearcher;
+using kstring::KStr;
+
+namespace {
+std::vector<std::string> make_bodies(std::size_t n, bench::Rng& rng) {
+    std::vector<std::string> out;
+    out.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string body = "{\"user\": " + std::to_string(rng.below(100000)) + ", \"msg\": \"";
+        body += bench::make_cjk_text(40 + rng.below(40), rng);
+        body += "\", \"path\": \"/api/v1/items\"}";
+        out.push_back(body);
+    }
+    return out;
+}
+
+std::vector<std::string> make_keywords(std::size_t n, bench::Rng& rng) {
+    std::vector<std::string> out;
+    for (std::size_t i = 0; i < n; ++i) out.push_back("kw" + std::to_string(rng.below(1000000)) + "!");
+    return out;
+}
+
+void run(std::size_t n_keywords, const std::vector<std::string>& bodies, bench::Rng& rng) {
+    std::vector<std::string> words = make_keywords(n_keywords, rng);
+    std::vector<KStr> pats;
+    for (const auto& w : words) pats.emplace_back(w.c_str());
+    KMultiSearcher matcher(pats);
+    std::size_t total_bytes = 0;
+    for (const auto& b : bodies) total_bytes += b.size();
+    std::size_t avg = total_bytes / bodies.size();
+
+    std::printf(" %zu keywords, %zu states, prefilter = %s\n", n_keywords, matcher.engine().state_count(),
+                matcher.engine().has_prefilter() ? "on" : "off");
+    double t_loop = bench::time_ns(5, [&](std::size_t) {
+        std::size_t hits = 0;
+        for (const auto& b : bodies) {
+            KStr body(b.data(), b.size());
+            for (const auto& p : pats) {
+                if (body.contains(p)) {
+                    ++hits;
+                    break;
+                }
+            }
+        }
+        bench::do_not_optimize(hits);
+    });
+    double t_multi = bench::time_ns(5, [&](std::size_t) {
+        std::size_t hits = 0;
+        for (const auto& b : bodies) hits += matcher.contains_any(KStr(b.data(), b.size()));
+        bench::do_not_optimize(hits);
+    });
+    double n = static_cast<double>(bodies.size());
+    bench::report_throughput("contains loop per body", t_loop / n, avg);
+    bench::report_throughput("KMultiSearcher::contains_any per body", t_multi / n, avg);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::vector<std::string> bodies = make_bodies(5000, rng);
+    run(4, bodies, rng);
+    run(50, bodies, rng);
+    run(500, bodies, rng);
+    return 0;
+}
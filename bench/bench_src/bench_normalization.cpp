@@ -0,0 +1,65 @@
+// Unicode 规范化: 已是 NFC 的标识符 (quick check 直接返回原视图) vs 需要组合的分解形式输入
+#include "bench_util.hpp"
+#include "kstring.hpp"
+
+using kstring::KStr;
+using kstring::KString;
+using kstring::unicode::NormalizationForm;
+
+namespace {
+void run(const char* name, const std::vector<std::string>& ids) {
+    std::size_t bytes = 0;
+    for (const auto& id : ids) bytes += id.size();
+    std::size_t avg = bytes / ids.size();
+    double n = static_cast<double>(ids.size());
+    std::printf(" %s identifiers, avg %zu bytes\n", name, avg);
+
+    double t_copy = bench::time_ns(20, [&](std::size_t) {
+        std::size_t total = 0;
+        for (const auto& id : ids) total += KString(id.c_str()).byte_size();
+        bench::do_not_optimize(total);
+    });
+    double t_view = bench::time_ns(20, [&](std::size_t) {
+        std::size_t total = 0;
+        KString buf;
+        for (const auto& id : ids) total += KStr(id.c_str()).normalize(NormalizationForm::NFC, buf).byte_size();
+        bench::do_not_optimize(total);
+    });
+    double t_owned = bench::time_ns(20, [&](std::size_t) {
+        std::size_t total = 0;
+        for (const auto& id : ids) total += KStr(id.c_str()).normalize(NormalizationForm::NFKC).byte_size();
+        bench::do_not_optimize(total);
+    });
+    bench::report_throughput("KString copy (baseline)", t_copy / n, avg);
+    bench::report_throughput("normalize(NFC, buf)", t_view / n, avg);
+    bench::report_throughput("normalize(NFKC) -> KString", t_owned / n, avg);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::printf("backend = %s\n", kstring::unicode::normalization_simd_backend());
+
+    std::vector<std::string> ascii;
+    std::vector<std::string> cjk;
+    std::vector<std::string> decomposed;
+    for (std::size_t i = 0; i < 20000; ++i) {
+        std::string id = "user_profile_setting_" + std::to_string(rng.below(1000000));
+        ascii.push_back(id);
+        cjk.push_back(id + "_" + bench::make_cjk_text(6, rng));
+        decomposed.push_back("cafe\xcc\x81_" + id + "_re\xcc\x81sume\xcc\x81");
+    }
+    run("ascii", ascii);
+    run("cjk", cjk);
+    run("decomposed", decomposed);
+
+    std::string doc;
+    while (doc.size() < (1u << 20)) {
+        doc += "The quick brown fox jumps over the lazy dog. " + bench::make_cjk_text(8, rng);
+    }
+    KStr big(doc.c_str());
+    double t_qc =
+        bench::time_ns(50, [&](std::size_t) { bench::do_not_optimize(big.is_normalized(NormalizationForm::NFC)); });
+    bench::report_throughput("is_normalized(NFC) 1 MiB mixed", t_qc, doc.size());
+    return 0;
+}
@@ -0,0 +1,93 @@
+// 替换: 改动前逐字符解码并逐个移动尾部的 replace_all vs SIMD 查找 + 单遍写入; 以及子串级的脱敏替换
+#include <algorithm>
+#include "bench_util.hpp"
+#include "kastr.hpp"
+#include "kastring.hpp"
+#include "kstr.hpp"
+#include "kstring.hpp"
+#include "utf8.hpp"
+
+using kstring::Byte;
+using kstring::ByteVec;
+using kstring::CodePoint;
+using kstring::KAStr;
+using kstring::KStr;
+
+namespace {
+// 改动前的实现: 变长时每次替换都移动整个尾部并 resize, 遇到非法字节即停止
+void old_replace_all(ByteVec& data, CodePoint cp_old, CodePoint cp_new) {
+    std::size_t pos = 0;
+    utf8::UTF8Encoded encoded = utf8::encode(cp_new);
+    std::size_t new_len = encoded.len;
+    while (pos < data.size()) {
+        utf8::UTF8Decoded dec = utf8::decode_one(data, pos);
+        if (! dec.ok) break;
+        std::size_t next = dec.next_pos;
+        if (dec.codepoint != cp_old) {
+            pos = next;
+            continue;
+        }
+        std::size_t old_len = next - pos;
+        if (new_len > old_len) {
+            std::size_t tail_len = data.size() - next;
+            data.resize(data.size() + new_len - old_len);
+            std::move_backward(data.begin() + next, data.begin() + next + tail_len, data.end());
+        } else if (new_len < old_len) {
+            std::move(data.begin() + next, data.end(), data.begin() + next - (old_len - new_len));
+            data.resize(data.size() - (old_len - new_len));
+        }
+        std::copy(encoded.begin(), encoded.end(), data.begin() + pos);
+        pos += new_len;
+    }
+}
+
+void run_codepoint(const ByteVec& doc, CodePoint from, CodePoint to, const char* name) {
+    std::printf(" replace_all %s, %zu bytes\n", name, doc.size());
+    double t_old = bench::time_ns(3, [&](std::size_t) {
+        ByteVec copy = doc;
+        old_replace_all(copy, from, to);
+        bench::do_not_optimize(copy.size());
+    });
+    double t_new = bench::time_ns(3, [&](std::size_t) {
+        ByteVec copy = doc;
+        utf8::replace_all(copy, from, to);
+        bench::do_not_optimize(copy.size());
+    });
+    bench::report_throughput("old replace_all (shift tail)", t_old, doc.size());
+    bench::report_throughput("replace_all (single pass)", t_new, doc.size());
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    // 256 KiB 中文文本: 旧实现每个分隔符都移动整个尾部, 文档再大就跑不完
+    std::string small;
+    while (small.size() < (256u << 10)) small += bench::make_cjk_text(12, rng) + "\xef\xbc\x8c";
+    ByteVec doc(small.begin(), small.end());
+    run_codepoint(doc, 0xFF0C, 0x3001, "\xef\xbc\x8c -> \xe3\x80\x81 (same length)");
+    run_codepoint(doc, 0xFF0C, ',', "\xef\xbc\x8c -> ',' (shrink)");
+    run_codepoint(doc, 0xFF0C, 0x1F601, "\xef\xbc\x8c -> emoji (grow)");
+
+    // 32 MiB 日志的子串脱敏, 只测新实现
+    std::string log;
+    while (log.size() < (32u << 20)) {
+        log += "2024-05-01 user=" + std::to_string(rng.below(100000)) + " token=secret" +
+               std::to_string(rng.below(10)) + " " + bench::make_cjk_text(6, rng) + "\n";
+    }
+    KStr text(log.data(), log.size());
+    std::printf(" redaction over %zu bytes\n", log.size());
+    double t_redact = bench::time_ns(3, [&](std::size_t) {
+        bench::do_not_optimize(text.replace("token=secret", "token=[REDACTED]").byte_size());
+    });
+    double t_shrink =
+        bench::time_ns(3, [&](std::size_t) { bench::do_not_optimize(text.replace("token=", "").byte_size()); });
+    double t_ascii = bench::time_ns(3, [&](std::size_t) {
+        bench::do_not_optimize(KAStr(log.data(), log.size()).replace("2024-05-01", "YYYY-MM-DD").byte_size());
+    });
+    double t_copy = bench::time_ns(3, [&](std::size_t) { bench::do_not_optimize(kstring::KString(text).byte_size()); });
+    bench::report_throughput("KString copy (baseline)", t_copy, log.size());
+    bench::report_throughput("KStr::replace (grow)", t_redact, log.size());
+    bench::report_throughput("KStr::replace (shrink)", t_shrink, log.size());
+    bench::report_throughput("KAStr::replace (same length)", t_ascii, log.size());
+    return 0;
+}
@@ -0,0 +1,45 @@
+// 有损修复: encode_all(decode_all()) 经 UTF-32 中转 vs sanitize 的整段校验 + memcpy
+#include "bench_util.hpp"
+#include "utf8.hpp"
+
+using kstring::ByteSpan;
+using kstring::ByteVec;
+
+namespace {
+void run(const char* name, const std::string& text) {
+    ByteVec data(text.begin(), text.end());
+    std::size_t bytes = data.size();
+    std::printf(" %s input, %zu bytes\n", name, bytes);
+    double t_round = bench::time_ns(10, [&](std::size_t) {
+        bench::do_not_optimize(utf8::encode_all(utf8::decode_all(data)).size());
+    });
+    double t_sanitize =
+        bench::time_ns(10, [&](std::size_t) { bench::do_not_optimize(utf8::sanitize(data).size()); });
+    double t_in_place = bench::time_ns(10, [&](std::size_t) {
+        ByteVec copy = data;
+        bench::do_not_optimize(utf8::sanitize_in_place(copy));
+    });
+    bench::report_throughput("encode_all(decode_all())", t_round, bytes);
+    bench::report_throughput("sanitize", t_sanitize, bytes);
+    bench::report_throughput("copy + sanitize_in_place", t_in_place, bytes);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::string valid;
+    std::string rare;
+    std::string dirty;
+    const char* garbage[] = {"\xff", "\xc0\x80", "\xed\xa0\x80", "\xe4\xbd", "\x80"};
+    while (valid.size() < (1u << 20)) {
+        std::string line = "GET /api/" + std::to_string(rng.below(100000)) + " " + bench::make_cjk_text(8, rng) + "\n";
+        valid += line;
+        rare += line;
+        if (rng.below(200) == 0) rare += garbage[rng.below(5)];
+        dirty += line.substr(0, 12) + garbage[rng.below(5)];
+    }
+    run("valid", valid);
+    run("rare errors (1 per ~200 lines)", rare);
+    run("dirty (1 per 12 bytes)", dirty);
+    return 0;
+}
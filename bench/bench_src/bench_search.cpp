@@ -0,0 +1,57 @@
+// 逆向子串查找: 朴素逐位置 memcmp vs search::rfind 的各个实现
+#include <cstring>
+#include "bench_util.hpp"
+#include "search.hpp"
+
+using kstring::Byte;
+using kstring::ByteSpan;
+namespace search = kstring::search;
+
+namespace {
+std::size_t naive_rfind(ByteSpan hay, ByteSpan pat) {
+    if (pat.size() > hay.size()) return kstring::knpos;
+    for (std::size_t i = hay.size() - pat.size() + 1; i-- > 0;) {
+        if (std::memcmp(hay.data() + i, pat.data(), pat.size()) == 0) return i;
+    }
+    return kstring::knpos;
+}
+
+// 模拟日志: 每行结构相似, 目标模式只出现在开头, 逆向查找需扫完整个 buffer
+std::string make_log(std::size_t lines, bench::Rng& rng) {
+    std::string out = "2024-01-01 00:00:00 FATAL boot failure #1\n";
+    for (std::size_t i = 0; i < lines; ++i) {
+        out += "2024-01-01 12:34:56 INFO request id=";
+        out += std::to_string(rng.next() % 1000000);
+        out += " status=200 path=/api/v1/items\n";
+    }
+    return out;
+}
+
+template <typename Fn>
+void run_case(const char* name, ByteSpan hay, ByteSpan pat, Fn fn) {
+    double t = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(fn(hay, pat)); });
+    bench::report_throughput(name, t, hay.size());
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::string log = make_log(100000, rng);
+    ByteSpan hay(reinterpret_cast<const Byte*>(log.data()), log.size());
+    std::printf("log text: %.1f MB, backend = %s\n", static_cast<double>(log.size()) / (1024.0 * 1024.0),
+                search::simd_backend());
+
+    const char* patterns[] = {"#", "FATAL", "FATAL boot failure", "2024-01-01 00:00:00 FATAL"};
+    for (const char* p : patterns) {
+        ByteSpan pat(reinterpret_cast<const Byte*>(p), std::strlen(p));
+        std::printf(" pattern \"%s\" (%zu bytes)\n", p, pat.size());
+        run_case("naive memcmp", hay, pat, naive_rfind);
+        run_case("search::rfind (dispatched)", hay, pat, search::rfind);
+        run_case("detail::rfind_scalar", hay, pat, search::detail::rfind_scalar);
+#if defined(__x86_64__) || defined(__i386__)
+        run_case("detail::rfind_sse2", hay, pat, search::detail::rfind_sse2);
+        if (__builtin_cpu_supports("avx2")) run_case("detail::rfind_avx2", hay, pat, search::detail::rfind_avx2);
+#endif
+    }
+    return 0;
+}
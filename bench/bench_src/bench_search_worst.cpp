@@ -0,0 +1,50 @@
+// 子串查找的最坏输入: 4 MiB 的 'a' 中查找 'a…b…a' (首末字节处处命中, 校验到中间才失配)
+// 对照 glibc memmem (Two-Way, 线性), 检查 search::find / rfind / find_many / find_ignore_ascii_case 与 Searcher
+// 不会退化为 O(n·m)
+#include <cstring>
+#include <string>
+#include "bench_util.hpp"
+#include "search.hpp"
+
+using kstring::Byte;
+using kstring::ByteSpan;
+namespace search = kstring::search;
+
+namespace {
+template <typename Fn>
+void run_case(const char* name, std::size_t bytes, Fn fn) {
+    double t = bench::time_ns(3, [&](std::size_t) { bench::do_not_optimize(fn()); });
+    bench::report_throughput(name, t, bytes);
+}
+} // namespace
+
+int main() {
+    const std::string hay_str(4u << 20, 'a');
+    ByteSpan hay(reinterpret_cast<const Byte*>(hay_str.data()), hay_str.size());
+    std::printf("hay: 4 MiB of 'a', backend = %s\n", search::simd_backend());
+
+    const std::size_t lengths[] = {16, 64, 2000};
+    for (std::size_t m : lengths) {
+        std::string pat_str(m, 'a');
+        pat_str[m / 2] = 'b';
+        ByteSpan pat(reinterpret_cast<const Byte*>(pat_str.data()), pat_str.size());
+        search::Searcher searcher(pat);
+        std::printf(" needle 'a…b…a', %zu bytes, searcher = %s\n", m,
+                    search::Searcher::algorithm_name(searcher.algorithm()));
+        run_case("glibc memmem", hay.size(), [&] {
+            return memmem(hay.data(), hay.size(), pat.data(), pat.size()) != nullptr;
+        });
+        run_case("search::find", hay.size(), [&] { return search::find(hay, pat); });
+        run_case("search::rfind", hay.size(), [&] { return search::rfind(hay, pat); });
+        run_case("search::find_many", hay.size(), [&] {
+            std::size_t out[16];
+            return search::find_many(hay, pat, 0, out, 16);
+        });
+        run_case("Searcher::find", hay.size(), [&] { return searcher.find(hay); });
+        run_case("Searcher::rfind", hay.size(), [&] { return searcher.rfind(hay); });
+        run_case("search::find_ignore_ascii_case", hay.size(), [&] {
+            return search::find_ignore_ascii_case(hay, pat);
+        });
+    }
+    return 0;
+}
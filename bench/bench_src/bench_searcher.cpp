@@ -0,0 +1,72 @@
+// 同一模式在大量短记录中查找: 每次调用 KStr::find vs 预编译的 KSearcher
+// 记录总量控制在缓存可容纳的范围内, 避免结果被内存带宽主导
+#include <algorithm>
+#include <cstring>
+#include "bench_util.hpp"
+#include "ksearcher.hpp"
+
+using kstring::KSearcher;
+using kstring::KStr;
+namespace search = kstring::search;
+
+namespace {
+std::vector<std::string> make_records(std::size_t n, bench::Rng& rng) {
+    static const char* levels[] = {"INFO", "WARN", "DEBUG", "ERROR"};
+    std::vector<std::string> out;
+    out.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string rec = "ts=";
+        rec += std::to_string(rng.next() % 100000000);
+        rec += " level=";
+        rec += levels[rng.below(4)];
+        rec += " 用户请求处理完成 path=/api/v1/items/";
+        rec += std::to_string(rng.below(1000));
+        out.push_back(rec);
+    }
+    return out;
+}
+
+void run(const char* pattern, const std::vector<std::string>& records) {
+    KStr pat(pattern);
+    KSearcher searcher(pat);
+    std::size_t total_bytes = 0;
+    for (const auto& r : records) total_bytes += r.size();
+
+    std::printf(" pattern \"%s\" (%zu bytes), searcher algorithm = %s\n", pattern, pat.byte_size(),
+                search::Searcher::algorithm_name(searcher.engine().algorithm()));
+
+    double t_std = bench::time_ns(200, [&](std::size_t) {
+        std::size_t hits = 0;
+        for (const auto& r : records) {
+            hits += std::search(r.begin(), r.end(), pattern, pattern + std::strlen(pattern)) != r.end();
+        }
+        bench::do_not_optimize(hits);
+    });
+    double t_find = bench::time_ns(200, [&](std::size_t) {
+        std::size_t hits = 0;
+        for (const auto& r : records) hits += KStr(r.data(), r.size()).find_in_bytes(pat) != kstring::knpos;
+        bench::do_not_optimize(hits);
+    });
+    double t_searcher = bench::time_ns(200, [&](std::size_t) {
+        std::size_t hits = 0;
+        for (const auto& r : records) hits += searcher.contains(KStr(r.data(), r.size()));
+        bench::do_not_optimize(hits);
+    });
+
+    double n = static_cast<double>(records.size());
+    bench::report_throughput("std::search per record", t_std / n, total_bytes / records.size());
+    bench::report_throughput("KStr::find_in_bytes per record", t_find / n, total_bytes / records.size());
+    bench::report_throughput("KSearcher::contains per record", t_searcher / n, total_bytes / records.size());
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::vector<std::string> records = make_records(20000, rng);
+    std::printf("%zu records, backend = %s\n", records.size(), search::simd_backend());
+    run("=", records);
+    run("ERROR", records);
+    run("level=ERROR 用户", records);
+    run("path=/api/v1/items/999 and a deliberately long needle that never occurs in records at all!!", records);
+    return 0;
+}
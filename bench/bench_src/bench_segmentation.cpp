@@ -0,0 +1,54 @@
+// UAX #29 切分: split_whitespace_iter (基线) vs 词边界 / 词 / 句 / 字素簇迭代, 混合文字文本
+#include "bench_util.hpp"
+#include "kstr.hpp"
+
+using kstring::KStr;
+
+namespace {
+template <typename Range>
+std::size_t count(const Range& range) {
+    std::size_t n = 0;
+    for (KStr seg : range) n += seg.byte_size() != 0;
+    return n;
+}
+
+void run(const char* name, const std::string& text) {
+    KStr s(text.data(), text.size());
+    std::size_t bytes = text.size();
+    std::printf(" %s text, %zu bytes: %zu whitespace tokens, %zu words, %zu sentences\n", name, bytes,
+                count(s.split_whitespace_iter()), count(s.iter_words()), count(s.iter_sentences()));
+
+    double t_split = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(count(s.split_whitespace_iter())); });
+    double t_bounds = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(count(s.iter_word_bounds())); });
+    double t_words = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(count(s.iter_words())); });
+    double t_rev = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(count(s.iter_words().reversed())); });
+    double t_sent = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(count(s.iter_sentences())); });
+    double t_graph = bench::time_ns(20, [&](std::size_t) { bench::do_not_optimize(count(s.iter_graphemes())); });
+    bench::report_throughput("split_whitespace_iter (baseline)", t_split, bytes);
+    bench::report_throughput("iter_word_bounds", t_bounds, bytes);
+    bench::report_throughput("iter_words", t_words, bytes);
+    bench::report_throughput("iter_words().reversed()", t_rev, bytes);
+    bench::report_throughput("iter_sentences", t_sent, bytes);
+    bench::report_throughput("iter_graphemes", t_graph, bytes);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    const char* latin[] = {"The quick brown fox can't jump over 3.14 lazy dogs. ", "Version 2.0 ships on Monday! ",
+                           "Caf\xc3\xa9 cr\xc3\xa8me, na\xc3\xafve r\xc3\xa9sum\xc3\xa9? "};
+    const char* cyrillic = "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, \xd0\xbc\xd0\xb8\xd1\x80. ";
+
+    std::string ascii;
+    std::string mixed;
+    while (mixed.size() < (1u << 20)) {
+        const char* sentence = latin[rng.below(3)];
+        ascii += latin[0];
+        mixed += sentence;
+        mixed += cyrillic;
+        mixed += bench::make_cjk_text(12, rng) + "\xe3\x80\x82";
+    }
+    run("english", ascii);
+    run("mixed-script", mixed);
+    return 0;
+}
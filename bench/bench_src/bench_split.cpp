@@ -0,0 +1,89 @@
+// CSV 行按 ',' 切分: 逐字节 memcmp 的旧实现 vs split (批量 SIMD 偏移) vs split_iter vs split_offsets
+#include <cstring>
+#include "bench_util.hpp"
+#include "kstr.hpp"
+
+using kstring::KStr;
+
+namespace {
+std::vector<std::string> make_rows(std::size_t n, bench::Rng& rng) {
+    std::vector<std::string> out;
+    out.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string row;
+        for (int col = 0; col < 12; ++col) {
+            if (col) row += ',';
+            row += std::to_string(rng.below(100000));
+            if (col % 4 == 3) row += "北京市";
+        }
+        out.push_back(row);
+    }
+    return out;
+}
+
+// 改动前 KStr::split_count 的做法: 每个位置 memcmp
+std::vector<KStr> split_bytewise(KStr s, KStr delim) {
+    std::vector<KStr> out;
+    kstring::ByteSpan hay = s.as_bytes();
+    kstring::ByteSpan pat = delim.as_bytes();
+    std::size_t start = 0;
+    std::size_t pos = 0;
+    while (pos + pat.size() <= hay.size()) {
+        if (std::memcmp(hay.data() + pos, pat.data(), pat.size()) == 0) {
+            out.emplace_back(hay.data() + start, pos - start);
+            pos += pat.size();
+            start = pos;
+        } else {
+            ++pos;
+        }
+    }
+    out.emplace_back(hay.data() + start, hay.size() - start);
+    return out;
+}
+
+void run(const char* delim, const std::vector<std::string>& rows) {
+    KStr d(delim);
+    std::size_t total_bytes = 0;
+    for (const auto& r : rows) total_bytes += r.size();
+    std::size_t avg = total_bytes / rows.size();
+    double n = static_cast<double>(rows.size());
+    std::printf(" delimiter \"%s\"\n", delim);
+
+    double t_old = bench::time_ns(20, [&](std::size_t) {
+        std::size_t fields = 0;
+        for (const auto& r : rows) fields += split_bytewise(KStr(r.data(), r.size()), d).size();
+        bench::do_not_optimize(fields);
+    });
+    double t_split = bench::time_ns(20, [&](std::size_t) {
+        std::size_t fields = 0;
+        for (const auto& r : rows) fields += KStr(r.data(), r.size()).split(d).size();
+        bench::do_not_optimize(fields);
+    });
+    double t_iter = bench::time_ns(20, [&](std::size_t) {
+        std::size_t fields = 0;
+        for (const auto& r : rows) {
+            for (KStr f : KStr(r.data(), r.size()).split_iter(d)) fields += f.byte_size();
+        }
+        bench::do_not_optimize(fields);
+    });
+    double t_offsets = bench::time_ns(20, [&](std::size_t) {
+        std::size_t offs[64];
+        std::size_t fields = 0;
+        for (const auto& r : rows) fields += KStr(r.data(), r.size()).split_offsets(d, offs, 64);
+        bench::do_not_optimize(fields);
+    });
+    bench::report_throughput("byte-by-byte memcmp split per row", t_old / n, avg);
+    bench::report_throughput("KStr::split per row", t_split / n, avg);
+    bench::report_throughput("KStr::split_iter per row", t_iter / n, avg);
+    bench::report_throughput("KStr::split_offsets per row", t_offsets / n, avg);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::vector<std::string> rows = make_rows(20000, rng);
+    std::printf("%zu rows, backend = %s\n", rows.size(), kstring::search::simd_backend());
+    run(",", rows);
+    run("北京", rows);
+    return 0;
+}
@@ -0,0 +1,56 @@
+// 分块流式校验 / 解码 (64 KB 一块) vs 把整条消息缓存后一次性 is_valid / decode_all
+#include "bench_util.hpp"
+#include "utf8.hpp"
+
+using kstring::ByteSpan;
+using kstring::ByteVec;
+using kstring::CodePoint;
+
+namespace {
+const std::size_t CHUNK = 64 * 1024;
+
+void run(const char* name, const std::string& text) {
+    ByteVec data(text.begin(), text.end());
+    std::size_t bytes = data.size();
+    std::printf(" %s input, %zu bytes, %zu byte chunks\n", name, bytes, CHUNK);
+    double t_whole = bench::time_ns(10, [&](std::size_t) {
+        ByteVec buffered;
+        for (std::size_t pos = 0; pos < bytes; pos += CHUNK) {
+            buffered.insert(buffered.end(), data.begin() + pos, data.begin() + std::min(bytes, pos + CHUNK));
+        }
+        bench::do_not_optimize(utf8::is_valid(buffered));
+    });
+    double t_stream = bench::time_ns(10, [&](std::size_t) {
+        utf8::StreamValidator v;
+        for (std::size_t pos = 0; pos < bytes; pos += CHUNK) {
+            v.feed(ByteSpan(data.data() + pos, std::min(CHUNK, bytes - pos)));
+        }
+        bench::do_not_optimize(v.finish());
+    });
+    double t_decode_all = bench::time_ns(10, [&](std::size_t) { bench::do_not_optimize(utf8::decode_all(data).size()); });
+    std::vector<CodePoint> out;
+    double t_decoder = bench::time_ns(10, [&](std::size_t) {
+        utf8::StreamDecoder dec;
+        out.clear();
+        for (std::size_t pos = 0; pos < bytes; pos += CHUNK) {
+            dec.feed(ByteSpan(data.data() + pos, std::min(CHUNK, bytes - pos)), out);
+        }
+        dec.finish(out);
+        bench::do_not_optimize(out.size());
+    });
+    bench::report_throughput("buffer + is_valid", t_whole, bytes);
+    bench::report_throughput("StreamValidator::feed", t_stream, bytes);
+    bench::report_throughput("decode_all (whole buffer)", t_decode_all, bytes);
+    bench::report_throughput("StreamDecoder::feed", t_decoder, bytes);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::string text;
+    while (text.size() < (4u << 20)) {
+        text += "GET /api/" + std::to_string(rng.below(100000)) + " " + bench::make_cjk_text(8, rng) + "\n";
+    }
+    run("CJK mixed", text);
+    return 0;
+}
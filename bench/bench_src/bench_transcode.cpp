@@ -0,0 +1,73 @@
+// UTF-8 ↔ UTF-16 / Latin-1: decode_all 经 UTF-32 中转 vs 直接转码到复用的缓冲
+#include "bench_util.hpp"
+#include "utf8.hpp"
+
+using kstring::ByteVec;
+using kstring::CodePoint;
+
+namespace {
+// 旧做法: 先解码为 UTF-32, 再逐个码点拆成 UTF-16
+void via_utf32(const ByteVec& data, std::u16string& out) {
+    std::vector<CodePoint> cps = utf8::decode_all(data);
+    out.clear();
+    out.reserve(cps.size() * 2);
+    for (CodePoint cp : cps) {
+        if (cp < 0x10000) {
+            out.push_back(static_cast<char16_t>(cp));
+        } else {
+            cp -= 0x10000;
+            out.push_back(static_cast<char16_t>(0xD800 + (cp >> 10)));
+            out.push_back(static_cast<char16_t>(0xDC00 + (cp & 0x3FF)));
+        }
+    }
+}
+
+void run(const char* name, const std::string& text) {
+    ByteVec data(text.begin(), text.end());
+    std::size_t bytes = data.size();
+    std::printf(" %s input, %zu bytes\n", name, bytes);
+    std::u16string wide;
+    ByteVec back;
+    double t_old = bench::time_ns(10, [&](std::size_t) {
+        via_utf32(data, wide);
+        bench::do_not_optimize(wide.size());
+    });
+    double t_to16 = bench::time_ns(10, [&](std::size_t) {
+        wide.clear();
+        utf8::append_utf16(data, wide);
+        bench::do_not_optimize(wide.size());
+    });
+    double t_from16 = bench::time_ns(10, [&](std::size_t) {
+        back.clear();
+        utf8::append_from_utf16(wide.data(), wide.size(), back);
+        bench::do_not_optimize(back.size());
+    });
+    double t_latin1 = bench::time_ns(10, [&](std::size_t) {
+        back.clear();
+        utf8::append_latin1(data, back);
+        bench::do_not_optimize(back.size());
+    });
+    bench::report_throughput("decode_all + UTF-32 -> UTF-16", t_old, bytes);
+    bench::report_throughput("append_utf16", t_to16, bytes);
+    bench::report_throughput("append_from_utf16", t_from16, bytes);
+    bench::report_throughput("append_latin1 (lossy)", t_latin1, bytes);
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::string ascii;
+    std::string cjk;
+    std::string dirty;
+    while (cjk.size() < (1u << 20)) {
+        std::string id = std::to_string(rng.below(100000));
+        ascii += "GET /api/" + id + " HTTP/1.1 200 OK\n";
+        std::string line = "GET /api/" + id + " " + bench::make_cjk_text(8, rng) + "\n";
+        cjk += line;
+        dirty += line.substr(0, 12) + "\xff" + line.substr(12);
+    }
+    run("ASCII", ascii);
+    run("CJK mixed", cjk);
+    run("dirty (1 error per line)", dirty);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace bench {
+// 防止编译器把被测结果优化掉
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// 简单的 xorshift 伪随机数, 保证每次运行数据一致
+struct Rng {
+    uint64_t state;
+
+    explicit Rng(uint64_t seed = 0x9E3779B97F4A7C15ull) : state(seed) {}
+
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    std::size_t below(std::size_t n) {
+        return static_cast<std::size_t>(next() % n);
+    }
+};
+
+// 运行 fn 共 iters 次, 返回每次平均耗时 (ns)
+template <typename Fn>
+inline double time_ns(std::size_t iters, Fn fn) {
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iters; ++i) fn(i);
+    auto end = std::chrono::steady_clock::now();
+    double total = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    return total / static_cast<double>(iters);
+}
+
+inline void report(const char* name, double ns_per_op) {
+    std::printf("  %-48s %14.1f ns/op\n", name, ns_per_op);
+}
+
+inline void report_throughput(const char* name, double ns_per_op, std::size_t bytes) {
+    double gbps = static_cast<double>(bytes) / ns_per_op;
+    std::printf("  %-48s %14.1f ns/op  %8.3f GB/s\n", name, ns_per_op, gbps);
+}
+
+// 生成 n 个随机 CJK 统一表意文字 (U+4E00 ~ U+9FFF), 每个 3 字节
+inline std::string make_cjk_text(std::size_t chars, Rng& rng) {
+    std::string out;
+    out.reserve(chars * 3);
+    for (std::size_t i = 0; i < chars; ++i) {
+        uint32_t cp = 0x4E00 + static_cast<uint32_t>(rng.below(0x9FFF - 0x4E00));
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    return out;
+}
+} // namespace bench
@@ -0,0 +1,81 @@
+// 空白处理: 逐字符解码 + unordered_set 查表的旧实现 vs whitespace 批量扫描 (trim / split_whitespace)
+#include <unordered_set>
+#include "bench_util.hpp"
+#include "kstr.hpp"
+
+using kstring::KStr;
+
+namespace {
+// 改动前 KChar::is_whitespace 的做法
+bool old_is_whitespace(kstring::CodePoint cp) {
+    static const std::unordered_set<uint32_t> spaces = {0x20,   0x09,   0x0A,   0x0B,   0x0C,   0x0D,
+                                                        0xA0,   0x1680, 0x2000, 0x2001, 0x2002, 0x2003,
+                                                        0x2004, 0x2005, 0x2006, 0x2007, 0x2008, 0x2009,
+                                                        0x200A, 0x2028, 0x2029, 0x202F, 0x205F, 0x3000};
+    return spaces.count(cp) > 0;
+}
+
+KStr old_trim(KStr s) {
+    kstring::ByteSpan data = s.as_bytes();
+    std::size_t start = 0;
+    for (const auto& ch : s.iter_chars()) {
+        if (! old_is_whitespace(ch.value())) break;
+        start += ch.utf8_size();
+    }
+    std::size_t end = data.size();
+    for (auto it = s.iter_chars_rev().begin(); it != s.iter_chars_rev().end() && end > start; ++it) {
+        if (! old_is_whitespace((*it).value())) break;
+        end -= (*it).utf8_size();
+    }
+    return KStr(data.data() + start, end - start);
+}
+
+// 改动前 split_whitespace 的做法: 逐字符判断, 每个空白都是一个分隔符
+std::size_t old_split_whitespace(KStr s) {
+    std::size_t words = 0;
+    bool in_word = false;
+    for (const auto& ch : s.iter_chars()) {
+        bool space = old_is_whitespace(ch.value());
+        if (! space && ! in_word) ++words;
+        in_word = ! space;
+    }
+    return words;
+}
+
+std::string make_padded(const std::string& body, std::size_t pad) {
+    return std::string(pad, ' ') + "\t" + body + "\n" + std::string(pad, ' ');
+}
+} // namespace
+
+int main() {
+    bench::Rng rng;
+    std::printf("backend = %s\n", kstring::whitespace::simd_backend());
+
+    std::string ascii_body;
+    for (int i = 0; i < 200; ++i) ascii_body += "word" + std::to_string(rng.below(1000)) + "  ";
+    std::string cjk_body;
+    for (int i = 0; i < 200; ++i) cjk_body += bench::make_cjk_text(3, rng) + "\xe3\x80\x80";
+
+    const std::string texts[] = {make_padded(ascii_body, 64), make_padded(cjk_body, 64)};
+    const char* names[] = {"ascii", "cjk"};
+    for (int t = 0; t < 2; ++t) {
+        KStr s(texts[t].data(), texts[t].size());
+        std::size_t bytes = texts[t].size();
+        std::printf(" %s text, %zu bytes\n", names[t], bytes);
+
+        double t_old_trim = bench::time_ns(20000, [&](std::size_t) { bench::do_not_optimize(old_trim(s)); });
+        double t_trim = bench::time_ns(20000, [&](std::size_t) { bench::do_not_optimize(s.trim()); });
+        double t_old_split =
+            bench::time_ns(2000, [&](std::size_t) { bench::do_not_optimize(old_split_whitespace(s)); });
+        double t_split = bench::time_ns(2000, [&](std::size_t) {
+            std::size_t words = 0;
+            for (KStr w : s.split_whitespace_iter()) words += w.byte_size() != 0;
+            bench::do_not_optimize(words);
+        });
+        bench::report_throughput("old trim (unordered_set)", t_old_trim, 130);
+        bench::report_throughput("KStr::trim", t_trim, 130);
+        bench::report_throughput("old split_whitespace (unordered_set)", t_old_split, bytes);
+        bench::report_throughput("KStr::split_whitespace_iter", t_split, bytes);
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "base.hpp"
+
+namespace kstring {
+namespace search {
+// 多个模式在同一起点都能匹配时的取舍规则, 两种规则都是先取起点最靠左的匹配
+enum class MatchKind {
+    LeftmostFirst,  // 取构造时排在最前 (id 最小) 的模式, 同正则的 a|ab
+    LeftmostLongest // 取最长的模式, 等长时取 id 最小的
+};
+
+// 一次多模式匹配: 模式 id (构造时的下标) 与字节区间 [start, end), 未匹配时三者均为 knpos
+struct MultiMatch {
+    std::size_t pattern;
+    std::size_t start;
+    std::size_t end;
+
+    MultiMatch() : pattern(knpos), start(knpos), end(knpos) {}
+
+    MultiMatch(std::size_t pat, std::size_t s, std::size_t e) : pattern(pat), start(s), end(e) {}
+
+    bool found() const {
+        return pattern != knpos;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const MultiMatch& m) {
+        return os << "[pattern=" << m.pattern << ", " << m.start << ".." << m.end << "]";
+    }
+
+    friend bool operator==(const MultiMatch& a, const MultiMatch& b) {
+        return a.pattern == b.pattern && a.start == b.start && a.end == b.end;
+    }
+
+    friend bool operator!=(const MultiMatch& a, const MultiMatch& b) {
+        return ! (a == b);
+    }
+};
+
+/**
+ * @brief 字节级多模式匹配引擎 (Aho-Corasick), 一次扫描同时查找任意多个模式
+ * 构造时建 trie 并补全为 DFA, 转移表按字节等价类压缩: 只有模式中出现过的字节各占一列, 其余字节共用一列
+ * 不同首字节不超过 FIRST_OF_SIMD_MAX 个时, 回到初始状态后用 SIMD 的 find_first_of 直接跳到下一个可能的起点
+ * 转移表大小为 状态数 × 字节类数 × 4 字节, 状态数不超过模式总字节数 + 1
+ * 引擎持有模式的拷贝, 不依赖构造时传入的内存
+ */
+class AhoCorasick {
+  public:
+    explicit AhoCorasick(const std::vector<ByteSpan>& patterns, MatchKind kind = MatchKind::LeftmostFirst);
+
+    std::size_t pattern_count() const {
+        return offsets_.size() - 1;
+    }
+
+    ByteSpan pattern(std::size_t id) const;
+
+    MatchKind match_kind() const {
+        return kind_;
+    }
+
+    // 是否启用了首字节预过滤
+    bool has_prefilter() const {
+        return ! start_bytes_.empty();
+    }
+
+    std::size_t state_count() const {
+        return depth_.size();
+    }
+
+    // 从字节位置 from 起的第一个匹配, from 超过 hay.size() 或无匹配时返回 found() == false 的结果
+    MultiMatch find(ByteSpan hay, std::size_t from = 0) const;
+
+    // 所有互不重叠的匹配, 空匹配之后前进一个字节
+    std::vector<MultiMatch> find_all(ByteSpan hay) const;
+
+    bool contains_any(ByteSpan hay) const {
+        return find(hay).found();
+    }
+
+  private:
+    void build();
+    bool better(const MultiMatch& cand, const MultiMatch& best) const;
+
+    ByteVec storage_;                  // 所有模式首尾相接
+    std::vector<std::size_t> offsets_; // 第 i 个模式为 storage_[offsets_[i], offsets_[i + 1])
+    MatchKind kind_;
+    std::uint16_t classes_[256];       // 字节 -> 字节类, 0 为未出现在任何模式中的字节
+    std::size_t alphabet_;             // 字节类个数
+    std::vector<std::uint32_t> trans_; // DFA 转移表, trans_[state * alphabet_ + class]
+    std::vector<std::uint32_t> depth_; // 状态对应的 trie 前缀长度
+    std::vector<std::uint32_t> match_; // 恰好在该状态结束的模式 id (重复模式取最小), 没有则为 NONE
+    std::vector<std::uint32_t> dict_;  // 后缀链上下一个有 match_ 的状态, 没有则为 NONE
+    std::size_t empty_id_;             // 最小的空模式 id, 没有空模式为 knpos
+    ByteVec start_bytes_;              // 预过滤用的全部不同首字节, 未启用时为空
+};
+} // namespace search
+} // namespace kstring
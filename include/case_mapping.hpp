@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include "base.hpp"
+#include "unicode.hpp"
+
+namespace kstring {
+namespace unicode {
+// 完整大小写映射的结果, 最多 3 个码点 (如 ß → SS, ΐ → Ϊ́)
+struct CaseMapping {
+    CodePoint chars[3];
+    std::size_t len;
+
+    const CodePoint* begin() const {
+        return chars;
+    }
+
+    const CodePoint* end() const {
+        return chars + len;
+    }
+};
+
+// 码点的大小写记录 (两级表后再取一次记录); 超出 Unicode 范围的值没有映射
+inline const tables::CaseRecord& case_record(CodePoint cp) {
+    if (cp >= 0x110000) return tables::CASE_RECORDS[0];
+    std::size_t block = static_cast<std::size_t>(tables::CASE_STAGE1[cp >> tables::CASE_SHIFT]) << tables::CASE_SHIFT;
+    return tables::CASE_RECORDS[tables::CASE_STAGE2[block | (cp & ((1u << tables::CASE_SHIFT) - 1))]];
+}
+
+// 简单映射 (UnicodeData), 一对一, 没有映射时返回自身
+inline CodePoint simple_uppercase(CodePoint cp) {
+    return cp + static_cast<CodePoint>(case_record(cp).upper);
+}
+
+inline CodePoint simple_lowercase(CodePoint cp) {
+    return cp + static_cast<CodePoint>(case_record(cp).lower);
+}
+
+inline CodePoint simple_titlecase(CodePoint cp) {
+    return cp + static_cast<CodePoint>(case_record(cp).title);
+}
+
+/**
+ * @brief 完整映射 (SpecialCasing 中的无条件映射, 其余同简单映射), 与语言无关
+ * 带条件的映射中只有 Final_Sigma 由 to_lowercase 按上下文处理, 土耳其语等语言相关的映射不处理
+ */
+CaseMapping full_uppercase(CodePoint cp);
+CaseMapping full_lowercase(CodePoint cp);
+CaseMapping full_titlecase(CodePoint cp);
+
+/**
+ * @brief 把 text 的小写/大写形式追加到 out, 使用完整映射
+ * 32 字节全是 ASCII 时用 SIMD 整块转换, 其余字符逐个查表; 非法字节原样复制
+ */
+void append_lowercase(ByteSpan text, ByteVec& out);
+void append_uppercase(ByteSpan text, ByteVec& out);
+
+// 当前 CPU 上 ASCII 整块转换实际使用的实现: "avx2" / "sse2" / "scalar"
+const char* case_simd_backend();
+} // namespace unicode
+} // namespace kstring
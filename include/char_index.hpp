@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "base.hpp"
+
+namespace kstring {
+/**
+ * @brief 采样的 "字符下标 -> 字节偏移" 索引
+ * 每 stride 个字符记录一次起始字节偏移, 随机按字符访问只需从最近的采样点向后走不超过 stride 个字符,
+ * 即 O(stride) 而不是 O(N)。全 ASCII 文本不存采样点, 字符下标即字节偏移。
+ *
+ * 索引只借用 data 而不拥有, 使用期间 data 必须保持有效且不被修改。
+ * 字符切分语义与 utf8::decode_one 的 next_pos 一致（一个非法序列计为一个字符）。
+ */
+class CharOffsetIndex {
+  public:
+    enum : std::size_t {
+        DEFAULT_STRIDE = 64
+    };
+
+    CharOffsetIndex();
+
+    explicit CharOffsetIndex(ByteSpan data, std::size_t stride = DEFAULT_STRIDE);
+
+    ByteSpan source() const {
+        return data_;
+    }
+
+    std::size_t stride() const {
+        return stride_;
+    }
+
+    std::size_t char_size() const {
+        return char_size_;
+    }
+
+    bool is_ascii() const {
+        return ascii_;
+    }
+
+    // 索引自身占用的采样点数量
+    std::size_t sample_count() const {
+        return samples_.size();
+    }
+
+    // 第 char_idx 个字符的起始字节偏移, char_idx == char_size() 时返回 data.size(), 超出返回 knpos
+    std::size_t byte_offset(std::size_t char_idx) const;
+
+    // 给定字节偏移之前的字符数, 语义同 KStr::count_chars_before
+    std::size_t char_index(std::size_t byte_offset) const;
+
+    // 将索引重新绑定到内容完全相同的另一块内存（拷贝/移动拥有者时使用）
+    void rebind(ByteSpan data);
+
+  private:
+    ByteSpan data_;
+    std::size_t stride_;
+    std::size_t char_size_;
+    bool ascii_;
+    std::vector<std::size_t> samples_; // samples_[k] 为第 k * stride_ 个字符的起始字节偏移
+};
+} // namespace kstring
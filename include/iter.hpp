@@ -1,6 +1,7 @@
 #pragma once
 #include "base.hpp"
 #include "kchar.hpp"
+#include "segmentation.hpp"
 #include "utf8.hpp"
 
 namespace kstring {
@@ -9,16 +10,18 @@ struct CharIterator {
     std::size_t cur_pos; // 当前字符的起始字节位置
     std::size_t end_pos; // 字符串末尾字节位置
     mutable KChar current;
+    mutable std::size_t next_pos; // 解码后下一个字符的起始位置, 一个非法序列整体跳过
     mutable bool decoded;
 
     CharIterator(ByteSpan data, std::size_t start_pos)
-        : data_(data), cur_pos(start_pos), end_pos(data.size()), current(), decoded(false) {}
+        : data_(data), cur_pos(start_pos), end_pos(data.size()), current(), next_pos(start_pos), decoded(false) {}
 
     KChar operator*() const {
         if (cur_pos >= end_pos) return KChar(); // 返回空字符
         if (! decoded) {
             auto dec = utf8::decode_one(data_, cur_pos);
             current = dec.ok ? KChar(dec.codepoint) : KChar();
+            next_pos = dec.next_pos;
             decoded = true;
         }
         return current;
@@ -26,8 +29,7 @@ struct CharIterator {
 
     CharIterator& operator++() {
         if (decoded) { // 已经解码则直接复用
-            std::size_t size = current.utf8_size();
-            cur_pos += (size == 0) ? 1 : size;
+            cur_pos = next_pos;
         } else { // 尚未解码则解码获取 next_pos
             auto dec = utf8::decode_one(data_, cur_pos);
             cur_pos = dec.next_pos;
@@ -37,6 +39,11 @@ struct CharIterator {
         return *this;
     }
 
+    // 当前字符的起始字节位置
+    std::size_t byte_offset() const {
+        return cur_pos;
+    }
+
     bool operator==(const CharIterator& other) const {
         return cur_pos == other.cur_pos && data_.data() == other.data_.data();
     }
@@ -66,21 +73,101 @@ struct CharRange {
     }
 };
 
+/**
+ * @brief 按块解码的字符迭代器: 每次用 simdutf 把接下来至多 CHUNK 个字符转换到内联的 UTF-32 缓冲区, 再逐个给出 KChar
+ * 给出的字符序列与 iter_chars 相同 (每个非法序列给出一个 KChar()), 只做正向单遍遍历
+ */
+class ChunkedCharIterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = KChar;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = KChar;
+
+    static const std::size_t CHUNK = 64;
+
+    ChunkedCharIterator(ByteSpan data, std::size_t pos)
+        : data_(data), pos_(pos), offset_(pos), idx_(0), len_(0), buf_() {
+        refill();
+    }
+
+    KChar operator*() const {
+        CodePoint cp = buf_[idx_];
+        return cp == utf8::INVALID_SEQUENCE ? KChar() : KChar(cp);
+    }
+
+    // 非法序列总在块尾, 块内的字符都是合法码点, 按编码长度累加起始位置
+    ChunkedCharIterator& operator++() {
+        if (++idx_ == len_) {
+            refill();
+        } else {
+            CodePoint cp = buf_[idx_ - 1];
+            offset_ += cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+        }
+        return *this;
+    }
+
+    // 当前字符的起始字节位置
+    std::size_t byte_offset() const {
+        return offset_;
+    }
+
+    // 比较尚未给出的位置: 已解码到的字节位置与缓冲区中剩余的字符数
+    bool operator==(const ChunkedCharIterator& other) const {
+        return pos_ == other.pos_ && len_ - idx_ == other.len_ - other.idx_ && data_.data() == other.data_.data();
+    }
+
+    bool operator!=(const ChunkedCharIterator& other) const {
+        return ! (*this == other);
+    }
+
+  private:
+    void refill() {
+        idx_ = 0;
+        offset_ = pos_;
+        len_ = utf8::decode_chunk(data_, pos_, buf_, CHUNK);
+    }
+
+    ByteSpan data_;
+    std::size_t pos_;    // 下一块的起始字节位置
+    std::size_t offset_; // 当前字符的起始字节位置
+    std::size_t idx_;    // 当前字符在缓冲区中的下标
+    std::size_t len_;    // 缓冲区中的字符数, 为 0 表示结束
+    CodePoint buf_[CHUNK];
+};
+
+struct ChunkedCharRange {
+    ByteSpan data;
+
+    explicit ChunkedCharRange(ByteSpan d) : data(d) {}
+
+    ChunkedCharIterator begin() const {
+        return ChunkedCharIterator(data, 0);
+    }
+
+    ChunkedCharIterator end() const {
+        return ChunkedCharIterator(data, data.size());
+    }
+};
+
 struct ReverseCharIterator {
     ByteSpan data_;
     std::size_t cur_pos; // 当前字符的末尾字节位置（注意：是末尾！）
     mutable KChar current;
+    mutable std::size_t prev_pos; // 解码后当前字符的起始位置
     mutable bool decoded;
 
     ReverseCharIterator(ByteSpan data, std::size_t end_pos)
-        : data_(data), cur_pos(end_pos), current(), decoded(false) {}
+        : data_(data), cur_pos(end_pos), current(), prev_pos(end_pos), decoded(false) {}
 
     KChar operator*() const {
         if (cur_pos == 0) return KChar(); // 到达字符串开头，返回空字符
         if (! decoded) {
-            // 需要从当前位置向前寻找一个有效的UTF-8字符起始位置
+            // 从末尾跳过续字节找到首字节, 切分与正向迭代一致
             auto dec = utf8::decode_one_prev(data_, cur_pos);
             current = dec.ok ? KChar(dec.codepoint) : KChar();
+            prev_pos = dec.next_pos;
             decoded = true;
         }
         return current;
@@ -88,8 +175,7 @@ struct ReverseCharIterator {
 
     ReverseCharIterator& operator++() {
         if (decoded) { // 已经解码则直接复用
-            std::size_t size = current.utf8_size();
-            cur_pos -= (size == 0) ? 1 : size;
+            cur_pos = prev_pos;
         } else { // 尚未解码则解码获取 next_pos
             auto dec = utf8::decode_one_prev(data_, cur_pos);
             cur_pos = dec.next_pos;
@@ -128,6 +214,163 @@ struct ReverseCharRange {
     }
 };
 
+// 分段策略, 供 BasicSegmentIterator 使用: next / prev 给出相邻的边界, keep 决定是否给出该分段
+struct GraphemeSegmenter {
+    static std::size_t next(ByteSpan text, std::size_t pos) {
+        return unicode::next_grapheme_boundary(text, pos);
+    }
+
+    static std::size_t prev(ByteSpan text, std::size_t pos) {
+        return unicode::prev_grapheme_boundary(text, pos);
+    }
+
+    static bool keep(ByteSpan) {
+        return true;
+    }
+};
+
+// 词边界之间的所有分段, 包括空白与标点
+struct WordBoundSegmenter {
+    static std::size_t next(ByteSpan text, std::size_t pos) {
+        return unicode::next_word_boundary(text, pos);
+    }
+
+    static std::size_t prev(ByteSpan text, std::size_t pos) {
+        return unicode::prev_word_boundary(text, pos);
+    }
+
+    static bool keep(ByteSpan) {
+        return true;
+    }
+};
+
+// 只保留含字母, 数字或表意文字的词
+struct WordSegmenter : WordBoundSegmenter {
+    static bool keep(ByteSpan segment) {
+        return unicode::is_word_like(segment);
+    }
+};
+
+struct SentenceSegmenter {
+    static std::size_t next(ByteSpan text, std::size_t pos) {
+        return unicode::next_sentence_boundary(text, pos);
+    }
+
+    static std::size_t prev(ByteSpan text, std::size_t pos) {
+        return unicode::prev_sentence_boundary(text, pos);
+    }
+
+    static bool keep(ByteSpan) {
+        return true;
+    }
+};
+
+/**
+ * @brief 按 UAX #29 边界切分的迭代器 (字素簇 / 词 / 句), 每次给出一个指向原串的视图 (View 为 KStr), 不分配内存
+ * 逆向迭代从尾到头给出与正向相同的切分; offset() 为当前分段在原串中的字节偏移
+ */
+template <typename View, typename Segmenter>
+class BasicSegmentIterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = View;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const View*;
+    using reference = const View&;
+
+    // 正向时 pos 为当前分段的起始位置, 逆向时为当前分段的结束位置
+    BasicSegmentIterator(ByteSpan data, std::size_t pos, bool reverse)
+        : data_(data), lo_(pos), hi_(pos), reverse_(reverse), current_() {
+        load();
+    }
+
+    const View& operator*() const {
+        return current_;
+    }
+
+    const View* operator->() const {
+        return &current_;
+    }
+
+    std::size_t offset() const {
+        return lo_;
+    }
+
+    BasicSegmentIterator& operator++() {
+        step();
+        load();
+        return *this;
+    }
+
+    BasicSegmentIterator operator++(int) {
+        BasicSegmentIterator old(*this);
+        ++*this;
+        return old;
+    }
+
+    bool operator==(const BasicSegmentIterator& other) const {
+        return (reverse_ ? hi_ : lo_) == (other.reverse_ ? other.hi_ : other.lo_) && data_.data() == other.data_.data();
+    }
+
+    bool operator!=(const BasicSegmentIterator& other) const {
+        return ! (*this == other);
+    }
+
+  private:
+    void step() {
+        if (reverse_) {
+            hi_ = lo_;
+        } else {
+            lo_ = hi_;
+        }
+    }
+
+    // 找到下一个 keep 的分段, 到头时为空
+    void load() {
+        while (true) {
+            if (reverse_) {
+                lo_ = Segmenter::prev(data_, hi_);
+            } else {
+                hi_ = Segmenter::next(data_, lo_);
+            }
+            if (lo_ == hi_ || Segmenter::keep(data_.subspan(lo_, hi_ - lo_))) break;
+            step();
+        }
+        current_ = View(data_.data() + lo_, hi_ - lo_);
+    }
+
+    ByteSpan data_;
+    std::size_t lo_; // 当前分段为 [lo_, hi_)
+    std::size_t hi_;
+    bool reverse_;
+    View current_;
+};
+
+// iter_graphemes / iter_words 等返回的区间, reversed() 得到反方向的区间
+template <typename View, typename Segmenter>
+class BasicSegmentRange {
+  public:
+    using iterator = BasicSegmentIterator<View, Segmenter>;
+
+    explicit BasicSegmentRange(ByteSpan data, bool reverse = false) : data_(data), reverse_(reverse) {}
+
+    iterator begin() const {
+        return iterator(data_, reverse_ ? data_.size() : 0, reverse_);
+    }
+
+    iterator end() const {
+        return iterator(data_, reverse_ ? 0 : data_.size(), reverse_);
+    }
+
+    BasicSegmentRange reversed() const {
+        return BasicSegmentRange(data_, ! reverse_);
+    }
+
+  private:
+    ByteSpan data_;
+    bool reverse_;
+};
+
 struct CharIndex {
     KChar ch;
     std::size_t byte_offset;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base.hpp"
+#include "split.hpp"
 #include <cstring>
 #include <stdexcept>
 #include <string>
@@ -8,10 +9,15 @@
 
 namespace kstring {
 class KAString;
+class KASearcher;
 
 // ascii-only string, read-only and hasn't ownership
 class KAStr {
   public:
+    typedef BasicSplitRange<KAStr, SubstrDelimiter> SplitRange;
+    typedef BasicSplitRange<KAStr, LineDelimiter> LineRange;
+    typedef BasicSplitRange<KAStr, AsciiWhitespaceDelimiter> WhitespaceRange;
+
     KAStr() : data_() {}
 
     KAStr(const char* cstr) : data_(reinterpret_cast<const Byte*>(cstr), std::strlen(cstr)) {}
@@ -93,12 +99,28 @@ class KAStr {
 
     std::size_t rfind(KAStr substr) const;
 
+    // 使用预编译的查找器, 同一模式反复查找时省去每次的预处理
+    std::size_t find(const KASearcher& searcher) const;
+    std::size_t rfind(const KASearcher& searcher) const;
+
     bool contains(KAStr substr) const;
 
     bool starts_with(KAStr prefix) const;
 
     bool ends_with(KAStr suffix) const;
 
+    // 忽略 ASCII 大小写的版本, 不分配内存 (如 HTTP 头字段名的比较)
+    bool eq_ignore_ascii_case(KAStr other) const;
+
+    std::size_t find_ignore_ascii_case(KAStr substr) const;
+
+    bool starts_with_ignore_ascii_case(KAStr prefix) const;
+
+    bool ends_with_ignore_ascii_case(KAStr suffix) const;
+
+    // 与 eq_ignore_ascii_case 相容的哈希
+    std::size_t hash_ignore_ascii_case() const;
+
     KAStr substr(std::size_t start, std::size_t count) const;
     KAStr substr(std::size_t start) const;
 
@@ -125,6 +147,26 @@ class KAStr {
 
     std::vector<KAStr> lines() const;
 
+    // split 系列的惰性版本, 逐个给出视图而不分配内存; 正向同 split_count, reversed() 后同 rsplit_count
+    SplitRange split_iter(KAStr delim, std::size_t max_splits = knpos) const {
+        return SplitRange(data_, SubstrDelimiter(delim.data_), max_splits);
+    }
+
+    SplitRange rsplit_iter(KAStr delim, std::size_t max_splits = knpos) const {
+        return SplitRange(data_, SubstrDelimiter(delim.data_), max_splits, true);
+    }
+
+    LineRange lines_iter() const {
+        return LineRange(data_, LineDelimiter());
+    }
+
+    WhitespaceRange split_whitespace_iter() const {
+        return WhitespaceRange(data_, AsciiWhitespaceDelimiter());
+    }
+
+    // 分隔符字节偏移批量写入 out, 语义同 KStr::split_offsets
+    std::size_t split_offsets(KAStr delim, std::size_t* out, std::size_t cap, std::size_t from = 0) const;
+
     KAStr strip_prefix(KAStr prefix) const;
 
     KAStr strip_suffix(KAStr suffix) const;
@@ -135,6 +177,10 @@ class KAStr {
 
     KAStr trim() const;
 
+    // 替换为新串, 语义同 KStr::replace / replacen; from 为空时在每个字节之间 (含首尾) 插入 to
+    KAString replace(KAStr from, KAStr to) const;
+    KAString replacen(KAStr from, KAStr to, std::size_t count) const;
+
     template <typename Predicate>
     std::vector<KAStr> match(Predicate pred) const {
         std::vector<KAStr> out;
@@ -198,6 +244,20 @@ inline std::size_t fnv1a_hash(const ByteRange& r) {
     }
     return h;
 }
+
+// 忽略 ASCII 大小写的哈希与相等比较, 用作无序容器的模板参数:
+//   std::unordered_map<KAStr, V, IgnoreAsciiCaseHash, IgnoreAsciiCaseEqual>
+struct IgnoreAsciiCaseHash {
+    std::size_t operator()(const KAStr& s) const {
+        return s.hash_ignore_ascii_case();
+    }
+};
+
+struct IgnoreAsciiCaseEqual {
+    bool operator()(const KAStr& lhs, const KAStr& rhs) const {
+        return lhs.eq_ignore_ascii_case(rhs);
+    }
+};
 } // namespace kstring
 
 namespace std {
@@ -7,6 +7,7 @@
 #include <stdexcept>
 #include <string>
 #include <ostream>
+#include <utility>
 
 #include "./kastr.hpp"
 #include "./sso.hpp"
@@ -28,6 +29,9 @@ class KAString {
 
     KAString(KAStr kastr) : data_(kastr.data(), kastr.byte_size()) {}
 
+    // 接管 bytes 的存储, 长串不再拷贝字节 (短串拷入 SSO, bytes 保持原样); 内嵌的 0 字节原样保留
+    explicit KAString(ByteVec&& bytes) : data_(std::move(bytes)) {}
+
     // 拷贝构造/赋值, 移动构造/赋值, 析构
     KAString(const KAString&) = default;
     KAString& operator=(const KAString&) = default;
@@ -305,6 +309,14 @@ class KAString {
         return as_kastr().rfind(substr);
     }
 
+    std::size_t find(const KASearcher& searcher) const {
+        return as_kastr().find(searcher);
+    }
+
+    std::size_t rfind(const KASearcher& searcher) const {
+        return as_kastr().rfind(searcher);
+    }
+
     bool contains(KAStr substr) const {
         return as_kastr().contains(substr);
     }
@@ -317,6 +329,26 @@ class KAString {
         return as_kastr().ends_with(suffix);
     }
 
+    bool eq_ignore_ascii_case(KAStr other) const {
+        return as_kastr().eq_ignore_ascii_case(other);
+    }
+
+    std::size_t find_ignore_ascii_case(KAStr substr) const {
+        return as_kastr().find_ignore_ascii_case(substr);
+    }
+
+    bool starts_with_ignore_ascii_case(KAStr prefix) const {
+        return as_kastr().starts_with_ignore_ascii_case(prefix);
+    }
+
+    bool ends_with_ignore_ascii_case(KAStr suffix) const {
+        return as_kastr().ends_with_ignore_ascii_case(suffix);
+    }
+
+    std::size_t hash_ignore_ascii_case() const {
+        return as_kastr().hash_ignore_ascii_case();
+    }
+
     KAStr substr(std::size_t start, std::size_t count) const {
         return as_kastr().substr(start, count);
     }
@@ -373,6 +405,26 @@ class KAString {
         return as_kastr().lines();
     }
 
+    KAStr::SplitRange split_iter(KAStr delim, std::size_t max_splits = knpos) const {
+        return as_kastr().split_iter(delim, max_splits);
+    }
+
+    KAStr::SplitRange rsplit_iter(KAStr delim, std::size_t max_splits = knpos) const {
+        return as_kastr().rsplit_iter(delim, max_splits);
+    }
+
+    KAStr::LineRange lines_iter() const {
+        return as_kastr().lines_iter();
+    }
+
+    KAStr::WhitespaceRange split_whitespace_iter() const {
+        return as_kastr().split_whitespace_iter();
+    }
+
+    std::size_t split_offsets(KAStr delim, std::size_t* out, std::size_t cap, std::size_t from = 0) const {
+        return as_kastr().split_offsets(delim, out, cap, from);
+    }
+
     KAStr strip_prefix(KAStr prefix) const {
         return as_kastr().strip_prefix(prefix);
     }
@@ -393,6 +445,14 @@ class KAString {
         return as_kastr().trim();
     }
 
+    KAString replace(KAStr from, KAStr to) const {
+        return as_kastr().replace(from, to);
+    }
+
+    KAString replacen(KAStr from, KAStr to, std::size_t count) const {
+        return as_kastr().replacen(from, to, count);
+    }
+
     template <typename Predicate>
     std::vector<KAStr> match(Predicate pred) const {
         return as_kastr().match(pred);
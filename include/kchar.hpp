@@ -4,9 +4,11 @@
 #include <cstring>
 #include <ostream>
 #include <stdexcept>
-#include <unordered_set>
 #include "base.hpp"
+#include "case_mapping.hpp"
+#include "unicode.hpp"
 #include "utf8.hpp"
+#include "whitespace.hpp"
 
 namespace kstring {
 class KChar {
@@ -72,68 +74,95 @@ class KChar {
         return cp_ <= 0x7F;
     }
 
-    bool is_digit() const {
+    bool is_ascii_digit() const {
         return cp_ >= '0' && cp_ <= '9';
     }
 
-    bool is_upper() const {
+    bool is_ascii_upper() const {
         return cp_ >= 'A' && cp_ <= 'Z';
     }
 
-    bool is_lower() const {
+    bool is_ascii_lower() const {
         return cp_ >= 'a' && cp_ <= 'z';
     }
 
+    bool is_ascii_alpha() const {
+        return is_ascii_upper() || is_ascii_lower();
+    }
+
+    // Unicode 判定, 查 unicode_tables 中的两级表
+    unicode::GeneralCategory general_category() const {
+        return unicode::general_category(cp_);
+    }
+
+    unicode::CharMask char_mask() const {
+        return unicode::char_mask(cp_);
+    }
+
+    // 十进制数字 (Nd), 如 '0', '٣', '９'
+    bool is_digit() const {
+        return (char_mask() & unicode::CHAR_DIGIT) != 0;
+    }
+
+    // 任意数字 (N*), 如 'Ⅻ', '½'
+    bool is_numeric() const {
+        return (char_mask() & unicode::CHAR_NUMBER) != 0;
+    }
+
+    bool is_upper() const {
+        return unicode::is_uppercase(cp_);
+    }
+
+    bool is_lower() const {
+        return unicode::is_lowercase(cp_);
+    }
+
+    // Alphabetic 属性, 包括汉字与假名
     bool is_alpha() const {
-        return is_upper() || is_lower();
+        return unicode::is_alphabetic(cp_);
     }
 
     bool is_alnum() const {
-        return is_alpha() || is_digit();
+        return is_alpha() || is_numeric();
     }
 
     bool is_whitespace() const {
-        static const std::unordered_set<uint32_t> unicode_spaces = {// ASCII 空白
-                                                                    0x0020,
-                                                                    0x0009,
-                                                                    0x000A,
-                                                                    0x000B,
-                                                                    0x000C,
-                                                                    0x000D,
-                                                                    // unicode 空白
-                                                                    0x00A0,
-                                                                    0x1680,
-                                                                    0x2000,
-                                                                    0x2001,
-                                                                    0x2002,
-                                                                    0x2003,
-                                                                    0x2004,
-                                                                    0x2005,
-                                                                    0x2006,
-                                                                    0x2007,
-                                                                    0x2008,
-                                                                    0x2009,
-                                                                    0x200A,
-                                                                    0x2028,
-                                                                    0x2029,
-                                                                    0x202F,
-                                                                    0x205F,
-                                                                    0x3000};
-        return unicode_spaces.count(cp_) > 0;
+        return is_whitespace_codepoint(cp_);
+    }
+
+    bool is_punctuation() const {
+        return (char_mask() & unicode::CHAR_PUNCTUATION) != 0;
     }
 
+    bool is_control() const {
+        return general_category() == unicode::GeneralCategory::Cc;
+    }
+
+    // 除控制, 格式, 代理, 私用, 未分配与行/段分隔符以外的字符, 包括空格
     bool is_printable() const {
-        return (cp_ >= 0x20 && cp_ <= 0x7E); // basic printable ASCII
+        return (char_mask() & unicode::CHAR_PRINTABLE) != 0;
     }
 
+    // 简单大小写映射 (一对一), 如 'ж' → 'Ж'; 没有映射时返回自身
     KChar to_upper() const {
-        if (is_lower()) return KChar(cp_ - 32);
-        return *this;
+        return KChar(unicode::simple_uppercase(cp_));
     }
 
     KChar to_lower() const {
-        if (is_upper()) return KChar(cp_ + 32);
-        return *this;
+        return KChar(unicode::simple_lowercase(cp_));
+    }
+
+    KChar to_title() const {
+        return KChar(unicode::simple_titlecase(cp_));
+    }
+
+    // 完整大小写映射, 可能是多个字符, 如 'ß' → "SS"
+    unicode::CaseMapping to_upper_full() const {
+        return unicode::full_uppercase(cp_);
+    }
+
+    unicode::CaseMapping to_lower_full() const {
+        return unicode::full_lowercase(cp_);
     }
 
     char to_char() const {
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "aho_corasick.hpp"
+#include "kastr.hpp"
+#include "kstr.hpp"
+#include "search.hpp"
+
+namespace kstring {
+/**
+ * @brief 预编译的 UTF-8 子串查找器, 由模式构造一次后可在任意多个 KStr 上反复查找
+ * 预处理 (算法选择, 跳转表, 临界分解等) 只在构造时进行一次, 适合同一模式扫描大量短记录
+ * 拷贝开销很小, 引擎在拷贝之间共享
+ * @example：
+ *   KSearcher needle("错误");
+ *   for (KStr line : lines) if (line.find(needle) != knpos) ...
+ */
+class KSearcher {
+  public:
+    explicit KSearcher(KStr needle);
+
+    KStr needle() const {
+        return KStr(engine_->needle());
+    }
+
+    const search::Searcher& engine() const {
+        return *engine_;
+    }
+
+    // 按字符下标, 语义同 KStr::find / rfind
+    std::size_t find(KStr hay) const;
+    std::size_t rfind(KStr hay) const;
+
+    CharIndex find_index(KStr hay) const;
+    CharIndex rfind_index(KStr hay) const;
+
+    std::size_t find_in_bytes(KStr hay) const;
+    std::size_t rfind_in_bytes(KStr hay) const;
+
+    bool contains(KStr hay) const;
+
+    // 语义同 KStr::find_all, 复用本查找器的引擎
+    FindRange find_all(KStr hay) const;
+
+    // 非重叠匹配个数; 空模式匹配每个字符边界, 结果为字符数 + 1
+    std::size_t count(KStr hay) const;
+
+  private:
+    std::shared_ptr<const search::Searcher> engine_;
+};
+
+// ASCII 版本的预编译查找器, 位置均为字节下标
+class KASearcher {
+  public:
+    explicit KASearcher(KAStr needle);
+
+    KAStr needle() const {
+        ByteSpan bytes = engine_->needle();
+        return KAStr(bytes.data(), bytes.size());
+    }
+
+    const search::Searcher& engine() const {
+        return *engine_;
+    }
+
+    std::size_t find(KAStr hay) const;
+    std::size_t rfind(KAStr hay) const;
+    bool contains(KAStr hay) const;
+
+    // 所有非重叠匹配的起始位置
+    std::vector<std::size_t> find_all(KAStr hay) const;
+
+    // 非重叠匹配个数; 空模式结果为字节数 + 1
+    std::size_t count(KAStr hay) const;
+
+  private:
+    std::shared_ptr<const search::Searcher> engine_;
+};
+
+using search::MatchKind;
+
+// 多模式匹配结果, text 为指向被查找串的视图; 未匹配时 pattern / byte_offset / char_index 均为 knpos
+struct KMatch {
+    std::size_t pattern;
+    std::size_t byte_offset;
+    std::size_t char_index;
+    KStr text;
+
+    KMatch() : pattern(knpos), byte_offset(knpos), char_index(knpos), text() {}
+
+    KMatch(std::size_t pat, std::size_t byte_off, std::size_t char_idx, KStr t)
+        : pattern(pat), byte_offset(byte_off), char_index(char_idx), text(t) {}
+
+    bool found() const {
+        return pattern != knpos;
+    }
+};
+
+/**
+ * @brief 预编译的多模式查找器, 一次扫描同时查找全部模式, 代替对每个关键词循环调用 contains
+ * 起点相同的多个匹配按 MatchKind 取舍, 拷贝开销很小, 引擎在拷贝之间共享
+ * @example：
+ *   KMultiSearcher keywords({"错误", "error", "超时"});
+ *   for (const auto& m : keywords.find_all(body)) report(m.pattern, m.char_index, m.text);
+ */
+class KMultiSearcher {
+  public:
+    explicit KMultiSearcher(const std::vector<KStr>& patterns, MatchKind kind = MatchKind::LeftmostFirst);
+
+    std::size_t pattern_count() const {
+        return engine_->pattern_count();
+    }
+
+    KStr pattern(std::size_t id) const {
+        return KStr(engine_->pattern(id));
+    }
+
+    const search::AhoCorasick& engine() const {
+        return *engine_;
+    }
+
+    KMatch find(KStr hay) const;
+
+    // 所有互不重叠的匹配, 字符下标沿扫描增量统计; 空匹配之后前进一个字符
+    std::vector<KMatch> find_all(KStr hay) const;
+
+    bool contains_any(KStr hay) const {
+        return engine_->contains_any(hay.as_bytes());
+    }
+
+  private:
+    std::shared_ptr<const search::AhoCorasick> engine_;
+};
+
+// ASCII 版本的多模式匹配结果, 位置为字节下标
+struct KAMatch {
+    std::size_t pattern;
+    std::size_t offset;
+    KAStr text;
+
+    KAMatch() : pattern(knpos), offset(knpos), text() {}
+
+    KAMatch(std::size_t pat, std::size_t off, KAStr t) : pattern(pat), offset(off), text(t) {}
+
+    bool found() const {
+        return pattern != knpos;
+    }
+};
+
+class KAMultiSearcher {
+  public:
+    explicit KAMultiSearcher(const std::vector<KAStr>& patterns, MatchKind kind = MatchKind::LeftmostFirst);
+
+    std::size_t pattern_count() const {
+        return engine_->pattern_count();
+    }
+
+    KAStr pattern(std::size_t id) const {
+        ByteSpan bytes = engine_->pattern(id);
+        return KAStr(bytes.data(), bytes.size());
+    }
+
+    const search::AhoCorasick& engine() const {
+        return *engine_;
+    }
+
+    KAMatch find(KAStr hay) const;
+
+    // 所有互不重叠的匹配, 空匹配之后前进一个字节
+    std::vector<KAMatch> find_all(KAStr hay) const;
+
+    bool contains_any(KAStr hay) const {
+        return engine_->contains_any(ByteSpan(hay.data(), hay.byte_size()));
+    }
+
+  private:
+    std::shared_ptr<const search::AhoCorasick> engine_;
+};
+} // namespace kstring
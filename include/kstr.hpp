@@ -1,10 +1,96 @@
 #pragma once
 
+#include <memory>
+#include "char_index.hpp"
 #include "iter.hpp"
+#include "normalization.hpp"
+#include "search.hpp"
+#include "split.hpp"
+#include "unicode.hpp"
 
 namespace kstring {
+class KSearcher;
+class KString;
+
+/**
+ * @brief KStr::find_all 的迭代器, 每次给出一个匹配的 CharIndex (首字符, 字节偏移, 字符下标)
+ * 字符下标按 iter_chars 的切分统计（一个非法序列计为一个字符）, 合法 UTF-8 下与 find 的结果一致
+ */
+class FindIterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = CharIndex;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const CharIndex*;
+    using reference = const CharIndex&;
+
+    // 结束迭代器
+    FindIterator();
+
+    FindIterator(ByteSpan hay, std::shared_ptr<const search::Searcher> searcher);
+
+    const CharIndex& operator*() const {
+        return current_;
+    }
+
+    const CharIndex* operator->() const {
+        return &current_;
+    }
+
+    FindIterator& operator++() {
+        advance();
+        return *this;
+    }
+
+    bool operator==(const FindIterator& other) const {
+        if (done_ || other.done_) return done_ == other.done_;
+        return current_.byte_offset == other.current_.byte_offset && hay_.data() == other.hay_.data();
+    }
+
+    bool operator!=(const FindIterator& other) const {
+        return ! (*this == other);
+    }
+
+  private:
+    void advance();
+
+    ByteSpan hay_;
+    std::shared_ptr<const search::Searcher> searcher_; // 模式只编译一次, 在迭代器拷贝之间共享
+    std::size_t search_pos_;    // 下一次查找的起始字节位置
+    std::size_t counted_pos_;   // 已统计到的字符边界
+    std::size_t counted_chars_; // counted_pos_ 之前的字符数
+    CharIndex current_;
+    bool done_;
+};
+
+class FindRange {
+  public:
+    FindRange(ByteSpan hay, std::shared_ptr<const search::Searcher> searcher)
+        : hay_(hay), searcher_(std::move(searcher)) {}
+
+    FindIterator begin() const {
+        return FindIterator(hay_, searcher_);
+    }
+
+    FindIterator end() const {
+        return FindIterator();
+    }
+
+  private:
+    ByteSpan hay_;
+    std::shared_ptr<const search::Searcher> searcher_;
+};
+
 class KStr {
   public:
+    typedef BasicSplitRange<KStr, SubstrDelimiter> SplitRange;
+    typedef BasicSplitRange<KStr, LineDelimiter> LineRange;
+    typedef BasicSplitRange<KStr, Utf8WhitespaceDelimiter> WhitespaceRange;
+    typedef BasicSegmentRange<KStr, GraphemeSegmenter> GraphemeRange;
+    typedef BasicSegmentRange<KStr, WordBoundSegmenter> WordBoundRange;
+    typedef BasicSegmentRange<KStr, WordSegmenter> WordRange;
+    typedef BasicSegmentRange<KStr, SentenceSegmenter> SentenceRange;
+
     KStr();
 
     // 该函数假设 cstr 是以 null 结尾的有效 UTF-8 字符串
@@ -21,6 +107,21 @@ class KStr {
 
     explicit KStr(ByteSpan bytes);
 
+    /**
+     * @brief 挂载一个字符偏移索引（借用, 不拥有）, 返回携带索引的视图
+     * 此后 char_at / operator[] / substr / subrange / split_at 等按字符下标的操作为 O(stride)
+     * 由该视图派生出的子视图不再携带索引
+     *
+     * @warning index 必须由本视图的同一块字节构建, 且生命周期长于返回的视图
+     */
+    KStr with_index(const CharOffsetIndex& index) const;
+
+    // 为当前视图构建字符偏移索引
+    CharOffsetIndex build_index(std::size_t stride = CharOffsetIndex::DEFAULT_STRIDE) const;
+
+    // 当前挂载的索引, 未挂载时为 nullptr
+    const CharOffsetIndex* index() const;
+
     friend bool operator==(const KStr& lhs, const KStr& rhs);
 
     friend bool operator==(const KStr& lhs, const char* rhs);
@@ -61,6 +162,35 @@ class KStr {
     CharRange iter_chars() const;
     ReverseCharRange iter_chars_rev() const;
 
+    /**
+     * @brief 按块解码的字符迭代器, 给出与 iter_chars 相同的 KChar 序列
+     * 每次用 simdutf 把至多 64 个字符转换到迭代器内的 UTF-32 缓冲区, 适合整串的谓词扫描
+     */
+    ChunkedCharRange iter_chars_chunked() const;
+
+    /**
+     * @brief 扩展字素簇 (用户可见字符) 迭代器, 每次给出一个子视图; 逆向迭代给出相同的切分
+     * 例:
+     *   KStr s("e\u0301👨\u200D👩\u200D👧🇨🇳");
+     *   for (KStr g : s.iter_graphemes()) ...  // "e\u0301", "👨\u200D👩\u200D👧", "🇨🇳"
+     *   s.grapheme_count() -> 3, s.char_size() -> 9
+     */
+    GraphemeRange iter_graphemes() const;
+    GraphemeRange iter_graphemes_rev() const;
+    std::size_t grapheme_count() const;
+
+    /**
+     * @brief 按 UAX #29 词边界切分, 给出子视图, 不分配内存; reversed() 逆向迭代, 迭代器的 offset() 为字节偏移
+     * iter_word_bounds 给出所有分段 (含空白与标点), iter_words 只给出含字母, 数字或汉字的分段
+     * 例:
+     *   KStr("can't stop 3.14 中文").iter_words()  // "can't", "stop", "3.14", "中", "文"
+     */
+    WordBoundRange iter_word_bounds() const;
+    WordRange iter_words() const;
+
+    // 按 UAX #29 句边界切分, 句末的空白与换行属于前一句
+    SentenceRange iter_sentences() const;
+
     // 获取第 idx 个字符（按字符下标），返回为子串字节
     ByteSpan operator[](std::size_t idx) const;
 
@@ -72,7 +202,7 @@ class KStr {
      * @brief 统计给定 byte offset 之前有多少个字符
      * 字符下标表示从开头到该字节偏移前，共有多少个字符。
      * 
-     * @warning 本函数是 O(N) 的，因为必须线性遍历每个 UTF-8 字符。
+     * @warning 本函数是 O(N) 的，因为必须线性遍历每个 UTF-8 字符; 挂载 CharOffsetIndex 后为 O(stride)。
      * @param byte_offset 字节偏移（必须小于等于总字节长度）
      * @return std::size_t 从起始位置到该偏移之间的字符数量（即字符下标）
      * @example：
@@ -98,6 +228,29 @@ class KStr {
 
     std::size_t rfind(KStr substr) const;
 
+    /**
+     * @brief 查找并同时返回匹配起点的字节偏移与字符下标, 避免调用方再做一次换算
+     * 找不到时 byte_offset 与 char_index 均为 knpos
+     * @example：
+     *   KStr("你a好").find_index("好") -> [好, byte=4, char=2]
+     */
+    CharIndex find_index(KStr substr) const;
+
+    CharIndex rfind_index(KStr substr) const;
+
+    // 使用预编译的查找器, 同一模式反复查找时省去每次的预处理
+    std::size_t find(const KSearcher& searcher) const;
+    std::size_t rfind(const KSearcher& searcher) const;
+    CharIndex find_index(const KSearcher& searcher) const;
+    CharIndex rfind_index(const KSearcher& searcher) const;
+
+    /**
+     * @brief 依次枚举所有非重叠匹配, 惰性求值
+     * 字符下标在相邻匹配之间增量累加, 枚举全部匹配总计 O(N) 而非 O(匹配数 * N)
+     * 空模式匹配每个字符边界（含末尾）
+     */
+    FindRange find_all(KStr substr) const;
+
     bool contains(KStr substr) const;
 
     bool starts_with(KStr prefix) const;
@@ -122,6 +275,25 @@ class KStr {
 
     std::vector<KStr> lines() const;
 
+    /**
+     * @brief 以上 split 系列的惰性版本, 按需逐个给出指向原串的视图, 不分配内存, 可以随时停止
+     * 正向迭代同 split_count, reversed() 后同 rsplit_count; 空分隔符抛出 std::invalid_argument
+     * @example：
+     *   for (KStr field : row.split_iter(",")) ...
+     *   KStr last = path.rsplit_iter("/").front();
+     */
+    SplitRange split_iter(KStr delim, std::size_t max_splits = knpos) const;
+    SplitRange rsplit_iter(KStr delim, std::size_t max_splits = knpos) const;
+    LineRange lines_iter() const;
+    WhitespaceRange split_whitespace_iter() const;
+
+    /**
+     * @brief 把从字节位置 from 起的分隔符字节偏移批量写入调用方提供的 out, 最多 cap 个, 不分配内存
+     * 写满时从 out[cap - 1] + delim.byte_size() 继续; 空分隔符抛出 std::invalid_argument
+     * @return 写入的个数
+     */
+    std::size_t split_offsets(KStr delim, std::size_t* out, std::size_t cap, std::size_t from = 0) const;
+
     KStr strip_prefix(KStr prefix) const;
     KStr strip_suffix(KStr suffix) const;
 
@@ -129,41 +301,96 @@ class KStr {
     KStr trim_end() const;
     KStr trim() const;
 
-    template <typename Predicate, typename Emit>
-    void match_loop(const CharRange& chars, Predicate pred, Emit emit) const {
+    /**
+     * @brief 把互不重叠的 from 全部替换为 to, 返回新串; replacen 只替换前 count 个
+     * 按字节 SIMD 查找, 结果单遍写入一次预留好的缓冲; from 为空时在每个字符边界 (含首尾) 插入 to
+     * @example：KStr("a，b，c").replace("，", "、") -> "a、b、c"
+     */
+    KString replace(KStr from, KStr to) const;
+    KString replacen(KStr from, KStr to, std::size_t count) const;
+
+    /**
+     * @brief 每个字符的 Unicode 分类位图 (unicode::CharMask), 非法序列为 CHAR_INVALID
+     * @example：
+     *   auto masks = s.char_masks();
+     *   bool has_digit = masks[i] & unicode::CHAR_DIGIT;
+     */
+    std::vector<unicode::CharMask> char_masks() const;
+
+    /**
+     * @brief 完整大小写映射后的新串 (ß → SS, 词尾 Σ → ς), 与语言无关; 非法字节原样保留
+     * ASCII 按 32 字节整块转换, 其余字符查表; 需要包含 kstring.hpp 才能使用返回值
+     * @example：
+     *   KString key = KStr("Straße").to_uppercase(); // "STRASSE"
+     */
+    KString to_lowercase() const;
+    KString to_uppercase() const;
+
+    // 有损修复为合法 UTF-8 (每个非法序列换成一个 U+FFFD), 见 utf8::sanitize
+    KString to_valid_utf8() const;
+
+    /**
+     * @brief 转码为 UTF-16 / Latin-1, 结果追加到调用方的 out, 不经过 UTF-32 中转; 错误处理见 utf8::append_utf16
+     * from_utf16 / from_latin1 先清空 buf 再写入, 返回 buf 的视图 (buf 的容量可在多次调用间复用)
+     * @example：
+     *   std::u16string wide;
+     *   KStr(line).to_utf16(wide, utf8::ErrorMode::Strict);
+     *   ByteVec buf;
+     *   KStr text = KStr::from_utf16(java_str, buf, utf8::ErrorMode::Lossy, utf8::Utf16Order::BigEndian);
+     */
+    void to_utf16(std::u16string& out, utf8::ErrorMode mode = utf8::ErrorMode::Lossy,
+                  utf8::Utf16Order order = utf8::Utf16Order::LittleEndian) const;
+    std::u16string to_utf16(utf8::ErrorMode mode = utf8::ErrorMode::Lossy,
+                            utf8::Utf16Order order = utf8::Utf16Order::LittleEndian) const;
+    void to_latin1(ByteVec& out, utf8::ErrorMode mode = utf8::ErrorMode::Lossy) const;
+    static KStr from_utf16(const std::u16string& str, ByteVec& buf, utf8::ErrorMode mode = utf8::ErrorMode::Lossy,
+                           utf8::Utf16Order order = utf8::Utf16Order::LittleEndian);
+    static KStr from_latin1(ByteSpan latin1, ByteVec& buf);
+
+    /**
+     * @brief Unicode 规范化 (UAX #15), 如比较用户输入的标识符之前统一为 NFC / NFKC
+     * normalize(form, buf) 在已经是目标形式时直接返回 *this, 不分配内存也不改动 buf; 否则把结果写入 buf 并返回其视图
+     * quick check 按 ASCII 段 SIMD 跳过, 只对不稳定的片段做分解与组合; 非法字节原样保留
+     * @example：
+     *   KString buf;
+     *   KStr id = KStr(input).normalize(unicode::NormalizationForm::NFC, buf);
+     */
+    bool is_normalized(unicode::NormalizationForm form) const;
+    KString normalize(unicode::NormalizationForm form) const;
+    KStr normalize(unicode::NormalizationForm form, KString& buf) const;
+
+    // chars 为 iter_chars() 或 iter_chars_chunked(); 字节位置取自迭代器, 非法序列按其实际长度计入
+    template <typename Range, typename Predicate, typename Emit>
+    void match_loop(const Range& chars, Predicate pred, Emit emit) const {
         bool in_match = false;
         std::size_t start_byte = 0;
         std::size_t start_idx = 0;
         std::size_t cur_idx = 0;
-        std::size_t byte_pos = 0;
 
-        for (const auto& entry : chars) {
-            if (pred(entry)) {
+        for (auto it = chars.begin(), end = chars.end(); it != end; ++it, ++cur_idx) {
+            if (pred(*it)) {
                 if (! in_match) {
-                    start_byte = byte_pos;
+                    start_byte = it.byte_offset();
                     start_idx = cur_idx;
                     in_match = true;
                 }
             } else {
                 if (in_match) {
-                    emit(start_idx, start_byte, byte_pos);
+                    emit(start_idx, start_byte, it.byte_offset());
                     in_match = false;
                 }
             }
-
-            ++cur_idx;
-            byte_pos += entry.utf8_size();
         }
 
         if (in_match) {
-            emit(start_idx, start_byte, byte_pos);
+            emit(start_idx, start_byte, data_.size());
         }
     }
 
     template <typename Predicate>
     std::vector<KStr> match(Predicate pred) const {
         std::vector<KStr> out;
-        match_loop(iter_chars(), pred, [&](std::size_t, std::size_t start, std::size_t end) {
+        match_loop(iter_chars_chunked(), pred, [&](std::size_t, std::size_t start, std::size_t end) {
             out.emplace_back(&data_[start], end - start);
         });
         return out;
@@ -172,7 +399,7 @@ class KStr {
     template <typename Predicate>
     std::vector<std::pair<std::size_t, KStr>> match_indices(Predicate pred) const {
         std::vector<std::pair<std::size_t, KStr>> out;
-        match_loop(iter_chars(), pred, [&](std::size_t idx, std::size_t start, std::size_t end) {
+        match_loop(iter_chars_chunked(), pred, [&](std::size_t idx, std::size_t start, std::size_t end) {
             out.emplace_back(idx, KStr(ByteSpan(&data_[start], end - start)));
         });
         return out;
@@ -180,22 +407,19 @@ class KStr {
 
     template <typename Predicate>
     KStr trim_start_matches(Predicate pred) const {
-        std::size_t byte_start = 0;
-        for (const auto& ch : iter_chars()) {
-            if (! pred(ch)) break;
-            byte_start += ch.utf8_size();
-        }
+        ChunkedCharRange chars = iter_chars_chunked();
+        auto it = chars.begin();
+        for (auto end = chars.end(); it != end && pred(*it); ++it) {}
+        std::size_t byte_start = it.byte_offset();
         return KStr(ByteSpan(&data_[byte_start], data_.size() - byte_start));
     }
 
     template <typename Predicate>
     KStr trim_end_matches(Predicate pred) const {
-        std::size_t byte_end = data_.size();
-        for (const auto& ch : iter_chars_rev()) {
-            if (! pred(ch)) break;
-            byte_end -= ch.utf8_size();
-        }
-        return KStr(ByteSpan(&data_[0], byte_end));
+        ReverseCharRange chars = iter_chars_rev();
+        auto it = chars.begin();
+        for (auto end = chars.end(); it != end && pred(*it); ++it) {}
+        return KStr(ByteSpan(&data_[0], it.cur_pos));
     }
 
     template <typename Predicate>
@@ -204,6 +428,10 @@ class KStr {
     }
 
   private:
+    // 第 idx 个字符的起始字节偏移; idx == 字符数时返回 byte_size(), 超出返回 knpos
+    std::size_t locate_char(std::size_t idx) const;
+
     ByteSpan data_;
+    const CharOffsetIndex* index_; // 借用的字符偏移索引, 可为空
 };
 } // namespace kstring
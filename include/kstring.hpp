@@ -1,3 +1,510 @@
 #pragma once
 
-// todo
+#include "base.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <ostream>
+
+#include "./kastr.hpp"
+#include "./kstr.hpp"
+#include "./sso.hpp"
+
+namespace kstring {
+// utf-8 string, 拥有所有权, 字节存放在 SSOBytes 中
+// 缓存字符数, 非 ASCII 字节数与非法序列数, 修改时只统计变动的部分, 避免每次调用 char_size() 都重新扫描
+// 非 ASCII 的长串在首次按字符下标访问时惰性构建 CharOffsetIndex, 修改时失效
+// 线程安全与标准容器相同: 多个线程可以同时调用同一对象的 const 方法 (索引经原子指针发布, 只有一份生效),
+// 但修改不能与任何其他访问并发
+class KString {
+  public:
+    enum : std::size_t {
+        INDEX_THRESHOLD = 256 // 字节数达到该阈值才值得构建字符偏移索引
+    };
+
+    KString();
+
+    // 与 KStr 一致, 不校验 UTF-8 合法性, 仅视为字节串
+    KString(const char* cstr);
+
+    KString(const std::string& str);
+
+    KString(const char* ptr, std::size_t len);
+
+    KString(const Byte* ptr, std::size_t len);
+
+    KString(KStr kstr);
+
+    explicit KString(KChar ch);
+
+    // 接管 bytes 的存储, 长串不再拷贝字节 (短串拷入 SSO, bytes 保持原样); 缓存统计一遍
+    explicit KString(ByteVec&& bytes);
+
+    // 拷贝构造/赋值, 移动构造/赋值, 析构
+    // 索引借用的是自身字节, 不能直接共享: 拷贝时丢弃（惰性重建）, 移动时重新绑定
+    KString(const KString& other);
+    KString& operator=(const KString& other);
+    KString(KString&& other) noexcept;
+    KString& operator=(KString&& other) noexcept;
+    ~KString();
+
+    operator std::string() const {
+        return std::string(reinterpret_cast<const char*>(data_.data()), data_.size());
+    }
+
+    // 隐式转换 KStr, 也可以通过 as_kstr() 显式转换
+    operator KStr() const {
+        return as_kstr();
+    }
+
+    // 若已构建字符偏移索引, 返回的视图会携带它
+    KStr as_kstr() const {
+        KStr view(data_.data(), data_.size());
+        const CharOffsetIndex* index = index_.load(std::memory_order_acquire);
+        return index ? view.with_index(*index) : view;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const KString& s) {
+        return os << s.as_kstr();
+    }
+
+    friend bool operator==(const KString& lhs, const KString& rhs) {
+        // 字符数不同则内容必然不同, 先比缓存
+        if (lhs.char_size_ != rhs.char_size_) return false;
+        return lhs.as_kstr() == rhs.as_kstr();
+    }
+
+    friend bool operator!=(const KString& lhs, const KString& rhs) {
+        return ! (lhs == rhs);
+    }
+
+    friend bool operator==(const KString& lhs, const KStr& rhs) {
+        return lhs.as_kstr() == rhs;
+    }
+
+    friend bool operator==(const KStr& lhs, const KString& rhs) {
+        return rhs == lhs;
+    }
+
+    friend bool operator==(const KString& lhs, const char* rhs) {
+        if (rhs == nullptr) return lhs.empty();
+        return lhs.as_kstr() == KStr(rhs);
+    }
+
+    friend bool operator==(const char* lhs, const KString& rhs) {
+        return rhs == lhs;
+    }
+
+    friend bool operator==(const KString& lhs, const std::string& rhs) {
+        return lhs.as_kstr() == KStr(rhs.data(), rhs.size());
+    }
+
+    friend bool operator==(const std::string& lhs, const KString& rhs) {
+        return rhs == lhs;
+    }
+
+    friend bool operator!=(const KString& lhs, const char* rhs) {
+        return ! (lhs == rhs);
+    }
+
+    friend bool operator!=(const char* lhs, const KString& rhs) {
+        return ! (lhs == rhs);
+    }
+
+    friend bool operator!=(const KString& lhs, const std::string& rhs) {
+        return ! (lhs == rhs);
+    }
+
+    friend bool operator!=(const std::string& lhs, const KString& rhs) {
+        return ! (lhs == rhs);
+    }
+
+    friend bool operator<(const KString& lhs, const KString& rhs) {
+        return lhs.as_kstr() < rhs.as_kstr();
+    }
+
+    friend KString operator+(const KString& lhs, const KString& rhs) {
+        KString result;
+        result.reserve(lhs.byte_size() + rhs.byte_size());
+        result.append(lhs);
+        result.append(rhs);
+        return result;
+    }
+
+    friend KString operator+(const KString& lhs, KStr rhs) {
+        KString result = lhs;
+        result.append(rhs);
+        return result;
+    }
+
+    friend KString operator+(KStr lhs, const KString& rhs) {
+        KString result(lhs);
+        result.append(rhs);
+        return result;
+    }
+
+    friend KString operator+(const KString& lhs, const char* rhs) {
+        KString result = lhs;
+        result.append(rhs);
+        return result;
+    }
+
+    friend KString operator+(const char* lhs, const KString& rhs) {
+        KString result(lhs);
+        result.append(rhs);
+        return result;
+    }
+
+    friend KString operator+(const KString& lhs, KChar ch) {
+        KString result = lhs;
+        result.push_back(ch);
+        return result;
+    }
+
+    KString& operator+=(const KString& rhs) {
+        this->append(rhs);
+        return *this;
+    }
+
+    KString& operator+=(KStr rhs) {
+        this->append(rhs);
+        return *this;
+    }
+
+    KString& operator+=(const char* rhs) {
+        this->append(rhs);
+        return *this;
+    }
+
+    KString& operator+=(const std::string& rhs) {
+        this->append(rhs.data(), rhs.size());
+        return *this;
+    }
+
+    KString& operator+=(KChar ch) {
+        this->push_back(ch);
+        return *this;
+    }
+
+    // 修改接口, 均会同步维护字符数缓存
+    void append(KStr str);
+    void append(const KString& other);
+    void append(const char* cstr);
+    void append(const char* ptr, std::size_t len);
+    void push_back(KChar ch);
+
+    // 弹出最后一个字符, 空串抛出 std::runtime_error
+    KChar pop_back();
+
+    void clear();
+
+    void reserve(std::size_t cap) {
+        data_.reserve(cap);
+    }
+
+    void shrink_to_fit() {
+        data_.shrink_to_fit();
+    }
+
+    void swap(KString& other) noexcept;
+
+    friend void swap(KString& lhs, KString& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    bool empty() const {
+        return data_.empty();
+    }
+
+    std::size_t byte_size() const {
+        return data_.size();
+    }
+
+    // 返回缓存的字符数, O(1)
+    std::size_t char_size() const {
+        return char_size_;
+    }
+
+    bool is_ascii() const {
+        return non_ascii_ == 0;
+    }
+
+    bool is_valid_utf8() const {
+        return invalid_ == 0;
+    }
+
+    const Byte* data() const {
+        return data_.data();
+    }
+
+    ByteSpan as_bytes() const {
+        return ByteSpan(data_.data(), data_.size());
+    }
+
+    CharRange iter_chars() const {
+        return as_kstr().iter_chars();
+    }
+
+    ReverseCharRange iter_chars_rev() const {
+        return as_kstr().iter_chars_rev();
+    }
+
+    ChunkedCharRange iter_chars_chunked() const {
+        return as_kstr().iter_chars_chunked();
+    }
+
+    KStr::GraphemeRange iter_graphemes() const {
+        return as_kstr().iter_graphemes();
+    }
+
+    KStr::GraphemeRange iter_graphemes_rev() const {
+        return as_kstr().iter_graphemes_rev();
+    }
+
+    std::size_t grapheme_count() const {
+        return as_kstr().grapheme_count();
+    }
+
+    KStr::WordBoundRange iter_word_bounds() const {
+        return as_kstr().iter_word_bounds();
+    }
+
+    KStr::WordRange iter_words() const {
+        return as_kstr().iter_words();
+    }
+
+    KStr::SentenceRange iter_sentences() const {
+        return as_kstr().iter_sentences();
+    }
+
+    uint8_t byte_at(std::size_t idx) const {
+        if (idx >= data_.size()) {
+            throw std::out_of_range("KString::byte_at index out of bounds");
+        }
+        return data_[idx];
+    }
+
+    // 以下按字符下标的操作在全 ASCII 时退化为字节下标 O(1), 否则借助惰性构建的索引 O(stride)
+    ByteSpan operator[](std::size_t idx) const;
+    KChar char_at(std::size_t idx) const;
+    std::size_t char_index_to_byte_offset(std::size_t idx) const;
+    std::size_t count_chars_before(std::size_t byte_offset) const;
+
+    std::size_t find(KStr substr) const;
+    std::size_t rfind(KStr substr) const;
+    CharIndex find_index(KStr substr) const;
+    CharIndex rfind_index(KStr substr) const;
+    std::size_t find(const KSearcher& searcher) const;
+    std::size_t rfind(const KSearcher& searcher) const;
+
+    FindRange find_all(KStr substr) const {
+        return as_kstr().find_all(substr);
+    }
+
+    std::size_t find_in_bytes(KStr substr) const {
+        return as_kstr().find_in_bytes(substr);
+    }
+
+    std::size_t rfind_in_bytes(KStr substr) const {
+        return as_kstr().rfind_in_bytes(substr);
+    }
+
+    bool contains(KStr substr) const {
+        return as_kstr().contains(substr);
+    }
+
+    bool starts_with(KStr prefix) const {
+        return as_kstr().starts_with(prefix);
+    }
+
+    bool ends_with(KStr suffix) const {
+        return as_kstr().ends_with(suffix);
+    }
+
+    KStr substr(std::size_t start, std::size_t count) const;
+    KStr subrange(std::size_t start, std::size_t end) const;
+    std::pair<KStr, KStr> split_at(std::size_t mid) const;
+
+    std::pair<KStr, KStr> split_exclusive_at(std::size_t mid) const {
+        return as_kstr().split_exclusive_at(mid);
+    }
+
+    std::vector<KStr> split_count(KStr delim, std::size_t max_splits) const {
+        return as_kstr().split_count(delim, max_splits);
+    }
+
+    std::vector<KStr> rsplit_count(KStr delim, std::size_t max_splits) const {
+        return as_kstr().rsplit_count(delim, max_splits);
+    }
+
+    std::vector<KStr> split(KStr delim) const {
+        return as_kstr().split(delim);
+    }
+
+    std::vector<KStr> rsplit(KStr delim) const {
+        return as_kstr().rsplit(delim);
+    }
+
+    std::pair<KStr, KStr> split_once(KStr delim) const {
+        return as_kstr().split_once(delim);
+    }
+
+    std::pair<KStr, KStr> rsplit_once(KStr delim) const {
+        return as_kstr().rsplit_once(delim);
+    }
+
+    std::vector<KStr> split_whitespace() const {
+        return as_kstr().split_whitespace();
+    }
+
+    std::vector<KStr> lines() const {
+        return as_kstr().lines();
+    }
+
+    KStr::SplitRange split_iter(KStr delim, std::size_t max_splits = knpos) const {
+        return as_kstr().split_iter(delim, max_splits);
+    }
+
+    KStr::SplitRange rsplit_iter(KStr delim, std::size_t max_splits = knpos) const {
+        return as_kstr().rsplit_iter(delim, max_splits);
+    }
+
+    KStr::LineRange lines_iter() const {
+        return as_kstr().lines_iter();
+    }
+
+    KStr::WhitespaceRange split_whitespace_iter() const {
+        return as_kstr().split_whitespace_iter();
+    }
+
+    std::size_t split_offsets(KStr delim, std::size_t* out, std::size_t cap, std::size_t from = 0) const {
+        return as_kstr().split_offsets(delim, out, cap, from);
+    }
+
+    KStr strip_prefix(KStr prefix) const {
+        return as_kstr().strip_prefix(prefix);
+    }
+
+    KStr strip_suffix(KStr suffix) const {
+        return as_kstr().strip_suffix(suffix);
+    }
+
+    KStr trim_start() const {
+        return as_kstr().trim_start();
+    }
+
+    KStr trim_end() const {
+        return as_kstr().trim_end();
+    }
+
+    KStr trim() const {
+        return as_kstr().trim();
+    }
+
+    KString replace(KStr from, KStr to) const {
+        return as_kstr().replace(from, to);
+    }
+
+    KString replacen(KStr from, KStr to, std::size_t count) const {
+        return as_kstr().replacen(from, to, count);
+    }
+
+    std::vector<unicode::CharMask> char_masks() const {
+        return as_kstr().char_masks();
+    }
+
+    KString to_lowercase() const {
+        return as_kstr().to_lowercase();
+    }
+
+    KString to_uppercase() const {
+        return as_kstr().to_uppercase();
+    }
+
+    // 缓存表明已合法时直接拷贝
+    KString to_valid_utf8() const {
+        return is_valid_utf8() ? *this : as_kstr().to_valid_utf8();
+    }
+
+    void to_utf16(std::u16string& out, utf8::ErrorMode mode = utf8::ErrorMode::Lossy,
+                  utf8::Utf16Order order = utf8::Utf16Order::LittleEndian) const {
+        as_kstr().to_utf16(out, mode, order);
+    }
+
+    std::u16string to_utf16(utf8::ErrorMode mode = utf8::ErrorMode::Lossy,
+                            utf8::Utf16Order order = utf8::Utf16Order::LittleEndian) const {
+        return as_kstr().to_utf16(mode, order);
+    }
+
+    void to_latin1(ByteVec& out, utf8::ErrorMode mode = utf8::ErrorMode::Lossy) const {
+        as_kstr().to_latin1(out, mode);
+    }
+
+    // 由 UTF-16 / Latin-1 构造, 错误处理见 utf8::append_from_utf16
+    static KString from_utf16(const std::u16string& str, utf8::ErrorMode mode = utf8::ErrorMode::Lossy,
+                              utf8::Utf16Order order = utf8::Utf16Order::LittleEndian);
+    static KString from_latin1(const std::string& latin1);
+
+    bool is_normalized(unicode::NormalizationForm form) const {
+        return as_kstr().is_normalized(form);
+    }
+
+    KString normalize(unicode::NormalizationForm form) const {
+        return as_kstr().normalize(form);
+    }
+
+    template <typename Predicate>
+    std::vector<KStr> match(Predicate pred) const {
+        return as_kstr().match(pred);
+    }
+
+    template <typename Predicate>
+    std::vector<std::pair<std::size_t, KStr>> match_indices(Predicate pred) const {
+        return as_kstr().match_indices(pred);
+    }
+
+    template <typename Predicate>
+    KStr trim_start_matches(Predicate pred) const {
+        return as_kstr().trim_start_matches(pred);
+    }
+
+    template <typename Predicate>
+    KStr trim_end_matches(Predicate pred) const {
+        return as_kstr().trim_end_matches(pred);
+    }
+
+    template <typename Predicate>
+    KStr trim_matches(Predicate pred) const {
+        return as_kstr().trim_matches(pred);
+    }
+
+  private:
+    // 按需构建索引并返回携带索引的视图, 供按字符下标的操作使用
+    KStr indexed_kstr() const;
+    // 内容被修改, 索引失效
+    void invalidate_index() {
+        delete index_.exchange(nullptr, std::memory_order_relaxed);
+    }
+
+    // 追加字节并增量维护缓存
+    void append_bytes(const Byte* ptr, std::size_t len);
+
+    SSOBytes data_;
+    std::size_t char_size_; // 缓存的字符数, 语义与 utf8::char_count 一致
+    std::size_t non_ascii_; // 大于 0x7F 的字节数, 为 0 即全 ASCII
+    std::size_t invalid_;   // 非法序列数 (按 decode_one 切分), 为 0 即合法 UTF-8; 合法时拼接的字符数可直接相加
+    mutable std::atomic<CharOffsetIndex*> index_; // 惰性构建的字符偏移索引, 由本对象持有
+};
+} // namespace kstring
+
+namespace std {
+template <>
+struct hash<kstring::KString> {
+    std::size_t operator()(const kstring::KString& s) const {
+        return kstring::fnv1a_hash(s.as_bytes());
+    }
+};
+} // namespace std
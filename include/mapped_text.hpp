@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "base.hpp"
+#include "kastr.hpp"
+#include "kstr.hpp"
+
+namespace kstring {
+/**
+ * @brief 只读映射整个文件并交出 KStr / KAStr 视图, 启动时加载数 GB 的词典不必先读进 std::string
+ * 映射随对象释放, 视图 (以及由其得到的 lines_iter 等) 不能比 MappedText 活得更久; 只可移动, 不可拷贝
+ * 默认提示内核顺序读取并提前预读 (MADV_SEQUENTIAL / MADV_WILLNEED); HINT_HUGEPAGE 在内核支持时申请透明大页,
+ * 不支持的提示会被忽略; 打开或映射失败时抛出 std::runtime_error
+ * @example：
+ *   MappedText dict("words.txt");
+ *   if (! dict.is_valid_utf8(0)) ...
+ *   for (KStr line : dict.lines_iter()) ...
+ */
+class MappedText {
+  public:
+    enum Hint : unsigned {
+        HINT_NONE = 0,
+        HINT_SEQUENTIAL = 1 << 0, // MADV_SEQUENTIAL
+        HINT_WILLNEED = 1 << 1,   // MADV_WILLNEED
+        HINT_HUGEPAGE = 1 << 2,   // MADV_HUGEPAGE
+        HINT_DEFAULT = HINT_SEQUENTIAL | HINT_WILLNEED
+    };
+
+    MappedText();
+    explicit MappedText(const std::string& path, unsigned hints = HINT_DEFAULT);
+
+    MappedText(const MappedText&) = delete;
+    MappedText& operator=(const MappedText&) = delete;
+    MappedText(MappedText&& other) noexcept;
+    MappedText& operator=(MappedText&& other) noexcept;
+    ~MappedText();
+
+    // 解除映射, 之后等同于空文本
+    void close();
+
+    const Byte* data() const {
+        return static_cast<const Byte*>(addr_);
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    ByteSpan as_bytes() const {
+        return ByteSpan(data(), size_);
+    }
+
+    KStr as_kstr() const {
+        return KStr(data(), size_);
+    }
+
+    KAStr as_kastr() const {
+        return KAStr(data(), size_);
+    }
+
+    KStr::LineRange lines_iter() const {
+        return as_kstr().lines_iter();
+    }
+
+    /**
+     * @brief 惰性校验 UTF-8, 第一次调用时才读取整个文件, 结果缓存 (缓存不做并发保护, 多线程共享时先在一个线程里调用一次)
+     * threads > 1 时按字符边界切成若干段, 各段由 simdutf 并行校验; threads 为 0 时取 hardware_concurrency
+     * first_invalid 返回第一个非法字节的偏移, 与 utf8::first_invalid 相同, 全部合法时为 knpos
+     */
+    bool is_valid_utf8(unsigned threads = 1) const {
+        return first_invalid(threads) == knpos;
+    }
+
+    std::size_t first_invalid(unsigned threads = 1) const;
+
+  private:
+    void* addr_;
+    std::size_t size_;
+    mutable bool validated_;
+    mutable std::size_t first_invalid_;
+};
+} // namespace kstring
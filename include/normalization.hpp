@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "base.hpp"
+#include "unicode_tables.hpp"
+
+namespace kstring {
+namespace unicode {
+// Unicode 规范化形式 (UAX #15)
+enum class NormalizationForm : std::uint8_t {
+    NFC,
+    NFD,
+    NFKC,
+    NFKD
+};
+
+enum class QuickCheck : std::uint8_t {
+    Yes,
+    No,
+    Maybe
+};
+
+// 码点的规范化记录 (两级表后再取一次记录); 超出 Unicode 范围的值视为 ccc 0 且没有分解
+inline const tables::NormRecord& norm_record(CodePoint cp) {
+    if (cp >= 0x110000) return tables::NORM_RECORDS[0];
+    std::size_t block = static_cast<std::size_t>(tables::NORM_STAGE1[cp >> tables::NORM_SHIFT]) << tables::NORM_SHIFT;
+    return tables::NORM_RECORDS[tables::NORM_STAGE2[block | (cp & ((1u << tables::NORM_SHIFT) - 1))]];
+}
+
+// Canonical_Combining_Class
+inline std::uint8_t combining_class(CodePoint cp) {
+    return norm_record(cp).ccc;
+}
+
+/**
+ * @brief UAX #15 的 quick check: 按字符查 *_QC 属性并检查组合类顺序, 不做分解与组合
+ * 连续的 ASCII 字节用 SIMD 整段跳过; 非法字节视为原样保留的 Yes
+ * @return Yes 表示已经是该形式, No 表示不是, Maybe 需要完整规范化后才能确定
+ */
+QuickCheck quick_check(ByteSpan text, NormalizationForm form);
+
+// 精确判定; quick check 给出 Maybe 时再完整规范化一次比较
+bool is_normalized(ByteSpan text, NormalizationForm form);
+
+/**
+ * @brief 把 text 规范化后追加到 out
+ * quick check 为 Yes 的片段原样复制, 只对不稳定的片段 (两个稳定边界之间) 做分解, 规范排序与组合
+ * 非法字节原样复制, 并视为片段边界
+ */
+void append_normalized(ByteSpan text, NormalizationForm form, ByteVec& out);
+
+// 当前 CPU 上 ASCII 段跳过实际使用的实现: "avx2" / "sse2" / "scalar"
+const char* normalization_simd_backend();
+} // namespace unicode
+} // namespace kstring
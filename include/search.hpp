@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "base.hpp"
+
+namespace kstring {
+// 字节级子串查找引擎, 不涉及字符编解码
+// x86 上按 CPU 运行时选择 AVX2 / SSE2 实现, 其他平台退化为 memchr / memrchr + memcmp
+namespace search {
+// 第一个 / 最后一个等于 b 的字节位置, 找不到返回 knpos
+std::size_t find_byte(ByteSpan hay, Byte b);
+std::size_t rfind_byte(ByteSpan hay, Byte b);
+
+/**
+ * @brief 一次性正向查找 pat 在 hay 中第一次出现的字节位置, 不做预处理也不分配内存
+ * 单字节模式走 memchr; 更长的模式用 SIMD 同时比较模式的首字节与末字节筛出候选位置, 再 memcmp 校验
+ * 校验累计比较的字节数超过已扫描字节数的常数倍时 (如在全 'a' 中找 'a…b…a') 改用 Two-Way, 最坏仍为线性
+ * 同一模式反复查找时应使用 Searcher, 它会预先挑选更罕见的过滤字节
+ * @return pat 为空返回 0, 找不到返回 knpos
+ */
+std::size_t find(ByteSpan hay, ByteSpan pat);
+
+/**
+ * @brief 逆向查找 pat 在 hay 中最后一次出现的字节位置
+ * 单字节模式走 memrchr, 更长的模式同 find 使用 SIMD 首末字节候选过滤, 校验超出预算时改用逆向 Two-Way
+ * @return pat 为空返回 hay.size(), 找不到返回 knpos
+ */
+std::size_t rfind(ByteSpan hay, ByteSpan pat);
+
+enum : std::size_t {
+    FIRST_OF_SIMD_MAX = 8 // 字节集合不超过该大小时 find_first_of 使用 SIMD
+};
+
+/**
+ * @brief hay 中第一个属于字节集合 set 的位置, 多模式匹配用它跳过不可能是匹配起点的字节
+ * 集合不超过 FIRST_OF_SIMD_MAX 个字节时每个字节一次 SIMD 比较, 更大的集合查 256 项表
+ * @return set 为空或找不到返回 knpos
+ */
+std::size_t find_first_of(ByteSpan hay, ByteSpan set);
+
+/**
+ * @brief 批量查找: 从字节位置 from 起, 把 pat 在 hay 中互不重叠的出现位置依次写入 out, 最多 cap 个
+ * 每步以 SIMD 比较 64 个候选起点的首字节与末字节得到候选位图, 逐位校验; 单字节模式无需校验
+ * 校验超出预算时同 find 改由 Two-Way 找出其余位置
+ * 写满 cap 个即返回, 调用方从 out[cap - 1] + pat.size() 继续
+ * @return 写入的个数; pat 为空抛出 std::invalid_argument
+ */
+std::size_t find_many(ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out, std::size_t cap);
+
+/**
+ * @brief 单遍替换: 把 hay 中 pat 互不重叠的前 limit 次出现换成 with, 结果追加到 out, 返回替换次数
+ * 用 find_many 按批取出位置; with 不长于 pat 时按 hay.size() 预留上界边找边写, 否则先收集位置算出准确长度,
+ * out 只扩容一次, 其余全是整段 memcpy; pat 为空时 hay 原样追加
+ */
+std::size_t replace(ByteSpan hay, ByteSpan pat, ByteSpan with, ByteVec& out, std::size_t limit = knpos);
+
+/**
+ * @brief 忽略 ASCII 大小写的比较与查找: 只把 A-Z 与 a-z 视为相同, 其余字节 (含非 ASCII) 按原值比较
+ * 大小写折叠在 SIMD 比较循环内完成, 不生成临时的小写副本; 查找同 find 以折叠后的首末字节过滤候选
+ * 候选校验同 find 受工作量上限约束, 超出后改用在折叠字节上比较的 Two-Way, 最坏仍为线性
+ * find_ignore_ascii_case 的返回值约定同 find
+ */
+bool equal_ignore_ascii_case(ByteSpan a, ByteSpan b);
+std::size_t find_ignore_ascii_case(ByteSpan hay, ByteSpan pat);
+
+// 折叠大小写后的 FNV-1a, 与 equal_ignore_ascii_case 相容; 不含大写字母时与 fnv1a_hash 结果相同
+std::size_t hash_ignore_ascii_case(ByteSpan s);
+
+// 当前 CPU 上实际使用的实现: "avx2" / "sse2" / "scalar"
+const char* simd_backend();
+
+/**
+ * @brief 预编译的子串查找器, 构造时按模式长度选定算法并完成预处理, 之后可在任意多个 hay 上复用
+ *   - 空模式: 直接返回
+ *   - 1 字节: memchr / memrchr
+ *   - 2 ~ PACKED_PAIR_MAX 字节且有 SIMD: 以两个罕见字节为过滤条件的 packed pair
+ *   - 同上但无 SIMD: Two-Way (线性最坏复杂度, 无额外内存)
+ *   - 更长的模式: Boyer-Moore-Horspool (正向与逆向各一张 256 项跳转表)
+ * packed pair 与 Horspool 的候选校验有工作量上限, 超出后改用 Two-Way, 各算法最坏都是线性的
+ * 查找器持有模式的拷贝, 不依赖构造时传入的内存
+ */
+class Searcher {
+  public:
+    enum class Algorithm {
+        Empty,
+        Byte,
+        PackedPair,
+        TwoWay,
+        Horspool
+    };
+
+    enum : std::size_t {
+        PACKED_PAIR_MAX = 64
+    };
+
+    explicit Searcher(ByteSpan needle);
+
+    // 强制指定算法 (模式长度不满足要求时抛出 std::invalid_argument), 用于测试与 benchmark 对照
+    Searcher(ByteSpan needle, Algorithm algo);
+
+    ByteSpan needle() const {
+        return ByteSpan(needle_.data(), needle_.size());
+    }
+
+    Algorithm algorithm() const {
+        return algo_;
+    }
+
+    static const char* algorithm_name(Algorithm algo);
+
+    // 第一次出现的字节位置, 空模式返回 0, 找不到返回 knpos
+    std::size_t find(ByteSpan hay) const;
+
+    // 最后一次出现的字节位置, 空模式返回 hay.size(), 找不到返回 knpos
+    std::size_t rfind(ByteSpan hay) const;
+
+    // 非重叠匹配的个数, 空模式视为每个字节位置 (含末尾) 都匹配
+    std::size_t count(ByteSpan hay) const;
+
+  private:
+    void compile();
+
+    std::size_t find_two_way(ByteSpan hay) const;
+    std::size_t find_horspool(ByteSpan hay) const;
+    std::size_t rfind_horspool(ByteSpan hay) const;
+
+    ByteVec needle_;
+    Algorithm algo_;
+    std::size_t rare1_; // packed pair 使用的两个罕见字节在模式中的下标, rare1_ != rare2_
+    std::size_t rare2_;
+    std::size_t tw_suffix_; // Two-Way 的临界分解位置与周期 (TwoWay 与 Horspool 使用)
+    std::size_t tw_period_;
+    bool tw_periodic_;
+    std::vector<std::size_t> shift_;  // Horspool 正向跳转表
+    std::vector<std::size_t> rshift_; // Horspool 逆向跳转表
+};
+
+// 各实现的直接入口, 供测试与 benchmark 对照, 调用方需自行确认 CPU 支持
+namespace detail {
+std::size_t rfind_scalar(ByteSpan hay, ByteSpan pat);
+std::size_t find_many_scalar(ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out, std::size_t cap);
+bool equal_ignore_ascii_case_scalar(ByteSpan a, ByteSpan b);
+std::size_t find_ignore_ascii_case_scalar(ByteSpan hay, ByteSpan pat);
+#if defined(__x86_64__) || defined(__i386__)
+std::size_t rfind_sse2(ByteSpan hay, ByteSpan pat);
+std::size_t rfind_avx2(ByteSpan hay, ByteSpan pat);
+std::size_t find_many_sse2(ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out, std::size_t cap);
+std::size_t find_many_avx2(ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out, std::size_t cap);
+bool equal_ignore_ascii_case_sse2(ByteSpan a, ByteSpan b);
+bool equal_ignore_ascii_case_avx2(ByteSpan a, ByteSpan b);
+std::size_t find_ignore_ascii_case_sse2(ByteSpan hay, ByteSpan pat);
+std::size_t find_ignore_ascii_case_avx2(ByteSpan hay, ByteSpan pat);
+#endif
+} // namespace detail
+} // namespace search
+} // namespace kstring
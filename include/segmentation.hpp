@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "base.hpp"
+#include "unicode_tables.hpp"
+
+namespace kstring {
+namespace unicode {
+// Grapheme_Cluster_Break (UAX #29), 顺序与生成的 GCB 表一致
+enum class GraphemeBreak : std::uint8_t {
+    Other,
+    CR,
+    LF,
+    Control,
+    Extend,
+    ZWJ,
+    RegionalIndicator,
+    Prepend,
+    SpacingMark,
+    L,
+    V,
+    T,
+    LV,
+    LVT
+};
+
+static_assert(static_cast<unsigned>(GraphemeBreak::LVT) + 1 == tables::GCB_COUNT, "GraphemeBreak order");
+
+// Word_Break (UAX #29), 顺序与生成的 WB 表一致
+enum class WordBreak : std::uint8_t {
+    Other,
+    CR,
+    LF,
+    Newline,
+    Extend,
+    ZWJ,
+    RegionalIndicator,
+    Format,
+    Katakana,
+    HebrewLetter,
+    ALetter,
+    SingleQuote,
+    DoubleQuote,
+    MidNumLet,
+    MidLetter,
+    MidNum,
+    Numeric,
+    ExtendNumLet,
+    WSegSpace
+};
+
+static_assert(static_cast<unsigned>(WordBreak::WSegSpace) + 1 == tables::WB_COUNT, "WordBreak order");
+
+// Sentence_Break (UAX #29), 顺序与生成的 SB 表一致
+enum class SentenceBreak : std::uint8_t {
+    Other,
+    CR,
+    LF,
+    Extend,
+    Sep,
+    Format,
+    Sp,
+    Lower,
+    Upper,
+    OLetter,
+    Numeric,
+    ATerm,
+    SContinue,
+    STerm,
+    Close
+};
+
+static_assert(static_cast<unsigned>(SentenceBreak::Close) + 1 == tables::SB_COUNT, "SentenceBreak order");
+
+// 码点的字素簇记录: 低 4 位为 GraphemeBreak, 另有 Extended_Pictographic 位; 超出 Unicode 范围的值视为 Other
+inline std::uint8_t grapheme_record(CodePoint cp) {
+    if (cp >= 0x110000) return 0;
+    std::size_t block = static_cast<std::size_t>(tables::GCB_STAGE1[cp >> tables::GCB_SHIFT]) << tables::GCB_SHIFT;
+    return tables::GCB_STAGE2[block | (cp & ((1u << tables::GCB_SHIFT) - 1))];
+}
+
+inline GraphemeBreak grapheme_break(CodePoint cp) {
+    return static_cast<GraphemeBreak>(grapheme_record(cp) & tables::GCB_BITS);
+}
+
+inline bool is_extended_pictographic(CodePoint cp) {
+    return (grapheme_record(cp) & tables::GCB_EXTENDED_PICTOGRAPHIC) != 0;
+}
+
+// 码点的词记录: 低 5 位为 WordBreak, 另有 Extended_Pictographic 位
+inline std::uint8_t word_record(CodePoint cp) {
+    if (cp >= 0x110000) return 0;
+    std::size_t block = static_cast<std::size_t>(tables::WB_STAGE1[cp >> tables::WB_SHIFT]) << tables::WB_SHIFT;
+    return tables::WB_STAGE2[block | (cp & ((1u << tables::WB_SHIFT) - 1))];
+}
+
+inline WordBreak word_break(CodePoint cp) {
+    return static_cast<WordBreak>(word_record(cp) & tables::WB_BITS);
+}
+
+inline SentenceBreak sentence_break(CodePoint cp) {
+    if (cp >= 0x110000) return SentenceBreak::Other;
+    std::size_t block = static_cast<std::size_t>(tables::SB_STAGE1[cp >> tables::SB_SHIFT]) << tables::SB_SHIFT;
+    return static_cast<SentenceBreak>(tables::SB_STAGE2[block | (cp & ((1u << tables::SB_SHIFT) - 1))]);
+}
+
+/**
+ * @brief 从字素簇边界 pos 开始的扩展字素簇 (UAX #29) 的结束位置; pos >= size 时返回 size
+ * pos 之前的内容不参与判断 (视为文本开头). 非法字节逐字节自成一簇
+ * ASCII, 汉字与谚文音节彼此相邻时不查属性表, 直接断开
+ */
+std::size_t next_grapheme_boundary(ByteSpan text, std::size_t pos);
+
+// 以字素簇边界 pos 结尾的扩展字素簇的起始位置; 与 next_grapheme_boundary 给出同样的切分
+std::size_t prev_grapheme_boundary(ByteSpan text, std::size_t pos);
+
+// 字素簇个数
+std::size_t grapheme_count(ByteSpan text);
+
+/**
+ * @brief 词边界 (UAX #29 WB1 - WB999) 之后的下一个词边界; pos 须为词边界, pos >= size 时返回 size
+ * 空白与标点各自成段, 汉字逐字成段; 非法字节逐字节按 Other 处理
+ * ASCII 字母数字串, 空格串与汉字走快速路径, 其余逐个位置按规则判断
+ */
+std::size_t next_word_boundary(ByteSpan text, std::size_t pos);
+
+// 词边界 pos 之前的上一个词边界; 与 next_word_boundary 给出同样的切分
+std::size_t prev_word_boundary(ByteSpan text, std::size_t pos);
+
+// 分段中是否含有字母, 数字或表意文字 (Alphabetic 或 General_Category 为 N*), 用于从词边界分段中挑出词
+bool is_word_like(ByteSpan segment);
+
+/**
+ * @brief 句边界 (UAX #29 SB1 - SB998) 之后的下一个句边界; pos 须为句边界, pos >= size 时返回 size
+ * 只有段落分隔符与 SATerm Close* Sp* 之后才可能断句, 中间的 ASCII 字节整段跳过
+ */
+std::size_t next_sentence_boundary(ByteSpan text, std::size_t pos);
+
+// 句边界 pos 之前的上一个句边界; 从 pos 向前查找句末标点与段落分隔符, 按同样的规则判断
+std::size_t prev_sentence_boundary(ByteSpan text, std::size_t pos);
+} // namespace unicode
+} // namespace kstring
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "base.hpp"
+#include "search.hpp"
+
+namespace kstring {
+// 分隔符在 hay 中的位置与长度, pos 为 knpos 表示没有
+struct DelimMatch {
+    std::size_t pos;
+    std::size_t len;
+};
+
+// 空分段的处理方式
+enum class EmptySegments {
+    Keep,     // 全部保留, 如 split(",")
+    DropLast, // 丢弃最右侧 (末尾) 的空分段, 如 lines 中以换行结尾的文本
+    DropAll   // 丢弃所有空分段, 如 split_whitespace 中连续的空白
+};
+
+/**
+ * 分隔符策略, 供 BasicSplitIterator 查找分隔符:
+ *   next(hay, from): [from, size) 中第一个分隔符
+ *   prev(hay, end):  完整落在 [0, end) 中的最后一个分隔符
+ *   empties():       空分段的处理方式
+ */
+
+// 子串分隔符; 空模式表示逐字节切分 (KAStr 的语义), 此时不产生空分段
+struct SubstrDelimiter {
+    ByteSpan pat;
+
+    SubstrDelimiter() : pat() {}
+
+    explicit SubstrDelimiter(ByteSpan p) : pat(p) {}
+
+    DelimMatch next(ByteSpan hay, std::size_t from) const;
+    DelimMatch prev(ByteSpan hay, std::size_t end) const;
+
+    EmptySegments empties() const {
+        return pat.empty() ? EmptySegments::DropLast : EmptySegments::Keep;
+    }
+};
+
+// 行分隔符 \n, \r\n 与单独的 \r; 以换行结尾时不产生末尾的空行
+struct LineDelimiter {
+    DelimMatch next(ByteSpan hay, std::size_t from) const;
+    DelimMatch prev(ByteSpan hay, std::size_t end) const;
+
+    EmptySegments empties() const {
+        return EmptySegments::DropLast;
+    }
+};
+
+// Unicode 空白 (KChar::is_whitespace), 非法字节视为非空白
+struct Utf8WhitespaceDelimiter {
+    DelimMatch next(ByteSpan hay, std::size_t from) const;
+    DelimMatch prev(ByteSpan hay, std::size_t end) const;
+
+    EmptySegments empties() const {
+        return EmptySegments::DropAll;
+    }
+};
+
+// ASCII 空白 (isspace)
+struct AsciiWhitespaceDelimiter {
+    DelimMatch next(ByteSpan hay, std::size_t from) const;
+    DelimMatch prev(ByteSpan hay, std::size_t end) const;
+
+    EmptySegments empties() const {
+        return EmptySegments::DropAll;
+    }
+};
+
+/**
+ * @brief 惰性分割迭代器, 每次查找一个分隔符并给出一个指向原串的视图, 不分配内存
+ * 正向迭代等价于 split_count, 逆向迭代等价于 rsplit_count (从右向左查找分隔符, 分段按从右到左给出)
+ * 最多分割 max_splits 次, 之后剩余部分作为最后一个分段
+ */
+template <typename View, typename Delimiter>
+class BasicSplitIterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = View;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const View*;
+    using reference = const View&;
+
+    // 结束迭代器
+    BasicSplitIterator() : hay_(), delim_(), reverse_(false), lo_(0), hi_(0), splits_left_(0), first_(false),
+                      finished_(true), done_(true), current_() {}
+
+    BasicSplitIterator(ByteSpan hay, Delimiter delim, std::size_t max_splits, bool reverse)
+        : hay_(hay), delim_(delim), reverse_(reverse), lo_(0), hi_(hay.size()), splits_left_(max_splits),
+          first_(true), finished_(false), done_(false), current_() {
+        advance();
+    }
+
+    const View& operator*() const {
+        return current_;
+    }
+
+    const View* operator->() const {
+        return &current_;
+    }
+
+    BasicSplitIterator& operator++() {
+        advance();
+        return *this;
+    }
+
+    BasicSplitIterator operator++(int) {
+        BasicSplitIterator old(*this);
+        advance();
+        return old;
+    }
+
+    bool operator==(const BasicSplitIterator& other) const {
+        if (done_ || other.done_) return done_ == other.done_;
+        return hay_.data() == other.hay_.data() && lo_ == other.lo_ && hi_ == other.hi_ &&
+               finished_ == other.finished_;
+    }
+
+    bool operator!=(const BasicSplitIterator& other) const {
+        return ! (*this == other);
+    }
+
+  private:
+    void advance() {
+        const EmptySegments empties = delim_.empties();
+        while (! finished_) {
+            // 尚未处理的部分为 [lo_, hi_)
+            std::size_t seg_start = lo_;
+            std::size_t seg_end = hi_;
+            DelimMatch d = {knpos, 0};
+            if (splits_left_ != 0) d = reverse_ ? delim_.prev(hay_, hi_) : delim_.next(hay_, lo_);
+            // 正向时最后一个分段在最右侧, 逆向时第一个分段在最右侧
+            bool rightmost = reverse_ ? first_ : d.pos == knpos;
+            if (d.pos == knpos) {
+                finished_ = true;
+            } else if (reverse_) {
+                seg_start = d.pos + d.len;
+                hi_ = d.pos;
+                --splits_left_;
+            } else {
+                seg_end = d.pos;
+                lo_ = d.pos + d.len;
+                --splits_left_;
+            }
+            first_ = false;
+
+            if (seg_start == seg_end) {
+                if (empties == EmptySegments::DropAll) continue;
+                if (empties == EmptySegments::DropLast && rightmost) continue;
+            }
+            current_ = View(hay_.data() + seg_start, seg_end - seg_start);
+            return;
+        }
+        done_ = true;
+    }
+
+    ByteSpan hay_;
+    Delimiter delim_;
+    bool reverse_;
+    std::size_t lo_;
+    std::size_t hi_;
+    std::size_t splits_left_;
+    bool first_;    // 逆向时下一个分段是否为最右侧分段
+    bool finished_; // 最后一个分段已经给出
+    bool done_;
+    View current_;
+};
+
+// split_iter / lines_iter / split_whitespace_iter 返回的惰性区间, reversed() 得到逆向 (rsplit 语义) 区间
+template <typename View, typename Delimiter>
+class BasicSplitRange {
+  public:
+    using iterator = BasicSplitIterator<View, Delimiter>;
+
+    BasicSplitRange(ByteSpan hay, Delimiter delim, std::size_t max_splits = knpos, bool reverse = false)
+        : hay_(hay), delim_(delim), max_splits_(max_splits), reverse_(reverse) {}
+
+    iterator begin() const {
+        return iterator(hay_, delim_, max_splits_, reverse_);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    BasicSplitRange reversed() const {
+        return BasicSplitRange(hay_, delim_, max_splits_, ! reverse_);
+    }
+
+    bool is_reversed() const {
+        return reverse_;
+    }
+
+    // 第一个分段, 区间为空时返回空视图
+    View front() const {
+        iterator it = begin();
+        return it == end() ? View() : *it;
+    }
+
+  private:
+    ByteSpan hay_;
+    Delimiter delim_;
+    std::size_t max_splits_;
+    bool reverse_;
+};
+
+/**
+ * @brief split_count 的批量实现: 每次用 search::find_many 取出一批分隔符位置 (写入栈上缓冲) 再生成分段
+ * 相比逐个查找, 短字段 (如 CSV) 时省去每个字段一次的查找调用开销; pat 不能为空
+ */
+template <typename View>
+std::vector<View> split_bulk(ByteSpan hay, ByteSpan pat, std::size_t max_splits) {
+    enum : std::size_t {
+        BATCH = 64
+    };
+    std::vector<View> out;
+    std::size_t offsets[BATCH];
+    std::size_t start = 0;
+    while (max_splits > 0) {
+        std::size_t want = max_splits < BATCH ? max_splits : BATCH;
+        std::size_t found = search::find_many(hay, pat, start, offsets, want);
+        // 多数输入第一批就能取完全部分隔符, 一次分配到位
+        if (out.empty()) out.reserve(found + 1);
+        for (std::size_t i = 0; i < found; ++i) {
+            out.emplace_back(hay.data() + start, offsets[i] - start);
+            start = offsets[i] + pat.size();
+        }
+        max_splits -= found;
+        if (found < want) break;
+    }
+    out.emplace_back(hay.data() + start, hay.size() - start);
+    return out;
+}
+} // namespace kstring
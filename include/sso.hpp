@@ -115,6 +115,20 @@ class SSOBytes {
         init_uncheck(bs.begin(), bs.size());
     }
 
+    /**
+     * @brief 接管 vec 的堆缓冲, 不拷贝字节
+     * 装得进 SSO 时改为拷贝, 此时 vec 保持原样, 调用方可以继续复用它的缓冲
+     */
+    explicit SSOBytes(std::vector<Byte>&& vec) {
+        if (vec.size() <= SSO_CAPACITY) {
+            sso.len = 0;
+            if (! vec.empty()) init_uncheck(vec.data(), vec.size());
+        } else {
+            new (&heap.vec) std::vector<Byte>(std::move(vec));
+            heap.tag = kHeapFlag;
+        }
+    }
+
     SSOBytes(const SSOBytes& other) {
         if (other.is_sso()) {
             std::memcpy(sso.data, other.sso.data, other.sso.len);
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "base.hpp"
+#include "unicode_tables.hpp"
+
+namespace kstring {
+namespace unicode {
+// General_Category, 顺序与 tools/gen_unicode_tables.py 一致: 字母, 标记, 数字, 标点, 符号, 分隔符, 其他
+enum class GeneralCategory : std::uint8_t {
+    Lu, Ll, Lt, Lm, Lo, // 字母
+    Mn, Mc, Me,         // 标记
+    Nd, Nl, No,         // 数字
+    Pc, Pd, Ps, Pe, Pi, Pf, Po,
+    Sm, Sc, Sk, So,
+    Zs, Zl, Zp,
+    Cc, Cf, Cs, Co, Cn // 控制, 格式, 代理, 私用, 未分配
+};
+
+// 每个字符的分类位图, classify 批量给出
+typedef std::uint16_t CharMask;
+
+enum : CharMask {
+    CHAR_LETTER = 1u << 0,          // L*
+    CHAR_MARK = 1u << 1,            // M*
+    CHAR_NUMBER = 1u << 2,          // N*
+    CHAR_DIGIT = 1u << 3,           // Nd
+    CHAR_PUNCTUATION = 1u << 4,     // P*
+    CHAR_SYMBOL = 1u << 5,          // S*
+    CHAR_SEPARATOR = 1u << 6,       // Z*
+    CHAR_CONTROL = 1u << 7,         // Cc
+    CHAR_PRINTABLE = 1u << 8,       // 除 Zl, Zp 与 C* 以外的字符
+    CHAR_WHITE_SPACE = 1u << 9,     // White_Space 属性
+    CHAR_ALPHABETIC = 1u << 10,     // Alphabetic 属性
+    CHAR_LOWERCASE = 1u << 11,      // Lowercase 属性
+    CHAR_UPPERCASE = 1u << 12,      // Uppercase 属性
+    CHAR_CASED = 1u << 13,          // Cased 属性
+    CHAR_CASE_IGNORABLE = 1u << 14, // Case_Ignorable 属性
+    CHAR_INVALID = 1u << 15         // 非法 UTF-8 序列, 不与其他位同时出现
+};
+
+static_assert(static_cast<unsigned>(GeneralCategory::Cn) + 1 == tables::GC_COUNT, "GeneralCategory order");
+static_assert(tables::PROP_WHITE_SPACE << 4 == CHAR_WHITE_SPACE &&
+                  tables::PROP_CASE_IGNORABLE << 4 == CHAR_CASE_IGNORABLE,
+              "property flags map to CharMask by a shift");
+
+// 码点的属性记录 (两级表, 两次访存); 超出 Unicode 范围的值视为未分配
+inline std::uint16_t properties(CodePoint cp) {
+    if (cp >= 0x110000) return static_cast<std::uint16_t>(GeneralCategory::Cn);
+    std::size_t block = static_cast<std::size_t>(tables::PROP_STAGE1[cp >> tables::PROP_SHIFT]) << tables::PROP_SHIFT;
+    return tables::PROP_STAGE2[block | (cp & ((1u << tables::PROP_SHIFT) - 1))];
+}
+
+inline GeneralCategory general_category(CodePoint cp) {
+    return static_cast<GeneralCategory>(properties(cp) & tables::PROP_GC_BITS);
+}
+
+inline bool is_white_space(CodePoint cp) {
+    return (properties(cp) & tables::PROP_WHITE_SPACE) != 0;
+}
+
+inline bool is_alphabetic(CodePoint cp) {
+    return (properties(cp) & tables::PROP_ALPHABETIC) != 0;
+}
+
+inline bool is_lowercase(CodePoint cp) {
+    return (properties(cp) & tables::PROP_LOWERCASE) != 0;
+}
+
+inline bool is_uppercase(CodePoint cp) {
+    return (properties(cp) & tables::PROP_UPPERCASE) != 0;
+}
+
+inline bool is_cased(CodePoint cp) {
+    return (properties(cp) & tables::PROP_CASED) != 0;
+}
+
+inline bool is_case_ignorable(CodePoint cp) {
+    return (properties(cp) & tables::PROP_CASE_IGNORABLE) != 0;
+}
+
+// 由 General_Category 得到的分类位, 按枚举顺序做区间比较
+constexpr CharMask category_mask(GeneralCategory gc) {
+    return gc <= GeneralCategory::Lo   ? CharMask(CHAR_LETTER | CHAR_PRINTABLE)
+           : gc <= GeneralCategory::Me ? CharMask(CHAR_MARK | CHAR_PRINTABLE)
+           : gc == GeneralCategory::Nd ? CharMask(CHAR_NUMBER | CHAR_DIGIT | CHAR_PRINTABLE)
+           : gc <= GeneralCategory::No ? CharMask(CHAR_NUMBER | CHAR_PRINTABLE)
+           : gc <= GeneralCategory::Po ? CharMask(CHAR_PUNCTUATION | CHAR_PRINTABLE)
+           : gc <= GeneralCategory::So ? CharMask(CHAR_SYMBOL | CHAR_PRINTABLE)
+           : gc == GeneralCategory::Zs ? CharMask(CHAR_SEPARATOR | CHAR_PRINTABLE)
+           : gc <= GeneralCategory::Zp ? CharMask(CHAR_SEPARATOR)
+           : gc == GeneralCategory::Cc ? CharMask(CHAR_CONTROL)
+                                       : CharMask(0);
+}
+
+inline CharMask char_mask(CodePoint cp) {
+    std::uint16_t props = properties(cp);
+    CharMask flags = static_cast<CharMask>((props & ~tables::PROP_GC_BITS) << 4);
+    return static_cast<CharMask>(category_mask(static_cast<GeneralCategory>(props & tables::PROP_GC_BITS)) | flags);
+}
+
+/**
+ * @brief 批量分类: 从 pos 起逐字符写出 CharMask, 最多 cap 个, pos 前进到下一个未处理的字符
+ * 非法序列按 utf8::decode_one 的步长各占一项, 值为 CHAR_INVALID; 返回写出的个数
+ */
+std::size_t classify(ByteSpan text, std::size_t& pos, CharMask* out, std::size_t cap);
+
+// 整段文本的分类结果, 每个字符一项
+std::vector<CharMask> classify(ByteSpan text);
+
+// 生成属性表所用的 Unicode 版本, 如 "14.0.0"
+const char* version();
+} // namespace unicode
+} // namespace kstring
@@ -0,0 +1,125 @@
+// 由 tools/gen_unicode_tables.py 根据 data/ucd 生成, 请勿手工修改 (make unicode)
+#pragma once
+
+#include <cstdint>
+
+namespace kstring {
+namespace unicode {
+namespace tables {
+enum : unsigned {
+    UNICODE_VERSION_MAJOR = 14,
+    UNICODE_VERSION_MINOR = 0,
+    UNICODE_VERSION_UPDATE = 0
+};
+
+enum : unsigned {
+    GC_COUNT = 30,
+    GCB_COUNT = 14,
+    WB_COUNT = 19,
+    SB_COUNT = 15
+};
+
+enum : std::uint8_t {
+    GCB_BITS = 0x0F,
+    GCB_EXTENDED_PICTOGRAPHIC = 0x10,
+    WB_BITS = 0x1F,
+    WB_EXTENDED_PICTOGRAPHIC = 0x20
+};
+
+enum : std::uint16_t {
+    PROP_GC_BITS = 0x1F,
+    PROP_WHITE_SPACE = 1u << 5,
+    PROP_ALPHABETIC = 1u << 6,
+    PROP_LOWERCASE = 1u << 7,
+    PROP_UPPERCASE = 1u << 8,
+    PROP_CASED = 1u << 9,
+    PROP_CASE_IGNORABLE = 1u << 10
+};
+
+// 属性记录: 低 5 位为 General_Category, 其余为 PROP_* 二元属性
+enum : unsigned {
+    PROP_SHIFT = 7
+};
+extern const std::uint8_t PROP_STAGE1[8704];
+extern const std::uint16_t PROP_STAGE2[31872];
+
+// 大小写映射: 值为 CASE_RECORDS 的下标, 0 表示没有映射
+enum : unsigned {
+    CASE_SHIFT = 8
+};
+extern const std::uint8_t CASE_STAGE1[4352];
+extern const std::uint16_t CASE_STAGE2[7168];
+
+// 规范化: 值为 NORM_RECORDS 的下标, 0 表示 ccc 为 0, 没有分解且 quick check 全为 Yes
+enum : unsigned {
+    NORM_SHIFT = 7
+};
+extern const std::uint8_t NORM_STAGE1[8704];
+extern const std::uint16_t NORM_STAGE2[21120];
+
+// 字素簇: 低 4 位为 Grapheme_Cluster_Break, 另有 Extended_Pictographic 位
+enum : unsigned {
+    GCB_SHIFT = 7
+};
+extern const std::uint8_t GCB_STAGE1[8704];
+extern const std::uint8_t GCB_STAGE2[19072];
+
+// 词: 低 5 位为 Word_Break, 另有 Extended_Pictographic 位
+enum : unsigned {
+    WB_SHIFT = 7
+};
+extern const std::uint8_t WB_STAGE1[8704];
+extern const std::uint8_t WB_STAGE2[26496];
+
+// 句: Sentence_Break
+enum : unsigned {
+    SB_SHIFT = 7
+};
+extern const std::uint8_t SB_STAGE1[8704];
+extern const std::uint8_t SB_STAGE2[27520];
+
+// 简单映射存为与原码点的差值; full_* 为完整映射在 CASE_SPECIAL 中的偏移 (长度, 码点...), 0 表示同简单映射
+struct CaseRecord {
+    std::int32_t upper;
+    std::int32_t lower;
+    std::int32_t title;
+    std::uint16_t full_upper;
+    std::uint16_t full_lower;
+    std::uint16_t full_title;
+};
+
+extern const CaseRecord CASE_RECORDS[276];
+extern const std::uint32_t CASE_SPECIAL[305];
+
+enum : std::uint8_t {
+    NORM_NFD_NO = 1u << 0,
+    NORM_NFKD_NO = 1u << 1,
+    NORM_NFC_NO = 1u << 2,
+    NORM_NFC_MAYBE = 1u << 3,
+    NORM_NFKC_NO = 1u << 4,
+    NORM_NFKC_MAYBE = 1u << 5
+};
+
+// canonical / compat 为完全展开后的分解在 DECOMP 中的偏移 (长度, 码点...);
+// canonical 为 0 表示没有规范分解, compat 为 0 表示兼容分解同规范分解. 谚文音节按算法分解, 不在表中
+struct NormRecord {
+    std::uint8_t ccc;
+    std::uint8_t flags;
+    std::uint16_t canonical;
+    std::uint16_t compat;
+};
+
+extern const NormRecord NORM_RECORDS[3828];
+extern const std::uint32_t DECOMP[10389];
+
+// 主组合 (first, second) -> composite, 按 (first, second) 升序
+struct CompositionPair {
+    std::uint32_t first;
+    std::uint32_t second;
+    std::uint32_t composite;
+};
+
+extern const CompositionPair COMPOSITIONS[941];
+} // namespace tables
+} // namespace unicode
+} // namespace kstring
@@ -92,28 +92,228 @@ bool is_overflow_codepoint(CodePoint cp);
 // 编码一个 code point 为 UTF-8 序列
 UTF8Encoded encode(CodePoint cp);
 
+// 把合法码点 (调用方保证) 的 UTF-8 编码写到 out, 返回字节数; 供批量输出的热路径内联使用
+inline std::size_t encode_to(Byte* out, CodePoint cp) {
+    if (cp < 0x80) {
+        out[0] = static_cast<Byte>(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = static_cast<Byte>(0xC0 | (cp >> 6));
+        out[1] = static_cast<Byte>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = static_cast<Byte>(0xE0 | (cp >> 12));
+        out[1] = static_cast<Byte>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<Byte>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<Byte>(0xF0 | (cp >> 18));
+    out[1] = static_cast<Byte>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<Byte>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<Byte>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
 // 尝试解码 data[pos...] 开头的字符（失败时返回 false）, next_pos 存放解码后应处的 pos
 UTF8Decoded decode_one(const ByteSpan& data, std::size_t pos);
 
+// 内联解码 p 开头的一个合法多字节序列, 返回长度; 非法时返回 0, 由调用方交给 decode_one 处理
+// avail 为 p 之后可读的字节数, 热路径上省去 decode_one 的函数调用
+inline std::size_t try_decode(const Byte* p, std::size_t avail, CodePoint& cp) {
+    const Byte lead = p[0];
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        if (avail < 2 || (p[1] & 0xC0) != 0x80) return 0;
+        cp = (static_cast<CodePoint>(lead & 0x1F) << 6) | static_cast<CodePoint>(p[1] & 0x3F);
+        return 2;
+    }
+    if ((lead & 0xF0) == 0xE0) {
+        if (avail < 3 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80) return 0;
+        cp = (static_cast<CodePoint>(lead & 0x0F) << 12) | (static_cast<CodePoint>(p[1] & 0x3F) << 6) |
+             static_cast<CodePoint>(p[2] & 0x3F);
+        return (cp >= 0x800 && (cp < 0xD800 || cp > 0xDFFF)) ? 3 : 0;
+    }
+    if (lead >= 0xF0 && lead <= 0xF4) {
+        if (avail < 4 || (p[1] & 0xC0) != 0x80 || (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80) return 0;
+        cp = (static_cast<CodePoint>(lead & 0x07) << 18) | (static_cast<CodePoint>(p[1] & 0x3F) << 12) |
+             (static_cast<CodePoint>(p[2] & 0x3F) << 6) | static_cast<CodePoint>(p[3] & 0x3F);
+        return (cp >= 0x10000 && cp <= 0x10FFFF) ? 4 : 0;
+    }
+    return 0;
+}
+
+// 内联解码以 end 结尾的一个合法多字节序列, 返回长度; 不存在时返回 0 (与 try_decode 对称, 只向前看至多 4 字节)
+inline std::size_t try_decode_prev(const Byte* begin, std::size_t end, CodePoint& cp) {
+    const std::size_t limit = end >= 4 ? end - 4 : 0;
+    std::size_t start = end - 1;
+    while (start > limit && (begin[start] & 0xC0) == 0x80) --start;
+    const std::size_t len = end - start;
+    return (len >= 2 && try_decode(begin + start, len, cp) == len) ? len : 0;
+}
+
+/**
+ * @brief 解码以 pos 结尾的字符, next_pos 存放其起始位置; pos 为 0 时返回 ok = false, next_pos = 0
+ * 从 pos 向前跳过至多 3 个续字节找到首字节, 只校验一次; 非法输入的切分与 decode_one 正向迭代完全一致
+ * (一个非法序列计为一个字符, 末尾被截断的序列连同其后的字节同样算作一个)
+ */
 UTF8Decoded decode_one_prev(const ByteSpan& data, std::size_t pos);
+
+// decode_chunk 输出中代表一个非法序列的值 (超出码点范围, 不会与 U+FFFD 混淆)
+const CodePoint INVALID_SEQUENCE = 0x110000;
+
+/**
+ * @brief 从 pos 起批量解码至多 cap (>= 4) 个字符到 out, pos 前移到第一个未解码的字节, 返回写入的个数
+ * 合法段由 simdutf 整段转换为 UTF-32, 只在出错处退回 decode_one: 每个非法序列写一个 INVALID_SEQUENCE 并结束本块,
+ * 与 CharIterator 的切分一致; pos >= size 时返回 0
+ */
+std::size_t decode_chunk(const ByteSpan& data, std::size_t& pos, CodePoint* out, std::size_t cap);
 std::vector<CodePoint> decode_all(const ByteSpan& data);
 ByteVec encode_all(const std::vector<CodePoint>& code_vec);
 
+/**
+ * @brief 有损修复为合法 UTF-8: 每个非法序列 (decode_one 的切分) 换成一个 U+FFFD, 与 encode_all(decode_all(data)) 逐字节相同
+ * 先用 simdutf 整体校验, 合法时直接返回原样的拷贝; 否则合法段整段 memcpy, 不经过 UTF-32 中转
+ * append_sanitized 把结果追加到 out; sanitize_in_place 在合法时不做任何写入与分配, 返回是否修改过
+ */
+void append_sanitized(const ByteSpan& data, ByteVec& out);
+ByteVec sanitize(const ByteSpan& data);
+bool sanitize_in_place(ByteVec& data);
+
+/** @brief 转码遇到非法输入时的处理: Strict 抛出 std::invalid_argument 且 out 保持调用前的内容, Lossy 替换后继续 */
+enum class ErrorMode { Strict, Lossy };
+
+/** @brief UTF-16 单元在内存中的字节序: Windows 文件与 x86 上的 char16_t 为 LittleEndian, Java 序列化为 BigEndian */
+enum class Utf16Order { LittleEndian, BigEndian };
+
+/**
+ * @brief UTF-8 与 UTF-16 / Latin-1 之间直接转码, 结果追加到调用方提供的 out (可复用其容量), 不经过 UTF-32 中转
+ * 合法段由 simdutf 整段转换, 只在出错处停下处理一个单元; Strict 的异常信息给出出错位置
+ * (UTF-8 输入为字节偏移, UTF-16 输入为 char16_t 下标)
+ * Lossy: UTF-8 的每个非法序列 (decode_one 的切分) 与 UTF-16 的每个孤立代理换成一个 U+FFFD;
+ *        转为 Latin-1 时非法序列与 U+0100 及以上的字符各换成一个 '?'
+ * Latin-1 转 UTF-8 总是成功
+ */
+void append_utf16(const ByteSpan& data, std::u16string& out, ErrorMode mode = ErrorMode::Lossy,
+                  Utf16Order order = Utf16Order::LittleEndian);
+void append_from_utf16(const char16_t* data, std::size_t len, ByteVec& out, ErrorMode mode = ErrorMode::Lossy,
+                       Utf16Order order = Utf16Order::LittleEndian);
+void append_latin1(const ByteSpan& data, ByteVec& out, ErrorMode mode = ErrorMode::Lossy);
+void append_from_latin1(const ByteSpan& data, ByteVec& out);
+
+/**
+ * @brief 分块到达的 UTF-8 流 (socket / 文件按 64 KB 读取) 的增量校验, 不必先缓存整条消息
+ * 每块的主体交给 simdutf 整段校验, 只把末尾被截断的序列 (至多 3 字节) 留到下一次 feed 拼接;
+ * error_offset() 是整条流中的全局字节偏移, 与对所有块拼接后调用 first_invalid 的结果相同
+ * feed 在发现错误后返回 false, 之后的输入不再检查; finish 表示流结束, 此时仍未补全的序列算作错误
+ * @example：
+ *   utf8::StreamValidator v;
+ *   while (read(fd, buf, 65536) > 0) if (! v.feed(chunk)) break;
+ *   bool ok = v.finish();
+ */
+class StreamValidator {
+  public:
+    StreamValidator();
+
+    bool feed(const ByteSpan& chunk);
+    bool finish();
+    void reset();
+
+    bool ok() const {
+        return error_ == kstring::knpos;
+    }
+
+    // 第一个非法序列的全局字节偏移, 没有时为 knpos
+    std::size_t error_offset() const {
+        return error_;
+    }
+
+    std::size_t bytes_fed() const {
+        return fed_;
+    }
+
+  private:
+    Byte pending_[4];         // 上一块末尾未补全的序列
+    std::size_t pending_len_;
+    std::size_t fed_;         // 已 feed 的总字节数
+    std::size_t error_;
+};
+
+/**
+ * @brief 分块解码, 码点追加到调用方的 out; 块边界的处理同 StreamValidator
+ * Lossy: 每个非法序列写一个 ILL_CODEPOINT, 输出与对拼接结果调用 decode_all 逐个相同, 与分块方式无关
+ * Strict: 停在第一个非法序列, 之前的码点已写入 out, feed / finish 返回 false
+ * 两种模式下 error_offset() 都给出第一个非法序列的全局字节偏移; feed / finish 的返回值即 ok()
+ */
+class StreamDecoder {
+  public:
+    explicit StreamDecoder(ErrorMode mode = ErrorMode::Lossy);
+
+    bool feed(const ByteSpan& chunk, std::vector<CodePoint>& out);
+    bool finish(std::vector<CodePoint>& out);
+    void reset();
+
+    bool ok() const {
+        return error_ == kstring::knpos;
+    }
+
+    std::size_t error_offset() const {
+        return error_;
+    }
+
+    std::size_t bytes_fed() const {
+        return fed_;
+    }
+
+  private:
+    // 记录 offset 处的非法序列, 返回是否继续解码
+    bool on_error(std::size_t offset);
+
+    ErrorMode mode_;
+    Byte pending_[4];
+    std::size_t pending_len_;
+    std::size_t fed_;
+    std::size_t error_;
+};
+
 // decode range [start, end)
 std::vector<CodePoint> decode_range(const ByteSpan& data, size_t start, size_t end);
 // 查找字符数（不是字节数）
 std::size_t char_count(const ByteSpan& data);
 
-// 查找首次出现的 code point（按字符计数）
+// 非法序列的个数, 按 decode_one 切分, 与 char_count 中计为 ILL_CODEPOINT 的字符一一对应; 合法时为 0
+std::size_t invalid_count(const ByteSpan& data);
+
+// 从字符边界 pos 起统计到字节位置 end 之前开始的字符数, 并把 pos 推进到新的字符边界
+// 切分语义与 decode_one 的 next_pos 一致; end 落在某个序列中间时该序列计入, pos 会越过 end
+// 用于在递增的一串位置之间增量换算字符下标
+std::size_t count_chars_to(const ByteSpan& data, std::size_t& pos, std::size_t end);
+
+// 从 pos 起向后跳过 n 个字符, 返回跳过后的字节位置; 不足 n 个字符时返回 knpos
+// 切分语义与 decode_one 的 next_pos 一致, ASCII 连续段整段跳过
+std::size_t advance_chars(const ByteSpan& data, std::size_t pos, std::size_t n);
+
+/**
+ * @brief 查找首次出现的 code point, 返回字符下标; 找不到或 target 不是合法码点时返回 knpos
+ * 目标先编码为 UTF-8 再用 SIMD 子串查找定位, 字节偏移由 simdutf 计数换算为字符下标
+ * 非法序列不会中断查找, 按 decode_one 的切分计为一个字符
+ */
 std::size_t find_codepoint(const ByteSpan& data, CodePoint target_codepoint);
 
 void replace_at(ByteVec& data, size_t index, CodePoint cp_new);
+
+/**
+ * @brief 把所有 cp_old 替换为 cp_new; 与 find_codepoint 相同, 按编码后的字节串 SIMD 查找, 非法序列不中断
+ * 等长时原地覆盖; 否则交给 search::replace 单遍写入一次分配好的新缓冲, 不再逐个移动尾部
+ */
 void replace_all(ByteVec& data, CodePoint cp_old, CodePoint cp_new);
 
 void replace_first(ByteVec& data, CodePoint cp_old, CodePoint cp_new);
 
 // 是否是 ASCII 纯文本
 bool is_all_ascii(const ByteSpan& data);
+// 大于 0x7F 的字节个数
+std::size_t non_ascii_count(const ByteSpan& data);
 std::string codepoint_to_string(utf8::CodePoint cp);
 } // namespace utf8
 
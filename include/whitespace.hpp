@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "base.hpp"
+
+namespace kstring {
+enum : std::uint64_t {
+    ASCII_WHITESPACE_MASK = 0x100003E00ull // \t \n \v \f \r 与空格, 第 cp 位表示码点 cp
+};
+
+/**
+ * @brief 码点是否为空白字符 (ASCII 空白, NBSP, U+1680, U+2000..U+200A, 行/段分隔符, U+202F, U+205F, U+3000)
+ * ASCII 查 64 位位图, 其余按区间比较, 不查表也不分配
+ */
+constexpr bool is_whitespace_codepoint(CodePoint cp) {
+    return cp < 0x80    ? (cp < 64 && ((ASCII_WHITESPACE_MASK >> cp) & 1u) != 0)
+           : cp < 0x2000 ? (cp == 0x00A0 || cp == 0x1680)
+                         : (cp <= 0x200A || cp == 0x2028 || cp == 0x2029 || cp == 0x202F || cp == 0x205F ||
+                            cp == 0x3000);
+}
+
+/**
+ * @brief 按字节批量扫描 UTF-8 文本中的空白, 供 trim / split_whitespace 使用
+ * 每次用 SIMD 对 32 字节分类: ASCII 空白直接命中, 只有可能开始多字节空白的首字节 (0xC2, 0xE1..0xE3) 才解码确认
+ * 非法字节视为非空白; 多字节空白的首字节不会被前面的非法序列吞掉, 因此结果与逐字符解码一致
+ */
+namespace whitespace {
+// [pos, size) 中第一个空白字符的起始位置, len 返回其字节数; 没有时返回 knpos
+std::size_t find(ByteSpan data, std::size_t pos, std::size_t& len);
+
+// 完整落在 [0, end) 中的最后一个空白字符的起始位置, len 返回其字节数; 没有时返回 knpos
+std::size_t rfind(ByteSpan data, std::size_t end, std::size_t& len);
+
+// 从字符边界 pos 起跳过连续空白, 返回第一个非空白字符的位置 (全是空白时为 size)
+std::size_t skip(ByteSpan data, std::size_t pos);
+
+// 从 end 向前跳过连续空白, 返回这段空白的起始位置 (全是空白时为 0)
+std::size_t rskip(ByteSpan data, std::size_t end);
+
+// 当前 CPU 上实际使用的实现: "avx2" / "sse2" / "scalar"
+const char* simd_backend();
+} // namespace whitespace
+} // namespace kstring
@@ -0,0 +1,167 @@
+#include <limits>
+#include <stdexcept>
+#include "aho_corasick.hpp"
+#include "search.hpp"
+
+namespace kstring {
+namespace search {
+namespace {
+const std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+} // namespace
+
+AhoCorasick::AhoCorasick(const std::vector<ByteSpan>& patterns, MatchKind kind)
+    : storage_(), offsets_(), kind_(kind), classes_(), alphabet_(0), trans_(), depth_(), match_(), dict_(),
+      empty_id_(knpos), start_bytes_() {
+    std::size_t total = 0;
+    for (const auto& pat : patterns) total += pat.size();
+    // 状态号与模式 id 用 uint32 存放
+    if (total >= NONE || patterns.size() >= NONE) {
+        throw std::length_error("AhoCorasick: too many patterns");
+    }
+
+    storage_.reserve(total);
+    offsets_.reserve(patterns.size() + 1);
+    offsets_.push_back(0);
+    for (const auto& pat : patterns) {
+        storage_.insert(storage_.end(), pat.begin(), pat.end());
+        offsets_.push_back(storage_.size());
+    }
+    build();
+}
+
+ByteSpan AhoCorasick::pattern(std::size_t id) const {
+    if (id >= pattern_count()) {
+        throw std::out_of_range("AhoCorasick::pattern id out of range");
+    }
+    return ByteSpan(storage_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]);
+}
+
+void AhoCorasick::build() {
+    // 字节等价类: 出现过的字节按字节序编号 1..k, 其余字节归入 0
+    bool used[256] = {};
+    for (Byte b : storage_) used[b] = true;
+    alphabet_ = 1;
+    for (std::size_t b = 0; b < 256; ++b) {
+        if (used[b]) classes_[b] = static_cast<std::uint16_t>(alphabet_++);
+    }
+
+    // trie, 缺失的边先记为 NONE
+    const std::size_t n_pat = pattern_count();
+    trans_.assign(alphabet_, NONE);
+    depth_.assign(1, 0);
+    match_.assign(1, NONE);
+    for (std::size_t id = 0; id < n_pat; ++id) {
+        ByteSpan pat = pattern(id);
+        if (pat.empty()) {
+            if (empty_id_ == knpos) empty_id_ = id;
+            continue;
+        }
+        std::uint32_t s = 0;
+        for (Byte b : pat) {
+            std::size_t slot = s * alphabet_ + classes_[b];
+            if (trans_[slot] == NONE) {
+                std::uint32_t next = static_cast<std::uint32_t>(depth_.size());
+                trans_[slot] = next;
+                trans_.resize(trans_.size() + alphabet_, NONE);
+                depth_.push_back(depth_[s] + 1);
+                match_.push_back(NONE);
+            }
+            s = trans_[slot];
+        }
+        // 按 id 递增插入, 重复的模式保留最小 id
+        if (match_[s] == NONE) match_[s] = static_cast<std::uint32_t>(id);
+    }
+
+    // BFS 计算失败链接并把缺失的边补全为 DFA 转移, 同时串起输出链 dict_
+    const std::size_t n_state = depth_.size();
+    std::vector<std::uint32_t> fail(n_state, 0);
+    dict_.assign(n_state, NONE);
+    std::vector<std::uint32_t> queue;
+    queue.reserve(n_state);
+    for (std::size_t c = 0; c < alphabet_; ++c) {
+        if (trans_[c] == NONE) {
+            trans_[c] = 0;
+        } else {
+            queue.push_back(trans_[c]);
+        }
+    }
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        std::uint32_t u = queue[head];
+        for (std::size_t c = 0; c < alphabet_; ++c) {
+            std::uint32_t& t = trans_[u * alphabet_ + c];
+            std::uint32_t via_fail = trans_[fail[u] * alphabet_ + c];
+            if (t == NONE) {
+                t = via_fail;
+            } else {
+                fail[t] = via_fail;
+                dict_[t] = match_[via_fail] != NONE ? via_fail : dict_[via_fail];
+                queue.push_back(t);
+            }
+        }
+    }
+
+    // 空模式在任何位置都能匹配, 预过滤没有意义
+    if (empty_id_ != knpos) return;
+    bool first[256] = {};
+    for (std::size_t id = 0; id < n_pat; ++id) {
+        Byte b = storage_[offsets_[id]];
+        if (! first[b]) {
+            first[b] = true;
+            start_bytes_.push_back(b);
+        }
+    }
+    if (start_bytes_.size() > FIRST_OF_SIMD_MAX) start_bytes_.clear();
+}
+
+bool AhoCorasick::better(const MultiMatch& cand, const MultiMatch& best) const {
+    if (! best.found()) return true;
+    if (cand.start != best.start) return cand.start < best.start;
+    if (kind_ == MatchKind::LeftmostLongest) {
+        std::size_t cand_len = cand.end - cand.start;
+        std::size_t best_len = best.end - best.start;
+        if (cand_len != best_len) return cand_len > best_len;
+    }
+    return cand.pattern < best.pattern;
+}
+
+MultiMatch AhoCorasick::find(ByteSpan hay, std::size_t from) const {
+    MultiMatch best;
+    const std::size_t n = hay.size();
+    if (from > n) return best;
+    if (empty_id_ != knpos) best = MultiMatch(empty_id_, from, from);
+
+    const Byte* h = hay.data();
+    const bool prefilter = has_prefilter();
+    std::uint32_t s = 0;
+    for (std::size_t j = from; j < n; ++j) {
+        // 处于初始状态且当前字节不是任何模式的首字节: 用 SIMD 跳到下一个候选起点
+        if (prefilter && s == 0 && ! best.found() && trans_[classes_[h[j]]] == 0) {
+            std::size_t skip = find_first_of(hay.subspan(j + 1), ByteSpan(start_bytes_.data(), start_bytes_.size()));
+            if (skip == knpos) return best;
+            j += skip + 1;
+        }
+        s = trans_[s * alphabet_ + classes_[h[j]]];
+        // 输出链上的匹配按长度递减排列, 即起点递增
+        for (std::uint32_t t = match_[s] != NONE ? s : dict_[s]; t != NONE; t = dict_[t]) {
+            MultiMatch cand(match_[t], j + 1 - depth_[t], j + 1);
+            if (better(cand, best)) best = cand;
+        }
+        // 之后的匹配起点不早于 j + 1 - depth_[s], 已经不可能比 best 更靠左
+        if (best.found() && j + 1 - depth_[s] > best.start) break;
+    }
+    return best;
+}
+
+std::vector<MultiMatch> AhoCorasick::find_all(ByteSpan hay) const {
+    std::vector<MultiMatch> out;
+    std::size_t pos = 0;
+    while (pos <= hay.size()) {
+        MultiMatch m = find(hay, pos);
+        if (! m.found()) break;
+        out.push_back(m);
+        pos = m.end > m.start ? m.end : m.end + 1;
+    }
+    return out;
+}
+} // namespace search
+} // namespace kstring
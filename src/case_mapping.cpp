@@ -0,0 +1,202 @@
+#include <cstring>
+#include "case_mapping.hpp"
+#include "utf8.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KSTRING_CASE_X86 1
+#endif
+
+namespace kstring {
+namespace unicode {
+namespace {
+enum : CodePoint {
+    CAPITAL_SIGMA = 0x03A3,
+    FINAL_SIGMA = 0x03C2
+};
+
+CaseMapping make_mapping(CodePoint cp, std::int32_t delta, std::uint16_t offset) {
+    CaseMapping m = {{0, 0, 0}, 1};
+    if (offset == 0) {
+        m.chars[0] = cp + static_cast<CodePoint>(delta);
+        return m;
+    }
+    m.len = tables::CASE_SPECIAL[offset];
+    for (std::size_t i = 0; i < m.len; ++i) m.chars[i] = tables::CASE_SPECIAL[offset + 1 + i];
+    return m;
+}
+
+// 32 字节全是 ASCII 时把 [lo, lo + 25] 中的字母翻转大小写后写入 out 并返回 true, 否则不写
+typedef bool (*AsciiBlockFn)(const Byte* in, Byte* out, Byte lo);
+
+inline Byte flip_ascii(Byte b, Byte lo) {
+    return static_cast<unsigned>(b - lo) < 26u ? static_cast<Byte>(b ^ 0x20) : b;
+}
+
+bool ascii_block_scalar(const Byte* in, Byte* out, Byte lo) {
+    std::uint64_t high = 0;
+    for (unsigned i = 0; i < 32; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, in + i, 8);
+        high |= word;
+    }
+    if ((high & 0x8080808080808080ull) != 0) return false;
+    for (unsigned i = 0; i < 32; ++i) out[i] = flip_ascii(in[i], lo);
+    return true;
+}
+
+#ifdef KSTRING_CASE_X86
+// b - lo <= 25 (无符号) 的字节翻转 0x20
+__attribute__((target("sse2"))) inline __m128i flip_sse2(__m128i v, __m128i base) {
+    __m128i d = _mm_sub_epi8(v, base);
+    __m128i in_range = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(25)), d);
+    return _mm_xor_si128(v, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+}
+
+__attribute__((target("sse2"))) bool ascii_block_sse2(const Byte* in, Byte* out, Byte lo) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+    if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0) return false;
+    const __m128i base = _mm_set1_epi8(static_cast<char>(lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), flip_sse2(a, base));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), flip_sse2(b, base));
+    return true;
+}
+
+__attribute__((target("avx2"))) bool ascii_block_avx2(const Byte* in, Byte* out, Byte lo) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    if (_mm256_movemask_epi8(v) != 0) return false;
+    __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8(static_cast<char>(lo)));
+    __m256i in_range = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(25)), d);
+    __m256i mask = _mm256_and_si256(in_range, _mm256_set1_epi8(0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_xor_si256(v, mask));
+    return true;
+}
+#endif
+
+struct Backend {
+    const char* name;
+    AsciiBlockFn ascii_block;
+};
+
+Backend select_backend() {
+#ifdef KSTRING_CASE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Backend{"avx2", ascii_block_avx2};
+    if (__builtin_cpu_supports("sse2")) return Backend{"sse2", ascii_block_sse2};
+#endif
+    return Backend{"scalar", ascii_block_scalar};
+}
+
+const Backend& backend() {
+    static const Backend selected = select_backend();
+    return selected;
+}
+
+// Final_Sigma: 前面 (跳过 Case_Ignorable) 是 Cased 字符, 后面 (同样跳过) 不是 Cased 字符
+bool is_final_sigma(ByteSpan text, std::size_t start, std::size_t next) {
+    bool cased_before = false;
+    for (std::size_t p = start; p > 0;) {
+        auto dec = utf8::decode_one_prev(text, p);
+        if (! dec.ok) break;
+        if (! is_case_ignorable(dec.codepoint)) {
+            cased_before = is_cased(dec.codepoint);
+            break;
+        }
+        p = dec.next_pos;
+    }
+    if (! cased_before) return false;
+    for (std::size_t p = next; p < text.size();) {
+        auto dec = utf8::decode_one(text, p);
+        if (! dec.ok) return true;
+        if (! is_case_ignorable(dec.codepoint)) return ! is_cased(dec.codepoint);
+        p = dec.next_pos;
+    }
+    return true;
+}
+
+void append_cased(ByteSpan text, ByteVec& out, bool upper) {
+    enum : std::size_t {
+        MAX_EXPANSION = 12 // 一个字符最多映射为 3 个码点, 每个最多 4 字节
+    };
+    const Byte lo = upper ? 'a' : 'A';
+    const AsciiBlockFn ascii_block = backend().ascii_block;
+    const std::size_t n = text.size();
+    std::size_t w = out.size();
+    // ASCII 一对一; 始终保证 out 在 w 之后至少还有 n - pos 字节
+    out.resize(w + n);
+    std::size_t pos = 0;
+    while (pos < n) {
+        if (pos + 32 <= n && ascii_block(text.data() + pos, out.data() + w, lo)) {
+            pos += 32;
+            w += 32;
+            continue;
+        }
+        // 块内有非 ASCII 字节, 逐字符处理到块尾
+        std::size_t stop = pos + 32 < n ? pos + 32 : n;
+        while (pos < stop) {
+            if (text[pos] < 0x80) {
+                out[w++] = flip_ascii(text[pos++], lo);
+                continue;
+            }
+            CodePoint cp = 0;
+            std::size_t len = utf8::try_decode(text.data() + pos, n - pos, cp);
+            if (len == 0) {
+                auto dec = utf8::decode_one(text, pos);
+                len = dec.next_pos - pos;
+                cp = dec.codepoint;
+                if (! dec.ok) {
+                    std::memcpy(out.data() + w, text.data() + pos, len);
+                    w += len;
+                    pos += len;
+                    continue;
+                }
+            }
+            const tables::CaseRecord& r = case_record(cp);
+            if (&r == tables::CASE_RECORDS) {
+                // 没有大小写映射 (如汉字), 原样复制
+                std::memcpy(out.data() + w, text.data() + pos, len);
+                w += len;
+                pos += len;
+                continue;
+            }
+            std::size_t need = w + MAX_EXPANSION + (n - pos - len);
+            if (out.size() < need) out.resize(need + out.size() / 2);
+            CaseMapping m = upper ? make_mapping(cp, r.upper, r.full_upper) : make_mapping(cp, r.lower, r.full_lower);
+            if (! upper && cp == CAPITAL_SIGMA && is_final_sigma(text, pos, pos + len)) m.chars[0] = FINAL_SIGMA;
+            for (CodePoint mapped : m) w += utf8::encode_to(out.data() + w, mapped);
+            pos += len;
+        }
+    }
+    out.resize(w);
+}
+} // namespace
+
+CaseMapping full_uppercase(CodePoint cp) {
+    const tables::CaseRecord& r = case_record(cp);
+    return make_mapping(cp, r.upper, r.full_upper);
+}
+
+CaseMapping full_lowercase(CodePoint cp) {
+    const tables::CaseRecord& r = case_record(cp);
+    return make_mapping(cp, r.lower, r.full_lower);
+}
+
+CaseMapping full_titlecase(CodePoint cp) {
+    const tables::CaseRecord& r = case_record(cp);
+    return make_mapping(cp, r.title, r.full_title);
+}
+
+void append_lowercase(ByteSpan text, ByteVec& out) {
+    append_cased(text, out, false);
+}
+
+void append_uppercase(ByteSpan text, ByteVec& out) {
+    append_cased(text, out, true);
+}
+
+const char* case_simd_backend() {
+    return backend().name;
+}
+} // namespace unicode
+} // namespace kstring
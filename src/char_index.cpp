@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "char_index.hpp"
+#include "utf8.hpp"
+
+namespace kstring {
+namespace {
+// 合法 UTF-8 中, 每个非 continuation 字节 (非 10xxxxxx) 恰好对应一个字符
+// SWAR: 一次处理 8 字节, 统计其中的字符起始字节数
+inline std::size_t count_char_starts8(const Byte* p) {
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    // bit7 = 1 且 bit6 = 0 即 continuation 字节
+    uint64_t cont = w & ~(w << 1) & 0x8080808080808080ull;
+    return 8 - static_cast<std::size_t>(__builtin_popcountll(cont));
+}
+
+inline bool is_char_start(Byte b) {
+    return (b & 0xC0) != 0x80;
+}
+
+// 合法 UTF-8 快速建索引: 无需解码, 只数字符起始字节
+void build_valid_samples(ByteSpan data, std::size_t stride, std::vector<std::size_t>& samples, std::size_t& chars) {
+    const std::size_t size = data.size();
+    const Byte* p = data.data();
+    std::size_t pos = 0;
+    std::size_t count = 0;
+    std::size_t next_sample = 0; // 下一个需要记录的字符序号
+
+    while (pos < size) {
+        if (count + 8 <= next_sample && pos + 8 <= size) {
+            // 这 8 字节内不可能越过采样点, 整块跳过
+            count += count_char_starts8(p + pos);
+            pos += 8;
+            continue;
+        }
+
+        if (is_char_start(p[pos])) {
+            if (count == next_sample) {
+                samples.push_back(pos);
+                next_sample += stride;
+            }
+            ++count;
+        }
+        ++pos;
+    }
+    chars = count;
+}
+
+// 含非法字节时按 decode_one 的切分语义逐字符前进
+void build_generic_samples(ByteSpan data, std::size_t stride, std::vector<std::size_t>& samples, std::size_t& chars) {
+    std::size_t pos = 0;
+    std::size_t count = 0;
+    while (pos < data.size()) {
+        if (count % stride == 0) samples.push_back(pos);
+        pos = data[pos] < 0x80 ? pos + 1 : utf8::decode_one(data, pos).next_pos;
+        ++count;
+    }
+    chars = count;
+}
+} // namespace
+
+CharOffsetIndex::CharOffsetIndex()
+    : data_(), stride_(DEFAULT_STRIDE), char_size_(0), ascii_(true), samples_() {}
+
+CharOffsetIndex::CharOffsetIndex(ByteSpan data, std::size_t stride)
+    : data_(data), stride_(stride), char_size_(0), ascii_(false), samples_() {
+    if (stride_ == 0) throw std::invalid_argument("CharOffsetIndex: stride must be positive");
+
+    ascii_ = utf8::is_all_ascii(data_);
+    if (ascii_) {
+        char_size_ = data_.size();
+        return;
+    }
+
+    samples_.reserve(data_.size() / stride_ + 1);
+    if (utf8::is_valid(data_)) {
+        build_valid_samples(data_, stride_, samples_, char_size_);
+    } else {
+        build_generic_samples(data_, stride_, samples_, char_size_);
+    }
+}
+
+std::size_t CharOffsetIndex::byte_offset(std::size_t char_idx) const {
+    if (char_idx > char_size_) return knpos;
+    if (ascii_) return char_idx;
+    if (char_idx == char_size_) return data_.size();
+
+    std::size_t k = char_idx / stride_;
+    return utf8::advance_chars(data_, samples_[k], char_idx - k * stride_);
+}
+
+std::size_t CharOffsetIndex::char_index(std::size_t byte_offset) const {
+    if (byte_offset > data_.size()) {
+        throw std::out_of_range("CharOffsetIndex::char_index byte_offset exceeds data size");
+    }
+    if (ascii_) return byte_offset;
+    if (byte_offset == data_.size()) return char_size_;
+
+    // 最后一个不超过 byte_offset 的采样点
+    auto it = std::upper_bound(samples_.begin(), samples_.end(), byte_offset);
+    std::size_t k = static_cast<std::size_t>(it - samples_.begin()) - 1;
+    std::size_t base = samples_[k];
+    return k * stride_ + utf8::char_count(data_.subspan(base, byte_offset - base));
+}
+
+void CharOffsetIndex::rebind(ByteSpan data) {
+    data_ = data;
+}
+} // namespace kstring
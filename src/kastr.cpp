@@ -1,28 +1,24 @@
 #include "../include/kastr.hpp"
+#include "../include/kastring.hpp"
+#include "../include/ksearcher.hpp"
+#include "../include/search.hpp"
 #include <stdexcept>
 
 namespace kstring {
 std::size_t KAStr::find(KAStr substr) const {
-    if (substr.byte_size() == 0) return 0;
-    if (substr.byte_size() > byte_size()) return kstring::knpos;
-
-#if defined(__GLIBC__) || defined(__linux__)
-    const void* where = ::memmem(begin(), byte_size(), substr.begin(), substr.byte_size());
-    if (where) return static_cast<const Byte*>(where) - data_.begin();
-#else
-    auto* it = std::search(begin(), end(), substr.begin(), substr.end(), [](Byte a, Byte b) { return a == b; });
-    if (it != data_.end()) return it - data_.begin();
-#endif
-    return kstring::knpos;
+    return search::find(data_, substr.data_);
 }
 
 std::size_t KAStr::rfind(KAStr substr) const {
-    if (substr.byte_size() > byte_size()) return kstring::knpos;
-    for (std::size_t i = byte_size() - substr.byte_size() + 1; i-- > 0;) {
-        // 朴素遍历
-        if (std::memcmp(data_.begin() + i, substr.begin(), substr.byte_size()) == 0) return i;
-    }
-    return kstring::knpos;
+    return search::rfind(data_, substr.data_);
+}
+
+std::size_t KAStr::find(const KASearcher& searcher) const {
+    return searcher.engine().find(data_);
+}
+
+std::size_t KAStr::rfind(const KASearcher& searcher) const {
+    return searcher.engine().rfind(data_);
 }
 
 bool KAStr::contains(KAStr substr) const {
@@ -39,6 +35,29 @@ bool KAStr::ends_with(KAStr suffix) const {
     return std::memcmp(data_.end() - suffix.byte_size(), suffix.begin(), suffix.byte_size()) == 0;
 }
 
+bool KAStr::eq_ignore_ascii_case(KAStr other) const {
+    return search::equal_ignore_ascii_case(data_, other.data_);
+}
+
+std::size_t KAStr::find_ignore_ascii_case(KAStr substr) const {
+    return search::find_ignore_ascii_case(data_, substr.data_);
+}
+
+bool KAStr::starts_with_ignore_ascii_case(KAStr prefix) const {
+    if (prefix.byte_size() > byte_size()) return false;
+    return search::equal_ignore_ascii_case(ByteSpan(data_.begin(), prefix.byte_size()), prefix.data_);
+}
+
+bool KAStr::ends_with_ignore_ascii_case(KAStr suffix) const {
+    if (suffix.byte_size() > byte_size()) return false;
+    return search::equal_ignore_ascii_case(ByteSpan(data_.end() - suffix.byte_size(), suffix.byte_size()),
+                                           suffix.data_);
+}
+
+std::size_t KAStr::hash_ignore_ascii_case() const {
+    return search::hash_ignore_ascii_case(data_);
+}
+
 KAStr KAStr::substr(std::size_t start, std::size_t count) const {
     if (start > byte_size()) return KAStr();
     count = std::min(count, byte_size() - start);
@@ -76,64 +95,22 @@ std::pair<KAStr, KAStr> KAStr::split_exclusive_at(std::size_t mid) const {
 }
 
 std::vector<KAStr> KAStr::split_count(KAStr delim, std::size_t max_splits) const {
-    std::vector<KAStr> result;
-    std::size_t pos = 0, splits = 0;
+    if (! delim.empty()) return split_bulk<KAStr>(data_, delim.data_, max_splits);
+    SplitRange range = split_iter(delim, max_splits);
+    return std::vector<KAStr>(range.begin(), range.end());
+}
 
+std::size_t KAStr::split_offsets(KAStr delim, std::size_t* out, std::size_t cap, std::size_t from) const {
     if (delim.empty()) {
-        std::size_t len = this->byte_size();
-        splits = std::min(len, max_splits);
-
-        for (std::size_t i = 0; i < splits; ++i) result.emplace_back(this->begin() + i, 1);
-
-        if (splits < len) result.emplace_back(this->begin() + splits, len - splits);
-        return result;
-    }
-
-    while (splits < max_splits) {
-        std::size_t found = this->subrange(pos, byte_size()).find(delim);
-        if (found == kstring::knpos) break;
-
-        result.emplace_back(data_.begin() + pos, found);
-        pos += found + delim.byte_size();
-        ++splits;
+        throw std::invalid_argument("KAStr::split_offsets(KAStr) with empty delimiter is not allowed");
     }
-
-    if (pos <= byte_size()) result.emplace_back(data_.begin() + pos, byte_size() - pos);
-    return result;
+    return search::find_many(data_, delim.data_, from, out, cap);
 }
 
+// 空分隔符时每个字节作为独立分段, 从右向左给出, 剩余前缀作为最后一段
 std::vector<KAStr> KAStr::rsplit_count(KAStr delim, std::size_t max_splits) const {
-    std::vector<KAStr> result;
-    std::size_t end = byte_size();
-    std::size_t splits = 0;
-
-    if (delim.empty()) {
-        std::size_t len = this->byte_size();
-        splits = std::min(len, max_splits);
-        std::size_t remain = len - splits;
-
-        // 每个字符作为独立分段
-        for (std::size_t i = len; i-- > remain;) {
-            result.emplace_back(this->begin() + i, 1);
-        }
-        // 保留前缀部分为剩余段
-        if (remain > 0) result.emplace_back(this->begin(), remain);
-
-        return result;
-    }
-
-    while (splits < max_splits) {
-        std::size_t found = this->subrange(0, end).rfind(delim);
-        if (found == kstring::knpos) break;
-
-        std::size_t after = found + delim.byte_size();
-        result.emplace_back(data_.begin() + after, end - after);
-        end = found;
-        ++splits;
-    }
-
-    result.emplace_back(data_.data(), end);
-    return result;
+    SplitRange range = rsplit_iter(delim, max_splits);
+    return std::vector<KAStr>(range.begin(), range.end());
 }
 
 std::vector<KAStr> KAStr::split(KAStr delim) const {
@@ -145,55 +122,31 @@ std::vector<KAStr> KAStr::rsplit(KAStr delim) const {
 }
 
 std::pair<KAStr, KAStr> KAStr::split_once(KAStr delim) const {
-    auto vec = split_count(delim, 1);
-    if (vec.size() == 1) return {vec[0], KAStr()};
-    return {vec[0], vec[1]};
+    SplitRange range = split_iter(delim, 1);
+    auto it = range.begin();
+    if (it == range.end()) return {KAStr(), KAStr()};
+    KAStr first = *it;
+    ++it;
+    return {first, it == range.end() ? KAStr() : *it};
 }
 
 std::pair<KAStr, KAStr> KAStr::rsplit_once(KAStr delim) const {
-    auto vec = rsplit_count(delim, 1);
-    if (vec.size() == 1) return {vec[0], KAStr()};
-    return {vec[0], vec[1]};
+    SplitRange range = rsplit_iter(delim, 1);
+    auto it = range.begin();
+    if (it == range.end()) return {KAStr(), KAStr()};
+    KAStr last = *it;
+    ++it;
+    return {last, it == range.end() ? KAStr() : *it};
 }
 
 std::vector<KAStr> KAStr::split_whitespace() const {
-    std::vector<KAStr> result;
-    std::size_t start = 0;
-    while (start < byte_size()) {
-        while (start < byte_size() && isspace(data_[start])) ++start;
-        std::size_t end = start;
-        while (end < byte_size() && ! isspace(data_[end])) ++end;
-        if (start < end) result.emplace_back(data_.begin() + start, end - start);
-        start = end;
-    }
-    return result;
+    WhitespaceRange range = split_whitespace_iter();
+    return std::vector<KAStr>(range.begin(), range.end());
 }
 
 std::vector<KAStr> KAStr::lines() const {
-    std::vector<KAStr> result;
-    std::size_t start = 0;
-
-    for (std::size_t i = 0; i < byte_size(); ++i) {
-        if (data_[i] == '\n') {
-            result.emplace_back(data_.begin() + start, i - start);
-            start = i + 1;
-        } else if (data_[i] == '\r') {
-            std::size_t len = i - start;
-            if (i + 1 < byte_size() && data_[i + 1] == '\n') {
-                result.emplace_back(data_.begin() + start, len);
-                start = i + 2;
-                ++i; // skip \n
-            } else {
-                result.emplace_back(data_.begin() + start, len);
-                start = i + 1;
-            }
-        }
-    }
-
-    if (start < byte_size()) {
-        result.emplace_back(data_.begin() + start, byte_size() - start);
-    }
-    return result;
+    LineRange range = lines_iter();
+    return std::vector<KAStr>(range.begin(), range.end());
 }
 
 KAStr KAStr::strip_prefix(KAStr prefix) const {
@@ -222,6 +175,27 @@ KAStr KAStr::trim() const {
     return trim_start().trim_end();
 }
 
+KAString KAStr::replace(KAStr from, KAStr to) const {
+    return replacen(from, to, knpos);
+}
+
+KAString KAStr::replacen(KAStr from, KAStr to, std::size_t count) const {
+    ByteVec out;
+    if (! from.empty()) {
+        search::replace(data_, from.data_, to.data_, out, count);
+        return KAString(std::move(out));
+    }
+    // 空模式: 每个字节之前插入一次, 最后一次在末尾
+    std::size_t pos = 0;
+    for (std::size_t inserted = 0; inserted < count; ++inserted) {
+        out.insert(out.end(), to.begin(), to.end());
+        if (pos >= byte_size()) break;
+        out.push_back(data_[pos++]);
+    }
+    out.insert(out.end(), data_.begin() + pos, data_.end());
+    return KAString(std::move(out));
+}
+
 
 }; // namespace kstring
 
@@ -0,0 +1,141 @@
+#include "ksearcher.hpp"
+
+namespace kstring {
+KSearcher::KSearcher(KStr needle) : engine_(std::make_shared<search::Searcher>(needle.as_bytes())) {}
+
+std::size_t KSearcher::find(KStr hay) const {
+    return hay.find(*this);
+}
+
+std::size_t KSearcher::rfind(KStr hay) const {
+    return hay.rfind(*this);
+}
+
+CharIndex KSearcher::find_index(KStr hay) const {
+    return hay.find_index(*this);
+}
+
+CharIndex KSearcher::rfind_index(KStr hay) const {
+    return hay.rfind_index(*this);
+}
+
+std::size_t KSearcher::find_in_bytes(KStr hay) const {
+    return engine_->find(hay.as_bytes());
+}
+
+std::size_t KSearcher::rfind_in_bytes(KStr hay) const {
+    return engine_->rfind(hay.as_bytes());
+}
+
+bool KSearcher::contains(KStr hay) const {
+    return engine_->find(hay.as_bytes()) != knpos;
+}
+
+FindRange KSearcher::find_all(KStr hay) const {
+    return FindRange(hay.as_bytes(), engine_);
+}
+
+std::size_t KSearcher::count(KStr hay) const {
+    if (engine_->needle().empty()) return hay.char_size() + 1;
+    return engine_->count(hay.as_bytes());
+}
+
+KASearcher::KASearcher(KAStr needle)
+    : engine_(std::make_shared<search::Searcher>(ByteSpan(needle.data(), needle.byte_size()))) {}
+
+std::size_t KASearcher::find(KAStr hay) const {
+    return hay.find(*this);
+}
+
+std::size_t KASearcher::rfind(KAStr hay) const {
+    return hay.rfind(*this);
+}
+
+bool KASearcher::contains(KAStr hay) const {
+    return find(hay) != knpos;
+}
+
+std::vector<std::size_t> KASearcher::find_all(KAStr hay) const {
+    std::vector<std::size_t> out;
+    ByteSpan bytes(hay.data(), hay.byte_size());
+    const std::size_t m = engine_->needle().size();
+    std::size_t pos = 0;
+    while (pos <= bytes.size()) {
+        std::size_t found = engine_->find(bytes.subspan(pos));
+        if (found == knpos) break;
+        out.push_back(pos + found);
+        // 空模式逐字节前进
+        pos += found + (m == 0 ? 1 : m);
+    }
+    return out;
+}
+
+std::size_t KASearcher::count(KAStr hay) const {
+    return engine_->count(ByteSpan(hay.data(), hay.byte_size()));
+}
+namespace {
+std::vector<ByteSpan> pattern_bytes(const std::vector<KStr>& patterns) {
+    std::vector<ByteSpan> out;
+    out.reserve(patterns.size());
+    for (const auto& p : patterns) out.push_back(p.as_bytes());
+    return out;
+}
+
+std::vector<ByteSpan> pattern_bytes(const std::vector<KAStr>& patterns) {
+    std::vector<ByteSpan> out;
+    out.reserve(patterns.size());
+    for (const auto& p : patterns) out.push_back(ByteSpan(p.data(), p.byte_size()));
+    return out;
+}
+} // namespace
+
+KMultiSearcher::KMultiSearcher(const std::vector<KStr>& patterns, MatchKind kind)
+    : engine_(std::make_shared<search::AhoCorasick>(pattern_bytes(patterns), kind)) {}
+
+KMatch KMultiSearcher::find(KStr hay) const {
+    ByteSpan bytes = hay.as_bytes();
+    search::MultiMatch m = engine_->find(bytes);
+    if (! m.found()) return KMatch();
+    std::size_t pos = 0;
+    std::size_t char_idx = utf8::count_chars_to(bytes, pos, m.start);
+    return KMatch(m.pattern, m.start, char_idx, KStr(bytes.subspan(m.start, m.end - m.start)));
+}
+
+std::vector<KMatch> KMultiSearcher::find_all(KStr hay) const {
+    std::vector<KMatch> out;
+    ByteSpan bytes = hay.as_bytes();
+    std::size_t counted_pos = 0; // 已统计到的字符边界
+    std::size_t counted_chars = 0;
+    std::size_t pos = 0;
+    while (pos <= bytes.size()) {
+        search::MultiMatch m = engine_->find(bytes, pos);
+        if (! m.found()) break;
+        counted_chars += utf8::count_chars_to(bytes, counted_pos, m.start);
+        out.emplace_back(m.pattern, m.start, counted_chars, KStr(bytes.subspan(m.start, m.end - m.start)));
+        if (m.end > m.start) {
+            pos = m.end;
+        } else {
+            // 空匹配跳过一个字符, 到达末尾后结束
+            pos = m.end < bytes.size() ? utf8::decode_one(bytes, m.end).next_pos : m.end + 1;
+        }
+    }
+    return out;
+}
+
+KAMultiSearcher::KAMultiSearcher(const std::vector<KAStr>& patterns, MatchKind kind)
+    : engine_(std::make_shared<search::AhoCorasick>(pattern_bytes(patterns), kind)) {}
+
+KAMatch KAMultiSearcher::find(KAStr hay) const {
+    search::MultiMatch m = engine_->find(ByteSpan(hay.data(), hay.byte_size()));
+    if (! m.found()) return KAMatch();
+    return KAMatch(m.pattern, m.start, KAStr(hay.data() + m.start, m.end - m.start));
+}
+
+std::vector<KAMatch> KAMultiSearcher::find_all(KAStr hay) const {
+    std::vector<KAMatch> out;
+    for (const auto& m : engine_->find_all(ByteSpan(hay.data(), hay.byte_size()))) {
+        out.emplace_back(m.pattern, m.start, KAStr(hay.data() + m.start, m.end - m.start));
+    }
+    return out;
+}
+} // namespace kstring
@@ -1,36 +1,51 @@
 #include "base.hpp"
+#include "case_mapping.hpp"
+#include "ksearcher.hpp"
 #include "kstr.hpp"
+#include "kstring.hpp"
+#include "search.hpp"
 #include "utf8.hpp"
-
-#if __cplusplus >= 201703L
-#include <functional> // for std::boyer_moore_searcher
-#define HAS_STD_BOYER_MOORE 1
-#else
-#define HAS_STD_BOYER_MOORE 0
-#endif
-
-#if defined(__GLIBC__) && ! defined(__APPLE__)
-#define HAS_MEMMEM 1
-#else
-#define HAS_MEMMEM 0
-#endif
+#include "whitespace.hpp"
 
 namespace kstring {
-KStr::KStr() : data_() {}
+KStr::KStr() : data_(), index_(nullptr) {}
 
 // 该函数假设 cstr 是以 null 结尾的有效 UTF-8 字符串
-KStr::KStr(const char* cstr) : data_(reinterpret_cast<const uint8_t*>(cstr), std::strlen(cstr)) {}
+KStr::KStr(const char* cstr) : data_(reinterpret_cast<const uint8_t*>(cstr), std::strlen(cstr)), index_(nullptr) {}
 
 // 非 null-terminated 字符串切片支持, 但UTF-8 合法性不保证，仅视为字节串
-KStr::KStr(const char* ptr, std::size_t len) : data_(reinterpret_cast<const uint8_t*>(ptr), len) {}
+KStr::KStr(const char* ptr, std::size_t len) : data_(reinterpret_cast<const uint8_t*>(ptr), len), index_(nullptr) {}
 
 // 面向底层操作场景，如 mmap buffer
-KStr::KStr(const uint8_t* ptr, std::size_t len) : data_(ptr, len) {}
+KStr::KStr(const uint8_t* ptr, std::size_t len) : data_(ptr, len), index_(nullptr) {}
 
 // initializer_list 不拥有所有权
 // KStr(std::initializer_list<utf8::Byte>) {    }
 
-KStr::KStr(ByteSpan bytes) : data_(bytes) {}
+KStr::KStr(ByteSpan bytes) : data_(bytes), index_(nullptr) {}
+
+KStr KStr::with_index(const CharOffsetIndex& index) const {
+    ByteSpan src = index.source();
+    if (src.data() != data_.data() || src.size() != data_.size()) {
+        throw std::invalid_argument("KStr::with_index index was built for different bytes");
+    }
+    KStr result(data_);
+    result.index_ = &index;
+    return result;
+}
+
+CharOffsetIndex KStr::build_index(std::size_t stride) const {
+    return CharOffsetIndex(data_, stride);
+}
+
+const CharOffsetIndex* KStr::index() const {
+    return index_;
+}
+
+std::size_t KStr::locate_char(std::size_t idx) const {
+    if (index_ != nullptr) return index_->byte_offset(idx);
+    return utf8::advance_chars(data_, 0, idx);
+}
 
 bool operator==(const KStr& lhs, const KStr& rhs) {
     if (lhs.data_.size() != rhs.data_.size()) return false;
@@ -101,6 +116,7 @@ ByteSpan KStr::as_bytes() const {
 
 // 返回字符数（非字节数）
 std::size_t KStr::char_size() const {
+    if (index_ != nullptr) return index_->char_size();
     return utf8::char_count(data_);
 }
 
@@ -117,40 +133,51 @@ ReverseCharRange KStr::iter_chars_rev() const {
     return ReverseCharRange(data_);
 }
 
+ChunkedCharRange KStr::iter_chars_chunked() const {
+    return ChunkedCharRange(data_);
+}
+
+KStr::GraphemeRange KStr::iter_graphemes() const {
+    return GraphemeRange(data_);
+}
+
+KStr::GraphemeRange KStr::iter_graphemes_rev() const {
+    return GraphemeRange(data_, true);
+}
+
+std::size_t KStr::grapheme_count() const {
+    return unicode::grapheme_count(data_);
+}
+
+KStr::WordBoundRange KStr::iter_word_bounds() const {
+    return WordBoundRange(data_);
+}
+
+KStr::WordRange KStr::iter_words() const {
+    return WordRange(data_);
+}
+
+KStr::SentenceRange KStr::iter_sentences() const {
+    return SentenceRange(data_);
+}
+
 // 获取第 idx 个字符（按字符下标），返回为子串字节
 ByteSpan KStr::operator[](std::size_t idx) const {
-    std::size_t pos = 0, i = 0;
-    while (pos < data_.size()) {
-        utf8::UTF8Decoded dec = utf8::decode_one(data_, pos);
-        if (i == idx) {
-            return ByteSpan(&data_[pos], dec.next_pos - pos);
-        }
-        pos = dec.next_pos;
-        ++i;
+    std::size_t pos = locate_char(idx);
+    if (pos == knpos || pos == data_.size()) {
+        throw std::out_of_range("KStr::operator[] index exceeds character count");
     }
-
-    throw std::out_of_range("KStr::operator[] index exceeds character count");
+    utf8::UTF8Decoded dec = utf8::decode_one(data_, pos);
+    return ByteSpan(&data_[pos], dec.next_pos - pos);
 }
 
 KChar KStr::char_at(std::size_t idx) const {
-    std::size_t pos = 0, i = 0;
-    while (pos < data_.size()) {
-        auto dec = utf8::decode_one(data_, pos);
-        if (! dec.ok) {
-            if (i == idx) {
-                return KChar(kstring::ILL_CODEPOINT); // 视作独立非法字节
-            }
-            ++i;
-            ++pos;
-        } else {
-            if (i == idx) {
-                return KChar(dec.codepoint);
-            }
-            ++i;
-            pos = dec.next_pos;
-        }
+    std::size_t pos = locate_char(idx);
+    if (pos == knpos || pos == data_.size()) {
+        throw std::out_of_range("KStr::char_at index out of bounds");
     }
-    throw std::out_of_range("KStr::char_at index out of bounds");
+    auto dec = utf8::decode_one(data_, pos);
+    return dec.ok ? KChar(dec.codepoint) : KChar(kstring::ILL_CODEPOINT); // 非法序列视作独立字符
 }
 
 uint8_t KStr::byte_at(std::size_t idx) const {
@@ -164,7 +191,7 @@ uint8_t KStr::byte_at(std::size_t idx) const {
      * @brief 统计给定 byte offset 之前有多少个字符
      * 字符下标表示从开头到该字节偏移前，共有多少个字符。
      * 
-     * @warning 本函数是 O(N) 的，因为必须线性遍历每个 UTF-8 字符。
+     * @warning 本函数是 O(N) 的，因为必须线性遍历每个 UTF-8 字符; 挂载 CharOffsetIndex 后为 O(stride)。
      * @param byte_offset 字节偏移（必须小于等于总字节长度）
      * @return std::size_t 从起始位置到该偏移之间的字符数量（即字符下标）
      * @example：
@@ -182,58 +209,26 @@ std::size_t KStr::count_chars_before(std::size_t byte_offset) const {
         throw std::out_of_range("byte_offset exceeds data size");
     }
 
-    return KStr(ByteSpan(data_.data(), byte_offset)).char_size();
+    if (index_ != nullptr) return index_->char_index(byte_offset);
+    return utf8::char_count(ByteSpan(data_.data(), byte_offset));
 }
 
 std::size_t KStr::char_index_to_byte_offset(std::size_t idx) const {
-    std::size_t pos = 0, i = 0;
-    while (pos < data_.size()) {
-        if (i == idx) return pos;
-        auto dec = utf8::decode_one(data_, pos);
-        pos = dec.next_pos;
-        ++i;
+    std::size_t pos = locate_char(idx);
+    if (pos == knpos || pos == data_.size()) {
+        throw std::out_of_range("KStr::char index exceeds character count");
     }
-    throw std::out_of_range("KStr::char index exceeds character count");
+    return pos;
 }
 
 // 字节级别的比较, 不涉及字符编解码
 static std::size_t find_in_bytes(ByteSpan hay, ByteSpan pat) {
-    if (pat.empty()) return 0;
-    if (pat.size() > hay.size()) return knpos;
-
-    // search successfully
-    {
-#if HAS_STD_BOYER_MOORE
-        std::boyer_moore_searcher bm(pat.begin(), pat.end());
-        auto it = bm(hay.begin(), hay.end());
-        if (it.first != hay.end()) return std::distance(hay.begin(), it.first);
-#elif HAS_MEMMEM
-        const void* where = memmem(hay.data(), hay.size(), pat.data(), pat.size());
-        if (where) {
-            auto offset = static_cast<const utf8::Byte*>(where) - hay.data();
-            return static_cast<std::size_t>(offset);
-        }
-#else
-        // fall back to std::search(), too slow !!!
-        auto it = std::search(hay.begin(), hay.end(), pat.begin(), pat.end());
-        if (it != hay.end()) return std::distance(hay.begin(), it);
-#endif
-    }
-
-    // not found
-    return knpos;
+    return search::find(hay, pat);
 }
 
 // 字节级别的比较, 不涉及字符编解码
-// 朴素逆序匹配, BM 算法难以处理逆序
 static std::size_t rfind_in_bytes(ByteSpan hay, ByteSpan pat) {
-    if (pat.empty()) return hay.size(); // 表示末尾插入位置
-    if (pat.size() > hay.size()) return knpos;
-
-    for (std::size_t i = hay.size() - pat.size() + 1; i-- > 0;) {
-        if (std::memcmp(hay.data() + i, pat.data(), pat.size()) == 0) return i;
-    }
-    return knpos;
+    return search::rfind(hay, pat);
 }
 
 std::size_t KStr::find_in_bytes(KStr substr) const {
@@ -246,13 +241,97 @@ std::size_t KStr::rfind_in_bytes(KStr substr) const {
 
 // 查找字符位置（按字符下标），找不到返回 npos
 std::size_t KStr::find(KStr substr) const {
-    auto offset = ::kstring::find_in_bytes(this->as_bytes(), substr.as_bytes());
-    return (offset != knpos) ? count_chars_before(offset) : knpos;
+    return find_index(substr).char_index;
 }
 
 std::size_t KStr::rfind(KStr substr) const {
+    return rfind_index(substr).char_index;
+}
+
+// byte_offset 处的字符, 位于末尾或非法序列时为空字符
+static KChar char_at_byte(ByteSpan data, std::size_t byte_offset) {
+    if (byte_offset >= data.size()) return KChar();
+    auto dec = utf8::decode_one(data, byte_offset);
+    return dec.ok ? KChar(dec.codepoint) : KChar();
+}
+
+CharIndex KStr::find_index(KStr substr) const {
+    auto offset = ::kstring::find_in_bytes(this->as_bytes(), substr.as_bytes());
+    if (offset == knpos) return CharIndex(KChar(), knpos, knpos);
+    return CharIndex(char_at_byte(data_, offset), offset, count_chars_before(offset));
+}
+
+CharIndex KStr::rfind_index(KStr substr) const {
     auto offset = ::kstring::rfind_in_bytes(this->as_bytes(), substr.as_bytes());
-    return (offset != knpos) ? count_chars_before(offset) : knpos;
+    if (offset == knpos) return CharIndex(KChar(), knpos, knpos);
+    return CharIndex(char_at_byte(data_, offset), offset, count_chars_before(offset));
+}
+
+std::size_t KStr::find(const KSearcher& searcher) const {
+    return find_index(searcher).char_index;
+}
+
+std::size_t KStr::rfind(const KSearcher& searcher) const {
+    return rfind_index(searcher).char_index;
+}
+
+CharIndex KStr::find_index(const KSearcher& searcher) const {
+    auto offset = searcher.engine().find(data_);
+    if (offset == knpos) return CharIndex(KChar(), knpos, knpos);
+    return CharIndex(char_at_byte(data_, offset), offset, count_chars_before(offset));
+}
+
+CharIndex KStr::rfind_index(const KSearcher& searcher) const {
+    auto offset = searcher.engine().rfind(data_);
+    if (offset == knpos) return CharIndex(KChar(), knpos, knpos);
+    return CharIndex(char_at_byte(data_, offset), offset, count_chars_before(offset));
+}
+
+FindRange KStr::find_all(KStr substr) const {
+    // 整个枚举过程只编译一次模式
+    return FindRange(data_, std::make_shared<search::Searcher>(substr.as_bytes()));
+}
+
+FindIterator::FindIterator()
+    : hay_(), searcher_(), search_pos_(0), counted_pos_(0), counted_chars_(0), current_(), done_(true) {}
+
+FindIterator::FindIterator(ByteSpan hay, std::shared_ptr<const search::Searcher> searcher)
+    : hay_(hay), searcher_(std::move(searcher)), search_pos_(0), counted_pos_(0), counted_chars_(0), current_(),
+      done_(false) {
+    advance();
+}
+
+void FindIterator::advance() {
+    if (done_) return;
+    if (search_pos_ > hay_.size()) {
+        done_ = true;
+        return;
+    }
+
+    const std::size_t pat_size = searcher_->needle().size();
+    std::size_t offset = search_pos_;
+    if (pat_size != 0) {
+        offset = searcher_->find(hay_.subspan(search_pos_));
+        if (offset == knpos) {
+            done_ = true;
+            return;
+        }
+        offset += search_pos_;
+    }
+
+    // 只统计上一个匹配到本次匹配之间的字符
+    counted_chars_ += utf8::count_chars_to(hay_, counted_pos_, offset);
+
+    current_ = CharIndex(char_at_byte(hay_, offset), offset, counted_chars_);
+
+    // 非重叠: 从匹配末尾继续; 空模式逐字符前进, 末尾位置匹配后结束
+    if (pat_size != 0) {
+        search_pos_ = offset + pat_size;
+    } else if (offset < hay_.size()) {
+        search_pos_ = utf8::decode_one(hay_, offset).next_pos;
+    } else {
+        search_pos_ = hay_.size() + 1;
+    }
 }
 
 bool KStr::contains(KStr substr) const {
@@ -272,31 +351,21 @@ bool KStr::ends_with(KStr suffix) const {
 }
 
 KStr KStr::substr(std::size_t start, std::size_t count) const {
-    std::size_t pos = 0, idx = 0;
-    std::size_t begin_byte = 0;
-    bool found_begin = false;
-
-    while (pos < data_.size()) {
-        if (idx == start) {
-            begin_byte = pos;
-            found_begin = true;
-        }
-
-        auto dec = utf8::decode_one(data_, pos);
-        pos = dec.next_pos;
-        ++idx;
-
-        if (idx == start + count) {
-            return KStr(ByteSpan(&data_[begin_byte], pos - begin_byte));
-        }
+    std::size_t begin_byte = locate_char(start);
+    if (begin_byte == knpos || begin_byte == data_.size()) {
+        throw std::out_of_range("KStr::substr start index out of bounds");
     }
 
-    if (! found_begin) {
-        throw std::out_of_range("KStr::substr start index out of bounds");
+    // 如果不够 count 个字符，取到末尾
+    std::size_t end_byte = knpos;
+    if (index_ != nullptr) {
+        end_byte = (count > index_->char_size() - start) ? data_.size() : index_->byte_offset(start + count);
+    } else {
+        end_byte = utf8::advance_chars(data_, begin_byte, count);
     }
+    if (end_byte == knpos) end_byte = data_.size();
 
-    // 如果走到这，说明没够 count 个字符，取到末尾
-    return KStr(ByteSpan(&data_[begin_byte], data_.size() - begin_byte));
+    return KStr(ByteSpan(&data_[begin_byte], end_byte - begin_byte));
 }
 
 // [start, end) 区间
@@ -305,32 +374,18 @@ KStr KStr::subrange(std::size_t start, std::size_t end) const {
         throw std::out_of_range("KStr::subrange invalid range: start > end");
     }
 
-    std::size_t pos = 0, idx = 0;
-    std::size_t begin_byte = 0, end_byte = 0;
-    bool found_begin = false, found_end = false;
-
-    while (pos < data_.size()) {
-        if (idx == start) {
-            begin_byte = pos;
-            found_begin = true;
-        }
-        if (idx == end) {
-            end_byte = pos;
-            found_end = true;
-            break;
-        }
-
-        auto dec = utf8::decode_one(data_, pos);
-        pos = dec.next_pos;
-        ++idx;
-    }
-
-    if (! found_begin) {
+    std::size_t begin_byte = locate_char(start);
+    if (begin_byte == knpos || begin_byte == data_.size()) {
         throw std::out_of_range("KStr::subrange start index out of bounds");
     }
-    if (! found_end) {
-        end_byte = data_.size(); // end 落在末尾之后
+
+    std::size_t end_byte = knpos;
+    if (index_ != nullptr) {
+        end_byte = index_->byte_offset(end);
+    } else {
+        end_byte = utf8::advance_chars(data_, begin_byte, end - start);
     }
+    if (end_byte == knpos) end_byte = data_.size(); // end 落在末尾之后
 
     return KStr(ByteSpan(&data_[begin_byte], end_byte - begin_byte));
 }
@@ -350,63 +405,49 @@ std::pair<KStr, KStr> KStr::split_exclusive_at(std::size_t mid) const {
     return {pair.first, KStr(ByteSpan(right_bytes.data() + skip_len, right_bytes.size() - skip_len))};
 }
 
-// 核心 split 函数, 最多分割 count 次
-std::vector<KStr> KStr::split_count(KStr delim, std::size_t max_splits) const {
+KStr::SplitRange KStr::split_iter(KStr delim, std::size_t max_splits) const {
     if (delim.empty()) {
-        throw std::invalid_argument("KStr::split_count(KStr) with empty delimiter is not allowed");
+        throw std::invalid_argument("KStr::split_iter(KStr) with empty delimiter is not allowed");
     }
+    return SplitRange(data_, SubstrDelimiter(delim.as_bytes()), max_splits);
+}
 
-    std::vector<KStr> result;
-    auto delim_bytes = delim.as_bytes();
-    std::size_t start = 0;
-    std::size_t pos = 0;
-    std::size_t splits_done = 0;
-
-    while (pos + delim_bytes.size() <= data_.size() && splits_done < max_splits) {
-        if (std::memcmp(&data_[pos], delim_bytes.data(), delim_bytes.size()) == 0) {
-            result.emplace_back(&data_[start], pos - start);
-            pos += delim_bytes.size();
-            start = pos;
-            ++splits_done;
-        } else {
-            ++pos;
-        }
+KStr::SplitRange KStr::rsplit_iter(KStr delim, std::size_t max_splits) const {
+    if (delim.empty()) {
+        throw std::invalid_argument("KStr::rsplit_iter(KStr) with empty delimiter is not allowed");
     }
-
-    result.emplace_back(&data_[start], data_.size() - start);
-    return result;
+    return SplitRange(data_, SubstrDelimiter(delim.as_bytes()), max_splits, true);
 }
 
-std::vector<KStr> KStr::rsplit_count(KStr delim, std::size_t max_splits) const {
+std::size_t KStr::split_offsets(KStr delim, std::size_t* out, std::size_t cap, std::size_t from) const {
     if (delim.empty()) {
-        throw std::invalid_argument("KStr::rsplit_count(KStr) with empty delimiter is not allowed");
+        throw std::invalid_argument("KStr::split_offsets(KStr) with empty delimiter is not allowed");
     }
+    return search::find_many(data_, delim.as_bytes(), from, out, cap);
+}
 
-    std::vector<KStr> result;
-    auto hay = as_bytes();
-    auto pat = delim.as_bytes();
-
-    std::size_t end = hay.size();
-    std::size_t splits_done = 0;
-
-    while (end >= pat.size() && splits_done < max_splits) {
-        bool matched = false;
+KStr::LineRange KStr::lines_iter() const {
+    return LineRange(data_, LineDelimiter());
+}
 
-        for (std::size_t i = end - pat.size(); i != static_cast<std::size_t>(-1); --i) {
-            if (std::memcmp(hay.data() + i, pat.data(), pat.size()) == 0) {
-                result.emplace_back(&hay[i + pat.size()], end - i - pat.size());
-                end = i;
-                ++splits_done;
-                matched = true;
-                break;
-            }
-        }
+KStr::WhitespaceRange KStr::split_whitespace_iter() const {
+    return WhitespaceRange(data_, Utf8WhitespaceDelimiter());
+}
 
-        if (! matched) break;
+// 核心 split 函数, 最多分割 count 次
+std::vector<KStr> KStr::split_count(KStr delim, std::size_t max_splits) const {
+    if (delim.empty()) {
+        throw std::invalid_argument("KStr::split_count(KStr) with empty delimiter is not allowed");
     }
+    return split_bulk<KStr>(data_, delim.as_bytes(), max_splits);
+}
 
-    result.emplace_back(&hay[0], end);
-    return result;
+std::vector<KStr> KStr::rsplit_count(KStr delim, std::size_t max_splits) const {
+    if (delim.empty()) {
+        throw std::invalid_argument("KStr::rsplit_count(KStr) with empty delimiter is not allowed");
+    }
+    SplitRange range = rsplit_iter(delim, max_splits);
+    return std::vector<KStr>(range.begin(), range.end());
 }
 
 std::vector<KStr> KStr::split(KStr delim) const {
@@ -414,94 +455,36 @@ std::vector<KStr> KStr::split(KStr delim) const {
 }
 
 std::pair<KStr, KStr> KStr::split_once(KStr delim) const {
-    auto result = split_count(delim, 1);
-    if (result.size() == 1) return {result[0], KStr()};
-    return {result[0], result[1]};
+    SplitRange range = split_iter(delim, 1);
+    auto it = range.begin();
+    KStr first = *it;
+    ++it;
+    return {first, it == range.end() ? KStr() : *it};
 }
 
 std::vector<KStr> KStr::rsplit(KStr delim) const {
     return rsplit_count(delim, static_cast<std::size_t>(-1));
 }
 
+// 返回 {最后一个分隔符之后, 之前}; 找不到时为 {空, 整串}
 std::pair<KStr, KStr> KStr::rsplit_once(KStr delim) const {
-    auto result = rsplit_count(delim, 1);
-    if (result.size() == 1) return {KStr(), result[0]};
-    return {result[0], result[1]};
+    SplitRange range = rsplit_iter(delim, 1);
+    auto it = range.begin();
+    KStr last = *it;
+    ++it;
+    if (it == range.end()) return {KStr(), last};
+    return {last, *it};
 }
 
+// 非法字节视为非空白, 归入相邻的片段
 std::vector<KStr> KStr::split_whitespace() const {
-    std::vector<KStr> result;
-    std::size_t pos = 0;
-    std::size_t token_start = 0;
-    bool in_whitespace = true;
-    if (data_.empty()) return result;
-
-    while (pos < data_.size()) {
-        std::size_t current = pos;
-        auto dec = utf8::decode_one(data_, pos);
-
-        if (! dec.ok) {
-            ++pos; // 跳过非法字节
-            continue;
-        }
-
-        KChar ch(dec.codepoint);
-        pos = dec.next_pos;
-
-        if (ch.is_whitespace()) {
-            if (! in_whitespace) {
-                result.emplace_back(&data_[token_start], current - token_start);
-                in_whitespace = true;
-            } else {
-                // already in whitespace, skip
-            }
-        } else {
-            // 如果之前在 whitespace 需要更新
-            if (in_whitespace) {
-                token_start = current;
-                in_whitespace = false;
-            }
-        }
-    }
-
-    if (! in_whitespace) {
-        result.emplace_back(&data_[token_start], data_.size() - token_start);
-    }
-
-    return result;
+    WhitespaceRange range = split_whitespace_iter();
+    return std::vector<KStr>(range.begin(), range.end());
 }
 
 std::vector<KStr> KStr::lines() const {
-    std::vector<KStr> result;
-    std::size_t start = 0;
-    std::size_t pos = 0;
-    if (data_.empty()) return result;
-
-    while (pos < data_.size()) {
-        if (data_[pos] == '\r') {
-            if (pos + 1 < data_.size() && data_[pos + 1] == '\n') { // \r\n
-                result.emplace_back(&data_[start], pos - start);
-                pos += 2;
-                start = pos;
-            } else { // \r
-                result.emplace_back(&data_[start], pos - start);
-                ++pos;
-                start = pos;
-            }
-        } else if (data_[pos] == '\n') { // \n
-            result.emplace_back(&data_[start], pos - start);
-            ++pos;
-            start = pos;
-        } else {
-            ++pos;
-        }
-    }
-
-    if (start < data_.size()) {
-        result.emplace_back(&data_[start], data_.size() - start);
-    }
-
-    return result;
+    LineRange range = lines_iter();
+    return std::vector<KStr>(range.begin(), range.end());
 }
 
 // too complex !!
@@ -579,28 +562,136 @@ std::vector<KStr> KStr::lines() const {
 // }
 
 KStr KStr::trim_start() const {
-    std::size_t byte_start = 0;
-    for (const auto& ch : iter_chars()) {
-        if (! ch.is_whitespace()) break;
-        byte_start += ch.utf8_size();
-    }
-    return KStr(ByteSpan(&data_[byte_start], data_.size() - byte_start));
+    std::size_t byte_start = whitespace::skip(data_, 0);
+    return KStr(data_.subspan(byte_start));
 }
 
 KStr KStr::trim_end() const {
-    std::size_t byte_end = data_.size();
-    for (auto it = iter_chars_rev().begin(); it != iter_chars_rev().end(); ++it) {
-        const auto& ch = *it;
-        if (! ch.is_whitespace()) break;
-        byte_end -= ch.utf8_size();
-    }
-    return KStr(ByteSpan(&data_[0], byte_end));
+    return KStr(data_.first(whitespace::rskip(data_, data_.size())));
 }
 
 KStr KStr::trim() const {
     return trim_start().trim_end();
 }
 
+std::vector<unicode::CharMask> KStr::char_masks() const {
+    return unicode::classify(data_);
+}
+
+namespace {
+// 线程内缓冲保留的容量上限, 超出的部分用完即交还
+const std::size_t SCRATCH_KEEP = 4096;
+
+// 复用线程内的缓冲, 短串 (如索引键) 的结果不必每次分配
+ByteVec& scratch_buffer() {
+    static thread_local ByteVec buf;
+    buf.clear();
+    return buf;
+}
+
+void trim_scratch(ByteVec& buf) {
+    if (buf.capacity() > SCRATCH_KEEP) ByteVec().swap(buf);
+}
+
+// 把缓冲中的结果交给 KString: 长结果连同缓冲一起移交, 不再拷贝, 线程内随后重新分配; 短结果拷入 SSO
+// 缓冲远大于结果时 (如变短的替换按原长预留) 仍拷贝, 免得返回的串占着多余的内存
+KString take_scratch(ByteVec& buf) {
+    KString out = buf.capacity() <= 2 * buf.size() ? KString(std::move(buf)) : KString(buf.data(), buf.size());
+    trim_scratch(buf);
+    return out;
+}
+} // namespace
+
+KString KStr::to_lowercase() const {
+    ByteVec& buf = scratch_buffer();
+    unicode::append_lowercase(data_, buf);
+    return take_scratch(buf);
+}
+
+KString KStr::replace(KStr from, KStr to) const {
+    return replacen(from, to, knpos);
+}
+
+KString KStr::replacen(KStr from, KStr to, std::size_t count) const {
+    ByteVec& buf = scratch_buffer();
+    if (! from.empty()) {
+        search::replace(data_, from.data_, to.data_, buf, count);
+        return take_scratch(buf);
+    }
+    // 空模式: 按 decode_one 的切分在字符边界插入, 一个非法序列算一个字符
+    std::size_t pos = 0;
+    for (std::size_t inserted = 0; inserted < count; ++inserted) {
+        buf.insert(buf.end(), to.data_.begin(), to.data_.end());
+        if (pos >= data_.size()) break;
+        std::size_t next = utf8::decode_one(data_, pos).next_pos;
+        buf.insert(buf.end(), data_.begin() + pos, data_.begin() + next);
+        pos = next;
+    }
+    buf.insert(buf.end(), data_.begin() + pos, data_.end());
+    return take_scratch(buf);
+}
+
+KString KStr::to_uppercase() const {
+    ByteVec& buf = scratch_buffer();
+    unicode::append_uppercase(data_, buf);
+    return take_scratch(buf);
+}
+
+KString KStr::to_valid_utf8() const {
+    ByteVec& buf = scratch_buffer();
+    utf8::append_sanitized(data_, buf);
+    return take_scratch(buf);
+}
+
+void KStr::to_utf16(std::u16string& out, utf8::ErrorMode mode, utf8::Utf16Order order) const {
+    utf8::append_utf16(data_, out, mode, order);
+}
+
+std::u16string KStr::to_utf16(utf8::ErrorMode mode, utf8::Utf16Order order) const {
+    std::u16string out;
+    utf8::append_utf16(data_, out, mode, order);
+    return out;
+}
+
+void KStr::to_latin1(ByteVec& out, utf8::ErrorMode mode) const {
+    utf8::append_latin1(data_, out, mode);
+}
+
+KStr KStr::from_utf16(const std::u16string& str, ByteVec& buf, utf8::ErrorMode mode, utf8::Utf16Order order) {
+    buf.clear();
+    utf8::append_from_utf16(str.data(), str.size(), buf, mode, order);
+    return KStr(buf.data(), buf.size());
+}
+
+KStr KStr::from_latin1(ByteSpan latin1, ByteVec& buf) {
+    buf.clear();
+    utf8::append_from_latin1(latin1, buf);
+    return KStr(buf.data(), buf.size());
+}
+
+bool KStr::is_normalized(unicode::NormalizationForm form) const {
+    return unicode::is_normalized(data_, form);
+}
+
+KString KStr::normalize(unicode::NormalizationForm form) const {
+    ByteVec& buf = scratch_buffer();
+    unicode::append_normalized(data_, form, buf);
+    return take_scratch(buf);
+}
+
+KStr KStr::normalize(unicode::NormalizationForm form, KString& buf) const {
+    if (unicode::quick_check(data_, form) == unicode::QuickCheck::Yes) return *this;
+    ByteVec& normalized = scratch_buffer();
+    unicode::append_normalized(data_, form, normalized);
+    // quick check 为 Maybe 的输入可能本来就是目标形式
+    if (normalized.size() == data_.size() && std::memcmp(normalized.data(), data_.data(), data_.size()) == 0) {
+        trim_scratch(normalized);
+        return *this;
+    }
+    buf = take_scratch(normalized);
+    return buf.as_kstr();
+}
+
 KStr KStr::strip_prefix(KStr prefix) const {
     auto a = as_bytes();
     auto b = prefix.as_bytes();
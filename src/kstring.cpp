@@ -1 +1,352 @@
-// todo
+#include "kstring.hpp"
+#include "ksearcher.hpp"
+#include "utf8.hpp"
+
+namespace kstring {
+namespace {
+// 一段字节对 KString 缓存的贡献, 按 decode_one 切分统计
+struct TextCounts {
+    std::size_t chars;
+    std::size_t non_ascii;
+    std::size_t invalid;
+};
+
+TextCounts count_text(ByteSpan bytes) {
+    TextCounts counts = {bytes.size(), 0, 0};
+    if (utf8::is_all_ascii(bytes)) return counts;
+    counts.non_ascii = utf8::non_ascii_count(bytes);
+    counts.chars = utf8::char_count(bytes);
+    counts.invalid = utf8::invalid_count(bytes);
+    return counts;
+}
+
+/**
+ * 在末尾追加 (或从追加后的串截回) 任意字节时, 切分在两者中相同的最后一个字符边界 (不晚于末尾)
+ * 起点早于 n - 3 的序列至多 4 字节, 不会触及末尾, 追加前后切分相同; 它们之后的第一个边界即为所求
+ * 先退到 n - 4 处或之前的某个边界: 非续字节总是序列的起点 (只有末尾被截断的序列会吞下它们, 而这里离末尾足够远),
+ * 前 3 字节都是续字节的位置也是, 因为没有首字节能延伸到它; 再按 decode_one 向后走到 n - 3 及以后
+ */
+std::size_t stable_boundary(ByteSpan bytes) {
+    const std::size_t n = bytes.size();
+    if (n < 4) return 0;
+    const std::size_t start = n - 4;
+    std::size_t pos = start;
+    while (pos > 0 && pos + 3 > start && (bytes[pos] & 0xC0) == 0x80) --pos;
+    if (pos > 0 && (bytes[pos] & 0xC0) == 0x80) pos = start;
+    while (pos + 3 < n) pos = utf8::decode_one(bytes, pos).next_pos;
+    return pos;
+}
+} // namespace
+
+KString::KString() : data_(), char_size_(0), non_ascii_(0), invalid_(0), index_(nullptr) {}
+
+// 注意: 不能走 SSOBytes(const Byte*, size_t), 其 debug 模式会对输入做 strlen 检查, 而 KStr 视图未必以 0 结尾
+KString::KString(const char* cstr) : KString() {
+    if (cstr == nullptr) return;
+    append_bytes(reinterpret_cast<const Byte*>(cstr), std::strlen(cstr));
+}
+
+KString::KString(const std::string& str) : KString() {
+    append_bytes(reinterpret_cast<const Byte*>(str.data()), str.size());
+}
+
+KString::KString(const char* ptr, std::size_t len) : KString() {
+    append_bytes(reinterpret_cast<const Byte*>(ptr), len);
+}
+
+KString::KString(const Byte* ptr, std::size_t len) : KString() {
+    append_bytes(ptr, len);
+}
+
+KString::KString(KStr kstr) : KString() {
+    append_bytes(kstr.as_bytes().data(), kstr.byte_size());
+}
+
+KString::KString(KChar ch) : KString() {
+    push_back(ch);
+}
+
+KString::KString(ByteVec&& bytes) : data_(std::move(bytes)), char_size_(0), non_ascii_(0), invalid_(0), index_(nullptr) {
+    TextCounts counts = count_text(as_bytes());
+    char_size_ = counts.chars;
+    non_ascii_ = counts.non_ascii;
+    invalid_ = counts.invalid;
+}
+
+KString KString::from_utf16(const std::u16string& str, utf8::ErrorMode mode, utf8::Utf16Order order) {
+    ByteVec buf;
+    utf8::append_from_utf16(str.data(), str.size(), buf, mode, order);
+    return KString(std::move(buf));
+}
+
+KString KString::from_latin1(const std::string& latin1) {
+    ByteVec buf;
+    utf8::append_from_latin1(ByteSpan(reinterpret_cast<const Byte*>(latin1.data()), latin1.size()), buf);
+    return KString(std::move(buf));
+}
+
+KString::KString(const KString& other)
+    : data_(other.data_), char_size_(other.char_size_), non_ascii_(other.non_ascii_), invalid_(other.invalid_),
+      index_(nullptr) {}
+
+KString& KString::operator=(const KString& other) {
+    if (this == &other) return *this;
+    data_ = other.data_;
+    char_size_ = other.char_size_;
+    non_ascii_ = other.non_ascii_;
+    invalid_ = other.invalid_;
+    invalidate_index();
+    return *this;
+}
+
+KString::KString(KString&& other) noexcept
+    : data_(std::move(other.data_)),
+      char_size_(other.char_size_),
+      non_ascii_(other.non_ascii_),
+      invalid_(other.invalid_),
+      index_(other.index_.exchange(nullptr, std::memory_order_relaxed)) {
+    // SSO 模式下字节随对象搬迁, 索引需要指向新地址
+    if (CharOffsetIndex* index = index_.load(std::memory_order_relaxed)) index->rebind(as_bytes());
+    other.clear();
+}
+
+KString& KString::operator=(KString&& other) noexcept {
+    if (this == &other) return *this;
+    data_ = std::move(other.data_);
+    char_size_ = other.char_size_;
+    non_ascii_ = other.non_ascii_;
+    invalid_ = other.invalid_;
+    delete index_.exchange(other.index_.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+    if (CharOffsetIndex* index = index_.load(std::memory_order_relaxed)) index->rebind(as_bytes());
+    other.clear();
+    return *this;
+}
+
+KString::~KString() {
+    delete index_.load(std::memory_order_relaxed);
+}
+
+KStr KString::indexed_kstr() const {
+    if (index_.load(std::memory_order_acquire) == nullptr && ! is_ascii() && data_.size() >= INDEX_THRESHOLD) {
+        // 并发的 const 访问可能同时构建, 只有先发布的一份生效, 其余丢弃
+        std::unique_ptr<CharOffsetIndex> built(new CharOffsetIndex(as_bytes()));
+        CharOffsetIndex* expected = nullptr;
+        if (index_.compare_exchange_strong(expected, built.get(), std::memory_order_acq_rel)) built.release();
+    }
+    return as_kstr();
+}
+
+void KString::append_bytes(const Byte* ptr, std::size_t len) {
+    if (ptr == nullptr || len == 0) return;
+
+    invalidate_index();
+    if (invalid_ == 0) {
+        // 两段均合法时字符边界不会跨越拼接点, 各项计数直接相加
+        TextCounts piece = count_text(ByteSpan(ptr, len));
+        if (piece.invalid == 0) {
+            data_.append(ptr, len);
+            char_size_ += piece.chars;
+            non_ascii_ += piece.non_ascii;
+            return;
+        }
+    }
+
+    // 拼接点附近的非法序列可能与新字节合并: 只重新统计拼接点前最后一个不受影响的边界之后的部分
+    const std::size_t from = stable_boundary(as_bytes());
+    TextCounts before = count_text(as_bytes().subspan(from));
+    data_.append(ptr, len);
+    TextCounts after = count_text(as_bytes().subspan(from));
+    char_size_ = char_size_ - before.chars + after.chars;
+    non_ascii_ = non_ascii_ - before.non_ascii + after.non_ascii;
+    invalid_ = invalid_ - before.invalid + after.invalid;
+}
+
+void KString::append(KStr str) {
+    append_bytes(str.as_bytes().data(), str.byte_size());
+}
+
+void KString::append(const KString& other) {
+    if (this == &other) {
+        KString copy(other);
+        append(copy);
+        return;
+    }
+
+    if (other.empty()) return;
+    // other 的缓存可以直接复用, 无需再扫描
+    if (invalid_ == 0 && other.invalid_ == 0) {
+        invalidate_index();
+        data_.append(other.data(), other.byte_size());
+        char_size_ += other.char_size_;
+        non_ascii_ += other.non_ascii_;
+    } else {
+        append_bytes(other.data(), other.byte_size());
+    }
+}
+
+void KString::append(const char* cstr) {
+    if (cstr == nullptr) return;
+    append_bytes(reinterpret_cast<const Byte*>(cstr), std::strlen(cstr));
+}
+
+void KString::append(const char* ptr, std::size_t len) {
+    append_bytes(reinterpret_cast<const Byte*>(ptr), len);
+}
+
+void KString::push_back(KChar ch) {
+    utf8::UTF8Encoded enc = utf8::encode(ch.value());
+    if (invalid_ == 0) {
+        invalidate_index();
+        // KChar 总是合法码点, 编码结果必然合法
+        data_.append(enc.bytes, enc.len);
+        char_size_ += 1;
+        if (! ch.is_ascii()) non_ascii_ += enc.len;
+    } else {
+        append_bytes(enc.bytes, enc.len);
+    }
+}
+
+KChar KString::pop_back() {
+    if (empty()) {
+        throw std::runtime_error("KString::pop_back(): pop on empty KString");
+    }
+
+    utf8::UTF8Decoded dec = utf8::decode_one_prev(as_bytes(), data_.size());
+    KChar ch = dec.ok ? KChar(dec.codepoint) : KChar(kstring::ILL_CODEPOINT);
+    invalidate_index();
+
+    if (invalid_ == 0) {
+        // 合法串去掉最后一个字符仍然合法, 只需扣除这几个字节
+        char_size_ -= 1;
+        non_ascii_ -= utf8::non_ascii_count(as_bytes().subspan(dec.next_pos));
+    } else {
+        // 截短后新的末尾可能成为被截断的序列, 吞并之前分开计数的非法字节: 与追加相同, 只重新统计末尾附近
+        const std::size_t from = stable_boundary(as_bytes().first(dec.next_pos));
+        TextCounts before = count_text(as_bytes().subspan(from));
+        TextCounts after = count_text(as_bytes().subspan(from, dec.next_pos - from));
+        char_size_ = char_size_ - before.chars + after.chars;
+        non_ascii_ = non_ascii_ - before.non_ascii + after.non_ascii;
+        invalid_ = invalid_ - before.invalid + after.invalid;
+    }
+    data_.resize(dec.next_pos);
+    return ch;
+}
+
+void KString::clear() {
+    invalidate_index();
+    data_.clear();
+    char_size_ = 0;
+    non_ascii_ = 0;
+    invalid_ = 0;
+}
+
+void KString::swap(KString& other) noexcept {
+    data_.swap(other.data_);
+    std::swap(char_size_, other.char_size_);
+    std::swap(non_ascii_, other.non_ascii_);
+    std::swap(invalid_, other.invalid_);
+    CharOffsetIndex* index = index_.load(std::memory_order_relaxed);
+    CharOffsetIndex* other_index = other.index_.load(std::memory_order_relaxed);
+    index_.store(other_index, std::memory_order_relaxed);
+    other.index_.store(index, std::memory_order_relaxed);
+    if (other_index) other_index->rebind(as_bytes());
+    if (index) index->rebind(other.as_bytes());
+}
+
+ByteSpan KString::operator[](std::size_t idx) const {
+    if (is_ascii()) {
+        if (idx >= data_.size()) throw std::out_of_range("KString::operator[] index exceeds character count");
+        return ByteSpan(data_.data() + idx, 1);
+    }
+    return indexed_kstr()[idx];
+}
+
+KChar KString::char_at(std::size_t idx) const {
+    if (is_ascii()) {
+        if (idx >= data_.size()) throw std::out_of_range("KString::char_at index out of bounds");
+        return KChar(data_[idx]);
+    }
+    return indexed_kstr().char_at(idx);
+}
+
+std::size_t KString::char_index_to_byte_offset(std::size_t idx) const {
+    if (is_ascii()) {
+        if (idx >= data_.size()) throw std::out_of_range("KString::char index exceeds character count");
+        return idx;
+    }
+    return indexed_kstr().char_index_to_byte_offset(idx);
+}
+
+std::size_t KString::count_chars_before(std::size_t byte_offset) const {
+    if (byte_offset > data_.size()) {
+        throw std::out_of_range("byte_offset exceeds data size");
+    }
+    if (is_ascii()) return byte_offset;
+    if (byte_offset == data_.size()) return char_size_;
+    return indexed_kstr().count_chars_before(byte_offset);
+}
+
+std::size_t KString::find(KStr substr) const {
+    if (is_ascii()) return as_kstr().find_in_bytes(substr);
+    return indexed_kstr().find(substr);
+}
+
+std::size_t KString::rfind(KStr substr) const {
+    if (is_ascii()) return as_kstr().rfind_in_bytes(substr);
+    return indexed_kstr().rfind(substr);
+}
+
+std::size_t KString::find(const KSearcher& searcher) const {
+    if (is_ascii()) return searcher.find_in_bytes(as_kstr());
+    return indexed_kstr().find(searcher);
+}
+
+std::size_t KString::rfind(const KSearcher& searcher) const {
+    if (is_ascii()) return searcher.rfind_in_bytes(as_kstr());
+    return indexed_kstr().rfind(searcher);
+}
+
+// 全 ASCII 时字节偏移即字符下标
+static CharIndex ascii_char_index(const KString& s, std::size_t offset) {
+    if (offset == knpos) return CharIndex(KChar(), knpos, knpos);
+    KChar ch = offset < s.byte_size() ? KChar(s.byte_at(offset)) : KChar();
+    return CharIndex(ch, offset, offset);
+}
+
+CharIndex KString::find_index(KStr substr) const {
+    if (is_ascii()) return ascii_char_index(*this, as_kstr().find_in_bytes(substr));
+    return indexed_kstr().find_index(substr);
+}
+
+CharIndex KString::rfind_index(KStr substr) const {
+    if (is_ascii()) return ascii_char_index(*this, as_kstr().rfind_in_bytes(substr));
+    return indexed_kstr().rfind_index(substr);
+}
+
+KStr KString::substr(std::size_t start, std::size_t count) const {
+    if (is_ascii()) {
+        if (start >= data_.size()) throw std::out_of_range("KString::substr start index out of bounds");
+        count = std::min(count, data_.size() - start);
+        return KStr(data_.data() + start, count);
+    }
+    return indexed_kstr().substr(start, count);
+}
+
+KStr KString::subrange(std::size_t start, std::size_t end) const {
+    if (is_ascii()) {
+        if (start > end) throw std::out_of_range("KString::subrange invalid range: start > end");
+        if (start >= data_.size()) throw std::out_of_range("KString::subrange start index out of bounds");
+        end = std::min(end, data_.size());
+        return KStr(data_.data() + start, end - start);
+    }
+    return indexed_kstr().subrange(start, end);
+}
+
+std::pair<KStr, KStr> KString::split_at(std::size_t mid) const {
+    if (is_ascii()) {
+        if (mid >= data_.size()) throw std::out_of_range("KString::char index exceeds character count");
+        return {KStr(data_.data(), mid), KStr(data_.data() + mid, data_.size() - mid)};
+    }
+    return indexed_kstr().split_at(mid);
+}
+} // namespace kstring
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped_text.hpp"
+#include "utf8.hpp"
+
+namespace kstring {
+namespace {
+// 每个线程至少校验这么多字节, 更小的文件不值得起线程
+const std::size_t MIN_BYTES_PER_THREAD = 1 << 20;
+
+[[noreturn]] void throw_errno(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string("MappedText: ") + what + " '" + path + "': " + std::strerror(errno));
+}
+
+void advise(void* addr, std::size_t size, unsigned hints) {
+    // 提示只影响性能, 内核不支持 (如文件映射的透明大页) 时忽略失败
+    if (hints & MappedText::HINT_SEQUENTIAL) (void)::madvise(addr, size, MADV_SEQUENTIAL);
+    if (hints & MappedText::HINT_WILLNEED) (void)::madvise(addr, size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    if (hints & MappedText::HINT_HUGEPAGE) (void)::madvise(addr, size, MADV_HUGEPAGE);
+#endif
+}
+
+/**
+ * 段的起点向后越过至多 3 个续字节, 落在非续字节上: 此时没有序列跨越段边界, 整体合法当且仅当各段都合法,
+ * 且第一个出错的段给出的位置就是整体的 first_invalid (连续 4 个续字节必然非法, 越过 3 个已足够)
+ */
+std::size_t parallel_first_invalid(ByteSpan data, unsigned threads) {
+    const std::size_t n = data.size();
+    std::size_t parts = std::min<std::size_t>(threads, n / MIN_BYTES_PER_THREAD);
+    if (parts <= 1) return utf8::first_invalid(data);
+
+    std::vector<std::size_t> bounds(parts + 1, n);
+    bounds[0] = 0;
+    for (std::size_t i = 1; i < parts; ++i) {
+        std::size_t b = std::max(bounds[i - 1], n / parts * i);
+        for (int skip = 0; skip < 3 && b < n && (data[b] & 0xC0) == 0x80; ++skip) ++b;
+        bounds[i] = b;
+    }
+
+    std::vector<std::size_t> errors(parts, knpos);
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    auto check = [&](std::size_t i) {
+        std::size_t bad = utf8::first_invalid(data.subspan(bounds[i], bounds[i + 1] - bounds[i]));
+        if (bad != knpos) errors[i] = bounds[i] + bad;
+    };
+    for (std::size_t i = 1; i < parts; ++i) workers.emplace_back(check, i);
+    check(0);
+    for (auto& w : workers) w.join();
+
+    for (std::size_t e : errors) {
+        if (e != knpos) return e;
+    }
+    return knpos;
+}
+} // namespace
+
+MappedText::MappedText() : addr_(nullptr), size_(0), validated_(false), first_invalid_(knpos) {}
+
+MappedText::MappedText(const std::string& path, unsigned hints) : MappedText() {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw_errno("cannot open", path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int saved = errno;
+        ::close(fd);
+        errno = saved;
+        throw_errno("cannot stat", path);
+    }
+    // 空文件无法映射, 按空文本处理
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    if (size > 0) {
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            int saved = errno;
+            ::close(fd);
+            errno = saved;
+            throw_errno("cannot map", path);
+        }
+        advise(addr, size, hints);
+        addr_ = addr;
+        size_ = size;
+    }
+    // 映射建立后即可关闭描述符
+    ::close(fd);
+}
+
+MappedText::MappedText(MappedText&& other) noexcept
+    : addr_(other.addr_), size_(other.size_), validated_(other.validated_), first_invalid_(other.first_invalid_) {
+    other.addr_ = nullptr;
+    other.size_ = 0;
+    other.validated_ = false;
+}
+
+MappedText& MappedText::operator=(MappedText&& other) noexcept {
+    if (this == &other) return *this;
+    close();
+    addr_ = other.addr_;
+    size_ = other.size_;
+    validated_ = other.validated_;
+    first_invalid_ = other.first_invalid_;
+    other.addr_ = nullptr;
+    other.size_ = 0;
+    other.validated_ = false;
+    return *this;
+}
+
+MappedText::~MappedText() {
+    close();
+}
+
+void MappedText::close() {
+    if (addr_ != nullptr) ::munmap(addr_, size_);
+    addr_ = nullptr;
+    size_ = 0;
+    validated_ = false;
+    first_invalid_ = knpos;
+}
+
+std::size_t MappedText::first_invalid(unsigned threads) const {
+    if (! validated_) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        first_invalid_ = parallel_first_invalid(as_bytes(), threads);
+        validated_ = true;
+    }
+    return first_invalid_;
+}
+} // namespace kstring
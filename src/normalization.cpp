@@ -0,0 +1,318 @@
+#include <cstring>
+#include <vector>
+#include "normalization.hpp"
+#include "utf8.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KSTRING_NORM_X86 1
+#endif
+
+namespace kstring {
+namespace unicode {
+namespace {
+// 谚文音节按算法分解与组合 (Unicode 标准 3.12 节)
+enum : CodePoint {
+    HANGUL_S_BASE = 0xAC00,
+    HANGUL_L_BASE = 0x1100,
+    HANGUL_V_BASE = 0x1161,
+    HANGUL_T_BASE = 0x11A7,
+    HANGUL_L_COUNT = 19,
+    HANGUL_V_COUNT = 21,
+    HANGUL_T_COUNT = 28,
+    HANGUL_N_COUNT = HANGUL_V_COUNT * HANGUL_T_COUNT,
+    HANGUL_S_COUNT = HANGUL_L_COUNT * HANGUL_N_COUNT
+};
+
+// 返回 pos 起第一个非 ASCII 字节的位置, 没有则返回 n
+typedef std::size_t (*SkipAsciiFn)(const Byte* p, std::size_t pos, std::size_t n);
+
+std::size_t skip_ascii_scalar(const Byte* p, std::size_t pos, std::size_t n) {
+    for (; pos + 8 <= n; pos += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p + pos, 8);
+        if ((word & 0x8080808080808080ull) != 0) break;
+    }
+    while (pos < n && p[pos] < 0x80) ++pos;
+    return pos;
+}
+
+#ifdef KSTRING_NORM_X86
+__attribute__((target("sse2"))) std::size_t skip_ascii_sse2(const Byte* p, std::size_t pos, std::size_t n) {
+    for (; pos + 16 <= n; pos += 16) {
+        unsigned mask =
+            static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + pos))));
+        if (mask != 0) return pos + static_cast<unsigned>(__builtin_ctz(mask));
+    }
+    return skip_ascii_scalar(p, pos, n);
+}
+
+__attribute__((target("avx2"))) std::size_t skip_ascii_avx2(const Byte* p, std::size_t pos, std::size_t n) {
+    for (; pos + 32 <= n; pos += 32) {
+        unsigned mask = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + pos))));
+        if (mask != 0) return pos + static_cast<unsigned>(__builtin_ctz(mask));
+    }
+    return skip_ascii_sse2(p, pos, n);
+}
+#endif
+
+struct Backend {
+    const char* name;
+    SkipAsciiFn skip_ascii;
+};
+
+Backend select_backend() {
+#ifdef KSTRING_NORM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Backend{"avx2", skip_ascii_avx2};
+    if (__builtin_cpu_supports("sse2")) return Backend{"sse2", skip_ascii_sse2};
+#endif
+    return Backend{"scalar", skip_ascii_scalar};
+}
+
+const Backend& backend() {
+    static const Backend selected = select_backend();
+    return selected;
+}
+
+// 各形式对应的 quick check 位与分解/组合方式
+struct FormInfo {
+    std::uint8_t no;
+    std::uint8_t maybe;
+    bool compat;
+    bool compose;
+};
+
+FormInfo form_info(NormalizationForm form) {
+    switch (form) {
+    case NormalizationForm::NFC: return FormInfo{tables::NORM_NFC_NO, tables::NORM_NFC_MAYBE, false, true};
+    case NormalizationForm::NFD: return FormInfo{tables::NORM_NFD_NO, 0, false, false};
+    case NormalizationForm::NFKC: return FormInfo{tables::NORM_NFKC_NO, tables::NORM_NFKC_MAYBE, true, true};
+    case NormalizationForm::NFKD: return FormInfo{tables::NORM_NFKD_NO, 0, true, false};
+    }
+    return FormInfo{tables::NORM_NFC_NO, tables::NORM_NFC_MAYBE, false, true};
+}
+
+// 解码 pos 处的非 ASCII 字符; 非法序列返回 false, len 为 decode_one 跳过的字节数
+inline bool next_char(ByteSpan text, std::size_t pos, CodePoint& cp, std::size_t& len) {
+    len = utf8::try_decode(text.data() + pos, text.size() - pos, cp);
+    if (len != 0) return true;
+    utf8::UTF8Decoded dec = utf8::decode_one(text, pos);
+    len = dec.next_pos - pos;
+    cp = dec.codepoint;
+    return dec.ok;
+}
+
+struct ScanResult {
+    QuickCheck result;
+    std::size_t safe;      // 第一个非 Yes 字符所在片段的起点: 它之前最后一个稳定字符 (ccc 为 0 且为 Yes) 的位置
+    std::size_t issue_end; // 第一个非 Yes 字符之后的位置
+};
+
+/**
+ * quick check 主循环, pos 须是稳定边界
+ * stop_at_first 为 true 时遇到第一个非 Yes 字符即返回 (规范化用), 否则扫到能确定 No 为止
+ * 稳定字符之前的内容与之后的内容互不影响: 它不会与前面的字符组合, 也挡住了后面的组合字符
+ */
+ScanResult scan(ByteSpan text, std::size_t pos, const FormInfo& f, bool stop_at_first) {
+    const Byte* p = text.data();
+    const std::size_t n = text.size();
+    const SkipAsciiFn skip_ascii = backend().skip_ascii;
+    ScanResult out = {QuickCheck::Yes, n, n};
+    std::size_t safe = pos;
+    std::uint8_t last_ccc = 0;
+    while (pos < n) {
+        if (p[pos] < 0x80) {
+            pos = skip_ascii(p, pos, n);
+            safe = pos - 1; // 后面的组合字符可能与最后一个 ASCII 字母组合
+            last_ccc = 0;
+            continue;
+        }
+        CodePoint cp = 0;
+        std::size_t len = 0;
+        if (! next_char(text, pos, cp, len)) {
+            pos += len;
+            safe = pos; // 非法字节不参与组合, 之后即是边界
+            last_ccc = 0;
+            continue;
+        }
+        const tables::NormRecord& r = norm_record(cp);
+        QuickCheck q = QuickCheck::Yes;
+        if ((r.flags & f.no) != 0 || (r.ccc != 0 && last_ccc > r.ccc)) {
+            q = QuickCheck::No;
+        } else if ((r.flags & f.maybe) != 0) {
+            q = QuickCheck::Maybe;
+        }
+        if (q == QuickCheck::Yes) {
+            if (r.ccc == 0) safe = pos;
+        } else {
+            if (out.result == QuickCheck::Yes) {
+                out.safe = safe;
+                out.issue_end = pos + len;
+            }
+            out.result = q;
+            if (q == QuickCheck::No || stop_at_first) return out;
+        }
+        last_ccc = r.ccc;
+        pos += len;
+    }
+    return out;
+}
+
+// pos 起的下一个稳定边界: ASCII, 非法字节, 或 ccc 为 0 且 quick check 为 Yes 的字符
+std::size_t next_boundary(ByteSpan text, std::size_t pos, const FormInfo& f) {
+    while (pos < text.size()) {
+        if (text[pos] < 0x80) return pos;
+        CodePoint cp = 0;
+        std::size_t len = 0;
+        if (! next_char(text, pos, cp, len)) return pos;
+        const tables::NormRecord& r = norm_record(cp);
+        if (r.ccc == 0 && (r.flags & (f.no | f.maybe)) == 0) return pos;
+        pos += len;
+    }
+    return text.size();
+}
+
+struct Entry {
+    CodePoint cp;
+    std::uint8_t ccc;
+};
+
+// 追加一个字符并做规范排序: 非零组合类的字符向前越过组合类更大的字符 (稳定插入)
+inline void push_ordered(std::vector<Entry>& buf, CodePoint cp, std::uint8_t ccc) {
+    buf.push_back(Entry{cp, ccc});
+    if (ccc == 0) return;
+    std::size_t i = buf.size() - 1;
+    while (i > 0 && buf[i - 1].ccc > ccc) {
+        buf[i] = buf[i - 1];
+        --i;
+    }
+    buf[i] = Entry{cp, ccc};
+}
+
+void decompose(CodePoint cp, bool compat, std::vector<Entry>& buf) {
+    const CodePoint s = cp - HANGUL_S_BASE;
+    if (s < HANGUL_S_COUNT) {
+        buf.push_back(Entry{HANGUL_L_BASE + s / HANGUL_N_COUNT, 0});
+        buf.push_back(Entry{HANGUL_V_BASE + (s % HANGUL_N_COUNT) / HANGUL_T_COUNT, 0});
+        if (s % HANGUL_T_COUNT != 0) buf.push_back(Entry{HANGUL_T_BASE + s % HANGUL_T_COUNT, 0});
+        return;
+    }
+    const tables::NormRecord& r = norm_record(cp);
+    const std::uint16_t offset = (compat && r.compat != 0) ? r.compat : r.canonical;
+    if (offset == 0) {
+        push_ordered(buf, cp, r.ccc);
+        return;
+    }
+    // 表中的分解已完全展开, 不含谚文音节
+    const std::uint32_t* d = tables::DECOMP + offset;
+    for (std::uint32_t i = 1; i <= d[0]; ++i) push_ordered(buf, d[i], combining_class(d[i]));
+}
+
+// 主组合查找, 没有组合结果返回 0
+CodePoint compose_pair(CodePoint a, CodePoint b) {
+    const CodePoint l = a - HANGUL_L_BASE;
+    const CodePoint v = b - HANGUL_V_BASE;
+    if (l < HANGUL_L_COUNT && v < HANGUL_V_COUNT) return HANGUL_S_BASE + (l * HANGUL_V_COUNT + v) * HANGUL_T_COUNT;
+    const CodePoint s = a - HANGUL_S_BASE;
+    const CodePoint t = b - HANGUL_T_BASE;
+    if (s < HANGUL_S_COUNT && s % HANGUL_T_COUNT == 0 && t - 1 < HANGUL_T_COUNT - 1) return a + t;
+
+    std::size_t lo = 0;
+    std::size_t hi = sizeof(tables::COMPOSITIONS) / sizeof(tables::COMPOSITIONS[0]);
+    while (lo < hi) {
+        std::size_t mid = (lo + hi) / 2;
+        const tables::CompositionPair& c = tables::COMPOSITIONS[mid];
+        if (c.first < a || (c.first == a && c.second < b)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < sizeof(tables::COMPOSITIONS) / sizeof(tables::COMPOSITIONS[0])) {
+        const tables::CompositionPair& c = tables::COMPOSITIONS[lo];
+        if (c.first == a && c.second == b) return c.composite;
+    }
+    return 0;
+}
+
+// 规范组合: 字符与最近的起始字符之间没有被组合类相同或更高的字符隔开时尝试组合
+void compose(std::vector<Entry>& buf) {
+    if (buf.empty()) return;
+    std::size_t starter = knpos;
+    if (buf[0].ccc == 0) starter = 0;
+    unsigned last_ccc = buf[0].ccc == 0 ? 0 : 256;
+    std::size_t w = 1;
+    for (std::size_t i = 1; i < buf.size(); ++i) {
+        const Entry e = buf[i];
+        if (starter != knpos && (last_ccc < e.ccc || last_ccc == 0)) {
+            CodePoint composite = compose_pair(buf[starter].cp, e.cp);
+            if (composite != 0) {
+                buf[starter].cp = composite;
+                continue;
+            }
+        }
+        if (e.ccc == 0) starter = w;
+        last_ccc = e.ccc;
+        buf[w++] = e;
+    }
+    buf.resize(w);
+}
+
+// 片段两端都是稳定边界, 内部只有合法字符 (非法字节本身就是边界)
+void normalize_segment(ByteSpan text, std::size_t pos, std::size_t end, const FormInfo& f, ByteVec& out) {
+    static thread_local std::vector<Entry> buf;
+    buf.clear();
+    while (pos < end) {
+        if (text[pos] < 0x80) {
+            buf.push_back(Entry{text[pos++], 0});
+            continue;
+        }
+        CodePoint cp = 0;
+        std::size_t len = 0;
+        next_char(text, pos, cp, len);
+        decompose(cp, f.compat, buf);
+        pos += len;
+    }
+    if (f.compose) compose(buf);
+
+    std::size_t w = out.size();
+    out.resize(w + buf.size() * 4);
+    for (const Entry& e : buf) w += utf8::encode_to(out.data() + w, e.cp);
+    out.resize(w);
+}
+} // namespace
+
+QuickCheck quick_check(ByteSpan text, NormalizationForm form) {
+    return scan(text, 0, form_info(form), false).result;
+}
+
+bool is_normalized(ByteSpan text, NormalizationForm form) {
+    QuickCheck q = quick_check(text, form);
+    if (q != QuickCheck::Maybe) return q == QuickCheck::Yes;
+    ByteVec normalized;
+    normalized.reserve(text.size());
+    append_normalized(text, form, normalized);
+    return normalized.size() == text.size() && std::memcmp(normalized.data(), text.data(), text.size()) == 0;
+}
+
+void append_normalized(ByteSpan text, NormalizationForm form, ByteVec& out) {
+    const FormInfo f = form_info(form);
+    const std::size_t n = text.size();
+    std::size_t pos = 0;
+    while (pos < n) {
+        ScanResult s = scan(text, pos, f, true);
+        out.insert(out.end(), text.begin() + pos, text.begin() + s.safe);
+        if (s.result == QuickCheck::Yes) break;
+        std::size_t end = next_boundary(text, s.issue_end, f);
+        normalize_segment(text, s.safe, end, f, out);
+        pos = end;
+    }
+}
+
+const char* normalization_simd_backend() {
+    return backend().name;
+}
+} // namespace unicode
+} // namespace kstring
@@ -0,0 +1,1178 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "search.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KSTRING_SEARCH_X86 1
+#endif
+
+namespace kstring {
+namespace search {
+namespace {
+// 字节在常见文本 (英文, 代码, 日志, UTF-8 中文) 中的大致出现频率等级, 越大越常见
+// 仅用于挑选 packed pair 的过滤字节, 不要求精确. 分级:
+//   空格 255 > 常见小写字母 240 > UTF-8 continuation 220 > 其他小写 200 > 数字 190 > 3 字节首字节 180
+//   > 换行与常见标点 170 > 大写 150 > 其他可打印 120 > \t \r 110 > 2 字节首字节 100 > 其余 40
+const uint8_t kByteRank[256] = {
+     40,  40,  40,  40,  40,  40,  40,  40,  40, 110, 170,  40,  40, 110,  40,  40, // 0x00
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40, // 0x10
+    255, 120, 170, 120, 120, 120, 120, 120, 120, 120, 120, 120, 170, 170, 170, 170, // 0x20
+    190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 170, 120, 120, 170, 120, 120, // 0x30
+    120, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150, // 0x40
+    150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 120, 120, 120, 120, 170, // 0x50
+    120, 240, 200, 240, 240, 240, 200, 200, 240, 240, 200, 200, 240, 200, 240, 240, // 0x60
+    200, 200, 240, 240, 240, 240, 200, 200, 200, 200, 200, 120, 120, 120, 120,  40, // 0x70
+    220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, // 0x80
+    220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, // 0x90
+    220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, // 0xA0
+    220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, // 0xB0
+     40,  40, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, // 0xC0
+    100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, // 0xD0
+    180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, // 0xE0
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40, // 0xF0
+};
+
+// 挑选模式中最罕见的字节 i1, 以及取值不同的次罕见字节 i2 (m >= 2)
+void choose_pair(const Byte* p, std::size_t m, std::size_t& i1, std::size_t& i2) {
+    i1 = 0;
+    int best = kByteRank[p[0]];
+    for (std::size_t i = 1; i < m; ++i) {
+        int r = kByteRank[p[i]];
+        if (r < best) {
+            best = r;
+            i1 = i;
+        }
+    }
+
+    const Byte b1 = p[i1];
+    i2 = knpos;
+    best = 256;
+    for (std::size_t i = 0; i < m; ++i) {
+        int r = kByteRank[p[i]];
+        if (p[i] != b1 && r < best) {
+            best = r;
+            i2 = i;
+        }
+    }
+    // 模式由同一字节重复构成
+    if (i2 == knpos) i2 = (i1 == m - 1) ? 0 : m - 1;
+}
+
+// Two-Way 的临界分解 (Crochemore-Perrin), 返回分解位置并写入周期
+// 分别按正序与逆序字典序求最大后缀, 取较长者
+template <class View>
+std::size_t critical_factorization(View p, std::size_t m, std::size_t& period) {
+    std::size_t ms = knpos; // 最大后缀起点 - 1, 初值相当于 -1
+    std::size_t j = 0;
+    std::size_t k = 1;
+    std::size_t per = 1;
+    while (j + k < m) {
+        Byte a = p[j + k];
+        Byte b = p[ms + k];
+        if (a < b) {
+            j += k;
+            k = 1;
+            per = j - ms;
+        } else if (a == b) {
+            if (k != per) {
+                ++k;
+            } else {
+                j += per;
+                k = 1;
+            }
+        } else {
+            ms = j++;
+            k = per = 1;
+        }
+    }
+    period = per;
+
+    std::size_t ms_rev = knpos;
+    j = 0;
+    k = per = 1;
+    while (j + k < m) {
+        Byte a = p[j + k];
+        Byte b = p[ms_rev + k];
+        if (b < a) {
+            j += k;
+            k = 1;
+            per = j - ms_rev;
+        } else if (a == b) {
+            if (k != per) {
+                ++k;
+            } else {
+                j += per;
+                k = 1;
+            }
+        } else {
+            ms_rev = j++;
+            k = per = 1;
+        }
+    }
+
+    if (ms_rev + 1 < ms + 1) return ms + 1;
+    period = per;
+    return ms_rev + 1;
+}
+
+struct TwoWayPlan {
+    std::size_t suffix; // 临界分解位置
+    std::size_t period;
+    bool periodic;
+};
+
+template <class View>
+TwoWayPlan plan_two_way(View p, std::size_t m) {
+    TwoWayPlan plan;
+    plan.suffix = critical_factorization(p, m, plan.period);
+    plan.periodic = true;
+    for (std::size_t i = 0; i < plan.suffix; ++i) {
+        if (p[i] != p[i + plan.period]) {
+            plan.periodic = false;
+            break;
+        }
+    }
+    if (! plan.periodic) plan.period = std::max(plan.suffix, m - plan.suffix) + 1;
+    return plan;
+}
+
+// Two-Way 正向查找, 实现参照 Crochemore-Perrin 原始算法 (与 glibc memmem 的短模式分支一致)
+// 调用方保证 2 <= m <= n
+template <class HView, class PView>
+std::size_t two_way_search(HView h, std::size_t n, PView p, std::size_t m, const TwoWayPlan& plan) {
+    const std::size_t suffix = plan.suffix;
+    const std::size_t period = plan.period;
+
+    std::size_t j = 0;
+    if (plan.periodic) {
+        // 周期模式: 记住上一轮已匹配的前缀长度, 避免重复比较
+        std::size_t memory = 0;
+        while (j + m <= n) {
+            std::size_t i = std::max(suffix, memory);
+            while (i < m && p[i] == h[i + j]) ++i;
+            if (i >= m) {
+                i = suffix - 1;
+                while (memory < i + 1 && p[i] == h[i + j]) --i;
+                if (i + 1 < memory + 1) return j;
+                j += period;
+                memory = m - period;
+            } else {
+                j += i - suffix + 1;
+                memory = 0;
+            }
+        }
+    } else {
+        while (j + m <= n) {
+            std::size_t i = suffix;
+            while (i < m && p[i] == h[i + j]) ++i;
+            if (i >= m) {
+                i = suffix - 1;
+                while (i != knpos && p[i] == h[i + j]) --i;
+                if (i == knpos) return j;
+                j += period;
+            } else {
+                j += i - suffix + 1;
+            }
+        }
+    }
+    return knpos;
+}
+
+// Two-Way 看到的字节序列: Reverse 时第 i 个字节为 base[size - 1 - i],
+// 逆向查找即在倒序的 hay 中正向查找倒序的模式
+template <bool Reverse>
+struct ByteView {
+    const Byte* base;
+    std::size_t size;
+
+    Byte operator[](std::size_t i) const {
+        return Reverse ? base[size - 1 - i] : base[i];
+    }
+};
+
+// 不依赖预处理的一次性 Two-Way, 供 packed pair / Horspool 超出校验预算后接手; 调用方保证 2 <= m <= n
+std::size_t two_way_find(const Byte* h, std::size_t n, const Byte* p, std::size_t m) {
+    const ByteView<false> pat = {p, m};
+    return two_way_search(ByteView<false>{h, n}, n, pat, m, plan_two_way(pat, m));
+}
+
+std::size_t two_way_rfind(const Byte* h, std::size_t n, const Byte* p, std::size_t m) {
+    const ByteView<true> pat = {p, m};
+    std::size_t j = two_way_search(ByteView<true>{h, n}, n, pat, m, plan_two_way(pat, m));
+    return j == knpos ? knpos : n - m - j;
+}
+
+// 候选校验的工作量上限: 累计比较的字节数超过已越过候选起点数的 VERIFY_FACTOR 倍 (另加 VERIFY_SLACK) 时放弃,
+// 改用线性的 Two-Way. 首末字节处处命中而中间失配的输入 (如在全 'a' 中找 'a…b…a') 因此不会退化为 O(n·m);
+// 普通文本中候选稀少且多在开头几个字节就失配, 不会触发
+const std::size_t VERIFY_FACTOR = 8;
+const std::size_t VERIFY_SLACK = 4096;
+const std::size_t VERIFY_BLOCK = 64;
+
+// pair / fold 内核超出校验预算时的返回值, 由 find_pair_with / rfind_pair_with / find_fold_with 转交 Two-Way
+const std::size_t PAIR_GAVE_UP = knpos - 1;
+
+struct Verifier {
+    const Byte* p;
+    std::size_t m;
+    std::size_t spent; // 已比较的字节数
+
+    // 与模式逐块比较, 只计入实际比较过的块
+    bool equal(const Byte* at) {
+        for (std::size_t i = 0; i < m; i += VERIFY_BLOCK) {
+            std::size_t len = std::min(VERIFY_BLOCK, m - i);
+            spent += len;
+            if (std::memcmp(at + i, p + i, len) != 0) return false;
+        }
+        return true;
+    }
+
+    // 已越过 scanned 个候选起点时是否超出预算
+    bool exhausted(std::size_t scanned) const {
+        return spent > VERIFY_FACTOR * scanned + VERIFY_SLACK;
+    }
+};
+
+// packed pair 查找: 候选起点 j 需满足 h[j + i1] == p[i1] 且 h[j + i2] == p[i2], 再整体比较
+// 调用方保证 2 <= m <= n; 校验超出预算时返回 PAIR_GAVE_UP
+typedef std::size_t (*PairFn)(const Byte*, std::size_t, const Byte*, std::size_t, std::size_t, std::size_t);
+
+// 正向校验候选起点 [j, count)
+inline std::size_t find_pair_tail(const Byte* h, std::size_t j, std::size_t count, const Byte* p, std::size_t i1,
+                                  std::size_t i2, Verifier& verify) {
+    for (; j < count; ++j) {
+        if (h[j + i1] != p[i1] || h[j + i2] != p[i2]) continue;
+        if (verify.equal(h + j)) return j;
+        if (verify.exhausted(j)) return PAIR_GAVE_UP;
+    }
+    return knpos;
+}
+
+// 逆向校验候选起点 [0, count), total 为全部候选起点数
+inline std::size_t rfind_pair_tail(const Byte* h, std::size_t count, std::size_t total, const Byte* p,
+                                   std::size_t i1, std::size_t i2, Verifier& verify) {
+    for (std::size_t j = count; j-- > 0;) {
+        if (h[j + i1] != p[i1] || h[j + i2] != p[i2]) continue;
+        if (verify.equal(h + j)) return j;
+        if (verify.exhausted(total - j)) return PAIR_GAVE_UP;
+    }
+    return knpos;
+}
+
+// 标量版本: memchr / memrchr 定位 p[i1] 的候选
+std::size_t find_pair_scalar(const Byte* h, std::size_t n, const Byte* p, std::size_t m, std::size_t i1,
+                             std::size_t i2) {
+    Verifier verify = {p, m, 0};
+    const std::size_t count = n - m + 1;
+    std::size_t j = 0;
+    while (j < count) {
+        std::size_t hit = find_byte(ByteSpan(h + j + i1, count - j), p[i1]);
+        if (hit == knpos) return knpos;
+        j += hit;
+        if (h[j + i2] == p[i2]) {
+            if (verify.equal(h + j)) return j;
+            if (verify.exhausted(j)) return PAIR_GAVE_UP;
+        }
+        ++j;
+    }
+    return knpos;
+}
+
+std::size_t rfind_pair_scalar(const Byte* h, std::size_t n, const Byte* p, std::size_t m, std::size_t i1,
+                              std::size_t i2) {
+    Verifier verify = {p, m, 0};
+    const std::size_t total = n - m + 1;
+    std::size_t count = total;
+    while (count > 0) {
+        std::size_t j = rfind_byte(ByteSpan(h + i1, count), p[i1]);
+        if (j == knpos) return knpos;
+        if (h[j + i2] == p[i2]) {
+            if (verify.equal(h + j)) return j;
+            if (verify.exhausted(total - j)) return PAIR_GAVE_UP;
+        }
+        count = j;
+    }
+    return knpos;
+}
+
+std::size_t find_pair_with(PairFn fn, ByteSpan hay, ByteSpan pat, std::size_t i1, std::size_t i2) {
+    std::size_t at = fn(hay.data(), hay.size(), pat.data(), pat.size(), i1, i2);
+    return at == PAIR_GAVE_UP ? two_way_find(hay.data(), hay.size(), pat.data(), pat.size()) : at;
+}
+
+std::size_t rfind_pair_with(PairFn fn, ByteSpan hay, ByteSpan pat, std::size_t i1, std::size_t i2) {
+    std::size_t at = fn(hay.data(), hay.size(), pat.data(), pat.size(), i1, i2);
+    return at == PAIR_GAVE_UP ? two_way_rfind(hay.data(), hay.size(), pat.data(), pat.size()) : at;
+}
+
+// 字节集合查找, 集合大小 k 在 [2, FIRST_OF_SIMD_MAX] 之间时由 SIMD 实现处理, 否则查表
+typedef std::size_t (*SetFn)(const Byte*, std::size_t, const Byte*, std::size_t);
+
+std::size_t find_first_of_table(const Byte* h, std::size_t n, const Byte* set, std::size_t k) {
+    bool table[256] = {};
+    for (std::size_t i = 0; i < k; ++i) table[set[i]] = true;
+    for (std::size_t j = 0; j < n; ++j) {
+        if (table[h[j]]) return j;
+    }
+    return knpos;
+}
+
+// ASCII 大小写折叠: 只把 A-Z 变为小写, 其余字节 (含非 ASCII) 保持原值
+inline Byte fold_ascii(Byte b) {
+    return static_cast<unsigned>(b - 'A') < 26u ? static_cast<Byte>(b | 0x20) : b;
+}
+
+// 8 字节一组的 SWAR 折叠: 最高位为 0 且低 7 位落在 [A, Z] 的字节或上 0x20
+inline std::uint64_t fold_ascii_word(std::uint64_t x) {
+    const std::uint64_t ones = 0x0101010101010101ull;
+    const std::uint64_t high = 0x8080808080808080ull;
+    std::uint64_t low7 = x & ~high;
+    std::uint64_t ge_a = low7 + (0x80 - 'A') * ones;
+    std::uint64_t gt_z = low7 + (0x7F - 'Z') * ones;
+    std::uint64_t upper = (ge_a ^ gt_z) & ~x & high;
+    return x | (upper >> 2);
+}
+
+// 忽略 ASCII 大小写比较等长的两段字节; 查找先以折叠后的首末字节过滤候选, 命中再整体比较
+// 调用方保证 find 的 2 <= m <= n
+typedef bool (*EqualFoldFn)(const Byte*, const Byte*, std::size_t);
+typedef std::size_t (*FindFoldFn)(const Byte*, std::size_t, const Byte*, std::size_t);
+
+bool equal_fold_scalar(const Byte* a, const Byte* b, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t x;
+        std::uint64_t y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        if (x != y && fold_ascii_word(x) != fold_ascii_word(y)) return false;
+    }
+    for (; i < n; ++i) {
+        if (fold_ascii(a[i]) != fold_ascii(b[i])) return false;
+    }
+    return true;
+}
+
+// 折叠后的字节序列: 在 FoldView 上做 Two-Way 即忽略 ASCII 大小写的线性查找
+struct FoldView {
+    const Byte* base;
+
+    Byte operator[](std::size_t i) const {
+        return fold_ascii(base[i]);
+    }
+};
+
+// 折叠查找超出校验预算后接手; 调用方保证 2 <= m <= n
+std::size_t two_way_find_fold(const Byte* h, std::size_t n, const Byte* p, std::size_t m) {
+    const FoldView pat = {p};
+    return two_way_search(FoldView{h}, n, pat, m, plan_two_way(pat, m));
+}
+
+// 同 Verifier, 逐块以折叠比较校验候选, 预算规则相同
+struct FoldVerifier {
+    const Byte* p;
+    std::size_t m;
+    EqualFoldFn eq;
+    std::size_t spent;
+
+    bool equal(const Byte* at) {
+        for (std::size_t i = 0; i < m; i += VERIFY_BLOCK) {
+            std::size_t len = std::min(VERIFY_BLOCK, m - i);
+            spent += len;
+            if (! eq(at + i, p + i, len)) return false;
+        }
+        return true;
+    }
+
+    bool exhausted(std::size_t scanned) const {
+        return spent > VERIFY_FACTOR * scanned + VERIFY_SLACK;
+    }
+};
+
+// 逐个校验候选起点 [j, count); 超出校验预算时返回 PAIR_GAVE_UP
+inline std::size_t find_fold_tail(const Byte* h, std::size_t j, std::size_t count, const Byte* p, std::size_t m,
+                                  FoldVerifier& verify) {
+    const Byte first = fold_ascii(p[0]);
+    const Byte last = fold_ascii(p[m - 1]);
+    for (; j < count; ++j) {
+        if (fold_ascii(h[j]) != first || fold_ascii(h[j + m - 1]) != last) continue;
+        if (verify.equal(h + j)) return j;
+        if (verify.exhausted(j)) return PAIR_GAVE_UP;
+    }
+    return knpos;
+}
+
+std::size_t find_fold_scalar(const Byte* h, std::size_t n, const Byte* p, std::size_t m) {
+    FoldVerifier verify = {p, m, equal_fold_scalar, 0};
+    return find_fold_tail(h, 0, n - m + 1, p, m, verify);
+}
+
+// 批量查找: 把 [from, n - m] 中非重叠的匹配起点依次写入 out, 写满 cap 个即停止
+// 调用方保证 1 <= m <= n, from <= n - m + 1, cap > 0
+typedef std::size_t (*ManyFn)(const Byte*, std::size_t, const Byte*, std::size_t, std::size_t, std::size_t*,
+                              std::size_t);
+
+struct ManySink {
+    const Byte* h;
+    std::size_t n;
+    const Byte* p;
+    std::size_t m;
+    std::size_t from;
+    std::size_t next; // 下一个允许的起点, 保证匹配互不重叠
+    std::size_t* out;
+    std::size_t cap;
+    std::size_t count;
+    Verifier verify; // 只比较首末之间的字节
+
+    ManySink(const Byte* hay, std::size_t hay_len, const Byte* pat, std::size_t pat_len, std::size_t start,
+             std::size_t* dst, std::size_t dst_cap)
+        : h(hay), n(hay_len), p(pat), m(pat_len), from(start), next(start), out(dst), cap(dst_cap), count(0),
+          verify{pat + 1, pat_len > 2 ? pat_len - 2 : 0, 0} {}
+
+    // 首末字节已经命中的候选, 校验中间字节后写出; 返回 true 表示查找已结束 (out 已满或已由 Two-Way 接手)
+    bool accept(std::size_t j) {
+        if (j < next) return false;
+        if (! verify.equal(h + j + 1)) {
+            if (! verify.exhausted(j - from)) return false;
+            finish_two_way(j);
+            return true;
+        }
+        out[count++] = j;
+        next = j + m;
+        return count == cap;
+    }
+
+    // 超出校验预算: 从候选起点 j 开始用 Two-Way 找出其余的匹配 (此时 m > 2)
+    void finish_two_way(std::size_t j) {
+        const ByteView<false> pat = {p, m};
+        const TwoWayPlan plan = plan_two_way(pat, m);
+        while (count < cap && j + m <= n) {
+            std::size_t hit = two_way_search(ByteView<false>{h + j, n - j}, n - j, pat, m, plan);
+            if (hit == knpos) return;
+            out[count++] = j + hit;
+            j += hit + m;
+        }
+    }
+
+    // mask 的第 k 位对应候选起点 base + k
+    bool accept_mask(std::size_t base, std::uint64_t mask) {
+        while (mask != 0) {
+            std::size_t j = base + static_cast<std::size_t>(__builtin_ctzll(mask));
+            mask &= mask - 1;
+            if (accept(j)) return true;
+        }
+        return false;
+    }
+
+    // 逐个校验候选起点 [j, count_end)
+    void scan_tail(std::size_t j, std::size_t count_end) {
+        for (; j < count_end; ++j) {
+            if (h[j] == p[0] && h[j + m - 1] == p[m - 1] && accept(j)) return;
+        }
+    }
+};
+
+std::size_t find_many_scalar(const Byte* h, std::size_t n, const Byte* p, std::size_t m, std::size_t from,
+                             std::size_t* out, std::size_t cap) {
+    ManySink sink(h, n, p, m, from, out, cap);
+    const std::size_t count = n - m + 1;
+    std::size_t j = from;
+    while (j < count) {
+        std::size_t hit = find_byte(ByteSpan(h + j, count - j), p[0]);
+        if (hit == knpos) break;
+        j += hit;
+        if (h[j + m - 1] == p[m - 1] && sink.accept(j)) break;
+        j = std::max(j + 1, sink.next);
+    }
+    return sink.count;
+}
+
+#ifdef KSTRING_SEARCH_X86
+// 每块 16 个候选起点, 两个过滤字节都命中的位置才做 memcmp
+__attribute__((target("sse2"))) std::size_t find_pair_sse2(const Byte* h, std::size_t n, const Byte* p,
+                                                            std::size_t m, std::size_t i1, std::size_t i2) {
+    const __m128i v1 = _mm_set1_epi8(static_cast<char>(p[i1]));
+    const __m128i v2 = _mm_set1_epi8(static_cast<char>(p[i2]));
+    Verifier verify = {p, m, 0};
+    const std::size_t count = n - m + 1;
+    std::size_t j = 0;
+    for (; j + 16 <= count; j += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j + i1));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j + i2));
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(a, v1), _mm_cmpeq_epi8(b, v2));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (verify.equal(h + j + bit)) return j + bit;
+            if (verify.exhausted(j + bit)) return PAIR_GAVE_UP;
+            mask &= mask - 1;
+        }
+    }
+    return find_pair_tail(h, j, count, p, i1, i2, verify);
+}
+
+__attribute__((target("sse2"))) std::size_t rfind_pair_sse2(const Byte* h, std::size_t n, const Byte* p,
+                                                             std::size_t m, std::size_t i1, std::size_t i2) {
+    const __m128i v1 = _mm_set1_epi8(static_cast<char>(p[i1]));
+    const __m128i v2 = _mm_set1_epi8(static_cast<char>(p[i2]));
+    Verifier verify = {p, m, 0};
+    const std::size_t total = n - m + 1;
+    std::size_t count = total;
+    while (count >= 16) {
+        std::size_t j = count - 16;
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j + i1));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j + i2));
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(a, v1), _mm_cmpeq_epi8(b, v2));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        // 从高位 (靠后的位置) 往低位校验
+        while (mask != 0) {
+            unsigned bit = 31u - static_cast<unsigned>(__builtin_clz(mask));
+            if (verify.equal(h + j + bit)) return j + bit;
+            if (verify.exhausted(total - j - bit)) return PAIR_GAVE_UP;
+            mask &= ~(1u << bit);
+        }
+        count = j;
+    }
+    return rfind_pair_tail(h, count, total, p, i1, i2, verify);
+}
+
+// 同 sse2 版本, 每块 32 个候选起点
+__attribute__((target("avx2"))) std::size_t find_pair_avx2(const Byte* h, std::size_t n, const Byte* p,
+                                                            std::size_t m, std::size_t i1, std::size_t i2) {
+    const __m256i v1 = _mm256_set1_epi8(static_cast<char>(p[i1]));
+    const __m256i v2 = _mm256_set1_epi8(static_cast<char>(p[i2]));
+    Verifier verify = {p, m, 0};
+    const std::size_t count = n - m + 1;
+    std::size_t j = 0;
+    for (; j + 32 <= count; j += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j + i1));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j + i2));
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(a, v1), _mm256_cmpeq_epi8(b, v2));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (verify.equal(h + j + bit)) return j + bit;
+            if (verify.exhausted(j + bit)) return PAIR_GAVE_UP;
+            mask &= mask - 1;
+        }
+    }
+    return find_pair_tail(h, j, count, p, i1, i2, verify);
+}
+
+__attribute__((target("avx2"))) std::size_t rfind_pair_avx2(const Byte* h, std::size_t n, const Byte* p,
+                                                             std::size_t m, std::size_t i1, std::size_t i2) {
+    const __m256i v1 = _mm256_set1_epi8(static_cast<char>(p[i1]));
+    const __m256i v2 = _mm256_set1_epi8(static_cast<char>(p[i2]));
+    Verifier verify = {p, m, 0};
+    const std::size_t total = n - m + 1;
+    std::size_t count = total;
+    while (count >= 32) {
+        std::size_t j = count - 32;
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j + i1));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j + i2));
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(a, v1), _mm256_cmpeq_epi8(b, v2));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        while (mask != 0) {
+            unsigned bit = 31u - static_cast<unsigned>(__builtin_clz(mask));
+            if (verify.equal(h + j + bit)) return j + bit;
+            if (verify.exhausted(total - j - bit)) return PAIR_GAVE_UP;
+            mask &= ~(1u << bit);
+        }
+        count = j;
+    }
+    return rfind_pair_tail(h, count, total, p, i1, i2, verify);
+}
+
+// 每个集合字节一次 cmpeq, 结果按位或; 集合至多 FIRST_OF_SIMD_MAX 个字节
+__attribute__((target("sse2"))) std::size_t find_first_of_sse2(const Byte* h, std::size_t n, const Byte* set,
+                                                                std::size_t k) {
+    __m128i vs[FIRST_OF_SIMD_MAX];
+    for (std::size_t i = 0; i < k; ++i) vs[i] = _mm_set1_epi8(static_cast<char>(set[i]));
+    std::size_t j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j));
+        __m128i eq = _mm_cmpeq_epi8(a, vs[0]);
+        for (std::size_t i = 1; i < k; ++i) eq = _mm_or_si128(eq, _mm_cmpeq_epi8(a, vs[i]));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        if (mask != 0) return j + static_cast<unsigned>(__builtin_ctz(mask));
+    }
+    std::size_t tail = find_first_of_table(h + j, n - j, set, k);
+    return tail == knpos ? knpos : j + tail;
+}
+
+__attribute__((target("avx2"))) std::size_t find_first_of_avx2(const Byte* h, std::size_t n, const Byte* set,
+                                                                std::size_t k) {
+    __m256i vs[FIRST_OF_SIMD_MAX];
+    for (std::size_t i = 0; i < k; ++i) vs[i] = _mm256_set1_epi8(static_cast<char>(set[i]));
+    std::size_t j = 0;
+    for (; j + 32 <= n; j += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j));
+        __m256i eq = _mm256_cmpeq_epi8(a, vs[0]);
+        for (std::size_t i = 1; i < k; ++i) eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(a, vs[i]));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        if (mask != 0) return j + static_cast<unsigned>(__builtin_ctz(mask));
+    }
+    std::size_t tail = find_first_of_table(h + j, n - j, set, k);
+    return tail == knpos ? knpos : j + tail;
+}
+
+// 每步 64 个候选起点: 4 组 16 字节比较首字节与末字节, 拼成 64 位候选位图
+__attribute__((target("sse2"))) std::size_t find_many_sse2(const Byte* h, std::size_t n, const Byte* p,
+                                                            std::size_t m, std::size_t from, std::size_t* out,
+                                                            std::size_t cap) {
+    ManySink sink(h, n, p, m, from, out, cap);
+    const __m128i first = _mm_set1_epi8(static_cast<char>(p[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(p[m - 1]));
+    const std::size_t count = n - m + 1;
+    std::size_t j = from;
+    for (; j + 64 <= count; j += 64) {
+        std::uint64_t mask = 0;
+        for (std::size_t k = 0; k < 64; k += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j + k));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j + k + m - 1));
+            __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last));
+            mask |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(eq))) << k;
+        }
+        if (mask != 0 && sink.accept_mask(j, mask)) return sink.count;
+    }
+    sink.scan_tail(j, count);
+    return sink.count;
+}
+
+// 每步 64 个候选起点: 2 组 32 字节比较
+__attribute__((target("avx2"))) std::size_t find_many_avx2(const Byte* h, std::size_t n, const Byte* p,
+                                                            std::size_t m, std::size_t from, std::size_t* out,
+                                                            std::size_t cap) {
+    ManySink sink(h, n, p, m, from, out, cap);
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(p[0]));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(p[m - 1]));
+    const std::size_t count = n - m + 1;
+    std::size_t j = from;
+    for (; j + 64 <= count; j += 64) {
+        __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j));
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j + m - 1));
+        __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j + 32));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j + 32 + m - 1));
+        __m256i eq0 = _mm256_and_si256(_mm256_cmpeq_epi8(a0, first), _mm256_cmpeq_epi8(b0, last));
+        __m256i eq1 = _mm256_and_si256(_mm256_cmpeq_epi8(a1, first), _mm256_cmpeq_epi8(b1, last));
+        std::uint64_t mask = static_cast<std::uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(eq0))) |
+                             static_cast<std::uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(eq1))) << 32;
+        if (mask != 0 && sink.accept_mask(j, mask)) return sink.count;
+    }
+    sink.scan_tail(j, count);
+    return sink.count;
+}
+
+// 折叠 A-Z: v - 'A' <= 25 (无符号) 的字节或上 0x20
+__attribute__((target("sse2"))) inline __m128i fold_sse2(__m128i v) {
+    __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('A'));
+    __m128i upper = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(25)), d);
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+__attribute__((target("sse2"))) inline bool equal_fold_block_sse2(const Byte* a, const Byte* b) {
+    __m128i x = fold_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+    __m128i y = fold_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) == 0xFFFF;
+}
+
+// 不足 16 字节走 SWAR; 否则 16 字节一块, 最后一块与前一块重叠, 不再逐字节收尾
+__attribute__((target("sse2"))) bool equal_fold_sse2(const Byte* a, const Byte* b, std::size_t n) {
+    if (n < 16) return equal_fold_scalar(a, b, n);
+    for (std::size_t i = 0; i + 16 < n; i += 16) {
+        if (! equal_fold_block_sse2(a + i, b + i)) return false;
+    }
+    return equal_fold_block_sse2(a + n - 16, b + n - 16);
+}
+
+// 每块 16 个候选起点, 折叠后的首字节与末字节都命中才整体比较
+__attribute__((target("sse2"))) std::size_t find_fold_sse2(const Byte* h, std::size_t n, const Byte* p,
+                                                            std::size_t m) {
+    const __m128i first = _mm_set1_epi8(static_cast<char>(fold_ascii(p[0])));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(fold_ascii(p[m - 1])));
+    FoldVerifier verify = {p, m, equal_fold_sse2, 0};
+    const std::size_t count = n - m + 1;
+    std::size_t j = 0;
+    for (; j + 16 <= count; j += 16) {
+        __m128i a = fold_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j)));
+        __m128i b = fold_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + j + m - 1)));
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (verify.equal(h + j + bit)) return j + bit;
+            if (verify.exhausted(j + bit)) return PAIR_GAVE_UP;
+            mask &= mask - 1;
+        }
+    }
+    return find_fold_tail(h, j, count, p, m, verify);
+}
+
+__attribute__((target("avx2"))) inline __m256i fold_avx2(__m256i v) {
+    __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('A'));
+    __m256i upper = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(25)), d);
+    return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2"))) inline bool equal_fold_block_avx2(const Byte* a, const Byte* b) {
+    __m256i x = fold_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)));
+    __m256i y = fold_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)));
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) == -1;
+}
+
+__attribute__((target("avx2"))) bool equal_fold_avx2(const Byte* a, const Byte* b, std::size_t n) {
+    if (n < 32) return equal_fold_sse2(a, b, n);
+    for (std::size_t i = 0; i + 32 < n; i += 32) {
+        if (! equal_fold_block_avx2(a + i, b + i)) return false;
+    }
+    return equal_fold_block_avx2(a + n - 32, b + n - 32);
+}
+
+// 同 sse2 版本, 每块 32 个候选起点
+__attribute__((target("avx2"))) std::size_t find_fold_avx2(const Byte* h, std::size_t n, const Byte* p,
+                                                            std::size_t m) {
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(fold_ascii(p[0])));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(fold_ascii(p[m - 1])));
+    FoldVerifier verify = {p, m, equal_fold_avx2, 0};
+    const std::size_t count = n - m + 1;
+    std::size_t j = 0;
+    for (; j + 32 <= count; j += 32) {
+        __m256i a = fold_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j)));
+        __m256i b = fold_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + j + m - 1)));
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (verify.equal(h + j + bit)) return j + bit;
+            if (verify.exhausted(j + bit)) return PAIR_GAVE_UP;
+            mask &= mask - 1;
+        }
+    }
+    return find_fold_tail(h, j, count, p, m, verify);
+}
+#endif
+
+struct Backend {
+    const char* name;
+    bool simd;
+    PairFn find_pair;
+    PairFn rfind_pair;
+    SetFn find_first_of;
+    ManyFn find_many;
+    EqualFoldFn equal_fold;
+    FindFoldFn find_fold;
+};
+
+Backend select_backend() {
+#ifdef KSTRING_SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Backend{"avx2", true, find_pair_avx2, rfind_pair_avx2,
+                       find_first_of_avx2, find_many_avx2, equal_fold_avx2, find_fold_avx2};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return Backend{"sse2", true, find_pair_sse2, rfind_pair_sse2,
+                       find_first_of_sse2, find_many_sse2, equal_fold_sse2, find_fold_sse2};
+    }
+#endif
+    return Backend{"scalar", false, find_pair_scalar, rfind_pair_scalar, find_first_of_table, find_many_scalar,
+                   equal_fold_scalar, find_fold_scalar};
+}
+
+// 首次调用时探测一次 CPU 特性
+const Backend& backend() {
+    static const Backend selected = select_backend();
+    return selected;
+}
+
+std::size_t find_many_with(ManyFn fn, ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out,
+                           std::size_t cap) {
+    if (pat.empty()) {
+        throw std::invalid_argument("search::find_many with empty pattern is not allowed");
+    }
+    if (cap == 0 || pat.size() > hay.size() || from > hay.size() - pat.size()) return 0;
+    return fn(hay.data(), hay.size(), pat.data(), pat.size(), from, out, cap);
+}
+
+bool equal_fold_with(EqualFoldFn fn, ByteSpan a, ByteSpan b) {
+    if (a.size() != b.size()) return false;
+    if (a.empty()) return true;
+    return fn(a.data(), b.data(), a.size());
+}
+
+// 单字节模式: 字母查大小写两个字节, 其余字节直接 memchr; 多字节模式超出校验预算时改用折叠的 Two-Way
+std::size_t find_fold_with(FindFoldFn fn, ByteSpan hay, ByteSpan pat) {
+    if (pat.empty()) return 0;
+    if (pat.size() > hay.size()) return knpos;
+    if (pat.size() == 1) {
+        const Byte b = pat[0];
+        const Byte other = static_cast<Byte>(b ^ 0x20);
+        if (fold_ascii(b) != fold_ascii(other)) return find_byte(hay, b);
+        const Byte both[2] = {b, other};
+        return find_first_of(hay, ByteSpan(both, 2));
+    }
+    std::size_t at = fn(hay.data(), hay.size(), pat.data(), pat.size());
+    return at == PAIR_GAVE_UP ? two_way_find_fold(hay.data(), hay.size(), pat.data(), pat.size()) : at;
+}
+} // namespace
+
+std::size_t find_byte(ByteSpan hay, Byte b) {
+    if (hay.empty()) return knpos;
+    const void* where = std::memchr(hay.data(), b, hay.size());
+    return where ? static_cast<std::size_t>(static_cast<const Byte*>(where) - hay.data()) : knpos;
+}
+
+std::size_t rfind_byte(ByteSpan hay, Byte b) {
+    if (hay.empty()) return knpos;
+#if defined(__GLIBC__)
+    const void* where = ::memrchr(hay.data(), b, hay.size());
+    return where ? static_cast<std::size_t>(static_cast<const Byte*>(where) - hay.data()) : knpos;
+#else
+    for (std::size_t i = hay.size(); i-- > 0;) {
+        if (hay[i] == b) return i;
+    }
+    return knpos;
+#endif
+}
+
+// 一次性查找不做罕见字节分析 (其开销与短 hay 上的查找本身相当), 直接以首末字节作为过滤条件
+std::size_t find(ByteSpan hay, ByteSpan pat) {
+    if (pat.empty()) return 0;
+    if (pat.size() > hay.size()) return knpos;
+    if (pat.size() == 1) return find_byte(hay, pat[0]);
+
+    return find_pair_with(backend().find_pair, hay, pat, 0, pat.size() - 1);
+}
+
+std::size_t rfind(ByteSpan hay, ByteSpan pat) {
+    if (pat.empty()) return hay.size(); // 表示末尾插入位置
+    if (pat.size() > hay.size()) return knpos;
+    if (pat.size() == 1) return rfind_byte(hay, pat[0]);
+
+    return rfind_pair_with(backend().rfind_pair, hay, pat, 0, pat.size() - 1);
+}
+
+std::size_t find_first_of(ByteSpan hay, ByteSpan set) {
+    if (hay.empty() || set.empty()) return knpos;
+    if (set.size() == 1) return find_byte(hay, set[0]);
+    if (set.size() <= FIRST_OF_SIMD_MAX) return backend().find_first_of(hay.data(), hay.size(), set.data(), set.size());
+    return find_first_of_table(hay.data(), hay.size(), set.data(), set.size());
+}
+
+std::size_t find_many(ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out, std::size_t cap) {
+    return find_many_with(backend().find_many, hay, pat, from, out, cap);
+}
+
+std::size_t replace(ByteSpan hay, ByteSpan pat, ByteSpan with, ByteVec& out, std::size_t limit) {
+    const std::size_t base = out.size();
+    if (pat.empty() || limit == 0 || pat.size() > hay.size()) {
+        out.insert(out.end(), hay.begin(), hay.end());
+        return 0;
+    }
+
+    // next_batch 按批取出位置, from 为下一次查找的起点; emit 写出 at 之前未写的原文与替换串, 返回写到的末尾
+    const std::size_t BATCH = 128;
+    std::size_t found[BATCH];
+    std::size_t count = 0;
+    std::size_t from = 0;
+    auto next_batch = [&]() {
+        std::size_t n = find_many(hay, pat, from, found, std::min(BATCH, limit - count));
+        if (n != 0) from = found[n - 1] + pat.size();
+        return n;
+    };
+    std::size_t copied = 0; // hay 中已写出的字节
+    auto emit = [&](Byte* dst, std::size_t at) {
+        std::memcpy(dst, hay.data() + copied, at - copied);
+        dst += at - copied;
+        if (! with.empty()) std::memcpy(dst, with.data(), with.size());
+        copied = at + pat.size();
+        return dst + with.size();
+    };
+
+    if (with.size() <= pat.size()) {
+        // 不会变长: 按上界预留一次, 边找边写, 最后截掉多余部分
+        out.resize(base + hay.size());
+        Byte* dst = out.data() + base;
+        while (count < limit) {
+            std::size_t n = next_batch();
+            if (n == 0) break;
+            for (std::size_t i = 0; i < n; ++i) dst = emit(dst, found[i]);
+            count += n;
+        }
+        std::memcpy(dst, hay.data() + copied, hay.size() - copied);
+        out.resize(static_cast<std::size_t>(dst - out.data()) + hay.size() - copied);
+        return count;
+    }
+
+    // 会变长: 先收集全部位置得出准确长度, 输出只分配一次
+    std::vector<std::size_t> positions;
+    while (count < limit) {
+        std::size_t n = next_batch();
+        if (n == 0) break;
+        positions.insert(positions.end(), found, found + n);
+        count += n;
+    }
+    out.resize(base + hay.size() + count * (with.size() - pat.size()));
+    Byte* dst = out.data() + base;
+    for (std::size_t at : positions) dst = emit(dst, at);
+    std::memcpy(dst, hay.data() + copied, hay.size() - copied);
+    return count;
+}
+
+bool equal_ignore_ascii_case(ByteSpan a, ByteSpan b) {
+    return equal_fold_with(backend().equal_fold, a, b);
+}
+
+std::size_t find_ignore_ascii_case(ByteSpan hay, ByteSpan pat) {
+    return find_fold_with(backend().find_fold, hay, pat);
+}
+
+std::size_t hash_ignore_ascii_case(ByteSpan s) {
+    // 与 fnv1a_hash 相同的 FNV-1a, 输入换成折叠后的字节, 8 字节一组用 SWAR 折叠
+    std::size_t h = 14695981039346656037ull;
+    std::size_t i = 0;
+    for (; i + 8 <= s.size(); i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, s.data() + i, 8);
+        word = fold_ascii_word(word);
+        Byte folded[8];
+        std::memcpy(folded, &word, 8);
+        for (Byte b : folded) {
+            h ^= b;
+            h *= 1099511628211ull;
+        }
+    }
+    for (; i < s.size(); ++i) {
+        h ^= fold_ascii(s[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+const char* simd_backend() {
+    return backend().name;
+}
+
+Searcher::Searcher(ByteSpan needle)
+    : needle_(needle.begin(), needle.end()), algo_(Algorithm::Empty), rare1_(0), rare2_(0), tw_suffix_(0),
+      tw_period_(0), tw_periodic_(false), shift_(), rshift_() {
+    const std::size_t m = needle_.size();
+    if (m == 0) {
+        algo_ = Algorithm::Empty;
+    } else if (m == 1) {
+        algo_ = Algorithm::Byte;
+    } else if (m <= PACKED_PAIR_MAX) {
+        algo_ = backend().simd ? Algorithm::PackedPair : Algorithm::TwoWay;
+    } else {
+        algo_ = Algorithm::Horspool;
+    }
+    compile();
+}
+
+Searcher::Searcher(ByteSpan needle, Algorithm algo)
+    : needle_(needle.begin(), needle.end()), algo_(algo), rare1_(0), rare2_(0), tw_suffix_(0), tw_period_(0),
+      tw_periodic_(false), shift_(), rshift_() {
+    const std::size_t m = needle_.size();
+    bool ok = (algo == Algorithm::Empty && m == 0) || (algo == Algorithm::Byte && m == 1) ||
+              (algo != Algorithm::Empty && algo != Algorithm::Byte && m >= 2);
+    if (! ok) throw std::invalid_argument("Searcher: algorithm does not fit needle length");
+    compile();
+}
+
+const char* Searcher::algorithm_name(Algorithm algo) {
+    switch (algo) {
+    case Algorithm::Empty: return "empty";
+    case Algorithm::Byte: return "memchr";
+    case Algorithm::PackedPair: return "packed-pair";
+    case Algorithm::TwoWay: return "two-way";
+    case Algorithm::Horspool: return "horspool";
+    }
+    return "unknown";
+}
+
+void Searcher::compile() {
+    const std::size_t m = needle_.size();
+    if (m < 2) return;
+
+    const Byte* p = needle_.data();
+    // 逆向查找在 packed pair 与 Two-Way 下都使用双字节过滤
+    choose_pair(p, m, rare1_, rare2_);
+
+    if (algo_ == Algorithm::TwoWay || algo_ == Algorithm::Horspool) {
+        // Horspool 超出校验预算后同样交给 Two-Way
+        const TwoWayPlan plan = plan_two_way(ByteView<false>{p, m}, m);
+        tw_suffix_ = plan.suffix;
+        tw_period_ = plan.period;
+        tw_periodic_ = plan.periodic;
+    }
+    if (algo_ == Algorithm::Horspool) {
+        // 正向: 窗口末字节决定跳转; 逆向: 窗口首字节决定跳转
+        shift_.assign(256, m);
+        for (std::size_t i = 0; i + 1 < m; ++i) shift_[p[i]] = m - 1 - i;
+        rshift_.assign(256, m);
+        for (std::size_t i = m - 1; i > 0; --i) rshift_[p[i]] = i;
+    }
+}
+
+std::size_t Searcher::find(ByteSpan hay) const {
+    const std::size_t m = needle_.size();
+    if (m == 0) return 0;
+    if (m > hay.size()) return knpos;
+
+    switch (algo_) {
+    case Algorithm::Empty: return 0;
+    case Algorithm::Byte: return find_byte(hay, needle_[0]);
+    case Algorithm::PackedPair:
+        return find_pair_with(backend().find_pair, hay, needle(), rare1_, rare2_);
+    case Algorithm::TwoWay: return find_two_way(hay);
+    case Algorithm::Horspool: return find_horspool(hay);
+    }
+    return knpos;
+}
+
+std::size_t Searcher::rfind(ByteSpan hay) const {
+    const std::size_t m = needle_.size();
+    if (m == 0) return hay.size();
+    if (m > hay.size()) return knpos;
+
+    switch (algo_) {
+    case Algorithm::Empty: return hay.size();
+    case Algorithm::Byte: return rfind_byte(hay, needle_[0]);
+    case Algorithm::PackedPair:
+    case Algorithm::TwoWay:
+        return rfind_pair_with(backend().rfind_pair, hay, needle(), rare1_, rare2_);
+    case Algorithm::Horspool: return rfind_horspool(hay);
+    }
+    return knpos;
+}
+
+std::size_t Searcher::count(ByteSpan hay) const {
+    const std::size_t m = needle_.size();
+    if (m == 0) return hay.size() + 1;
+
+    std::size_t n = 0;
+    std::size_t pos = 0;
+    while (pos + m <= hay.size()) {
+        std::size_t found = find(hay.subspan(pos));
+        if (found == knpos) break;
+        ++n;
+        pos += found + m;
+    }
+    return n;
+}
+
+std::size_t Searcher::find_two_way(ByteSpan hay) const {
+    const TwoWayPlan plan = {tw_suffix_, tw_period_, tw_periodic_};
+    const ByteView<false> pat = {needle_.data(), needle_.size()};
+    return two_way_search(ByteView<false>{hay.data(), hay.size()}, hay.size(), pat, pat.size, plan);
+}
+
+std::size_t Searcher::find_horspool(ByteSpan hay) const {
+    const Byte* h = hay.data();
+    const Byte* p = needle_.data();
+    const std::size_t n = hay.size();
+    const std::size_t m = needle_.size();
+    const Byte last = p[m - 1];
+    Verifier verify = {p, m - 1, 0};
+
+    std::size_t j = 0;
+    while (j + m <= n) {
+        Byte c = h[j + m - 1];
+        if (c == last) {
+            if (verify.equal(h + j)) return j;
+            if (verify.exhausted(j)) return find_two_way(hay);
+        }
+        j += shift_[c];
+    }
+    return knpos;
+}
+
+std::size_t Searcher::rfind_horspool(ByteSpan hay) const {
+    const Byte* h = hay.data();
+    const Byte* p = needle_.data();
+    const std::size_t m = needle_.size();
+    Verifier verify = {p + 1, m - 1, 0};
+
+    const std::size_t last = hay.size() - m;
+    std::size_t j = last;
+    while (true) {
+        Byte c = h[j];
+        if (c == p[0]) {
+            if (verify.equal(h + j + 1)) return j;
+            if (verify.exhausted(last - j)) return two_way_rfind(h, hay.size(), p, m);
+        }
+        std::size_t s = rshift_[c];
+        if (j < s) break;
+        j -= s;
+    }
+    return knpos;
+}
+
+namespace detail {
+std::size_t rfind_scalar(ByteSpan hay, ByteSpan pat) {
+    if (pat.empty()) return hay.size();
+    if (pat.size() > hay.size()) return knpos;
+    if (pat.size() == 1) return rfind_byte(hay, pat[0]);
+
+    return rfind_pair_with(rfind_pair_scalar, hay, pat, 0, pat.size() - 1);
+}
+
+std::size_t find_many_scalar(ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out, std::size_t cap) {
+    return find_many_with(search::find_many_scalar, hay, pat, from, out, cap);
+}
+
+bool equal_ignore_ascii_case_scalar(ByteSpan a, ByteSpan b) {
+    return equal_fold_with(equal_fold_scalar, a, b);
+}
+
+std::size_t find_ignore_ascii_case_scalar(ByteSpan hay, ByteSpan pat) {
+    return find_fold_with(find_fold_scalar, hay, pat);
+}
+
+#ifdef KSTRING_SEARCH_X86
+std::size_t rfind_sse2(ByteSpan hay, ByteSpan pat) {
+    if (pat.empty()) return hay.size();
+    if (pat.size() > hay.size()) return knpos;
+    if (pat.size() == 1) return rfind_byte(hay, pat[0]);
+
+    return rfind_pair_with(rfind_pair_sse2, hay, pat, 0, pat.size() - 1);
+}
+
+std::size_t rfind_avx2(ByteSpan hay, ByteSpan pat) {
+    if (pat.empty()) return hay.size();
+    if (pat.size() > hay.size()) return knpos;
+    if (pat.size() == 1) return rfind_byte(hay, pat[0]);
+
+    return rfind_pair_with(rfind_pair_avx2, hay, pat, 0, pat.size() - 1);
+}
+
+std::size_t find_many_sse2(ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out, std::size_t cap) {
+    return find_many_with(search::find_many_sse2, hay, pat, from, out, cap);
+}
+
+std::size_t find_many_avx2(ByteSpan hay, ByteSpan pat, std::size_t from, std::size_t* out, std::size_t cap) {
+    return find_many_with(search::find_many_avx2, hay, pat, from, out, cap);
+}
+
+bool equal_ignore_ascii_case_sse2(ByteSpan a, ByteSpan b) {
+    return equal_fold_with(equal_fold_sse2, a, b);
+}
+
+bool equal_ignore_ascii_case_avx2(ByteSpan a, ByteSpan b) {
+    return equal_fold_with(equal_fold_avx2, a, b);
+}
+
+std::size_t find_ignore_ascii_case_sse2(ByteSpan hay, ByteSpan pat) {
+    return find_fold_with(find_fold_sse2, hay, pat);
+}
+
+std::size_t find_ignore_ascii_case_avx2(ByteSpan hay, ByteSpan pat) {
+    return find_fold_with(find_fold_avx2, hay, pat);
+}
+#endif
+} // namespace detail
+} // namespace search
+} // namespace kstring
@@ -0,0 +1,544 @@
+#include "segmentation.hpp"
+#include "unicode.hpp"
+#include "utf8.hpp"
+
+namespace kstring {
+namespace unicode {
+namespace {
+const std::uint8_t PICT = tables::GCB_EXTENDED_PICTOGRAPHIC;
+
+constexpr unsigned bit(GraphemeBreak g) {
+    return 1u << static_cast<unsigned>(g);
+}
+
+inline unsigned gcb_bit(std::uint8_t record) {
+    return 1u << (record & tables::GCB_BITS);
+}
+
+const unsigned CONTROLS = bit(GraphemeBreak::CR) | bit(GraphemeBreak::LF) | bit(GraphemeBreak::Control);
+const unsigned HANGUL_AFTER_L =
+    bit(GraphemeBreak::L) | bit(GraphemeBreak::V) | bit(GraphemeBreak::LV) | bit(GraphemeBreak::LVT);
+const unsigned NO_BREAK_BEFORE = bit(GraphemeBreak::Extend) | bit(GraphemeBreak::ZWJ) | bit(GraphemeBreak::SpacingMark);
+const unsigned RI = bit(GraphemeBreak::RegionalIndicator);
+
+/**
+ * 位于 pos 的 "简单" 字符的字节长度, 不是则返回 0: ASCII, CJK 统一表意文字 (U+3400..U+9FFF) 与谚文音节
+ * 两个简单字符之间除 CR LF 外总是字素簇边界 (它们都不是 Prepend / Extend / 谚文字母 / RI / ExtPict)
+ */
+inline std::size_t simple_len(const Byte* p, std::size_t pos, std::size_t n) {
+    Byte b = p[pos];
+    if (b < 0x80) return 1;
+    if (b < 0xE3 || b > 0xED || pos + 3 > n || (p[pos + 1] & 0xC0) != 0x80 || (p[pos + 2] & 0xC0) != 0x80) return 0;
+    CodePoint cp = (CodePoint(b & 0x0F) << 12) | (CodePoint(p[pos + 1] & 0x3F) << 6) | CodePoint(p[pos + 2] & 0x3F);
+    return (cp - 0x3400 < 0x6C00 || cp - 0xAC00 < 11172) ? 3 : 0;
+}
+
+// 以 pos 结尾的简单字符的起始位置, 不是则返回 knpos
+inline std::size_t simple_start(const Byte* p, std::size_t pos) {
+    if (p[pos - 1] < 0x80) return pos - 1;
+    if (pos >= 3 && simple_len(p, pos - 3, pos) == 3) return pos - 3;
+    return knpos;
+}
+
+// 解码 pos 处的字符并返回其字素簇记录, pos 移到下一个字符; 非法字节逐字节按 Control 处理
+inline std::uint8_t next_record(ByteSpan text, std::size_t& pos) {
+    const Byte b = text[pos];
+    if (b < 0x80) {
+        ++pos;
+        return grapheme_record(b);
+    }
+    CodePoint cp = 0;
+    std::size_t len = utf8::try_decode(text.data() + pos, text.size() - pos, cp);
+    if (len == 0) {
+        ++pos;
+        return static_cast<std::uint8_t>(GraphemeBreak::Control);
+    }
+    pos += len;
+    return grapheme_record(cp);
+}
+
+// 解码以 pos 结尾的字符, pos 移到其起始位置
+inline std::uint8_t prev_record(ByteSpan text, std::size_t& pos) {
+    const Byte b = text[pos - 1];
+    if (b < 0x80) {
+        --pos;
+        return grapheme_record(b);
+    }
+    CodePoint cp = 0;
+    std::size_t len = utf8::try_decode_prev(text.data(), pos, cp);
+    if (len == 0) {
+        --pos;
+        return static_cast<std::uint8_t>(GraphemeBreak::Control);
+    }
+    pos -= len;
+    return grapheme_record(cp);
+}
+
+/**
+ * prev 与 cur 之间是否为边界 (GB3 - GB999)
+ * zwj_after_pict: prev 为 ZWJ 且前面是 ExtPict Extend* (GB11)
+ * ri_odd: 以 prev 结尾的连续 RI 个数为奇数 (GB12, GB13)
+ */
+bool is_break(std::uint8_t prev, std::uint8_t cur, bool zwj_after_pict, bool ri_odd) {
+    const unsigned p = gcb_bit(prev);
+    const unsigned c = gcb_bit(cur);
+    if (p == bit(GraphemeBreak::CR)) return c != bit(GraphemeBreak::LF);
+    if ((p | c) & CONTROLS) return true;
+    if (p == bit(GraphemeBreak::L) && (c & HANGUL_AFTER_L)) return false;
+    if ((p & (bit(GraphemeBreak::LV) | bit(GraphemeBreak::V))) && (c & (bit(GraphemeBreak::V) | bit(GraphemeBreak::T))))
+        return false;
+    if ((p & (bit(GraphemeBreak::LVT) | bit(GraphemeBreak::T))) && c == bit(GraphemeBreak::T)) return false;
+    if (c & NO_BREAK_BEFORE) return false;
+    if (p == bit(GraphemeBreak::Prepend)) return false;
+    if (zwj_after_pict && (cur & PICT)) return false;
+    if (p == RI && c == RI) return ! ri_odd;
+    return true;
+}
+
+// pos 之前 (跳过 Extend) 是否为 ExtPict
+bool pict_before(ByteSpan text, std::size_t pos) {
+    while (pos > 0) {
+        std::uint8_t r = prev_record(text, pos);
+        if (gcb_bit(r) != bit(GraphemeBreak::Extend)) return (r & PICT) != 0;
+    }
+    return false;
+}
+
+// 以 pos 结尾的连续 RI 个数
+std::size_t ri_before(ByteSpan text, std::size_t pos) {
+    std::size_t count = 0;
+    while (pos > 0 && gcb_bit(prev_record(text, pos)) == RI) ++count;
+    return count;
+}
+
+// 词与句的切分中非法字节逐字节按 Other 处理 (超出范围的码点查表得到 Other)
+const CodePoint INVALID_CHAR = 0x110000;
+
+inline CodePoint decode_next(ByteSpan text, std::size_t& pos) {
+    const Byte b = text[pos];
+    if (b < 0x80) {
+        ++pos;
+        return b;
+    }
+    CodePoint cp = 0;
+    std::size_t len = utf8::try_decode(text.data() + pos, text.size() - pos, cp);
+    pos += len == 0 ? 1 : len;
+    return len == 0 ? INVALID_CHAR : cp;
+}
+
+inline CodePoint decode_prev(ByteSpan text, std::size_t& pos) {
+    const Byte b = text[pos - 1];
+    if (b < 0x80) {
+        --pos;
+        return b;
+    }
+    CodePoint cp = 0;
+    std::size_t len = utf8::try_decode_prev(text.data(), pos, cp);
+    pos -= len == 0 ? 1 : len;
+    return len == 0 ? INVALID_CHAR : cp;
+}
+
+// 汉字 (U+3400..U+9FFF, Word_Break 均为 Other) 占 3 字节时返回 true
+inline bool is_ideograph(const Byte* p, std::size_t pos, std::size_t n) {
+    Byte b = p[pos];
+    if (b < 0xE3 || b > 0xE9 || pos + 3 > n || (p[pos + 1] & 0xC0) != 0x80 || (p[pos + 2] & 0xC0) != 0x80) return false;
+    CodePoint cp = (CodePoint(b & 0x0F) << 12) | (CodePoint(p[pos + 1] & 0x3F) << 6) | CodePoint(p[pos + 2] & 0x3F);
+    return cp - 0x3400 < 0x6C00;
+}
+
+// ---- 词 ----
+
+const std::uint8_t WB_PICT = tables::WB_EXTENDED_PICTOGRAPHIC;
+
+constexpr unsigned bit(WordBreak w) {
+    return 1u << static_cast<unsigned>(w);
+}
+
+inline unsigned wb_bit(std::uint8_t record) {
+    return 1u << (record & tables::WB_BITS);
+}
+
+const unsigned WB_NEWLINES = bit(WordBreak::CR) | bit(WordBreak::LF) | bit(WordBreak::Newline);
+const unsigned WB_IGNORED = bit(WordBreak::Extend) | bit(WordBreak::Format) | bit(WordBreak::ZWJ);
+const unsigned AHLETTER = bit(WordBreak::ALetter) | bit(WordBreak::HebrewLetter);
+const unsigned MID_LETTER = bit(WordBreak::MidLetter) | bit(WordBreak::MidNumLet) | bit(WordBreak::SingleQuote);
+const unsigned MID_NUM = bit(WordBreak::MidNum) | bit(WordBreak::MidNumLet) | bit(WordBreak::SingleQuote);
+const unsigned HEBREW = bit(WordBreak::HebrewLetter);
+const unsigned NUMERIC = bit(WordBreak::Numeric);
+const unsigned KATAKANA = bit(WordBreak::Katakana);
+const unsigned EXTEND_NUM_LET = bit(WordBreak::ExtendNumLet);
+const unsigned WB_RI = bit(WordBreak::RegionalIndicator);
+
+// ASCII 中的 ALetter / Numeric / ExtendNumLet, 这些字节连成的串内部没有词边界
+inline bool is_ascii_word(Byte b) {
+    return static_cast<unsigned>((b | 0x20) - 'a') < 26u || static_cast<unsigned>(b - '0') < 10u || b == '_';
+}
+
+// ASCII 中的 MidLetter / MidNum / MidNumLet / Single_Quote, 可能把两侧的字母或数字连成一个词
+inline bool is_ascii_mid(Byte b) {
+    return b == '.' || b == ':' || b == ',' || b == ';' || b == '\'';
+}
+
+/**
+ * WB4: 以 pos 结尾的单元 (字符及其后的 Extend / Format / ZWJ) 的基字符记录, pos 移到基字符的起始位置
+ * 换行符与文本开头之后的忽略字符不附着, 最前面的那个自身作为基字符
+ */
+std::uint8_t word_unit_before(ByteSpan text, std::size_t& pos) {
+    std::size_t p = pos;
+    std::uint8_t ignored = 0;
+    while (p > 0) {
+        std::size_t q = p;
+        std::uint8_t r = word_record(decode_prev(text, q));
+        if ((wb_bit(r) & WB_IGNORED) == 0) {
+            if ((wb_bit(r) & WB_NEWLINES) && p != pos) break;
+            pos = q;
+            return r;
+        }
+        ignored = r;
+        p = q;
+    }
+    pos = p;
+    return ignored;
+}
+
+inline std::uint8_t word_unit_before_at(ByteSpan text, std::size_t pos) {
+    return word_unit_before(text, pos);
+}
+
+// pos 起跳过 Extend / Format / ZWJ 后的字符记录, 到末尾时返回 Other
+std::uint8_t word_after(ByteSpan text, std::size_t pos) {
+    while (pos < text.size()) {
+        std::uint8_t r = word_record(decode_next(text, pos));
+        if ((wb_bit(r) & WB_IGNORED) == 0) return r;
+    }
+    return 0;
+}
+
+// 0 < q < size 处是否为词边界 (WB3 - WB999), 上下文按需向两侧查看
+bool is_word_boundary(ByteSpan text, std::size_t q) {
+    std::size_t end = q;
+    const std::uint8_t cur = word_record(decode_next(text, end));
+    std::size_t start = q;
+    const std::uint8_t raw = word_record(decode_prev(text, start));
+    const unsigned c = wb_bit(cur);
+    const unsigned r = wb_bit(raw);
+    if (r == bit(WordBreak::CR) && c == bit(WordBreak::LF)) return false;
+    if ((r | c) & WB_NEWLINES) return true;
+    if (r == bit(WordBreak::ZWJ) && (cur & WB_PICT)) return false;
+    if (r == bit(WordBreak::WSegSpace) && c == bit(WordBreak::WSegSpace)) return false;
+    if (c & WB_IGNORED) return false;
+
+    unsigned a = r;
+    if (r & WB_IGNORED) {
+        start = q;
+        a = wb_bit(word_unit_before(text, start));
+    }
+    if ((a & (AHLETTER | NUMERIC)) && (c & (AHLETTER | NUMERIC))) return false; // WB5, WB8 - WB10
+    if ((a & AHLETTER) && (c & MID_LETTER) && (wb_bit(word_after(text, end)) & AHLETTER)) return false;
+    if ((a & MID_LETTER) && (c & AHLETTER) && (wb_bit(word_unit_before_at(text, start)) & AHLETTER)) return false;
+    if (a == HEBREW && c == bit(WordBreak::SingleQuote)) return false;
+    if (a == HEBREW && c == bit(WordBreak::DoubleQuote) && wb_bit(word_after(text, end)) == HEBREW) return false;
+    if (a == bit(WordBreak::DoubleQuote) && c == HEBREW && wb_bit(word_unit_before_at(text, start)) == HEBREW)
+        return false;
+    if ((a & MID_NUM) && c == NUMERIC && wb_bit(word_unit_before_at(text, start)) == NUMERIC) return false;
+    if (a == NUMERIC && (c & MID_NUM) && wb_bit(word_after(text, end)) == NUMERIC) return false;
+    if (a == KATAKANA && c == KATAKANA) return false;
+    if ((a & (AHLETTER | NUMERIC | KATAKANA | EXTEND_NUM_LET)) && c == EXTEND_NUM_LET) return false;
+    if (a == EXTEND_NUM_LET && (c & (AHLETTER | NUMERIC | KATAKANA))) return false;
+    if (a == WB_RI && c == WB_RI) {
+        // WB15, WB16: 以 q 结尾的连续 RI 单元为奇数个时不断开
+        std::size_t count = 0;
+        std::size_t p = q;
+        while (p > 0 && wb_bit(word_unit_before(text, p)) == WB_RI) ++count;
+        return count % 2 == 0;
+    }
+    return true;
+}
+
+// ---- 句 ----
+
+constexpr unsigned bit(SentenceBreak b) {
+    return 1u << static_cast<unsigned>(b);
+}
+
+inline unsigned sb_bit(CodePoint cp) {
+    return bit(sentence_break(cp));
+}
+
+const unsigned PARA_SEP = bit(SentenceBreak::Sep) | bit(SentenceBreak::CR) | bit(SentenceBreak::LF);
+const unsigned SATERM = bit(SentenceBreak::ATerm) | bit(SentenceBreak::STerm);
+const unsigned SB_IGNORED = bit(SentenceBreak::Extend) | bit(SentenceBreak::Format);
+
+// 可能开始一个句边界判断的 ASCII 字节: ATerm '.', STerm '!' '?', CR, LF
+inline bool is_sentence_stop(Byte b) {
+    return b == '.' || b == '!' || b == '?' || b == '\r' || b == '\n';
+}
+
+// SB5: 跳过 pos 起的 Extend / Format
+std::size_t skip_sentence_ignored(ByteSpan text, std::size_t pos) {
+    while (pos < text.size()) {
+        std::size_t q = pos;
+        if ((sb_bit(decode_next(text, q)) & SB_IGNORED) == 0) break;
+        pos = q;
+    }
+    return pos;
+}
+
+// pos 之前 (跳过 Extend / Format) 的字符的 SB 位; 忽略字符前是段落分隔符或文本开头时返回 0
+unsigned sentence_unit_before(ByteSpan text, std::size_t pos) {
+    bool skipped = false;
+    while (pos > 0) {
+        unsigned b = sb_bit(decode_prev(text, pos));
+        if ((b & SB_IGNORED) == 0) return (skipped && (b & PARA_SEP)) ? 0 : b;
+        skipped = true;
+    }
+    return 0;
+}
+
+// SB8: pos 起跳过非 OLetter / Upper / Lower / ParaSep / SATerm 的字符后是否为 Lower
+bool lower_follows(ByteSpan text, std::size_t pos) {
+    const unsigned stop = bit(SentenceBreak::OLetter) | bit(SentenceBreak::Upper) | PARA_SEP | SATERM;
+    while (pos < text.size()) {
+        unsigned b = sb_bit(decode_next(text, pos));
+        if (b == bit(SentenceBreak::Lower)) return true;
+        if (b & stop) return false;
+    }
+    return false;
+}
+
+/**
+ * t 处为 SATerm: 返回其后 Close* Sp* ParaSep? 的结束位置 (SB9 - SB11), brk 表示该位置是否为句边界
+ * 不断开 (SB6 - SB8a) 时返回的位置之后可以继续查找下一个 SATerm
+ */
+std::size_t sentence_end_after(ByteSpan text, std::size_t t, bool& brk) {
+    const std::size_t n = text.size();
+    std::size_t q = t;
+    const unsigned term = sb_bit(decode_next(text, q));
+    q = skip_sentence_ignored(text, q);
+    brk = false;
+    if (term == bit(SentenceBreak::ATerm) && q < n) {
+        std::size_t r = q;
+        unsigned next = sb_bit(decode_next(text, r));
+        if (next == bit(SentenceBreak::Numeric)) return q;
+        if (next == bit(SentenceBreak::Upper) &&
+            (sentence_unit_before(text, t) & (bit(SentenceBreak::Upper) | bit(SentenceBreak::Lower))))
+            return q;
+    }
+    for (SentenceBreak run : {SentenceBreak::Close, SentenceBreak::Sp}) {
+        while (q < n) {
+            std::size_t r = q;
+            if (sb_bit(decode_next(text, r)) != bit(run)) break;
+            q = skip_sentence_ignored(text, r);
+        }
+    }
+    brk = true;
+    if (q == n) return n;
+    std::size_t r = q;
+    unsigned next = sb_bit(decode_next(text, r));
+    if (next & PARA_SEP) {
+        if (next == bit(SentenceBreak::CR) && r < n && text[r] == '\n') ++r;
+        return r;
+    }
+    if (next & (bit(SentenceBreak::SContinue) | SATERM)) brk = false;
+    if (term == bit(SentenceBreak::ATerm) && lower_follows(text, q)) brk = false;
+    return q;
+}
+} // namespace
+
+std::size_t next_grapheme_boundary(ByteSpan text, std::size_t pos) {
+    const Byte* p = text.data();
+    const std::size_t n = text.size();
+    if (pos >= n) return n;
+
+    std::size_t len = simple_len(p, pos, n);
+    if (len != 0) {
+        std::size_t next = pos + len;
+        if (next == n) return n;
+        if (p[pos] == '\r') return p[next] == '\n' ? next + 1 : next;
+        if (simple_len(p, next, n) != 0) return next;
+    }
+
+    std::size_t q = pos;
+    std::uint8_t prev = next_record(text, q);
+    bool pict = (prev & PICT) != 0;
+    bool zwj_after_pict = false;
+    std::size_t ri = gcb_bit(prev) == RI ? 1 : 0;
+    while (q < n) {
+        std::size_t r = q;
+        std::uint8_t cur = next_record(text, r);
+        if (is_break(prev, cur, zwj_after_pict, (ri & 1) != 0)) return q;
+        zwj_after_pict = gcb_bit(cur) == bit(GraphemeBreak::ZWJ) && pict;
+        if (cur & PICT) {
+            pict = true;
+        } else if (gcb_bit(cur) != bit(GraphemeBreak::Extend)) {
+            pict = false;
+        }
+        ri = gcb_bit(cur) == RI ? ri + 1 : 0;
+        prev = cur;
+        q = r;
+    }
+    return n;
+}
+
+std::size_t prev_grapheme_boundary(ByteSpan text, std::size_t pos) {
+    const Byte* p = text.data();
+    if (pos > text.size()) pos = text.size();
+    if (pos == 0) return 0;
+
+    std::size_t start = simple_start(p, pos);
+    if (start != knpos) {
+        if (start == 0) return 0;
+        std::size_t before = simple_start(p, start);
+        if (before != knpos && ! (p[before] == '\r' && p[start] == '\n')) return start;
+    }
+
+    // 逐个向前检查字符对, GB11 与 GB12/13 需要的上下文按需向前回看
+    std::size_t s = pos;
+    std::uint8_t cur = prev_record(text, s);
+    while (s > 0) {
+        std::size_t t = s;
+        std::uint8_t prev = prev_record(text, t);
+        bool zwj_after_pict = gcb_bit(prev) == bit(GraphemeBreak::ZWJ) && (cur & PICT) && pict_before(text, t);
+        bool ri_odd = gcb_bit(prev) == RI && gcb_bit(cur) == RI && ri_before(text, t) % 2 == 0;
+        if (is_break(prev, cur, zwj_after_pict, ri_odd)) return s;
+        cur = prev;
+        s = t;
+    }
+    return 0;
+}
+
+std::size_t grapheme_count(ByteSpan text) {
+    std::size_t count = 0;
+    for (std::size_t pos = 0; pos < text.size(); pos = next_grapheme_boundary(text, pos)) ++count;
+    return count;
+}
+
+std::size_t next_word_boundary(ByteSpan text, std::size_t pos) {
+    const Byte* p = text.data();
+    const std::size_t n = text.size();
+    if (pos >= n) return n;
+
+    // 快速路径: [pos, q) 内部没有边界; 其后是 ASCII (不是可能连接两侧的标点) 或汉字时 q 就是边界
+    const Byte b = p[pos];
+    std::size_t q = pos + 1;
+    bool fast = true;
+    if (b == '\r') return (q < n && p[q] == '\n') ? q + 1 : q;
+    if (is_ascii_word(b)) {
+        while (q < n && is_ascii_word(p[q])) ++q;
+        fast = q == n || ! is_ascii_mid(p[q]);
+    } else if (b == ' ') {
+        while (q < n && p[q] == ' ') ++q;
+    } else if (b >= 0x80) {
+        fast = is_ideograph(p, pos, n);
+        q = pos;
+        decode_next(text, q);
+    }
+    if (fast && (q == n || p[q] < 0x80 || is_ideograph(p, q, n))) return q;
+
+    for (; q < n; decode_next(text, q)) {
+        if (is_word_boundary(text, q)) return q;
+    }
+    return n;
+}
+
+std::size_t prev_word_boundary(ByteSpan text, std::size_t pos) {
+    const Byte* p = text.data();
+    if (pos > text.size()) pos = text.size();
+    if (pos == 0) return 0;
+
+    // 快速路径, 与 next_word_boundary 对称: [s, pos) 内部没有边界, 其前一个字符确定不与之相连时 s 就是边界
+    const Byte b = p[pos - 1];
+    std::size_t s = pos - 1;
+    bool fast = true;
+    if (is_ascii_word(b)) {
+        while (s > 0 && is_ascii_word(p[s - 1])) --s;
+        fast = s == 0 || ! is_ascii_mid(p[s - 1]);
+    } else if (b == ' ') {
+        while (s > 0 && p[s - 1] == ' ') --s;
+    } else if (b >= 0x80) {
+        s = pos;
+        decode_prev(text, s);
+        fast = pos - s == 3 && is_ideograph(p, s, pos);
+    } else if (b == '\n' && s > 0 && p[s - 1] == '\r') {
+        --s;
+    }
+    if (fast) {
+        if (s == 0) return 0;
+        if (p[s - 1] < 0x80 && ! (p[s - 1] == '\r' && p[s] == '\n')) return s;
+        if (s >= 3 && is_ideograph(p, s - 3, s)) return s;
+    }
+
+    for (; s > 0; decode_prev(text, s)) {
+        if (is_word_boundary(text, s)) return s;
+    }
+    return 0;
+}
+
+bool is_word_like(ByteSpan segment) {
+    for (std::size_t pos = 0; pos < segment.size();) {
+        const Byte b = segment[pos];
+        if (b < 0x80) {
+            if (is_ascii_word(b) && b != '_') return true;
+            ++pos;
+            continue;
+        }
+        CodePoint cp = decode_next(segment, pos);
+        if (cp == INVALID_CHAR) continue;
+        GeneralCategory gc = general_category(cp);
+        if (is_alphabetic(cp) || gc == GeneralCategory::Nd || gc == GeneralCategory::Nl || gc == GeneralCategory::No)
+            return true;
+    }
+    return false;
+}
+
+std::size_t next_sentence_boundary(ByteSpan text, std::size_t pos) {
+    const Byte* p = text.data();
+    const std::size_t n = text.size();
+    std::size_t q = pos;
+    while (q < n) {
+        while (q < n && p[q] < 0x80 && ! is_sentence_stop(p[q])) ++q;
+        if (q == n) break;
+        std::size_t r = q;
+        const unsigned c = sb_bit(decode_next(text, r));
+        if (c & PARA_SEP) {
+            // SB3, SB4
+            if (c == bit(SentenceBreak::CR) && r < n && p[r] == '\n') ++r;
+            return r;
+        }
+        if (c & SATERM) {
+            bool brk = false;
+            std::size_t e = sentence_end_after(text, q, brk);
+            if (brk) return e;
+            r = e;
+        }
+        q = r;
+    }
+    return n;
+}
+
+std::size_t prev_sentence_boundary(ByteSpan text, std::size_t pos) {
+    const Byte* p = text.data();
+    const std::size_t n = text.size();
+    if (pos > n) pos = n;
+    std::size_t q = pos;
+    while (q > 0) {
+        while (q > 0 && p[q - 1] < 0x80 && ! is_sentence_stop(p[q - 1])) --q;
+        if (q == 0) break;
+        std::size_t t = q;
+        const unsigned c = sb_bit(decode_prev(text, t));
+        if (c & PARA_SEP) {
+            std::size_t e = q;
+            if (c == bit(SentenceBreak::CR) && e < n && p[e] == '\n') ++e;
+            if (c == bit(SentenceBreak::LF) && t > 0 && p[t - 1] == '\r') --t;
+            if (e < pos) return e;
+        } else if (c & SATERM) {
+            bool brk = false;
+            std::size_t e = sentence_end_after(text, t, brk);
+            if (brk && e < pos) return e;
+        }
+        q = t;
+    }
+    return 0;
+}
+} // namespace unicode
+} // namespace kstring
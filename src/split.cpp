@@ -0,0 +1,77 @@
+#include <cctype>
+#include "search.hpp"
+#include "split.hpp"
+#include "whitespace.hpp"
+
+namespace kstring {
+namespace {
+const DelimMatch NO_DELIM = {knpos, 0};
+
+bool is_ascii_space(Byte b) {
+    return std::isspace(b) != 0;
+}
+} // namespace
+
+DelimMatch SubstrDelimiter::next(ByteSpan hay, std::size_t from) const {
+    if (pat.empty()) {
+        // 逐字节切分: 每个字节之后都是一个零宽分隔符, 末尾除外
+        return from + 1 < hay.size() ? DelimMatch{from + 1, 0} : NO_DELIM;
+    }
+    std::size_t found = search::find(hay.subspan(from), pat);
+    return found == knpos ? NO_DELIM : DelimMatch{from + found, pat.size()};
+}
+
+DelimMatch SubstrDelimiter::prev(ByteSpan hay, std::size_t end) const {
+    if (pat.empty()) return end >= 2 ? DelimMatch{end - 1, 0} : NO_DELIM;
+    std::size_t found = search::rfind(hay.first(end), pat);
+    return found == knpos ? NO_DELIM : DelimMatch{found, pat.size()};
+}
+
+DelimMatch LineDelimiter::next(ByteSpan hay, std::size_t from) const {
+    static const Byte terminators[] = {'\r', '\n'};
+    std::size_t found = search::find_first_of(hay.subspan(from), ByteSpan(terminators, 2));
+    if (found == knpos) return NO_DELIM;
+    std::size_t pos = from + found;
+    if (hay[pos] == '\r' && pos + 1 < hay.size() && hay[pos + 1] == '\n') return DelimMatch{pos, 2};
+    return DelimMatch{pos, 1};
+}
+
+DelimMatch LineDelimiter::prev(ByteSpan hay, std::size_t end) const {
+    std::size_t lf = search::rfind_byte(hay.first(end), '\n');
+    std::size_t cr = search::rfind_byte(hay.first(end), '\r');
+    if (lf == knpos && cr == knpos) return NO_DELIM;
+    if (lf == knpos || (cr != knpos && cr > lf)) return DelimMatch{cr, 1};
+    if (lf > 0 && hay[lf - 1] == '\r') return DelimMatch{lf - 1, 2};
+    return DelimMatch{lf, 1};
+}
+
+// 一段连续空白作为一个分隔符返回, 省去逐个空白产生空分段再丢弃
+DelimMatch Utf8WhitespaceDelimiter::next(ByteSpan hay, std::size_t from) const {
+    std::size_t len = 0;
+    std::size_t pos = whitespace::find(hay, from, len);
+    if (pos == knpos) return NO_DELIM;
+    return DelimMatch{pos, whitespace::skip(hay, pos + len) - pos};
+}
+
+DelimMatch Utf8WhitespaceDelimiter::prev(ByteSpan hay, std::size_t end) const {
+    std::size_t len = 0;
+    std::size_t pos = whitespace::rfind(hay, end, len);
+    if (pos == knpos) return NO_DELIM;
+    std::size_t start = whitespace::rskip(hay, pos);
+    return DelimMatch{start, pos + len - start};
+}
+
+DelimMatch AsciiWhitespaceDelimiter::next(ByteSpan hay, std::size_t from) const {
+    for (std::size_t pos = from; pos < hay.size(); ++pos) {
+        if (is_ascii_space(hay[pos])) return DelimMatch{pos, 1};
+    }
+    return NO_DELIM;
+}
+
+DelimMatch AsciiWhitespaceDelimiter::prev(ByteSpan hay, std::size_t end) const {
+    for (std::size_t pos = end; pos-- > 0;) {
+        if (is_ascii_space(hay[pos])) return DelimMatch{pos, 1};
+    }
+    return NO_DELIM;
+}
+} // namespace kstring
@@ -0,0 +1,38 @@
+#include <string>
+#include "unicode.hpp"
+#include "utf8.hpp"
+
+namespace kstring {
+namespace unicode {
+std::size_t classify(ByteSpan text, std::size_t& pos, CharMask* out, std::size_t cap) {
+    std::size_t count = 0;
+    const std::size_t n = text.size();
+    while (count < cap && pos < n) {
+        // ASCII 不必解码
+        if (text[pos] < 0x80) {
+            out[count++] = char_mask(text[pos++]);
+            continue;
+        }
+        auto dec = utf8::decode_one(text, pos);
+        out[count++] = dec.ok ? char_mask(dec.codepoint) : CharMask(CHAR_INVALID);
+        pos = dec.next_pos;
+    }
+    return count;
+}
+
+std::vector<CharMask> classify(ByteSpan text) {
+    // 字符数不超过字节数, 按字节数预留后一次写完
+    std::vector<CharMask> out(text.size());
+    std::size_t pos = 0;
+    out.resize(classify(text, pos, out.data(), out.size()));
+    return out;
+}
+
+const char* version() {
+    static const std::string v = std::to_string(tables::UNICODE_VERSION_MAJOR) + "." +
+                                 std::to_string(tables::UNICODE_VERSION_MINOR) + "." +
+                                 std::to_string(tables::UNICODE_VERSION_UPDATE);
+    return v.c_str();
+}
+} // namespace unicode
+} // namespace kstring
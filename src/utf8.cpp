@@ -1,11 +1,14 @@
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstring>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <cstdint>
 #include "utf8.hpp"
 #include "base.hpp"
+#include "search.hpp"
 #include "third_party/simdutf.h"
 
 namespace utf8 {
@@ -84,15 +87,99 @@ Utf8EDResult encode_valid_prefix(kstring::span<const CodePoint> input, ByteVec&
     return Utf8EDResult(ok_chars, ok_bytes, error);
 }
 
+// ---- 表驱动的 DFA 解码 ----
+// 字节类别: 0 ASCII, 1 80..8F, 2 90..9F, 3 A0..BF (1..3 为续字节), 4 C0 C1, 5 C2..DF, 6 E0, 7 E1..EC EE EF, 8 ED,
+// 9 F0, 10 F1..F3, 11 F4, 12 F5..FF
+const Byte BYTE_CLASS[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, // 00..0F
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, // 10..1F
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, // 20..2F
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, // 30..3F
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, // 40..4F
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, // 50..5F
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, // 60..6F
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, // 70..7F
+     1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1, // 80..8F
+     2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2, // 90..9F
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, // A0..AF
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3, // B0..BF
+     4,  4,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5, // C0..CF
+     5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5, // D0..DF
+     6,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  8,  7,  7, // E0..EF
+     9, 10, 10, 10, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, // F0..FF
+};
+
+// 状态: 还需几个续字节, 以及目前是否仍可能合法 (BAD 表示过长编码 / 代理区 / 超出 U+10FFFF, 读完整个序列后才报错)
+// AFTER_xx 表示首字节为 xx, 第二个字节有额外的范围限制
+enum DecodeState : Byte { GOOD1, GOOD2, GOOD3, BAD1, BAD2, AFTER_E0, AFTER_ED, AFTER_F0, AFTER_F4, ACCEPT, INVALID };
+
+// 读到续字节后的状态, 列为 80..8F, 90..9F, A0..BF
+const Byte NEXT_STATE[][3] = {
+    {ACCEPT, ACCEPT, ACCEPT},   // GOOD1
+    {GOOD1, GOOD1, GOOD1},      // GOOD2
+    {GOOD2, GOOD2, GOOD2},      // GOOD3
+    {INVALID, INVALID, INVALID}, // BAD1
+    {BAD1, BAD1, BAD1},         // BAD2
+    {BAD1, BAD1, GOOD1},        // AFTER_E0: 80..9F 为过长编码
+    {GOOD1, GOOD1, BAD1},       // AFTER_ED: A0..BF 为代理区
+    {BAD2, GOOD2, GOOD2},       // AFTER_F0: 80..8F 为过长编码
+    {GOOD2, BAD2, BAD2},        // AFTER_F4: 90..BF 超出 U+10FFFF
+};
+
+// 按首字节类别: 序列长度 (0 为非法首字节), 初始状态, 首字节中码点位的掩码
+struct LeadInfo {
+    Byte length;
+    Byte state;
+    Byte mask;
+};
+
+const LeadInfo LEAD_INFO[13] = {
+    {1, ACCEPT, 0x7F},   {0, INVALID, 0},     {0, INVALID, 0}, {0, INVALID, 0},     {2, BAD1, 0x1F},
+    {2, GOOD1, 0x1F},    {3, AFTER_E0, 0x0F}, {3, GOOD2, 0x0F}, {3, AFTER_ED, 0x0F}, {4, AFTER_F0, 0x07},
+    {4, GOOD3, 0x07},    {4, AFTER_F4, 0x07}, {0, INVALID, 0},
+};
+
+/**
+ * 与原先逐步检查的 decode_one 给出相同的结果与 next_pos:
+ * 非法首字节 -> pos + 1; 序列超出末尾 -> size; 第 i 个字节不是续字节 -> pos + i;
+ * 过长编码 / 代理区 / 超出范围 -> pos + 序列长度
+ */
+inline UTF8Decoded dfa_decode(const Byte* p, std::size_t pos, std::size_t n) {
+    const Byte lead = p[pos];
+    if (lead < 0x80) return UTF8Decoded(lead, pos + 1);
+    const LeadInfo& info = LEAD_INFO[BYTE_CLASS[lead]];
+    const std::size_t len = info.length;
+    if (len == 0) return UTF8Decoded::ill(pos + 1);
+    if (len > n - pos) return UTF8Decoded::ill(n);
+
+    unsigned state = info.state;
+    CodePoint cp = lead & info.mask;
+    for (std::size_t i = 1; i < len; ++i) {
+        const Byte b = p[pos + i];
+        const unsigned c = BYTE_CLASS[b] - 1u;
+        if (c >= 3u) return UTF8Decoded::ill(pos + i);
+        state = NEXT_STATE[state][c];
+        cp = (cp << 6) | (b & 0x3Fu);
+    }
+    return state == ACCEPT ? UTF8Decoded(cp, pos + len) : UTF8Decoded::ill(pos + len);
+}
+
+// decode_one 切分中末尾被截断的序列的起点, 没有时返回 size
+// 非法输入中首字节与 ASCII 总是切分的起点, 唯一的例外是这个序列: 它吞掉其后的所有字节, 其中不会解码出字符
+std::size_t truncated_tail(const ByteSpan& data) {
+    const std::size_t n = data.size();
+    for (std::size_t s = n >= 3 ? n - 3 : 0; s < n; ++s) {
+        std::size_t len = LEAD_INFO[BYTE_CLASS[data[s]]].length;
+        if (len >= 2 && s + len > n) return s;
+    }
+    return n;
+}
+
 } // namespace
 
 // 获取当前字节起始的 UTF-8 编码的总长度（若非法则返回 0）
 std::size_t lead_utf8_length(Byte lead) {
-    if (lead <= 0x7F) return 1;                 // 0xxxxxxx
-    if (lead >= 0xC0 && lead <= 0xDF) return 2; // 110xxxxx (0xC0, 0xC1 are overlong)
-    if (lead >= 0xE0 && lead <= 0xEF) return 3; // 1110xxxx
-    if (lead >= 0xF0 && lead <= 0xF4) return 4; // 11110xxx (max legal is 0xF4 due to U+10FFFF)
-    return 0;                                   // invalid
+    return LEAD_INFO[BYTE_CLASS[lead]].length; // 0xC0, 0xC1 为 2 (过长编码在解码时报错), 0xF5 起为 0
 }
 
 // 获取第一个非法字节位置（返回 -1 表示全部合法）
@@ -184,40 +271,30 @@ UTF8Encoded encode(CodePoint cp) {
 // 尝试解码 data[pos...] 开头的字符（失败时返回 false）, next_pos 存放解码后应处的 pos
 UTF8Decoded decode_one(const ByteSpan& data, std::size_t pos) {
     if (pos >= data.size()) return UTF8Decoded::ill(data.size());
+    return dfa_decode(data.data(), pos, data.size());
+}
 
-    Byte lead = data[pos];
-    std::size_t len = lead_utf8_length(lead);
-    if (len == 0) return UTF8Decoded::ill(pos + 1);
-    if (pos + len > data.size()) return UTF8Decoded::ill(data.size());
+std::size_t decode_chunk(const ByteSpan& data, std::size_t& pos, CodePoint* out, std::size_t cap) {
+    const std::size_t n = data.size();
+    if (pos >= n) return 0;
 
-    // 检查 continuation 字节是否以 0x10 打头
-    for (std::size_t i = 1; i < len; ++i) {
-        if ((data[pos + i] & 0b11000000) != 0b10000000) {
-            return UTF8Decoded::ill(pos + i);
-        }
-    }
+    // 窗口不超过 cap 字节, 输出就不超过 cap 个字符; 末端退回到字符起始位置, 不截断多字节序列
+    std::size_t end = std::min(n, pos + cap);
+    for (std::size_t back = 0; end < n && back < 3 && end > pos + 1 && (data[end] & 0xC0) == 0x80; ++back) --end;
 
-    CodePoint cp = 0;
-    if (len == 1) {
-        cp = CodePoint(lead);
-    } else if (len == 2) {
-        cp = CodePoint(((lead & 0b00011111) << 6) | (data[pos + 1] & 0b00111111));
-    } else if (len == 3) {
-        cp =
-            CodePoint(((lead & 0b00001111) << 12) | ((data[pos + 1] & 0b00111111) << 6) | (data[pos + 2] & 0b00111111));
-    } else if (len == 4) {
-        cp = CodePoint(((lead & 0b00000111) << 18) | ((data[pos + 1] & 0b00111111) << 12) |
-                       ((data[pos + 2] & 0b00111111) << 6) | (data[pos + 3] & 0b00111111));
+    const char* in = reinterpret_cast<const char*>(data.data() + pos);
+    char32_t* dst = reinterpret_cast<char32_t*>(out);
+    simdutf::result r = simdutf::convert_utf8_to_utf32_with_errors(in, end - pos, dst);
+    if (r.error == simdutf::error_code::SUCCESS) {
+        pos = end;
+        return r.count;
     }
 
-    // Unicode 要求：字符必须用最短的 UTF-8 表示, 例如 U+0000 被编码为 2 字节 0xC0 0x80 是非法的
-    if (utf8_size(cp) != len) return UTF8Decoded::ill(pos + len);
-    // surrogate 区间属于 UTF-16 用作代理对的码点区, 不允许作为码点
-    if (is_surrogate_codepoint(cp)) return UTF8Decoded::ill(pos + len);
-    // 最大合法码点是 U+10FFFF, 超过也是非法的
-    if (is_overflow_codepoint(cp)) return UTF8Decoded::ill(pos + len);
-
-    return UTF8Decoded(cp, pos + len);
+    // r.count 为出错字符的起始字节: 之前的合法段整段转换, 出错的序列按 decode_one 整体跳过, 其后留给下一块
+    std::size_t count = r.count == 0 ? 0 : simdutf::convert_valid_utf8_to_utf32(in, r.count, dst);
+    out[count] = INVALID_SEQUENCE;
+    pos = dfa_decode(data.data(), pos + r.count, n).next_pos;
+    return count + 1;
 }
 
 std::vector<CodePoint> decode_all(const ByteSpan& data) {
@@ -266,6 +343,298 @@ ByteVec encode_all(const std::vector<CodePoint>& code_vec) {
     return result;
 }
 
+namespace {
+// 从第一个出错位置 bad 起修复: 合法段整段拷贝, 每个非法序列 (decode_one 的切分) 写一个 U+FFFD
+void append_repaired(const ByteSpan& data, std::size_t bad, ByteVec& out) {
+    const Byte replacement[3] = {0xEF, 0xBF, 0xBD}; // encode(ILL_CODEPOINT)
+    out.reserve(out.size() + data.size() + 2);
+    out.insert(out.end(), data.begin(), data.begin() + bad);
+    std::size_t pos = bad;
+    while (pos < data.size()) {
+        pos = decode_one(data, pos).next_pos;
+        out.insert(out.end(), replacement, replacement + 3);
+        std::size_t ok_bytes = count_valid_bytes(data.subspan(pos));
+        out.insert(out.end(), data.begin() + pos, data.begin() + pos + ok_bytes);
+        pos += ok_bytes;
+    }
+}
+} // namespace
+
+void append_sanitized(const ByteSpan& data, ByteVec& out) {
+    std::size_t bad = count_valid_bytes(data);
+    if (bad == data.size()) {
+        out.insert(out.end(), data.begin(), data.end());
+    } else {
+        append_repaired(data, bad, out);
+    }
+}
+
+ByteVec sanitize(const ByteSpan& data) {
+    ByteVec out;
+    append_sanitized(data, out);
+    return out;
+}
+
+bool sanitize_in_place(ByteVec& data) {
+    std::size_t bad = count_valid_bytes(data);
+    if (bad == data.size()) return false;
+    ByteVec out;
+    append_repaired(data, bad, out);
+    data.swap(out);
+    return true;
+}
+
+namespace {
+[[noreturn]] void throw_transcode_error(const char* func, const char* what, std::size_t pos) {
+    throw std::invalid_argument(std::string("utf8::") + func + ": " + what + " at offset " + std::to_string(pos));
+}
+
+// U+FFFD 按 order 排列后的 UTF-16 单元
+char16_t utf16_replacement(Utf16Order order) {
+    simdutf::endianness e = order == Utf16Order::LittleEndian ? simdutf::endianness::LITTLE : simdutf::endianness::BIG;
+    return simdutf::match_system(e) ? u'\uFFFD' : u'\uFDFF';
+}
+
+// 边校验边转换 UTF-8 到 UTF-16 (out 需有足够空间); 出错时 count 为出错处的字节偏移, out 的内容不确定
+simdutf::result utf8_to_utf16_with_errors(const char* in, std::size_t len, char16_t* out, Utf16Order order) {
+    return order == Utf16Order::LittleEndian ? simdutf::convert_utf8_to_utf16le_with_errors(in, len, out)
+                                             : simdutf::convert_utf8_to_utf16be_with_errors(in, len, out);
+}
+
+std::size_t valid_utf8_to_utf16(const char* in, std::size_t len, char16_t* out, Utf16Order order) {
+    return order == Utf16Order::LittleEndian ? simdutf::convert_valid_utf8_to_utf16le(in, len, out)
+                                             : simdutf::convert_valid_utf8_to_utf16be(in, len, out);
+}
+} // namespace
+
+void append_utf16(const ByteSpan& data, std::u16string& out, ErrorMode mode, Utf16Order order) {
+    const char* in = reinterpret_cast<const char*>(data.data());
+    const std::size_t old_size = out.size();
+    // UTF-16 单元数不超过 UTF-8 字节数, 先按上界一次性分配, 最后截到实际长度
+    out.resize(old_size + data.size());
+    std::size_t written = old_size;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        // 合法输入只需这一遍; 出错时 out 中的内容不可信, 重新转换出错位置之前的合法段
+        simdutf::result r = utf8_to_utf16_with_errors(in + pos, data.size() - pos, &out[written], order);
+        if (r.error == simdutf::error_code::SUCCESS) {
+            written += r.count;
+            break;
+        }
+        written += valid_utf8_to_utf16(in + pos, r.count, &out[written], order);
+        pos += r.count;
+        if (mode == ErrorMode::Strict) {
+            out.resize(old_size);
+            throw_transcode_error("append_utf16", "invalid UTF-8", pos);
+        }
+        out[written++] = utf16_replacement(order);
+        pos = decode_one(data, pos).next_pos;
+    }
+    out.resize(written);
+}
+
+void append_from_utf16(const char16_t* data, std::size_t len, ByteVec& out, ErrorMode mode, Utf16Order order) {
+    const bool le = order == Utf16Order::LittleEndian;
+    const std::size_t old_size = out.size();
+    std::size_t pos = 0;
+    while (pos < len) {
+        simdutf::result r = le ? simdutf::validate_utf16le_with_errors(data + pos, len - pos)
+                               : simdutf::validate_utf16be_with_errors(data + pos, len - pos);
+        const std::size_t ok_units = r.error == simdutf::error_code::SUCCESS ? len - pos : r.count;
+        const std::size_t ok_bytes = le ? simdutf::utf8_length_from_utf16le(data + pos, ok_units)
+                                        : simdutf::utf8_length_from_utf16be(data + pos, ok_units);
+        std::size_t at = out.size();
+        out.resize(at + ok_bytes);
+        char* dst = reinterpret_cast<char*>(out.data() + at);
+        std::size_t n = le ? simdutf::convert_valid_utf16le_to_utf8(data + pos, ok_units, dst)
+                           : simdutf::convert_valid_utf16be_to_utf8(data + pos, ok_units, dst);
+        assert(n == ok_bytes);
+        (void)n;
+        pos += ok_units;
+        if (pos == len) break;
+        // 孤立代理: 高代理后面不是低代理, 或单独出现的低代理; 只跳过这一个单元
+        if (mode == ErrorMode::Strict) {
+            out.resize(old_size);
+            throw_transcode_error("append_from_utf16", "unpaired surrogate", pos);
+        }
+        out.insert(out.end(), {0xEF, 0xBF, 0xBD});
+        ++pos;
+    }
+}
+
+void append_latin1(const ByteSpan& data, ByteVec& out, ErrorMode mode) {
+    const char* in = reinterpret_cast<const char*>(data.data());
+    const std::size_t old_size = out.size();
+    // Latin-1 字符数不超过 UTF-8 字节数
+    out.resize(old_size + data.size());
+    std::size_t written = old_size;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        const std::size_t ok_end = pos + count_valid_bytes(data.subspan(pos));
+        // 合法段内只会因 U+0100 及以上的字符停下
+        while (pos < ok_end) {
+            char* dst = reinterpret_cast<char*>(out.data() + written);
+            simdutf::result r = simdutf::convert_utf8_to_latin1_with_errors(in + pos, ok_end - pos, dst);
+            if (r.error == simdutf::error_code::SUCCESS) {
+                written += r.count;
+                pos = ok_end;
+                break;
+            }
+            written += simdutf::convert_valid_utf8_to_latin1(in + pos, r.count, dst);
+            pos += r.count;
+            if (mode == ErrorMode::Strict) {
+                out.resize(old_size);
+                throw_transcode_error("append_latin1", "character out of Latin-1 range", pos);
+            }
+            out[written++] = '?';
+            pos += lead_utf8_length(data[pos]);
+        }
+        if (pos == data.size()) break;
+        if (mode == ErrorMode::Strict) {
+            out.resize(old_size);
+            throw_transcode_error("append_latin1", "invalid UTF-8", pos);
+        }
+        out[written++] = '?';
+        pos = decode_one(data, pos).next_pos;
+    }
+    out.resize(written);
+}
+
+void append_from_latin1(const ByteSpan& data, ByteVec& out) {
+    const char* in = reinterpret_cast<const char*>(data.data());
+    const std::size_t at = out.size();
+    out.resize(at + simdutf::utf8_length_from_latin1(in, data.size()));
+    std::size_t n = simdutf::convert_latin1_to_utf8(in, data.size(), reinterpret_cast<char*>(out.data() + at));
+    assert(at + n == out.size());
+    (void)n;
+}
+
+StreamValidator::StreamValidator() : pending_(), pending_len_(0), fed_(0), error_(kstring::knpos) {}
+
+void StreamValidator::reset() {
+    pending_len_ = 0;
+    fed_ = 0;
+    error_ = kstring::knpos;
+}
+
+bool StreamValidator::feed(const ByteSpan& chunk) {
+    const std::size_t n = chunk.size();
+    const std::size_t pending_start = fed_ - pending_len_;
+    fed_ += n;
+    if (! ok()) return false;
+
+    // 先用本块开头的字节补全上一块留下的序列 (pending_[0] 总是首字节)
+    std::size_t pos = 0;
+    if (pending_len_ > 0) {
+        const std::size_t need = lead_utf8_length(pending_[0]);
+        pos = std::min(n, need - pending_len_);
+        std::copy(chunk.begin(), chunk.begin() + pos, pending_ + pending_len_);
+        pending_len_ += pos;
+        if (pending_len_ < need) return true;
+        pending_len_ = 0;
+        if (! is_valid(ByteSpan(pending_, need))) {
+            error_ = pending_start;
+            return false;
+        }
+    }
+
+    const std::size_t tail = pos + truncated_tail(chunk.subspan(pos));
+    std::size_t ok_bytes = count_valid_bytes(chunk.subspan(pos, tail - pos));
+    if (pos + ok_bytes < tail) {
+        error_ = fed_ - n + pos + ok_bytes;
+        return false;
+    }
+    pending_len_ = n - tail;
+    std::copy(chunk.begin() + tail, chunk.end(), pending_);
+    return true;
+}
+
+bool StreamValidator::finish() {
+    if (pending_len_ > 0 && ok()) error_ = fed_ - pending_len_;
+    pending_len_ = 0;
+    return ok();
+}
+
+StreamDecoder::StreamDecoder(ErrorMode mode)
+    : mode_(mode), pending_(), pending_len_(0), fed_(0), error_(kstring::knpos) {}
+
+void StreamDecoder::reset() {
+    pending_len_ = 0;
+    fed_ = 0;
+    error_ = kstring::knpos;
+}
+
+bool StreamDecoder::on_error(std::size_t offset) {
+    if (error_ == kstring::knpos) error_ = offset;
+    return mode_ == ErrorMode::Lossy;
+}
+
+bool StreamDecoder::feed(const ByteSpan& chunk, std::vector<CodePoint>& out) {
+    const std::size_t n = chunk.size();
+    const std::size_t pending_start = fed_ - pending_len_;
+    fed_ += n;
+    if (! ok() && mode_ == ErrorMode::Strict) return false;
+
+    // 上一块留下的序列接上本块开头至多 4 字节后按 decode_one 切分; 拼接后仍被截断时继续留到下一块
+    std::size_t pos = 0;
+    if (pending_len_ > 0) {
+        Byte joined[8];
+        const std::size_t head = std::min<std::size_t>(n, 4);
+        std::memcpy(joined, pending_, pending_len_);
+        std::copy(chunk.begin(), chunk.begin() + head, joined + pending_len_);
+        const std::size_t joined_len = pending_len_ + head;
+        std::size_t jpos = 0;
+        while (jpos < pending_len_) {
+            const std::size_t len = lead_utf8_length(joined[jpos]);
+            if (head == n && len >= 2 && jpos + len > joined_len) {
+                pending_len_ = joined_len - jpos;
+                std::memmove(pending_, joined + jpos, pending_len_);
+                return ok();
+            }
+            UTF8Decoded d = dfa_decode(joined, jpos, joined_len);
+            if (! d.ok && ! on_error(pending_start + jpos)) {
+                pending_len_ = 0;
+                return false;
+            }
+            out.push_back(d.ok ? d.codepoint : kstring::ILL_CODEPOINT);
+            jpos = d.next_pos;
+        }
+        pos = jpos - pending_len_;
+        pending_len_ = 0;
+    }
+
+    // 主体: 合法段由 simdutf 整段转换为 UTF-32; 非法序列在整块上按 dfa_decode 切分, 不会越过留下的截断序列
+    const std::size_t tail = pos + truncated_tail(chunk.subspan(pos));
+    const char* in = reinterpret_cast<const char*>(chunk.data());
+    while (pos < tail) {
+        const std::size_t old_size = out.size();
+        out.resize(old_size + (tail - pos));
+        char32_t* dst = reinterpret_cast<char32_t*>(out.data() + old_size);
+        simdutf::result r = simdutf::convert_utf8_to_utf32_with_errors(in + pos, tail - pos, dst);
+        if (r.error == simdutf::error_code::SUCCESS) {
+            out.resize(old_size + r.count);
+            pos = tail;
+            break;
+        }
+        std::size_t count = r.count == 0 ? 0 : simdutf::convert_valid_utf8_to_utf32(in + pos, r.count, dst);
+        out.resize(old_size + count);
+        pos += r.count;
+        if (! on_error(fed_ - n + pos)) return false;
+        out.push_back(kstring::ILL_CODEPOINT);
+        pos = dfa_decode(chunk.data(), pos, n).next_pos;
+    }
+    pending_len_ = n - tail;
+    std::copy(chunk.begin() + tail, chunk.end(), pending_);
+    return ok();
+}
+
+bool StreamDecoder::finish(std::vector<CodePoint>& out) {
+    // 流在截断的序列中结束: 与 decode_one 相同, 剩下的字节整体算作一个非法字符
+    if (pending_len_ > 0 && on_error(fed_ - pending_len_)) out.push_back(kstring::ILL_CODEPOINT);
+    pending_len_ = 0;
+    return ok();
+}
+
 // decode range [start, end)
 std::vector<CodePoint> decode_range(const ByteSpan& data, size_t start, size_t end) {
     std::vector<CodePoint> results;
@@ -279,80 +648,117 @@ std::vector<CodePoint> decode_range(const ByteSpan& data, size_t start, size_t e
 
 UTF8Decoded decode_one_prev(const ByteSpan& data, std::size_t pos) {
     if (pos == 0) return UTF8Decoded(0, false, 0);
+    const Byte* p = data.data();
 
-    // 最多看 4 字节
-    std::size_t start = (pos >= 4) ? pos - 4 : 0;
-
-    std::size_t p = pos - 1;
-    do {
-        auto dec = utf8::decode_one(data, p);
-        if (dec.ok) {
-            if (dec.next_pos == pos) // 正好 decode 到 [p, pos)
-                return UTF8Decoded(dec.codepoint, p);
-            else // 先迭代非法字符, FIXME
-                return UTF8Decoded(kstring::ILL_CODEPOINT, false, pos - 1);
-        }
-        // decode 失败, 继续往前探测
-        if (p == start) break;
-        --p;
-    } while (true);
+    // 末尾被截断的序列: decode_one 把它连同其后的字节算作一个非法字符
+    if (pos == data.size()) {
+        std::size_t tail = truncated_tail(data);
+        if (tail < pos) return UTF8Decoded::ill(tail);
+    }
 
-    // fallback: treat last byte (pos - 1) as illegal, 一个非法字节 = 一个字符
-    return UTF8Decoded(0, false, pos - 1);
+    const Byte last = p[pos - 1];
+    if (last < 0x80) return UTF8Decoded(last, pos - 1);
+    CodePoint cp = 0;
+    std::size_t len = try_decode_prev(p, pos, cp);
+    if (len != 0) return UTF8Decoded(cp, pos - len);
+
+    // 非法: 若前面的首字节覆盖到 pos, [start, pos) 是 decode_one 给出的一个非法序列, 否则 pos - 1 单独成一个
+    const std::size_t limit = pos >= 4 ? pos - 4 : 0;
+    std::size_t start = pos - 1;
+    while (start > limit && (p[start] & 0xC0) == 0x80) --start;
+    len = lead_utf8_length(p[start]);
+    return UTF8Decoded::ill(len >= 2 && start + len >= pos ? start : pos - 1);
 }
 
 // 查找字符数（不是字节数）
 std::size_t char_count(const ByteSpan& data) {
     std::size_t pos = 0;
     std::size_t count = 0;
-    size_t size = data.size();
-
-    std::vector<CodePoint> buf(size); // 最多每字节一个字符
+    const std::size_t size = data.size();
 
+    // 不做转码, 也无需额外内存: 合法段用 simdutf 直接计数, 遇到非法序列按 decode_one 跳过并计为一个字符
     while (pos < size) {
-        ByteSpan input = data.subspan(pos);
-        auto result = decode_valid_prefix(input, buf);
-        count += result.ok_chars;
+        auto bytes_chars_error = count_valid_bytes_chars_with_error(data.subspan(pos));
+        std::size_t ok_bytes = bytes_chars_error.first.first;
+        count += bytes_chars_error.first.second;
 
-        if (result.is_ok()) {
+        if (bytes_chars_error.second == simdutf::error_code::SUCCESS) {
             break;
         }
 
-        // is_err() 部分成功
-        // 我们需要确定这个偏移量内有多少个完整字符(此时在偏移量内必然是合法字符)
-        // 更新位置到错误处, 开始继续解码
-        pos += result.ok_bytes;
-        UTF8Decoded bad = decode_one(data, pos);
-        pos = bad.next_pos;
+        // 错误位置之前必然都是完整的合法字符, 从错误处继续
+        pos += ok_bytes;
+        pos = decode_one(data, pos).next_pos;
         count++;
     }
 
     return count;
 }
 
-// 查找首次出现的 code point（按字符计数）
-std::size_t find_codepoint(const ByteSpan& data, CodePoint target_cp) {
-    if (target_cp <= 0X7F) {
-        const void* result = std::memchr(data.data(), static_cast<uint8_t>(target_cp), data.size());
-        if (! result) return kstring::knpos;
+std::size_t invalid_count(const ByteSpan& data) {
+    std::size_t count = 0;
+    // 同 char_count: 合法段整段跳过, 非法序列按 decode_one 跳过
+    std::size_t pos = count_valid_bytes(data);
+    while (pos < data.size()) {
+        pos = decode_one(data, pos).next_pos;
+        ++count;
+        pos += count_valid_bytes(data.subspan(pos));
+    }
+    return count;
+}
 
-        std::size_t byte_offset = reinterpret_cast<const Byte*>(result) - data.data();
-        return char_count(ByteSpan(data.data(), byte_offset));
+std::size_t count_chars_to(const ByteSpan& data, std::size_t& pos, std::size_t end) {
+    std::size_t count = 0;
+    // 合法段用 simdutf 计数, 非法序列按 decode_one 在整个 data 上的切分跳过
+    while (pos < end) {
+        auto bytes_chars = count_valid_bytes_chars(data.subspan(pos, end - pos));
+        pos += bytes_chars.first;
+        count += bytes_chars.second;
+        if (pos < end) {
+            pos = decode_one(data, pos).next_pos;
+            ++count;
+        }
     }
+    return count;
+}
 
-    std::size_t index = 0;
-    for (std::size_t pos = 0; pos < data.size();) {
-        UTF8Decoded decode_result = decode_one(data, pos);
-        if (! decode_result.ok) break;
-        if (decode_result.codepoint == target_cp) return index;
-        pos = decode_result.next_pos;
-        ++index;
+std::size_t advance_chars(const ByteSpan& data, std::size_t pos, std::size_t n) {
+    const std::size_t size = data.size();
+    const char* base = reinterpret_cast<const char*>(data.data());
+
+    while (n > 0 && pos < size) {
+        if (data[pos] < 0x80) {
+            // ASCII 段: 一次性跳过 min(n, 剩余字节) 内的 ASCII 前缀
+            std::size_t limit = std::min(n, size - pos);
+            auto res = simdutf::validate_ascii_with_errors(base + pos, limit);
+            std::size_t run = res.is_ok() ? limit : res.count;
+            pos += run;
+            n -= run;
+        } else {
+            pos = decode_one(data, pos).next_pos;
+            --n;
+        }
     }
-    return kstring::knpos;
+    return n == 0 ? pos : kstring::knpos;
+}
+
+// 查找首次出现的 code point（按字符计数）
+std::size_t find_codepoint(const ByteSpan& data, CodePoint target_cp) {
+    if (is_surrogate_codepoint(target_cp) || is_overflow_codepoint(target_cp)) return kstring::knpos;
+
+    // 合法序列以首字节开头, 不会从别的字符中间匹配上: 直接按编码后的字节串做 SIMD 查找
+    UTF8Encoded encoded = encode(target_cp);
+    std::size_t byte_offset = kstring::search::find(data, ByteSpan(encoded.bytes, encoded.len));
+    if (byte_offset == kstring::knpos || byte_offset >= truncated_tail(data)) return kstring::knpos;
+
+    // 在整个 data 上计数: 单独截出前缀会让靠近截断点的首字节变成"末尾截断", 切分与全文不同
+    std::size_t pos = 0;
+    return count_chars_to(data, pos, byte_offset);
 }
 
 void replace_at(ByteVec& data, size_t index, CodePoint cp_new) {
-    UTF8Decoded decode_result = decode_one(data, index);
+    if (index >= data.size()) return;
+    UTF8Decoded decode_result = dfa_decode(data.data(), index, data.size());
     if (! decode_result.ok) return;
     std::size_t next_pos = decode_result.next_pos;
 
@@ -389,63 +795,34 @@ void replace_at(ByteVec& data, size_t index, CodePoint cp_new) {
 }
 
 void replace_all(ByteVec& data, CodePoint cp_old, CodePoint cp_new) {
-    std::size_t pos = 0;
-    UTF8Encoded encoded = encode(cp_new); // 预编码 cp_new，避免重复计算
-    std::size_t new_len = encoded.len;
-
-    while (pos < data.size()) {
-        UTF8Decoded decode_result = decode_one(data, pos);
-        if (! decode_result.ok) break;
-        std::size_t next = decode_result.next_pos;
-
-        if (decode_result.codepoint == cp_old) {
-            std::size_t old_len = next - pos;
-            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(new_len) - static_cast<std::ptrdiff_t>(old_len);
-
-            if (diff == 0) {
-                // 直接覆盖
-                std::copy(encoded.begin(), encoded.end(), data.begin() + pos);
-                pos = next;
-            } else {
-                std::size_t tail_begin = next;
-                std::size_t tail_len = data.size() - tail_begin;
-
-                if (diff > 0) {
-                    // 扩容 + 后移 tail
-                    data.resize(data.size() + diff);
-                    std::move_backward(data.begin() + tail_begin, data.begin() + tail_begin + tail_len, data.end());
-                } else {
-                    // 前移 tail（先 move，再 resize）
-                    std::move(data.begin() + tail_begin,
-                              data.end(),
-                              data.begin() + tail_begin + diff // diff < 0
-                    );
-                    data.resize(data.size() + diff);
-                }
-
-                // 替换
-                std::copy(encoded.begin(), encoded.end(), data.begin() + pos);
-                pos = pos + new_len;
-            }
-        } else {
-            pos = next;
+    if (is_surrogate_codepoint(cp_old) || is_overflow_codepoint(cp_old)) return;
+    UTF8Encoded from = encode(cp_old);
+    UTF8Encoded to = encode(cp_new);
+    const ByteSpan pat(from.bytes, from.len);
+    const ByteSpan body(data.data(), truncated_tail(data)); // 截断的序列中不会解码出 cp_old
+    if (kstring::search::find(body, pat) == kstring::knpos) return;
+
+    if (from.len == to.len) { // 等长: 原地覆盖, 不分配
+        std::size_t found[128];
+        std::size_t n = 0;
+        for (std::size_t pos = 0; (n = kstring::search::find_many(body, pat, pos, found, 128)) != 0;) {
+            for (std::size_t i = 0; i < n; ++i) std::memcpy(data.data() + found[i], to.bytes, to.len);
+            pos = found[n - 1] + from.len;
         }
+        return;
     }
+
+    ByteVec out;
+    kstring::search::replace(body, pat, ByteSpan(to.bytes, to.len), out);
+    out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(body.size()), data.end());
+    data.swap(out);
 }
 
 void replace_first(ByteVec& data, CodePoint cp_old, CodePoint cp_new) {
-    std::size_t pos = 0;
-    while (pos < data.size()) {
-        UTF8Decoded decode_result = decode_one(data, pos);
-        if (! decode_result.ok) break;
-
-        if (decode_result.codepoint == cp_old) {
-            replace_at(data, pos, cp_new);
-            return;
-        }
-
-        pos = decode_result.next_pos;
-    }
+    if (is_surrogate_codepoint(cp_old) || is_overflow_codepoint(cp_old)) return;
+    UTF8Encoded from = encode(cp_old);
+    std::size_t pos = kstring::search::find(data, ByteSpan(from.bytes, from.len));
+    if (pos != kstring::knpos && pos < truncated_tail(data)) replace_at(data, pos, cp_new);
 }
 
 // 是否是 ASCII 纯文本
@@ -453,6 +830,11 @@ bool is_all_ascii(const ByteSpan& data) {
     return simdutf::validate_ascii(reinterpret_cast<const char*>(data.data()), data.size());
 }
 
+std::size_t non_ascii_count(const ByteSpan& data) {
+    // 按 Latin-1 转 UTF-8 时每个高位字节变为 2 字节, 长度之差即为高位字节数
+    return simdutf::utf8_length_from_latin1(reinterpret_cast<const char*>(data.data()), data.size()) - data.size();
+}
+
 std::string codepoint_to_string(CodePoint cp) {
     UTF8Encoded bytes = utf8::encode(cp);
     return std::string(bytes.begin(), bytes.end()); // 转为 std::string 输出
@@ -0,0 +1,199 @@
+#include "utf8.hpp"
+#include "whitespace.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KSTRING_WHITESPACE_X86 1
+#endif
+
+namespace kstring {
+namespace whitespace {
+namespace {
+// 32 字节块的分类位图, 第 i 位对应块内第 i 个字节
+struct BlockMask {
+    std::uint32_t ascii; // ASCII 空白
+    std::uint32_t lead;  // 可能开始多字节空白的首字节
+};
+
+typedef BlockMask (*ClassifyFn)(const Byte*);
+
+inline bool is_ascii_space(Byte b) {
+    return b < 64 && ((ASCII_WHITESPACE_MASK >> b) & 1u) != 0;
+}
+
+// 多字节空白只有 U+00A0 (C2), U+1680 (E1), U+2000..U+205F (E2), U+3000 (E3)
+inline bool is_space_lead(Byte b) {
+    return b == 0xC2 || (b >= 0xE1 && b <= 0xE3);
+}
+
+// pos 处是否为多字节空白, 是则返回其字节数, 否则返回 0
+inline std::size_t multibyte_space_len(ByteSpan data, std::size_t pos) {
+    auto dec = utf8::decode_one(data, pos);
+    return dec.ok && is_whitespace_codepoint(dec.codepoint) ? dec.next_pos - pos : 0;
+}
+
+BlockMask classify_scalar(const Byte* p) {
+    BlockMask m = {0, 0};
+    for (unsigned i = 0; i < 32; ++i) {
+        if (is_ascii_space(p[i])) m.ascii |= 1u << i;
+        if (is_space_lead(p[i])) m.lead |= 1u << i;
+    }
+    return m;
+}
+
+#ifdef KSTRING_WHITESPACE_X86
+// b - lo <= span (无符号), 即 b 落在 [lo, lo + span]
+__attribute__((target("sse2"))) inline __m128i in_range_sse2(__m128i b, char lo, char span) {
+    __m128i d = _mm_sub_epi8(b, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(span)), d);
+}
+
+__attribute__((target("sse2"))) BlockMask classify_sse2(const Byte* p) {
+    BlockMask m = {0, 0};
+    for (unsigned half = 0; half < 32; half += 16) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + half));
+        __m128i ascii = _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(' ')), in_range_sse2(b, '\t', 4));
+        __m128i lead = _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(static_cast<char>(0xC2))),
+                                    in_range_sse2(b, static_cast<char>(0xE1), 2));
+        m.ascii |= static_cast<std::uint32_t>(_mm_movemask_epi8(ascii)) << half;
+        m.lead |= static_cast<std::uint32_t>(_mm_movemask_epi8(lead)) << half;
+    }
+    return m;
+}
+
+__attribute__((target("avx2"))) inline __m256i in_range_avx2(__m256i b, char lo, char span) {
+    __m256i d = _mm256_sub_epi8(b, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(span)), d);
+}
+
+__attribute__((target("avx2"))) BlockMask classify_avx2(const Byte* p) {
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i ascii = _mm256_or_si256(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(' ')), in_range_avx2(b, '\t', 4));
+    __m256i lead = _mm256_or_si256(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(static_cast<char>(0xC2))),
+                                   in_range_avx2(b, static_cast<char>(0xE1), 2));
+    BlockMask m = {static_cast<std::uint32_t>(_mm256_movemask_epi8(ascii)),
+                   static_cast<std::uint32_t>(_mm256_movemask_epi8(lead))};
+    return m;
+}
+#endif
+
+struct Backend {
+    const char* name;
+    ClassifyFn classify;
+};
+
+Backend select_backend() {
+#ifdef KSTRING_WHITESPACE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Backend{"avx2", classify_avx2};
+    if (__builtin_cpu_supports("sse2")) return Backend{"sse2", classify_sse2};
+#endif
+    return Backend{"scalar", classify_scalar};
+}
+
+const Backend& backend() {
+    static const Backend selected = select_backend();
+    return selected;
+}
+
+// q 处是否为完整落在 [0, end) 中的空白字符, 是则返回其字节数
+inline std::size_t space_len_at(ByteSpan data, std::size_t q, std::size_t end) {
+    if (data[q] < 0x80) return is_ascii_space(data[q]) ? 1 : 0;
+    if (! is_space_lead(data[q])) return 0;
+    std::size_t len = multibyte_space_len(data, q);
+    return q + len <= end ? len : 0;
+}
+} // namespace
+
+std::size_t find(ByteSpan data, std::size_t pos, std::size_t& len) {
+    const std::size_t n = data.size();
+    const ClassifyFn classify = backend().classify;
+    std::size_t p = pos;
+    for (; p + 32 <= n; p += 32) {
+        BlockMask m = classify(data.data() + p);
+        std::uint32_t bits = m.ascii | m.lead;
+        while (bits != 0) {
+            std::size_t q = p + static_cast<std::size_t>(__builtin_ctz(bits));
+            bits &= bits - 1;
+            len = space_len_at(data, q, n);
+            if (len != 0) return q;
+        }
+    }
+    for (; p < n; ++p) {
+        len = space_len_at(data, p, n);
+        if (len != 0) return p;
+    }
+    return knpos;
+}
+
+std::size_t rfind(ByteSpan data, std::size_t end, std::size_t& len) {
+    const ClassifyFn classify = backend().classify;
+    std::size_t e = end;
+    for (; e >= 32; e -= 32) {
+        BlockMask m = classify(data.data() + e - 32);
+        std::uint32_t bits = m.ascii | m.lead;
+        while (bits != 0) {
+            unsigned hi = 31u - static_cast<unsigned>(__builtin_clz(bits));
+            bits &= ~(1u << hi);
+            std::size_t q = e - 32 + hi;
+            len = space_len_at(data, q, end);
+            if (len != 0) return q;
+        }
+    }
+    for (std::size_t q = e; q-- > 0;) {
+        len = space_len_at(data, q, end);
+        if (len != 0) return q;
+    }
+    return knpos;
+}
+
+std::size_t skip(ByteSpan data, std::size_t pos) {
+    const std::size_t n = data.size();
+    const ClassifyFn classify = backend().classify;
+    std::size_t p = pos;
+    while (true) {
+        // 整块都是 ASCII 空白时直接跳过
+        for (; p + 32 <= n; p += 32) {
+            std::uint32_t other = ~classify(data.data() + p).ascii;
+            if (other != 0) {
+                p += static_cast<std::size_t>(__builtin_ctz(other));
+                break;
+            }
+        }
+        while (p < n && is_ascii_space(data[p])) ++p;
+        if (p >= n) return n;
+        if (! is_space_lead(data[p])) return p;
+        std::size_t len = multibyte_space_len(data, p);
+        if (len == 0) return p;
+        p += len;
+    }
+}
+
+std::size_t rskip(ByteSpan data, std::size_t end) {
+    const ClassifyFn classify = backend().classify;
+    std::size_t e = end;
+    while (true) {
+        for (; e >= 32; e -= 32) {
+            std::uint32_t other = ~classify(data.data() + e - 32).ascii;
+            if (other != 0) {
+                e = e - 31 + (31u - static_cast<unsigned>(__builtin_clz(other)));
+                break;
+            }
+        }
+        while (e > 0 && is_ascii_space(data[e - 1])) --e;
+        if (e == 0 || data[e - 1] < 0x80) return e;
+        // 末字节是续字节时, 多字节空白的首字节只可能在 e - 2 (U+00A0) 或 e - 3
+        std::size_t len = 0;
+        for (std::size_t k = 2; k <= 3 && len == 0; ++k) {
+            if (e >= k && is_space_lead(data[e - k]) && multibyte_space_len(data, e - k) == k) len = k;
+        }
+        if (len == 0) return e;
+        e -= len;
+    }
+}
+
+const char* simd_backend() {
+    return backend().name;
+}
+} // namespace whitespace
+} // namespace kstring
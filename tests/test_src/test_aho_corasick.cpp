@@ -0,0 +1,214 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+#include <vector>
+#include <doctest/doctest.h>
+#include "../../include/aho_corasick.hpp"
+#include "../../include/ksearcher.hpp"
+
+using namespace kstring;
+using search::AhoCorasick;
+using search::MultiMatch;
+
+namespace {
+ByteSpan bytes(const std::string& s) {
+    return ByteSpan(reinterpret_cast<const Byte*>(s.data()), s.size());
+}
+
+std::vector<ByteSpan> spans(const std::vector<std::string>& pats) {
+    std::vector<ByteSpan> out;
+    for (const auto& p : pats) out.push_back(bytes(p));
+    return out;
+}
+
+// 逐个起点尝试全部模式, 作为引擎结果的对照
+MultiMatch naive_find(const std::string& hay, const std::vector<std::string>& pats, MatchKind kind,
+                      std::size_t from) {
+    for (std::size_t start = from; start <= hay.size(); ++start) {
+        MultiMatch best;
+        for (std::size_t id = 0; id < pats.size(); ++id) {
+            if (hay.compare(start, pats[id].size(), pats[id]) != 0) continue;
+            if (start + pats[id].size() > hay.size()) continue;
+            bool take = ! best.found();
+            if (! take && kind == MatchKind::LeftmostLongest) take = pats[id].size() > best.end - best.start;
+            if (take) best = MultiMatch(id, start, start + pats[id].size());
+        }
+        if (best.found()) return best;
+    }
+    return MultiMatch();
+}
+
+std::vector<MultiMatch> naive_find_all(const std::string& hay, const std::vector<std::string>& pats,
+                                       MatchKind kind) {
+    std::vector<MultiMatch> out;
+    std::size_t pos = 0;
+    while (pos <= hay.size()) {
+        MultiMatch m = naive_find(hay, pats, kind, pos);
+        if (! m.found()) break;
+        out.push_back(m);
+        pos = m.end > m.start ? m.end : m.end + 1;
+    }
+    return out;
+}
+
+std::string random_text(std::size_t len, unsigned& seed, char alphabet) {
+    std::string s(len, 'a');
+    for (auto& c : s) {
+        seed = seed * 1103515245u + 12345u;
+        c = static_cast<char>('a' + (seed >> 16) % static_cast<unsigned>(alphabet));
+    }
+    return s;
+}
+} // namespace
+
+TEST_CASE("AhoCorasick leftmost-first prefers earlier patterns") {
+    std::vector<std::string> pats = {"abcd", "b", "bc", "ab"};
+    AhoCorasick ac(spans(pats));
+    CHECK(ac.pattern_count() == 4);
+    CHECK(ac.pattern(2) == bytes("bc"));
+    CHECK_THROWS_AS(ac.pattern(4), std::out_of_range);
+
+    CHECK(ac.find(bytes("xabcd")) == MultiMatch(0, 1, 5));
+    CHECK(ac.find(bytes("xabc")) == MultiMatch(3, 1, 3));
+    CHECK(ac.find(bytes("xbc")) == MultiMatch(1, 1, 2));
+    CHECK_FALSE(ac.find(bytes("xyz")).found());
+    CHECK_FALSE(ac.find(bytes("")).found());
+    CHECK(ac.contains_any(bytes("zzzb")));
+
+    // a|ab 语义: 较早的短模式胜出
+    AhoCorasick short_first(spans({"a", "ab"}));
+    CHECK(short_first.find(bytes("ab")) == MultiMatch(0, 0, 1));
+}
+
+TEST_CASE("AhoCorasick leftmost-longest prefers longer patterns") {
+    AhoCorasick ac(spans({"a", "ab", "abc", "b"}), MatchKind::LeftmostLongest);
+    CHECK(ac.find(bytes("xabcx")) == MultiMatch(2, 1, 4));
+    CHECK(ac.find(bytes("xabx")) == MultiMatch(1, 1, 3));
+    CHECK(ac.find(bytes("xbx")) == MultiMatch(3, 1, 2));
+
+    std::vector<MultiMatch> all = ac.find_all(bytes("abcab b"));
+    std::vector<MultiMatch> expected = {MultiMatch(2, 0, 3), MultiMatch(1, 3, 5), MultiMatch(3, 6, 7)};
+    CHECK(all == expected);
+
+    // 重复模式取最小 id
+    AhoCorasick dup(spans({"xy", "xy"}), MatchKind::LeftmostLongest);
+    CHECK(dup.find(bytes("axy")) == MultiMatch(0, 1, 3));
+}
+
+TEST_CASE("AhoCorasick empty pattern matches at every position") {
+    AhoCorasick ac(spans({"b", ""}));
+    CHECK_FALSE(ac.has_prefilter());
+    CHECK(ac.find(bytes("abc")) == MultiMatch(1, 0, 0));
+    CHECK(ac.find(bytes("abc"), 1) == MultiMatch(0, 1, 2));
+    CHECK(ac.find(bytes("abc"), 3) == MultiMatch(1, 3, 3));
+    CHECK_FALSE(ac.find(bytes("abc"), 4).found());
+
+    std::vector<MultiMatch> all = ac.find_all(bytes("ab"));
+    std::vector<MultiMatch> expected = {MultiMatch(1, 0, 0), MultiMatch(0, 1, 2), MultiMatch(1, 2, 2)};
+    CHECK(all == expected);
+
+    AhoCorasick none(spans({}));
+    CHECK(none.pattern_count() == 0);
+    CHECK_FALSE(none.find(bytes("abc")).found());
+}
+
+TEST_CASE("AhoCorasick prefilter skips non-start bytes") {
+    AhoCorasick ac(spans({"needle", "nail", "pin"}));
+    CHECK(ac.has_prefilter());
+    std::string hay(1000, '.');
+    hay += "pinneedle";
+    CHECK(ac.find(bytes(hay)) == MultiMatch(2, 1000, 1003));
+    CHECK(ac.find_all(bytes(hay)).size() == 2);
+    CHECK_FALSE(ac.find(bytes(std::string(1000, 'n'))).found());
+
+    // 首字节超过 SIMD 上限时不启用预过滤
+    AhoCorasick many(spans({"a", "b", "c", "d", "e", "f", "g", "h", "i"}));
+    CHECK_FALSE(many.has_prefilter());
+}
+
+TEST_CASE("AhoCorasick matches naive search on random inputs") {
+    unsigned seed = 7;
+    for (MatchKind kind : {MatchKind::LeftmostFirst, MatchKind::LeftmostLongest}) {
+        for (int round = 0; round < 200; ++round) {
+            std::vector<std::string> pats;
+            std::size_t n_pat = 1 + static_cast<std::size_t>(round % 12);
+            for (std::size_t i = 0; i < n_pat; ++i) {
+                seed = seed * 1103515245u + 12345u;
+                pats.push_back(random_text(1 + (seed >> 16) % 5, seed, round % 2 == 0 ? 3 : 12));
+            }
+            if (round % 17 == 0) pats.push_back("");
+            std::string hay = random_text(200, seed, round % 2 == 0 ? 3 : 12);
+
+            AhoCorasick ac(spans(pats), kind);
+            CHECK(ac.find(bytes(hay)) == naive_find(hay, pats, kind, 0));
+            CHECK(ac.find(bytes(hay), 50) == naive_find(hay, pats, kind, 50));
+            CHECK(ac.find_all(bytes(hay)) == naive_find_all(hay, pats, kind));
+        }
+    }
+}
+
+TEST_CASE("KMultiSearcher reports pattern, byte offset, char index and a view") {
+    KStr body("请求超时, error: 连接错误; retry error");
+    KMultiSearcher keywords({"错误", "error", "超时"});
+    CHECK(keywords.pattern_count() == 3);
+    CHECK(keywords.pattern(0) == "错误");
+
+    KMatch first = keywords.find(body);
+    REQUIRE(first.found());
+    CHECK(first.pattern == 2);
+    CHECK(first.byte_offset == 6);
+    CHECK(first.char_index == 2);
+    CHECK(first.text == "超时");
+    CHECK(first.text.as_bytes().data() == body.as_bytes().data() + 6);
+
+    std::vector<KMatch> all = keywords.find_all(body);
+    REQUIRE(all.size() == 4);
+    std::vector<std::size_t> ids, chars;
+    for (const auto& m : all) {
+        ids.push_back(m.pattern);
+        chars.push_back(m.char_index);
+        CHECK(m.text == keywords.pattern(m.pattern));
+        CHECK(body.count_chars_before(m.byte_offset) == m.char_index);
+    }
+    std::vector<std::size_t> expected_ids = {2, 1, 0, 1};
+    std::vector<std::size_t> expected_chars = {2, 6, 15, 25};
+    CHECK(ids == expected_ids);
+    CHECK(chars == expected_chars);
+
+    CHECK(keywords.contains_any(body));
+    CHECK_FALSE(keywords.contains_any(KStr("一切正常")));
+    CHECK_FALSE(keywords.find(KStr("一切正常")).found());
+    CHECK(keywords.find(KStr("一切正常")).char_index == knpos);
+}
+
+TEST_CASE("KMultiSearcher match kinds and empty patterns advance by char") {
+    KStr s("中文中");
+    KMultiSearcher first({"中", "中文"});
+    KMultiSearcher longest({"中", "中文"}, MatchKind::LeftmostLongest);
+    CHECK(first.find(s).text == "中");
+    CHECK(longest.find(s).text == "中文");
+    CHECK(longest.find_all(s).size() == 2);
+
+    KMultiSearcher empty({""});
+    std::vector<KMatch> all = empty.find_all(s);
+    REQUIRE(all.size() == 4);
+    CHECK(all[1].byte_offset == 3);
+    CHECK(all[3].char_index == 3);
+}
+
+TEST_CASE("KAMultiSearcher works on ascii views") {
+    KAStr hay("GET /index.html HTTP/1.1");
+    KAMultiSearcher methods({"GET", "POST", "HTTP"});
+    KAMatch m = methods.find(hay);
+    REQUIRE(m.found());
+    CHECK(m.pattern == 0);
+    CHECK(m.offset == 0);
+    CHECK(m.text == "GET");
+
+    std::vector<KAMatch> all = methods.find_all(hay);
+    REQUIRE(all.size() == 2);
+    CHECK(all[1].offset == 16);
+    CHECK(all[1].text.data() == hay.data() + 16);
+    CHECK(methods.pattern(1) == "POST");
+    CHECK_FALSE(methods.contains_any(KAStr("PUT /")));
+}
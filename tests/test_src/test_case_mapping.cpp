@@ -0,0 +1,140 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <doctest/doctest.h>
+#include "../../include/case_mapping.hpp"
+#include "../../include/kchar.hpp"
+#include "../../include/kstring.hpp"
+
+using namespace kstring;
+
+namespace {
+std::string str(const KString& s) {
+    return static_cast<std::string>(s);
+}
+
+std::string lower(const std::string& s) {
+    return str(KStr(s.c_str()).to_lowercase());
+}
+
+std::string upper(const std::string& s) {
+    return str(KStr(s.c_str()).to_uppercase());
+}
+
+std::string encode(const unicode::CaseMapping& m) {
+    std::string out;
+    for (CodePoint cp : m) out += KChar(cp).to_utf8string();
+    return out;
+}
+
+// 逐字符查完整映射的对照实现 (不含 Final_Sigma)
+std::string naive_case(const std::string& s, bool to_upper) {
+    ByteSpan data(reinterpret_cast<const Byte*>(s.data()), s.size());
+    std::string out;
+    for (std::size_t pos = 0; pos < data.size();) {
+        auto dec = utf8::decode_one(data, pos);
+        if (dec.ok) {
+            out += encode(to_upper ? unicode::full_uppercase(dec.codepoint) : unicode::full_lowercase(dec.codepoint));
+        } else {
+            out.append(s, pos, dec.next_pos - pos);
+        }
+        pos = dec.next_pos;
+    }
+    return out;
+}
+} // namespace
+
+TEST_CASE("simple mappings agree with the vendored UnicodeData") {
+    std::ifstream in("../data/ucd/UnicodeData.txt");
+    std::string line;
+    std::size_t rows = 0;
+    std::size_t mismatches = 0;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::vector<std::string> fields;
+        std::istringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ';')) fields.push_back(field);
+        fields.resize(15);
+        CodePoint cp = static_cast<CodePoint>(std::stoul(fields[0], nullptr, 16));
+        CodePoint up = fields[12].empty() ? cp : static_cast<CodePoint>(std::stoul(fields[12], nullptr, 16));
+        CodePoint lo = fields[13].empty() ? cp : static_cast<CodePoint>(std::stoul(fields[13], nullptr, 16));
+        CodePoint ti = fields[14].empty() ? cp : static_cast<CodePoint>(std::stoul(fields[14], nullptr, 16));
+        mismatches += unicode::simple_uppercase(cp) != up;
+        mismatches += unicode::simple_lowercase(cp) != lo;
+        mismatches += unicode::simple_titlecase(cp) != ti;
+        ++rows;
+    }
+    CHECK(rows > 2000);
+    CHECK(mismatches == 0);
+    CHECK(unicode::simple_uppercase(0x4E2D) == 0x4E2D);
+    CHECK(unicode::simple_uppercase(0x110000) == 0x110000);
+}
+
+TEST_CASE("KChar case mapping covers non-ASCII and multi-char results") {
+    CHECK(KChar(0x0436).to_upper() == KChar(0x0416)); // ж → Ж
+    CHECK(KChar(0x0416).to_lower() == KChar(0x0436));
+    CHECK(KChar(0x01C6).to_title() == KChar(0x01C5)); // ǆ → ǅ
+    CHECK(KChar(0x00DF).to_upper() == KChar(0x00DF)); // ß 没有简单映射
+    CHECK(encode(KChar(0x00DF).to_upper_full()) == "SS");
+    CHECK(encode(KChar(0xFB03).to_upper_full()) == "FFI");             // ﬃ
+    CHECK(encode(KChar(0x0130).to_lower_full()) == "i\xcc\x87");       // İ → i̇
+    CHECK(encode(unicode::full_titlecase(0x00DF)) == "Ss");
+    CHECK(KChar(0x0390).to_upper_full().len == 3);
+}
+
+TEST_CASE("to_lowercase / to_uppercase use full mappings") {
+    CHECK(upper("Straße") == "STRASSE");
+    CHECK(lower("ПРИВЕТ, Мир!") == "привет, мир!");
+    CHECK(upper("ǆemal") == "ǄEMAL");
+    CHECK(lower("İstanbul") == "i\xcc\x87stanbul");
+    CHECK(upper("中文 abc") == "中文 ABC");
+    CHECK(lower("") == "");
+
+    // 非法字节原样保留
+    std::string raw = "AB\xff" "C\xe4\xbd";
+    CHECK(lower(raw) == "ab\xff" "c\xe4\xbd");
+
+    KString owned("Hello WORLD");
+    CHECK(owned.to_lowercase() == "hello world");
+    CHECK(owned.to_uppercase() == "HELLO WORLD");
+}
+
+TEST_CASE("to_lowercase applies Final_Sigma") {
+    CHECK(lower("ΟΔΟΣ") == "οδος");
+    CHECK(lower("ΟΔΟΣ ΣΑ") == "οδος σα");
+    CHECK(lower("Σ") == "σ");
+    CHECK(lower("ΑΣ.") == "ας.");
+    CHECK(lower("Α'Σ'Α") == "α'σ'α"); // 后面跟着大小写字母
+    CHECK(lower("ΣΣ") == "σς");
+    CHECK(upper("οδος") == "ΟΔΟΣ");
+}
+
+TEST_CASE("bulk conversion matches per-char mapping across block boundaries") {
+    static const char* pieces[] = {"abcDEFghijKLMNopqrSTUVwxyz0123", "Ж", "ß", "ﬃ", " ", "İ", "中", "\xff", "ǅ",
+                                   "@[`{"};
+    unsigned seed = 7;
+    for (int round = 0; round < 300; ++round) {
+        std::string s;
+        seed = seed * 1103515245u + 12345u;
+        std::size_t len = (seed >> 16) % 200;
+        while (s.size() < len) {
+            seed = seed * 1103515245u + 12345u;
+            s += pieces[(seed >> 16) % 10];
+        }
+        CHECK(lower(s) == naive_case(s, false));
+        CHECK(upper(s) == naive_case(s, true));
+    }
+
+    // 追加到已有内容之后
+    ByteVec out = {'>'};
+    std::string long_ascii(100, 'Q');
+    unicode::append_lowercase(ByteSpan(reinterpret_cast<const Byte*>(long_ascii.data()), long_ascii.size()), out);
+    CHECK(out.size() == 101);
+    CHECK(out[0] == '>');
+    CHECK(out[100] == 'q');
+    CHECK(std::string(unicode::case_simd_backend()).size() > 0);
+}
@@ -0,0 +1,116 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <doctest/doctest.h>
+#include "../../include/kstr.hpp"
+
+using namespace kstring;
+
+namespace {
+// 逐字符线性走一遍, 作为索引结果的对照
+std::vector<std::size_t> linear_offsets(ByteSpan data) {
+    std::vector<std::size_t> out;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        out.push_back(pos);
+        pos = utf8::decode_one(data, pos).next_pos;
+    }
+    out.push_back(data.size());
+    return out;
+}
+
+std::string repeat(const std::string& s, std::size_t n) {
+    std::string out;
+    for (std::size_t i = 0; i < n; ++i) out += s;
+    return out;
+}
+} // namespace
+
+TEST_CASE("CharOffsetIndex on ascii text stores no samples") {
+    std::string text = repeat("hello world ", 50);
+    CharOffsetIndex idx(KStr(text.c_str()).as_bytes(), 16);
+    CHECK(idx.is_ascii());
+    CHECK(idx.sample_count() == 0);
+    CHECK(idx.char_size() == text.size());
+    CHECK(idx.byte_offset(123) == 123);
+    CHECK(idx.byte_offset(text.size()) == text.size());
+    CHECK(idx.byte_offset(text.size() + 1) == knpos);
+    CHECK(idx.char_index(77) == 77);
+}
+
+TEST_CASE("CharOffsetIndex matches linear scan on mixed text") {
+    std::string text = repeat("你好, world! 😀 ĉ", 40);
+    ByteSpan bytes = KStr(text.c_str()).as_bytes();
+    std::vector<std::size_t> expected = linear_offsets(bytes);
+
+    for (std::size_t stride : {1, 3, 64, 256}) {
+        CharOffsetIndex idx(bytes, stride);
+        CHECK_FALSE(idx.is_ascii());
+        REQUIRE(idx.char_size() == expected.size() - 1);
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            CHECK(idx.byte_offset(i) == expected[i]);
+            CHECK(idx.char_index(expected[i]) == i);
+        }
+    }
+}
+
+TEST_CASE("CharOffsetIndex handles invalid bytes like decode_one") {
+    std::vector<Byte> raw;
+    for (int i = 0; i < 30; ++i) {
+        raw.insert(raw.end(), {'a', 0xff, 0xe4, 0xbd, 0xa0, 0x80, 0xe4, 0xbd, 'b'});
+    }
+    ByteSpan bytes(raw);
+    std::vector<std::size_t> expected = linear_offsets(bytes);
+
+    CharOffsetIndex idx(bytes, 8);
+    REQUIRE(idx.char_size() == expected.size() - 1);
+    CHECK(idx.char_size() == utf8::char_count(bytes));
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        CHECK(idx.byte_offset(i) == expected[i]);
+    }
+}
+
+TEST_CASE("CharOffsetIndex rejects zero stride") {
+    CHECK_THROWS_AS(CharOffsetIndex(KStr("abc").as_bytes(), 0), std::invalid_argument);
+}
+
+TEST_CASE("KStr with_index gives same results as unindexed access") {
+    std::string text = repeat("中文abc😀", 100);
+    KStr plain(text.c_str());
+    CharOffsetIndex idx = plain.build_index(16);
+    KStr indexed = plain.with_index(idx);
+
+    REQUIRE(indexed.index() == &idx);
+    CHECK(plain.index() == nullptr);
+    CHECK(indexed.char_size() == plain.char_size());
+
+    for (std::size_t i = 0; i < plain.char_size(); i += 7) {
+        CHECK(indexed.char_at(i) == plain.char_at(i));
+        CHECK(KStr(indexed[i]) == KStr(plain[i]));
+        CHECK(indexed.char_index_to_byte_offset(i) == plain.char_index_to_byte_offset(i));
+        CHECK(indexed.substr(i, 5) == plain.substr(i, 5));
+        CHECK(indexed.subrange(i, i + 9) == plain.subrange(i, i + 9));
+        CHECK(indexed.split_at(i).first == plain.split_at(i).first);
+        CHECK(indexed.count_chars_before(i) == plain.count_chars_before(i));
+    }
+
+    std::size_t n = plain.char_size();
+    CHECK_THROWS_AS(indexed.char_at(n), std::out_of_range);
+    CHECK_THROWS_AS(indexed.substr(n, 1), std::out_of_range);
+    CHECK(indexed.substr(n - 1, 100) == "😀");
+    CHECK(indexed.find("😀") == plain.find("😀"));
+    CHECK(indexed.rfind("中") == plain.rfind("中"));
+}
+
+TEST_CASE("KStr with_index rejects an index built for other bytes") {
+    std::string a = "你好";
+    std::string b = "你好";
+    KStr sa(a.c_str());
+    CharOffsetIndex idx = KStr(b.c_str()).build_index();
+    CHECK_THROWS_AS(sa.with_index(idx), std::invalid_argument);
+}
+
+TEST_CASE("KStr substr with zero count yields empty view") {
+    KStr s("你好世界");
+    CHECK(s.substr(1, 0).empty());
+    CHECK(s.substr(1, 0).as_bytes().data() == s.as_bytes().data() + 3);
+}
@@ -1,6 +1,8 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+#include <unordered_map>
 #include "../../include/kastr.hpp"
+#include "../../include/kastring.hpp"
 
 #include <doctest/doctest.h>
 
@@ -499,3 +501,63 @@ TEST_CASE("KAStr prefix/suffix/trim") {
         CHECK(s.strip_suffix("abcdef") == "abc");
     }
 }
+
+TEST_CASE("KAStr replace / replacen") {
+    KAStr log("user=alice token=abc123 user=bob");
+    CHECK(log.replace("user=", "u:") == "u:alice token=abc123 u:bob");
+    CHECK(log.replace("abc123", "******") == "user=alice token=****** user=bob");
+    CHECK(log.replacen("user", "account", 1) == "account=alice token=abc123 user=bob");
+    CHECK(log.replace("missing", "x").as_kastr() == log);
+    CHECK(log.replace(" ", "") == "user=alicetoken=abc123user=bob");
+    CHECK(KAStr("aaaa").replace("aa", "a") == "aa");
+    CHECK(KAStr("").replace("a", "b") == "");
+
+    // 空模式: 每个字节之间 (含首尾) 插入
+    CHECK(KAStr("abc").replace("", "-") == "-a-b-c-");
+    CHECK(KAStr("abc").replacen("", "-", 2) == "-a-bc");
+    CHECK(KAStr("").replace("", "-") == "-");
+    CHECK(KAString("a.b.c").replacen(".", "::", 5) == "a::b::c");
+
+    // 内嵌 0 字节是合法的 ASCII, 结果不经过 C 字符串构造
+    const std::string nul = std::string("a\0b", 3) + std::string(24, 'x');
+    KAString replaced = KAStr(nul.data(), nul.size()).replace("b", "c");
+    CHECK(replaced.byte_size() == 27);
+    CHECK(std::string(replaced) == "a" + std::string(1, '\0') + "c" + std::string(24, 'x'));
+    CHECK(std::string(KAStr(nul.data(), 3).replace("", "-")) == std::string("-a-\0-b-", 7));
+}
+
+TEST_CASE("KAStr ignore-ascii-case operations") {
+    KAStr header("Content-Type");
+    CHECK(header.eq_ignore_ascii_case("content-type"));
+    CHECK(header.eq_ignore_ascii_case("CONTENT-TYPE"));
+    CHECK_FALSE(header.eq_ignore_ascii_case("content-typ"));
+    CHECK_FALSE(header.eq_ignore_ascii_case("content_type"));
+    CHECK(KAStr().eq_ignore_ascii_case(""));
+
+    KAStr line("GET /Index.HTML HTTP/1.1");
+    CHECK(line.find_ignore_ascii_case("index.html") == 5);
+    CHECK(line.find_ignore_ascii_case("http/") == 16);
+    CHECK(line.find_ignore_ascii_case("h") == 11);
+    CHECK(line.find_ignore_ascii_case("") == 0);
+    CHECK(line.find_ignore_ascii_case("index.htm!") == knpos);
+    CHECK(line.starts_with_ignore_ascii_case("get "));
+    CHECK_FALSE(line.starts_with_ignore_ascii_case("post"));
+    CHECK(line.ends_with_ignore_ascii_case("http/1.1"));
+    CHECK_FALSE(KAStr("ab").ends_with_ignore_ascii_case("xab"));
+
+    // 32 字节以上走整块比较, 差异在最后一个字节
+    std::string long_a(70, 'K');
+    std::string long_b(70, 'k');
+    CHECK(KAStr(long_a).eq_ignore_ascii_case(KAStr(long_b)));
+    long_b.back() = 'x';
+    CHECK_FALSE(KAStr(long_a).eq_ignore_ascii_case(KAStr(long_b)));
+
+    CHECK(header.hash_ignore_ascii_case() == KAStr("CONTENT-type").hash_ignore_ascii_case());
+    CHECK(KAStr("content-type").hash_ignore_ascii_case() == std::hash<KAStr>()(KAStr("content-type")));
+
+    std::unordered_map<KAStr, int, IgnoreAsciiCaseHash, IgnoreAsciiCaseEqual> headers;
+    headers["Host"] = 1;
+    headers["HOST"] = 2;
+    CHECK(headers.size() == 1);
+    CHECK(headers.at("host") == 2);
+}
@@ -42,7 +42,7 @@ TEST_CASE("KChar::is_ascii and related checks") {
     KChar euro(0x20AC); // €
     CHECK(! euro.is_ascii());
     CHECK(! euro.is_alpha());
-    CHECK(! euro.is_printable());
+    CHECK(euro.is_printable()); // Sc, 按 Unicode 表判定
 }
 
 TEST_CASE("KChar::to_ascii_char") {
@@ -0,0 +1,84 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+#include <vector>
+#include <doctest/doctest.h>
+#include "../../include/kastring.hpp"
+#include "../../include/ksearcher.hpp"
+#include "../../include/kstring.hpp"
+
+using namespace kstring;
+
+TEST_CASE("KSearcher finds by char index like KStr::find") {
+    KSearcher searcher("你好");
+    KStr s("abc你好abc你好");
+
+    CHECK(searcher.needle() == "你好");
+    CHECK(searcher.find(s) == 3);
+    CHECK(searcher.rfind(s) == 8);
+    CHECK(searcher.find_in_bytes(s) == 3);
+    CHECK(searcher.rfind_in_bytes(s) == 12);
+    CHECK(searcher.find_index(s) == CharIndex(KChar(0x4F60), 3, 3));
+    CHECK(searcher.contains(s));
+    CHECK_FALSE(searcher.contains(KStr("你 好")));
+    CHECK(searcher.find(KStr("")) == knpos);
+
+    // KStr / KString 接受查找器
+    CHECK(s.find(searcher) == s.find("你好"));
+    CHECK(s.rfind(searcher) == s.rfind("你好"));
+    CHECK(s.rfind_index(searcher) == s.rfind_index("你好"));
+    KString owned(s);
+    CHECK(owned.find(searcher) == 3);
+    CHECK(owned.rfind(searcher) == 8);
+    CHECK(KString("xx你好").find(KSearcher("x你")) == 1);
+    CHECK(KString("axbx").rfind(KSearcher("x")) == 3);
+}
+
+TEST_CASE("KSearcher reused across many records") {
+    KSearcher searcher("ERROR");
+    std::vector<std::string> records = {"INFO ok", "ERROR disk", "WARN ERROR ERROR", "", "ERRO"};
+    std::vector<std::size_t> expected = {knpos, 0, 5, knpos, knpos};
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        KStr rec(records[i].data(), records[i].size());
+        CHECK(searcher.find(rec) == expected[i]);
+        CHECK(searcher.find(rec) == rec.find("ERROR"));
+    }
+    CHECK(searcher.count(KStr("WARN ERROR ERROR")) == 2);
+}
+
+TEST_CASE("KSearcher find_all and count") {
+    KSearcher searcher("中");
+    KStr s("中a中b中");
+
+    std::vector<std::size_t> idx;
+    for (const auto& m : searcher.find_all(s)) idx.push_back(m.char_index);
+    std::vector<std::size_t> expected = {0, 2, 4};
+    CHECK(idx == expected);
+    CHECK(searcher.count(s) == 3);
+
+    KSearcher empty("");
+    CHECK(empty.count(s) == s.char_size() + 1);
+    CHECK(empty.find(s) == 0);
+}
+
+TEST_CASE("KASearcher works on byte positions") {
+    KASearcher searcher("ab");
+    KAStr s("xxabyyabab");
+
+    CHECK(searcher.needle() == "ab");
+    CHECK(searcher.find(s) == 2);
+    CHECK(searcher.rfind(s) == 8);
+    CHECK(searcher.contains(s));
+    CHECK(searcher.count(s) == 3);
+    std::vector<std::size_t> expected = {2, 6, 8};
+    CHECK(searcher.find_all(s) == expected);
+
+    CHECK(s.find(searcher) == s.find("ab"));
+    CHECK(s.rfind(searcher) == s.rfind("ab"));
+    KAString owned("zzab");
+    CHECK(owned.find(searcher) == 2);
+
+    KASearcher empty("");
+    CHECK(empty.find_all(KAStr("ab")).size() == 3);
+    CHECK(empty.count(KAStr("ab")) == 3);
+}
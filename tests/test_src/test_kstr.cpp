@@ -1,9 +1,12 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+#include <algorithm>
 #include <doctest/doctest.h>
 #include "../../include/kstr.hpp"
+#include "../../include/kstring.hpp"
 #include "base.hpp"
 
+using kstring::CharIndex;
 using kstring::KChar;
 using kstring::KStr;
 using utf8::ByteSpan;
@@ -87,6 +90,50 @@ TEST_CASE("KStr iter_chars() yields correct KChar sequence") {
     CHECK(bg == iter.end());
 }
 
+TEST_CASE("KStr iter_chars_chunked() matches iter_chars across chunk edges and invalid bytes") {
+    auto collect = [](KStr s, bool chunked) {
+        std::vector<utf8::CodePoint> out;
+        if (chunked) {
+            for (KChar ch : s.iter_chars_chunked()) out.push_back(ch.value());
+        } else {
+            for (KChar ch : s.iter_chars()) out.push_back(ch.value());
+        }
+        return out;
+    };
+
+    KStr small("你好abc");
+    CHECK(collect(small, true) == std::vector<utf8::CodePoint>({0x4f60, 0x597d, 'a', 'b', 'c'}));
+    CHECK(collect(KStr(""), true).empty());
+
+    // 多字节字符跨越 64 字节的块边界; 每个非法序列给出一个 KChar()
+    std::string text;
+    for (int i = 0; i < 40; ++i) text += "ab\xe4\xbd\xa0\xf0\x9f\x98\x81\xc3\xa9";
+    text += "\xe4\xbd" "x\xff\xed\xa0\x80\xc0\x80\xef\xbf\xbd\xf0\x9f\x98";
+    for (std::size_t start = 0; start < 16; ++start) {
+        KStr s(text.data() + start, text.size() - start);
+        CHECK(collect(s, true) == collect(s, false));
+    }
+
+    auto range = small.iter_chars_chunked();
+    auto it = range.begin();
+    ++it;
+    CHECK(*it == KChar(0x597d));
+    ++it;
+    ++it;
+    ++it;
+    CHECK(it != range.end());
+    ++it;
+    CHECK(it == range.end());
+
+    // match / trim_start_matches 走按块解码
+    KStr mixed("\xe4\xbd\xa0\xe5\xa5\xbd" "123\xe4\xb8\x96\xe7\x95\x8c" "45");
+    auto digits = mixed.match([](KChar c) { return c.is_ascii_digit(); });
+    REQUIRE(digits.size() == 2);
+    CHECK(digits[0] == KStr("123"));
+    CHECK(digits[1] == KStr("45"));
+    CHECK(mixed.trim_start_matches([](KChar c) { return ! c.is_ascii(); }) == KStr("123\xe4\xb8\x96\xe7\x95\x8c" "45"));
+}
+
 TEST_CASE("KStr iter_chars_rev() yields correct KChar reverse sequence") {
     KStr s("你好abc"); // UTF-8: 3 bytes + 3 bytes + 1+1+1
 
@@ -114,6 +161,30 @@ TEST_CASE("KStr iter_chars_rev() yields correct KChar reverse sequence") {
     CHECK(bg == iter.end());
 }
 
+TEST_CASE("KStr iter_chars_rev() mirrors iter_chars on invalid sequences") {
+    std::string text = "a\xe4\xbd" "x\xff\xed\xa0\x80\xc3\xa9\x80\x80\xf0\x9f\x98\x81\xc0\xaf" "b\xf0\x9f";
+    for (std::size_t start = 0; start < text.size(); ++start) {
+        KStr s(text.data() + start, text.size() - start);
+        std::vector<utf8::CodePoint> forward;
+        std::vector<utf8::CodePoint> backward;
+        for (KChar ch : s.iter_chars()) forward.push_back(ch.value());
+        for (KChar ch : s.iter_chars_rev()) backward.push_back(ch.value());
+        std::reverse(backward.begin(), backward.end());
+        CHECK(forward == backward);
+        CHECK(forward.size() == s.char_size());
+    }
+
+    // 非法序列按其实际长度裁掉, 不按 KChar() 的编码长度
+    auto not_alpha = [](KChar c) { return ! c.is_ascii_alpha(); };
+    KStr bad("ok\xe4\xbd\xc3\xa9\xed\xa0\x80");
+    CHECK(bad.trim_end_matches(not_alpha) == KStr("ok"));
+    CHECK(KStr("\xed\xa0\x80\xff" "ok").trim_start_matches(not_alpha) == KStr("ok"));
+    auto runs = KStr("a\xed\xa0\x80" "b\xe4\xbd").match(not_alpha);
+    REQUIRE(runs.size() == 2);
+    CHECK(runs[0].byte_size() == 3);
+    CHECK(runs[1].byte_size() == 2);
+}
+
 TEST_CASE("KStr char_at, byte_at, operator[]") {
     KStr s("你a好b"); // UTF-8: [你:3][a:1][好:3][b:1]
 
@@ -226,6 +297,66 @@ TEST_CASE("KStr find/rfind/contains") {
     }
 }
 
+TEST_CASE("KStr find_index / rfind_index / find_all") {
+    KStr s = ("你好abc你好abc");
+
+    SUBCASE("find_index returns byte and char position") {
+        CHECK(s.find_index("abc") == CharIndex(KChar('a'), 6, 2));
+        CHECK(s.rfind_index("你") == CharIndex(KChar(0x4F60), 9, 5));
+        CHECK(s.find_index("好").char_index == s.find("好"));
+
+        CharIndex none = s.find_index("xyz");
+        CHECK(none.byte_offset == kstring::knpos);
+        CHECK(none.char_index == kstring::knpos);
+    }
+
+    SUBCASE("find_all yields every non-overlapping match") {
+        std::vector<CharIndex> got;
+        for (const CharIndex& m : s.find_all("你好")) got.push_back(m);
+        REQUIRE(got.size() == 2);
+        CHECK(got[0] == CharIndex(KChar(0x4F60), 0, 0));
+        CHECK(got[1] == CharIndex(KChar(0x4F60), 9, 5));
+
+        std::vector<std::size_t> overlapped;
+        for (const auto& m : KStr("aaaaa").find_all("aa")) overlapped.push_back(m.byte_offset);
+        std::vector<std::size_t> expected = {0, 2};
+        CHECK(overlapped == expected);
+
+        CHECK(s.find_all("xyz").begin() == s.find_all("xyz").end());
+    }
+
+    SUBCASE("find_all agrees with count_chars_before on every match") {
+        std::string text;
+        for (int i = 0; i < 300; ++i) text += (i % 3 == 0) ? "😀x" : "中文x";
+        KStr t(text.c_str());
+        std::size_t n = 0;
+        for (const auto& m : t.find_all("x")) {
+            CHECK(m.char_index == t.count_chars_before(m.byte_offset));
+            CHECK(m.ch == KChar('x'));
+            ++n;
+        }
+        CHECK(n == 300);
+    }
+
+    SUBCASE("find_all with empty pattern matches every char boundary") {
+        std::vector<CharIndex> got;
+        for (const auto& m : KStr("你a").find_all("")) got.push_back(m);
+        REQUIRE(got.size() == 3);
+        CHECK(got[0] == CharIndex(KChar(0x4F60), 0, 0));
+        CHECK(got[1] == CharIndex(KChar('a'), 3, 1));
+        CHECK(got[2] == CharIndex(KChar(), 4, 2));
+    }
+
+    SUBCASE("find_all counts invalid sequences as one char") {
+        std::vector<uint8_t> raw = {0xFF, 'x', 0xE4, 0xBD, 'x', 0xE4, 0xBD, 0xA0, 'x'};
+        KStr bad(raw.data(), raw.size());
+        std::vector<std::size_t> idx;
+        for (const auto& m : bad.find_all("x")) idx.push_back(m.char_index);
+        std::vector<std::size_t> expected = {1, 3, 5};
+        CHECK(idx == expected);
+    }
+}
+
 TEST_CASE("test byte_offset_to_char_index") {
     KStr s = "你a好"; // UTF-8 字节数 = 3 + 1 + 3 = 7
     CHECK_EQ(s.count_chars_before(0), 0);
@@ -732,6 +863,67 @@ TEST_CASE("KStr trim functions") {
     }
 }
 
+TEST_CASE("KStr replace / replacen") {
+    // 日志，电话，地址
+    KStr text("\xe6\x97\xa5\xe5\xbf\x97\xef\xbc\x8c\xe7\x94\xb5\xe8\xaf\x9d\xef\xbc\x8c\xe5\x9c\xb0\xe5\x9d\x80");
+    kstring::KString out = text.replace("\xef\xbc\x8c", "\xe3\x80\x81"); // ， -> 、
+    CHECK(out == "\xe6\x97\xa5\xe5\xbf\x97\xe3\x80\x81\xe7\x94\xb5\xe8\xaf\x9d\xe3\x80\x81\xe5\x9c\xb0\xe5\x9d\x80");
+    CHECK(out.char_size() == text.char_size());
+    CHECK(text.replacen("\xef\xbc\x8c", ", ", 1).char_size() == text.char_size() + 1);
+    CHECK(text.replace("\xef\xbc\x8c", "").char_size() == 6);
+    CHECK(text.replace("x", "y") == text);
+
+    // 脱敏: 替换串更长, 输出一次分配
+    KStr card("id=1234 id=5678 id=1234");
+    CHECK(card.replace("1234", "[REDACTED]") == "id=[REDACTED] id=5678 id=[REDACTED]");
+    CHECK(card.replacen("id=", "", 2) == "1234 5678 id=1234");
+    CHECK(card.replacen("id=", "#", 0) == card);
+
+    // 空模式在每个字符边界插入, 非法序列算一个字符
+    CHECK(KStr("\xe4\xbd\xa0\xe5\xa5\xbd").replace("", "|") == "|\xe4\xbd\xa0|\xe5\xa5\xbd|");
+    CHECK(KStr("a\xe4\xbd" "b").replace("", "|") == "|a|\xe4\xbd|b|");
+    CHECK(KStr("ab").replacen("", "|", 2) == "|a|b");
+    CHECK(KStr("").replace("", "|") == "|");
+
+    // 非法字节原样保留, KString 同样提供
+    KStr dirty("a\xff,b\xff,c");
+    CHECK(dirty.replace(",", ";") == "a\xff;b\xff;c");
+    CHECK(kstring::KString("a-b").replace("-", "\xe2\x80\x94") == "a\xe2\x80\x94" "b");
+}
+
+TEST_CASE("KStr to_valid_utf8") {
+    KStr dirty("id=\xff\xe4\xbd" "42");
+    kstring::KString fixed = dirty.to_valid_utf8();
+    CHECK(fixed == "id=\xef\xbf\xbd\xef\xbf\xbd" "42");
+    CHECK(fixed.is_valid_utf8());
+    CHECK(fixed.char_size() == dirty.char_size());
+    CHECK(KStr("\xe4\xbd\xa0ok").to_valid_utf8() == "\xe4\xbd\xa0ok");
+    CHECK(kstring::KString("a\x80").to_valid_utf8() == "a\xef\xbf\xbd");
+}
+
+TEST_CASE("KStr UTF-16 / Latin-1 transcoding") {
+    KStr text("caf\xc3\xa9 \xe4\xbd\xa0");
+    std::u16string wide = text.to_utf16(utf8::ErrorMode::Strict);
+    CHECK(wide.size() == 6);
+    utf8::ByteVec buf;
+    CHECK(KStr::from_utf16(wide, buf) == text);
+    CHECK(kstring::KString::from_utf16(wide) == text);
+
+    std::u16string be;
+    text.to_utf16(be, utf8::ErrorMode::Lossy, utf8::Utf16Order::BigEndian);
+    CHECK(KStr::from_utf16(be, buf, utf8::ErrorMode::Strict, utf8::Utf16Order::BigEndian) == text);
+
+    CHECK_THROWS_AS(KStr("a\xff").to_utf16(utf8::ErrorMode::Strict), std::invalid_argument);
+    CHECK(KStr("a\xff").to_utf16().size() == 2);
+
+    utf8::ByteVec latin1;
+    KStr("caf\xc3\xa9").to_latin1(latin1, utf8::ErrorMode::Strict);
+    CHECK(latin1 == utf8::ByteVec({'c', 'a', 'f', 0xE9}));
+    CHECK(KStr::from_latin1(latin1, buf) == "caf\xc3\xa9");
+    CHECK(kstring::KString::from_latin1("caf\xe9") == "caf\xc3\xa9");
+    CHECK(kstring::KString::from_latin1("caf\xe9").is_valid_utf8());
+}
+
 TEST_CASE("KStr::strip_prefix and strip_suffix") {
     SUBCASE("empty string and empty prefix/suffix") {
         KStr s("");
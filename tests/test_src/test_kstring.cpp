@@ -0,0 +1,368 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <doctest/doctest.h>
+#include "../../include/kstring.hpp"
+
+using namespace kstring;
+
+TEST_CASE("KString constructors and cached metadata") {
+    SUBCASE("empty string") {
+        KString s;
+        CHECK(s.empty());
+        CHECK(s.byte_size() == 0);
+        CHECK(s.char_size() == 0);
+        CHECK(s.is_ascii());
+        CHECK(s.is_valid_utf8());
+        CHECK(s == "");
+    }
+
+    SUBCASE("ascii c-string") {
+        KString s("hello");
+        CHECK(s.byte_size() == 5);
+        CHECK(s.char_size() == 5);
+        CHECK(s.is_ascii());
+        CHECK(static_cast<std::string>(s) == "hello");
+    }
+
+    SUBCASE("utf-8 c-string") {
+        KString s("你好abc");
+        CHECK(s.byte_size() == 9);
+        CHECK(s.char_size() == 5);
+        CHECK_FALSE(s.is_ascii());
+        CHECK(s.is_valid_utf8());
+    }
+
+    SUBCASE("from KStr view and std::string") {
+        KStr view("世界!");
+        KString a(view);
+        KString b(std::string("世界!"));
+        CHECK(a == b);
+        CHECK(a == view);
+        CHECK(a.char_size() == 3);
+        // 拥有独立的内存
+        CHECK(a.as_bytes().data() != view.as_bytes().data());
+    }
+
+    SUBCASE("from non null-terminated bytes") {
+        std::vector<Byte> raw = {0xe4, 0xbd, 0xa0, 'x'};
+        KString s(raw.data(), 3);
+        CHECK(s == "你");
+        CHECK(s.char_size() == 1);
+    }
+
+    SUBCASE("from KChar") {
+        KString s(KChar(0x1F600));
+        CHECK(s.byte_size() == 4);
+        CHECK(s.char_size() == 1);
+        CHECK(s == "😀");
+    }
+
+    SUBCASE("invalid bytes follow utf8::char_count semantics") {
+        std::vector<Byte> raw = {'a', 0xff, 0xe4, 0xbd, 'b'};
+        KString s(raw.data(), raw.size());
+        CHECK_FALSE(s.is_valid_utf8());
+        CHECK(s.char_size() == utf8::char_count(ByteSpan(raw)));
+    }
+
+    SUBCASE("adopting a ByteVec counts once and keeps long buffers") {
+        ByteVec bytes;
+        for (int i = 0; i < 20; ++i) bytes.insert(bytes.end(), {0xE4, 0xBD, 0xA0, 'a'});
+        const Byte* buffer = bytes.data();
+        KString s(std::move(bytes));
+        CHECK(s.data() == buffer);
+        CHECK(s.char_size() == 40);
+        CHECK_FALSE(s.is_ascii());
+        CHECK(s.is_valid_utf8());
+
+        KString bad(ByteVec{'x', 0xFF, 0xE4, 0xBD});
+        CHECK(bad.char_size() == 3);
+        CHECK_FALSE(bad.is_valid_utf8());
+        CHECK(KString(ByteVec{}).empty());
+    }
+}
+
+TEST_CASE("KString mutation keeps char_size in sync") {
+    SUBCASE("append ascii keeps ascii flag") {
+        KString s("abc");
+        s.append("def");
+        CHECK(s == "abcdef");
+        CHECK(s.char_size() == 6);
+        CHECK(s.is_ascii());
+    }
+
+    SUBCASE("append utf-8 clears ascii flag") {
+        KString s("abc");
+        s += "你好";
+        CHECK(s.char_size() == 5);
+        CHECK_FALSE(s.is_ascii());
+        CHECK(s.char_size() == s.as_kstr().char_size());
+    }
+
+    SUBCASE("grow from SSO to heap") {
+        KString s;
+        for (int i = 0; i < 40; ++i) s += KChar(0x4F60);
+        CHECK(s.char_size() == 40);
+        CHECK(s.byte_size() == 120);
+        CHECK(s.char_size() == s.as_kstr().char_size());
+    }
+
+    SUBCASE("append split multi-byte sequence recounts") {
+        // "你" = e4 bd a0, 分两次追加, 中间态非法
+        KString s("a");
+        s.append("\xe4\xbd");
+        CHECK_FALSE(s.is_valid_utf8());
+        CHECK(s.char_size() == s.as_kstr().char_size());
+
+        s.append("\xa0");
+        CHECK(s.is_valid_utf8());
+        CHECK(s == "a你");
+        CHECK(s.char_size() == 2);
+    }
+
+    SUBCASE("append self") {
+        KString s("你a");
+        s.append(s);
+        CHECK(s == "你a你a");
+        CHECK(s.char_size() == 4);
+    }
+
+    SUBCASE("push_back and pop_back") {
+        KString s("ab");
+        s.push_back(KChar(0x597D));
+        CHECK(s.char_size() == 3);
+        CHECK_FALSE(s.is_ascii());
+
+        CHECK(s.pop_back() == KChar(0x597D));
+        CHECK(s == "ab");
+        CHECK(s.char_size() == 2);
+        CHECK(s.is_ascii());
+
+        CHECK(s.pop_back() == KChar('b'));
+        CHECK(s.pop_back() == KChar('a'));
+        CHECK(s.empty());
+        CHECK_THROWS_AS(s.pop_back(), std::runtime_error);
+    }
+
+    SUBCASE("random appends and pops on invalid bytes keep every cache in sync") {
+        // 续字节, 各种首字节与 ASCII 混合, 让截断序列与非法序列频繁落在拼接点两侧
+        const Byte alphabet[] = {'a', 0x80, 0xBF, 0xC2, 0xC0, 0xE4, 0xBD, 0xA0, 0xED, 0xF0, 0x9F, 0xF4, 0xF8};
+        unsigned seed = 17;
+        auto next = [&seed]() {
+            seed = seed * 1103515245u + 12345u;
+            return seed >> 16;
+        };
+        auto check_cache = [](const KString& s) {
+            ByteSpan bytes = s.as_bytes();
+            CHECK(s.char_size() == utf8::char_count(bytes));
+            CHECK(s.is_ascii() == utf8::is_all_ascii(bytes));
+            CHECK(s.is_valid_utf8() == utf8::is_valid(bytes));
+        };
+
+        KString s;
+        for (int step = 0; step < 3000; ++step) {
+            unsigned op = next() % 8;
+            if (op < 4) {
+                Byte piece[5];
+                std::size_t len = next() % 5 + 1;
+                for (std::size_t i = 0; i < len; ++i) piece[i] = alphabet[next() % sizeof(alphabet)];
+                s.append(reinterpret_cast<const char*>(piece), len);
+            } else if (op < 7 && ! s.empty()) {
+                // 非法串弹出后新的末尾可能成为截断序列并吞并前面的字节, 字符数不一定恰好减 1
+                s.pop_back();
+            } else {
+                s.push_back(KChar(next() % 2 ? 0x4F60 : 'z'));
+            }
+            check_cache(s);
+        }
+        while (! s.empty()) {
+            s.pop_back();
+            check_cache(s);
+        }
+    }
+
+    SUBCASE("clear resets cache") {
+        KString s("你好");
+        s.clear();
+        CHECK(s.empty());
+        CHECK(s.char_size() == 0);
+        CHECK(s.is_ascii());
+    }
+
+    SUBCASE("swap exchanges cache") {
+        KString a("你好");
+        KString b("xyz");
+        swap(a, b);
+        CHECK(a == "xyz");
+        CHECK(a.char_size() == 3);
+        CHECK(a.is_ascii());
+        CHECK(b == "你好");
+        CHECK(b.char_size() == 2);
+    }
+
+    SUBCASE("operator+") {
+        KString a("你");
+        KString b("好");
+        CHECK(a + b == "你好");
+        CHECK((a + "x").char_size() == 2);
+        CHECK(("x" + a).char_size() == 2);
+        CHECK((a + KChar('!')) == "你!");
+        CHECK((KStr("y") + a) == "y你");
+    }
+}
+
+TEST_CASE("KString char-indexed access") {
+    KString ascii("hello world");
+    KString utf8("你a好b");
+
+    SUBCASE("char_at") {
+        CHECK(ascii.char_at(4) == KChar('o'));
+        CHECK(utf8.char_at(2) == KChar(0x597D));
+        CHECK_THROWS_AS(ascii.char_at(11), std::out_of_range);
+        CHECK_THROWS_AS(utf8.char_at(4), std::out_of_range);
+    }
+
+    SUBCASE("operator[]") {
+        CHECK(KStr(ascii[1]) == "e");
+        CHECK(KStr(utf8[0]) == "你");
+        CHECK_THROWS_AS(ascii[100], std::out_of_range);
+    }
+
+    SUBCASE("char_index_to_byte_offset and count_chars_before") {
+        CHECK(ascii.char_index_to_byte_offset(6) == 6);
+        CHECK(utf8.char_index_to_byte_offset(2) == 4);
+        CHECK(ascii.count_chars_before(5) == 5);
+        CHECK(utf8.count_chars_before(4) == 2);
+        CHECK(utf8.count_chars_before(utf8.byte_size()) == 4);
+        CHECK_THROWS_AS(ascii.count_chars_before(100), std::out_of_range);
+    }
+
+    SUBCASE("substr / subrange / split_at match KStr") {
+        CHECK(ascii.substr(6, 5) == "world");
+        CHECK(ascii.substr(6, 100) == "world");
+        CHECK(utf8.substr(1, 2) == "a好");
+        CHECK_THROWS_AS(ascii.substr(100, 1), std::out_of_range);
+
+        CHECK(ascii.subrange(0, 5) == "hello");
+        CHECK(ascii.subrange(6, 100) == "world");
+        CHECK(utf8.subrange(2, 4) == "好b");
+        CHECK_THROWS_AS(ascii.subrange(4, 1), std::out_of_range);
+
+        auto parts = ascii.split_at(5);
+        CHECK(parts.first == "hello");
+        CHECK(parts.second == " world");
+        CHECK_THROWS_AS(ascii.split_at(11), std::out_of_range);
+        auto parts2 = utf8.split_at(1);
+        CHECK(parts2.first == "你");
+        CHECK(parts2.second == "a好b");
+    }
+
+    SUBCASE("find / rfind return char index") {
+        CHECK(ascii.find("o") == 4);
+        CHECK(ascii.rfind("o") == 7);
+        CHECK(utf8.find("好") == 2);
+        CHECK(utf8.rfind("b") == 3);
+        CHECK(utf8.find("z") == knpos);
+    }
+
+    SUBCASE("find_index / rfind_index / find_all") {
+        CHECK(ascii.find_index("o") == CharIndex(KChar('o'), 4, 4));
+        CHECK(ascii.rfind_index("o") == CharIndex(KChar('o'), 7, 7));
+        CHECK(ascii.find_index("z").char_index == knpos);
+        CHECK(utf8.find_index("好") == CharIndex(KChar(0x597D), 4, 2));
+        CHECK(utf8.rfind_index("b") == CharIndex(KChar('b'), 7, 3));
+
+        std::vector<std::size_t> idx;
+        for (const auto& m : ascii.find_all("o")) idx.push_back(m.char_index);
+        std::vector<std::size_t> expected = {4, 7};
+        CHECK(idx == expected);
+    }
+}
+
+TEST_CASE("KString delegates view operations and std::hash") {
+    KString s("  a,b,你  ");
+    CHECK(s.trim() == "a,b,你");
+    CHECK(s.trim().split(",").size() == 3);
+    CHECK(s.contains("你"));
+    CHECK(s.starts_with("  a"));
+    CHECK(s.ends_with("你  "));
+
+    std::unordered_map<KString, int> map;
+    map[KString("你好")] = 1;
+    map[KString("abc")] = 2;
+    CHECK(map[KString("你好")] == 1);
+    CHECK(map.find(KString("abd")) == map.end());
+
+    std::set<KString> sorted = {KString("b"), KString("a"), KString("c")};
+    CHECK(*sorted.begin() == "a");
+}
+
+TEST_CASE("KString lazily builds a char offset index for long non-ascii text") {
+    KString s;
+    for (int i = 0; i < 200; ++i) s += "中文a";
+    REQUIRE(s.byte_size() >= KString::INDEX_THRESHOLD);
+    CHECK(s.as_kstr().index() == nullptr);
+
+    CHECK(s.char_at(301) == KChar(0x6587)); // '文'
+    REQUIRE(s.as_kstr().index() != nullptr);
+    CHECK(s.as_kstr().index()->char_size() == s.char_size());
+    CHECK(s.substr(3, 3) == "中文a");
+
+    SUBCASE("mutation invalidates the index") {
+        s += "x";
+        CHECK(s.as_kstr().index() == nullptr);
+        CHECK(s.char_at(600) == KChar('x'));
+    }
+
+    SUBCASE("copy drops the index, move rebinds it") {
+        KString copy(s);
+        CHECK(copy.as_kstr().index() == nullptr);
+        CHECK(copy.char_at(301) == KChar(0x6587));
+
+        KString moved(std::move(copy));
+        REQUIRE(moved.as_kstr().index() != nullptr);
+        CHECK(moved.as_kstr().index()->source().data() == moved.data());
+        CHECK(moved.char_at(599) == KChar('a'));
+    }
+
+    SUBCASE("swap and move assignment keep each index bound to its own bytes") {
+        KString other = "短串";
+        s.swap(other);
+        REQUIRE(other.as_kstr().index() != nullptr);
+        CHECK(other.as_kstr().index()->source().data() == other.data());
+        CHECK(other.char_at(301) == KChar(0x6587));
+
+        s = std::move(other);
+        REQUIRE(s.as_kstr().index() != nullptr);
+        CHECK(s.as_kstr().index()->source().data() == s.data());
+        CHECK(s.substr(3, 3) == "中文a");
+    }
+}
+
+TEST_CASE("KString const access from several threads builds one shared index") {
+    KString s;
+    for (int i = 0; i < 500; ++i) s += "中文a";
+    const KString& shared = s;
+
+    // 各线程同时触发惰性构建, 只有一份索引被发布, 其余的被丢弃
+    bool ok[4] = {};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&shared, &ok, t] {
+            bool good = true;
+            for (std::size_t i = 0; i < 300; ++i) {
+                std::size_t idx = (i * 7 + static_cast<std::size_t>(t)) % 1500;
+                KChar expected = idx % 3 == 0 ? KChar(0x4E2D) : idx % 3 == 1 ? KChar(0x6587) : KChar('a');
+                good = good && shared.char_at(idx) == expected;
+            }
+            good = good && shared.substr(3, 3) == "中文a";
+            ok[t] = good;
+        });
+    }
+    for (auto& w : workers) w.join();
+    for (bool good : ok) CHECK(good);
+    REQUIRE(s.as_kstr().index() != nullptr);
+    CHECK(s.as_kstr().index()->char_size() == 1500);
+}
@@ -0,0 +1,102 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include <doctest/doctest.h>
+#include "../../include/mapped_text.hpp"
+#include "utf8.hpp"
+
+using kstring::ByteVec;
+using kstring::KStr;
+using kstring::MappedText;
+
+namespace {
+// 写入临时文件, 析构时删除
+struct TempFile {
+    std::string path;
+
+    explicit TempFile(const ByteVec& content) : path() {
+        char name[] = "/tmp/kstring_mapped_XXXXXX";
+        int fd = ::mkstemp(name);
+        REQUIRE(fd >= 0);
+        path = name;
+        std::size_t written = 0;
+        while (written < content.size()) {
+            ssize_t n = ::write(fd, content.data() + written, content.size() - written);
+            REQUIRE(n > 0);
+            written += static_cast<std::size_t>(n);
+        }
+        ::close(fd);
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    ~TempFile() {
+        std::remove(path.c_str());
+    }
+};
+
+ByteVec bytes_of(const std::string& s) {
+    return ByteVec(s.begin(), s.end());
+}
+} // namespace
+
+TEST_CASE("MappedText views and lines_iter") {
+    TempFile file(bytes_of("apple\n\xe8\x8b\xb9\xe6\x9e\x9c\r\nbanana\n"));
+    MappedText text(file.path);
+    CHECK(text.size() == 21);
+    CHECK(text.as_kstr() == KStr("apple\n\xe8\x8b\xb9\xe6\x9e\x9c\r\nbanana\n"));
+    CHECK(text.as_kastr().starts_with("apple"));
+
+    std::vector<KStr> lines;
+    for (KStr line : text.lines_iter()) lines.push_back(line);
+    CHECK(lines == text.as_kstr().lines());
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[1] == KStr("\xe8\x8b\xb9\xe6\x9e\x9c"));
+    CHECK(text.is_valid_utf8());
+
+    // 移动后映射随之转移
+    MappedText moved(std::move(text));
+    CHECK(moved.size() == 21);
+    CHECK(text.empty());
+    moved.close();
+    CHECK(moved.empty());
+}
+
+TEST_CASE("MappedText empty and missing files") {
+    TempFile empty(ByteVec{});
+    MappedText text(empty.path, MappedText::HINT_SEQUENTIAL | MappedText::HINT_HUGEPAGE);
+    CHECK(text.empty());
+    CHECK(text.as_kstr().empty());
+    CHECK(text.is_valid_utf8(4));
+    CHECK(text.lines_iter().begin() == text.lines_iter().end());
+
+    CHECK_THROWS_AS(MappedText("/nonexistent/kstring/dict.txt"), std::runtime_error);
+}
+
+TEST_CASE("MappedText parallel validation matches utf8::first_invalid") {
+    // 约 3 MiB, 足以切成多段; 多字节字符会落在分段边界上
+    ByteVec data;
+    while (data.size() < (3u << 20)) data.insert(data.end(), {0xE4, 0xBD, 0xA0, 0xF0, 0x9F, 0x98, 0x81, 'x'});
+
+    for (std::size_t bad_at : {std::size_t(5), data.size() / 2 + 1, data.size() - 2}) {
+        ByteVec broken = data;
+        broken[bad_at] = 0xFF;
+        TempFile file(broken);
+        MappedText text(file.path);
+        std::size_t expected = utf8::first_invalid(broken);
+        CHECK(text.first_invalid(4) == expected);
+        CHECK_FALSE(text.is_valid_utf8());
+        MappedText single(file.path);
+        CHECK(single.first_invalid(1) == expected);
+    }
+
+    TempFile file(data);
+    MappedText text(file.path, MappedText::HINT_DEFAULT | MappedText::HINT_HUGEPAGE);
+    CHECK(text.is_valid_utf8(0));
+    CHECK(text.first_invalid() == kstring::knpos);
+}
@@ -0,0 +1,148 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <doctest/doctest.h>
+#include "../../include/kstring.hpp"
+#include "../../include/normalization.hpp"
+
+using namespace kstring;
+using unicode::NormalizationForm;
+
+namespace {
+const NormalizationForm FORMS[] = {NormalizationForm::NFC, NormalizationForm::NFD, NormalizationForm::NFKC,
+                                   NormalizationForm::NFKD};
+
+ByteSpan bytes(const std::string& s) {
+    return ByteSpan(reinterpret_cast<const Byte*>(s.data()), s.size());
+}
+
+std::string normalize(const std::string& s, NormalizationForm form) {
+    ByteVec out;
+    unicode::append_normalized(bytes(s), form, out);
+    return std::string(out.begin(), out.end());
+}
+
+// "1E0A 0323" -> UTF-8
+std::string from_hex(const std::string& field) {
+    std::istringstream in(field);
+    std::string out;
+    std::string hex;
+    while (in >> hex) {
+        auto enc = utf8::encode(static_cast<CodePoint>(std::stoul(hex, nullptr, 16)));
+        out.append(enc.begin(), enc.end());
+    }
+    return out;
+}
+
+// NormalizationTest.txt 的每一行: source, NFC, NFD, NFKC, NFKD
+std::vector<std::vector<std::string>> read_tests() {
+    std::vector<std::vector<std::string>> rows;
+    std::ifstream in("../data/ucd/NormalizationTest.txt");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#' || line[0] == '@') continue;
+        std::vector<std::string> cols;
+        std::istringstream ss(line);
+        std::string field;
+        while (cols.size() < 5 && std::getline(ss, field, ';')) cols.push_back(from_hex(field));
+        rows.push_back(cols);
+    }
+    return rows;
+}
+} // namespace
+
+TEST_CASE("conformance with the vendored NormalizationTest rows") {
+    auto rows = read_tests();
+    REQUIRE(rows.size() > 6000);
+    std::size_t mismatches = 0;
+    std::size_t qc_errors = 0;
+    for (const auto& r : rows) {
+        const std::string& c1 = r[0];
+        const std::string& c2 = r[1];
+        const std::string& c3 = r[2];
+        const std::string& c4 = r[3];
+        const std::string& c5 = r[4];
+        // UAX #15 给出的不变式
+        mismatches += normalize(c1, NormalizationForm::NFC) != c2;
+        mismatches += normalize(c2, NormalizationForm::NFC) != c2;
+        mismatches += normalize(c3, NormalizationForm::NFC) != c2;
+        mismatches += normalize(c4, NormalizationForm::NFC) != c4;
+        mismatches += normalize(c1, NormalizationForm::NFD) != c3;
+        mismatches += normalize(c3, NormalizationForm::NFD) != c3;
+        mismatches += normalize(c5, NormalizationForm::NFD) != c5;
+        mismatches += normalize(c1, NormalizationForm::NFKC) != c4;
+        mismatches += normalize(c5, NormalizationForm::NFKC) != c4;
+        mismatches += normalize(c1, NormalizationForm::NFKD) != c5;
+        mismatches += normalize(c4, NormalizationForm::NFKD) != c5;
+
+        // 放进长 ASCII 上下文中结果不变 (走 SIMD 跳过与分段)
+        std::string context = "identifier prefix long enough for a block ";
+        mismatches += normalize(context + c1 + " " + c3, NormalizationForm::NFC) != context + c2 + " " + c2;
+        mismatches += normalize(context + c1 + " " + c4, NormalizationForm::NFKD) != context + c5 + " " + c5;
+
+        for (NormalizationForm form : FORMS) {
+            bool same = normalize(c1, form) == c1;
+            unicode::QuickCheck q = unicode::quick_check(bytes(c1), form);
+            qc_errors += (q == unicode::QuickCheck::Yes && ! same) || (q == unicode::QuickCheck::No && same);
+            qc_errors += unicode::is_normalized(bytes(c1), form) != same;
+        }
+    }
+    CHECK(mismatches == 0);
+    CHECK(qc_errors == 0);
+}
+
+TEST_CASE("combining classes and quick check") {
+    CHECK(unicode::combining_class('a') == 0);
+    CHECK(unicode::combining_class(0x0301) == 230);
+    CHECK(unicode::combining_class(0x0323) == 220);
+    CHECK(unicode::combining_class(0x110000) == 0);
+
+    using unicode::QuickCheck;
+    CHECK(unicode::quick_check(bytes("plain ascii"), NormalizationForm::NFD) == QuickCheck::Yes);
+    CHECK(unicode::quick_check(bytes("caf\xc3\xa9"), NormalizationForm::NFC) == QuickCheck::Yes);   // é
+    CHECK(unicode::quick_check(bytes("caf\xc3\xa9"), NormalizationForm::NFD) == QuickCheck::No);
+    CHECK(unicode::quick_check(bytes("cafe\xcc\x81"), NormalizationForm::NFC) == QuickCheck::Maybe); // e + ◌́
+    CHECK(unicode::quick_check(bytes("\xef\xac\x81"), NormalizationForm::NFKC) == QuickCheck::No);   // ﬁ
+    // 组合类顺序错误: ◌́ (230) 在 ◌̣ (220) 之前
+    CHECK(unicode::quick_check(bytes("a\xcc\x81\xcc\xa3"), NormalizationForm::NFD) == QuickCheck::No);
+    CHECK(unicode::quick_check(ByteSpan(), NormalizationForm::NFC) == QuickCheck::Yes);
+    CHECK(std::string(unicode::normalization_simd_backend()).size() > 0);
+}
+
+TEST_CASE("normalize keeps invalid bytes and segments around them") {
+    std::string s = "e\xcc\x81\xff\xcc\x81x\xe4\xbd";
+    CHECK(normalize(s, NormalizationForm::NFC) == "\xc3\xa9\xff\xcc\x81x\xe4\xbd");
+    CHECK(normalize("\xff", NormalizationForm::NFD) == "\xff");
+    CHECK(normalize("", NormalizationForm::NFKC) == "");
+    // 谚文音节与连写字母
+    CHECK(normalize("\xea\xb0\x81", NormalizationForm::NFD) == "\xe1\x84\x80\xe1\x85\xa1\xe1\x86\xa8");
+    CHECK(normalize("\xe1\x84\x80\xe1\x85\xa1\xe1\x86\xa8", NormalizationForm::NFC) == "\xea\xb0\x81");
+    CHECK(normalize("\xef\xac\x81le", NormalizationForm::NFKC) == "file");
+}
+
+TEST_CASE("KStr::normalize returns the input view when already normalized") {
+    std::string nfc = "Cafe\xcc\x81 cr\xc3\xa8me";
+    KStr input(nfc.c_str());
+
+    KString buf("untouched");
+    KStr same = KStr("already normalized").normalize(NormalizationForm::NFC, buf);
+    CHECK(same == "already normalized");
+    CHECK(buf == "untouched");
+
+    // Maybe 但已是 NFC: 仍返回原视图
+    std::string maybe = "a\xcc\x88\xcc\x81x"; // ä 之后的 ◌́ 无法再组合
+    std::string maybe_nfc = normalize(maybe, NormalizationForm::NFC);
+    KStr m(maybe_nfc.c_str());
+    CHECK(m.normalize(NormalizationForm::NFC, buf).as_bytes().data() == m.as_bytes().data());
+
+    KStr out = input.normalize(NormalizationForm::NFC, buf);
+    CHECK(out.as_bytes().data() == buf.as_kstr().as_bytes().data());
+    CHECK(out == "Caf\xc3\xa9 cr\xc3\xa8me");
+    CHECK(input.normalize(NormalizationForm::NFD) == "Cafe\xcc\x81 cre\xcc\x80me");
+    CHECK(input.is_normalized(NormalizationForm::NFD) == false);
+    CHECK(KString("Caf\xc3\xa9").is_normalized(NormalizationForm::NFC));
+    CHECK(KString("\xef\xac\x81").normalize(NormalizationForm::NFKD) == "fi");
+}
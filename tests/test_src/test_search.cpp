@@ -0,0 +1,432 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <doctest/doctest.h>
+#include "../../include/search.hpp"
+
+using namespace kstring;
+
+namespace {
+ByteSpan bytes(const std::string& s) {
+    return ByteSpan(reinterpret_cast<const Byte*>(s.data()), s.size());
+}
+
+std::size_t naive_find(const std::string& hay, const std::string& pat) {
+    std::size_t pos = hay.find(pat);
+    return pos == std::string::npos ? knpos : pos;
+}
+
+std::size_t naive_rfind(const std::string& hay, const std::string& pat) {
+    if (pat.empty()) return hay.size();
+    if (pat.size() > hay.size()) return knpos;
+    for (std::size_t i = hay.size() - pat.size() + 1; i-- > 0;) {
+        if (std::memcmp(hay.data() + i, pat.data(), pat.size()) == 0) return i;
+    }
+    return knpos;
+}
+
+// 小字母表随机串, 使首末字节频繁命中而中间不匹配
+std::string random_text(std::size_t len, unsigned& seed) {
+    std::string s(len, 'a');
+    for (auto& c : s) {
+        seed = seed * 1103515245u + 12345u;
+        c = static_cast<char>('a' + (seed >> 16) % 3);
+    }
+    return s;
+}
+
+template <typename Fn>
+void check_against_naive(Fn fn) {
+    unsigned seed = 7;
+    for (std::size_t n = 0; n < 130; ++n) {
+        std::string hay = random_text(n, seed);
+        for (std::size_t m = 0; m <= 6 && m <= n + 1; ++m) {
+            std::string pat = random_text(m, seed);
+            CHECK(fn(bytes(hay), bytes(pat)) == naive_rfind(hay, pat));
+        }
+        // 从 hay 中截取的模式一定能找到
+        if (n >= 4) {
+            std::string pat = hay.substr(n / 3, n / 4 + 2);
+            CHECK(fn(bytes(hay), bytes(pat)) == naive_rfind(hay, pat));
+        }
+    }
+}
+} // namespace
+
+TEST_CASE("search::rfind_byte") {
+    std::string s = "a,b,c";
+    CHECK(search::rfind_byte(bytes(s), ',') == 3);
+    CHECK(search::rfind_byte(bytes(s), 'a') == 0);
+    CHECK(search::rfind_byte(bytes(s), 'x') == knpos);
+    CHECK(search::rfind_byte(ByteSpan(), 'x') == knpos);
+}
+
+TEST_CASE("search::rfind edge cases") {
+    std::string hay = "2024-01-01 INFO start\n2024-01-01 WARN disk\n2024-01-02 INFO stop\n";
+    CHECK(search::rfind(bytes(hay), bytes("INFO")) == hay.rfind("INFO"));
+    CHECK(search::rfind(bytes(hay), bytes("\n")) == hay.size() - 1);
+    CHECK(search::rfind(bytes(hay), bytes("")) == hay.size());
+    CHECK(search::rfind(bytes(hay), bytes("ERROR")) == knpos);
+    CHECK(search::rfind(bytes("ab"), bytes("abc")) == knpos);
+    CHECK(search::rfind(bytes(hay), bytes(hay)) == 0);
+
+    // 匹配恰好位于块边界两侧
+    std::string big(100, 'x');
+    big.replace(0, 3, "abc");
+    CHECK(search::rfind(bytes(big), bytes("abc")) == 0);
+    big.replace(97, 3, "abc");
+    CHECK(search::rfind(bytes(big), bytes("abc")) == 97);
+}
+
+TEST_CASE("search::rfind backends agree with naive search") {
+    MESSAGE("dispatched backend: " << search::simd_backend());
+
+    SUBCASE("dispatched") {
+        check_against_naive(search::rfind);
+    }
+    SUBCASE("scalar") {
+        check_against_naive(search::detail::rfind_scalar);
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    SUBCASE("sse2") {
+        if (__builtin_cpu_supports("sse2")) check_against_naive(search::detail::rfind_sse2);
+    }
+    SUBCASE("avx2") {
+        if (__builtin_cpu_supports("avx2")) check_against_naive(search::detail::rfind_avx2);
+    }
+#endif
+}
+
+TEST_CASE("search::find one-shot matches std::string::find") {
+    unsigned seed = 11;
+    for (std::size_t n = 0; n < 130; ++n) {
+        std::string hay = random_text(n, seed);
+        for (std::size_t m = 0; m <= 6 && m <= n + 1; ++m) {
+            std::string pat = random_text(m, seed);
+            CHECK(search::find(bytes(hay), bytes(pat)) == naive_find(hay, pat));
+        }
+    }
+    CHECK(search::find_byte(bytes("abcabc"), 'c') == 2);
+    CHECK(search::find_byte(bytes("abcabc"), 'x') == knpos);
+}
+
+TEST_CASE("Searcher picks algorithm by needle length") {
+    using Algo = search::Searcher::Algorithm;
+    CHECK(search::Searcher(bytes("")).algorithm() == Algo::Empty);
+    CHECK(search::Searcher(bytes("x")).algorithm() == Algo::Byte);
+    Algo short_algo = search::Searcher(bytes("needle")).algorithm();
+    CHECK((short_algo == Algo::PackedPair || short_algo == Algo::TwoWay));
+    CHECK(search::Searcher(bytes(std::string(100, 'n'))).algorithm() == Algo::Horspool);
+
+    CHECK_THROWS_AS(search::Searcher(bytes("ab"), Algo::Byte), std::invalid_argument);
+    CHECK_THROWS_AS(search::Searcher(bytes("a"), Algo::TwoWay), std::invalid_argument);
+    CHECK(std::string(search::Searcher::algorithm_name(Algo::Horspool)) == "horspool");
+}
+
+TEST_CASE("Searcher algorithms agree with naive search") {
+    using Algo = search::Searcher::Algorithm;
+    const Algo algos[] = {Algo::PackedPair, Algo::TwoWay, Algo::Horspool};
+
+    unsigned seed = 3;
+    for (Algo algo : algos) {
+        for (std::size_t m = 2; m <= 12; ++m) {
+            // 周期性模式 (aaaa, abab) 与随机模式都要覆盖 Two-Way 的两个分支
+            std::string pats[] = {random_text(m, seed), std::string(m, 'a'), random_text(m, seed)};
+            pats[2] = (std::string("ab") + pats[2]).substr(0, m);
+            for (const auto& pat : pats) {
+                search::Searcher searcher(bytes(pat), algo);
+                for (std::size_t n = 0; n < 90; n += 7) {
+                    std::string hay = random_text(n, seed);
+                    CHECK(searcher.find(bytes(hay)) == naive_find(hay, pat));
+                    CHECK(searcher.rfind(bytes(hay)) == naive_rfind(hay, pat));
+                }
+            }
+        }
+    }
+
+    // 长模式
+    std::string hay;
+    for (int i = 0; i < 50; ++i) hay += random_text(40, seed) + "|";
+    std::string pat = hay.substr(900, 120);
+    for (Algo algo : algos) {
+        search::Searcher searcher(bytes(pat), algo);
+        CHECK(searcher.find(bytes(hay)) == naive_find(hay, pat));
+        CHECK(searcher.rfind(bytes(hay)) == naive_rfind(hay, pat));
+    }
+}
+
+TEST_CASE("Searcher count and reuse across haystacks") {
+    search::Searcher searcher(bytes("ab"));
+    CHECK(searcher.count(bytes("ababab")) == 3);
+    CHECK(searcher.count(bytes("xxabxxab")) == 2);
+    CHECK(searcher.count(bytes("")) == 0);
+    CHECK(search::Searcher(bytes("aa")).count(bytes("aaaaa")) == 2);
+    CHECK(search::Searcher(bytes("")).count(bytes("abc")) == 4);
+
+    // 查找器持有模式拷贝, 原始内存失效后仍可使用
+    std::string* tmp = new std::string("needle");
+    search::Searcher owned(bytes(*tmp));
+    delete tmp;
+    CHECK(owned.find(bytes("haystack with a needle")) == 16);
+}
+
+TEST_CASE("find_first_of matches a byte-set scan") {
+    unsigned seed = 11;
+    std::string hay = random_text(300, seed);
+    hay[257] = 'x';
+    hay[290] = 'y';
+    CHECK(search::find_first_of(bytes(hay), bytes("")) == knpos);
+    CHECK(search::find_first_of(bytes(""), bytes("ab")) == knpos);
+    CHECK(search::find_first_of(bytes(hay), bytes("x")) == 257);
+    CHECK(search::find_first_of(bytes(hay), bytes("yx")) == 257);
+    CHECK(search::find_first_of(bytes(hay), bytes("zy")) == 290);
+    CHECK(search::find_first_of(bytes(hay), bytes("zw")) == knpos);
+    // 超过 SIMD 上限的集合走查表
+    CHECK(search::find_first_of(bytes(hay), bytes("0123456789y")) == 290);
+    for (std::size_t i = 0; i < 40; ++i) {
+        std::string tail = hay.substr(hay.size() - i);
+        CHECK(search::find_first_of(bytes(tail), bytes("xy")) == naive_find(tail, "y"));
+    }
+}
+
+namespace {
+typedef std::size_t (*ManyFn)(ByteSpan, ByteSpan, std::size_t, std::size_t*, std::size_t);
+
+// 公开入口与各实现的直接入口
+std::vector<ManyFn> many_impls() {
+    std::vector<ManyFn> impls = {search::find_many, search::detail::find_many_scalar};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) impls.push_back(search::detail::find_many_sse2);
+    if (__builtin_cpu_supports("avx2")) impls.push_back(search::detail::find_many_avx2);
+#endif
+    return impls;
+}
+} // namespace
+
+TEST_CASE("find_many emits non-overlapping matches in batches") {
+    unsigned seed = 5;
+    std::string hay;
+    for (int i = 0; i < 40; ++i) hay += random_text(7, seed) + ",";
+    for (const std::string pat : {",", "a", "ab", "aa", "abca", "a,b"}) {
+        std::vector<std::size_t> expected;
+        for (std::size_t pos = hay.find(pat); pos != std::string::npos; pos = hay.find(pat, pos + pat.size())) {
+            expected.push_back(pos);
+        }
+
+        for (ManyFn fn : many_impls()) {
+            for (std::size_t cap : {1, 3, 64, 1000}) {
+                std::vector<std::size_t> got;
+                std::vector<std::size_t> buf(cap);
+                std::size_t from = 0;
+                while (true) {
+                    std::size_t n = fn(bytes(hay), bytes(pat), from, buf.data(), cap);
+                    got.insert(got.end(), buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(n));
+                    if (n < cap) break;
+                    from = buf[n - 1] + pat.size();
+                }
+                CHECK(got == expected);
+            }
+        }
+    }
+
+    std::size_t one = 0;
+    CHECK(search::find_many(bytes("abc"), bytes("abcd"), 0, &one, 1) == 0);
+    CHECK(search::find_many(bytes("abc"), bytes("c"), 3, &one, 1) == 0);
+    CHECK(search::find_many(bytes("abc"), bytes("c"), 0, &one, 0) == 0);
+    CHECK_THROWS_AS(search::find_many(bytes("abc"), bytes(""), 0, &one, 1), std::invalid_argument);
+}
+
+TEST_CASE("adversarial inputs exceed the verify budget and fall back to Two-Way") {
+    using Algo = search::Searcher::Algorithm;
+    typedef std::size_t (*RfindFn)(ByteSpan, ByteSpan);
+    std::vector<RfindFn> rfinds = {search::rfind, search::detail::rfind_scalar};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) rfinds.push_back(search::detail::rfind_sse2);
+    if (__builtin_cpu_supports("avx2")) rfinds.push_back(search::detail::rfind_avx2);
+#endif
+
+    // 全 'a' 中找 'a…b…a': 每个起点首末字节都命中, 校验到中间才失配
+    for (std::size_t m : {3, 17, 64, 100, 700}) {
+        std::string pat(m, 'a');
+        pat[m / 2] = 'b';
+        for (std::size_t at : {std::size_t(knpos), std::size_t(0), std::size_t(9000), std::size_t(20000 - m)}) {
+            std::string hay(20000, 'a');
+            if (at != knpos) hay.replace(at, m, pat);
+            if (at == 9000) hay.replace(15000, m, pat); // 两处匹配, rfind 应返回后一处
+            INFO("m = " << m << ", at = " << at);
+
+            CHECK(search::find(bytes(hay), bytes(pat)) == naive_find(hay, pat));
+            for (RfindFn fn : rfinds) CHECK(fn(bytes(hay), bytes(pat)) == naive_rfind(hay, pat));
+            for (Algo algo : {Algo::PackedPair, Algo::TwoWay, Algo::Horspool}) {
+                search::Searcher searcher(bytes(pat), algo);
+                CHECK(searcher.find(bytes(hay)) == naive_find(hay, pat));
+                CHECK(searcher.rfind(bytes(hay)) == naive_rfind(hay, pat));
+            }
+
+            std::vector<std::size_t> expected;
+            for (std::size_t pos = hay.find(pat); pos != std::string::npos; pos = hay.find(pat, pos + m)) {
+                expected.push_back(pos);
+            }
+            for (ManyFn fn : many_impls()) {
+                std::size_t buf[8];
+                std::size_t n = fn(bytes(hay), bytes(pat), 0, buf, 8);
+                CHECK(std::vector<std::size_t>(buf, buf + n) == expected);
+                // 从中途开始且 cap 较小
+                std::size_t one = 0;
+                std::size_t from = expected.empty() ? 0 : expected.back();
+                CHECK(fn(bytes(hay), bytes(pat), from, &one, 1) == (expected.empty() ? 0u : 1u));
+            }
+        }
+    }
+}
+
+namespace {
+typedef bool (*EqualFoldFn)(ByteSpan, ByteSpan);
+typedef std::size_t (*FindFoldFn)(ByteSpan, ByteSpan);
+
+std::string fold(std::string s) {
+    for (auto& c : s) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c | 0x20);
+    }
+    return s;
+}
+
+// 字母两种大小写与折叠边界附近的字节: @ [ ` { 以及最高位为 1 而低 7 位是字母的字节
+std::string random_mixed_case(std::size_t len, unsigned& seed) {
+    static const char alphabet[] = {'a', 'A', 'b', 'B', '@', '[', '`', '{', '\xc1', '\xe1'};
+    std::string s(len, 'a');
+    for (auto& c : s) {
+        seed = seed * 1103515245u + 12345u;
+        std::size_t r = (seed >> 16) % 16;
+        c = r < 10 ? alphabet[r] : static_cast<char>("abAB"[r % 4]);
+    }
+    return s;
+}
+} // namespace
+
+TEST_CASE("replace matches a naive find-and-append loop") {
+    auto naive_replace = [](const std::string& hay, const std::string& pat, const std::string& with,
+                            std::size_t limit) {
+        std::string out;
+        std::size_t pos = 0;
+        for (std::size_t n = 0; n < limit; ++n) {
+            std::size_t at = hay.find(pat, pos);
+            if (at == std::string::npos) break;
+            out += hay.substr(pos, at - pos) + with;
+            pos = at + pat.size();
+        }
+        return out + hay.substr(pos);
+    };
+    auto run = [](const std::string& hay, const std::string& pat, const std::string& with, std::size_t limit) {
+        ByteVec out = {'>'}; // 追加在已有内容之后
+        std::size_t n = search::replace(bytes(hay), bytes(pat), bytes(with), out, limit);
+        std::string result(out.begin() + 1, out.end());
+        return std::make_pair(n, result);
+    };
+
+    unsigned seed = 5;
+    const std::size_t limits[] = {0, 1, 3, 200, knpos};
+    for (std::size_t n : {0, 1, 7, 64, 300, 1000}) {
+        std::string hay = random_text(n, seed);
+        for (std::size_t m = 1; m <= 4; ++m) {
+            std::string pat = random_text(m, seed);
+            const std::string withs[] = {std::string(), std::string("X"), random_text(m, seed), std::string(9, 'Z')};
+            for (const std::string& with : withs) {
+                for (std::size_t limit : limits) {
+                    auto got = run(hay, pat, with, limit);
+                    CHECK(got.second == naive_replace(hay, pat, with, limit));
+                    std::size_t expected = 0;
+                    for (std::size_t at = hay.find(pat); at != std::string::npos && expected < limit;
+                         at = hay.find(pat, at + m)) {
+                        ++expected;
+                    }
+                    CHECK(got.first == expected);
+                }
+            }
+        }
+    }
+
+    // 空模式与模式比 hay 长时原样追加
+    CHECK(run("abc", "", "-", knpos) == std::make_pair(std::size_t(0), std::string("abc")));
+    CHECK(run("ab", "abc", "-", knpos) == std::make_pair(std::size_t(0), std::string("ab")));
+    CHECK(run("", "a", "-", knpos) == std::make_pair(std::size_t(0), std::string()));
+    CHECK(run("aaaa", "aa", "b", knpos) == std::make_pair(std::size_t(2), std::string("bb")));
+}
+
+TEST_CASE("ignore-ascii-case comparison and search agree across backends") {
+    std::vector<EqualFoldFn> eqs = {search::equal_ignore_ascii_case, search::detail::equal_ignore_ascii_case_scalar};
+    std::vector<FindFoldFn> finds = {search::find_ignore_ascii_case, search::detail::find_ignore_ascii_case_scalar};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        eqs.push_back(search::detail::equal_ignore_ascii_case_sse2);
+        finds.push_back(search::detail::find_ignore_ascii_case_sse2);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        eqs.push_back(search::detail::equal_ignore_ascii_case_avx2);
+        finds.push_back(search::detail::find_ignore_ascii_case_avx2);
+    }
+#endif
+    unsigned seed = 11;
+    for (std::size_t n = 0; n < 100; ++n) {
+        std::string a = random_mixed_case(n, seed);
+        // 只改动大小写的副本一定相等, 再改一个字节则不等
+        std::string b = a;
+        for (auto& c : b) {
+            seed = seed * 1103515245u + 12345u;
+            if (((seed >> 16) & 1) != 0 && ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')) c = static_cast<char>(c ^ 0x20);
+        }
+        std::string diff = b;
+        if (n > 0) diff[(seed >> 16) % n] = '\x7f';
+        for (EqualFoldFn eq : eqs) {
+            CHECK(eq(bytes(a), bytes(b)));
+            CHECK(eq(bytes(a), bytes(diff)) == (n == 0));
+            CHECK_FALSE(eq(bytes(a), bytes(a + "x")));
+        }
+        CHECK(search::hash_ignore_ascii_case(bytes(a)) == search::hash_ignore_ascii_case(bytes(b)));
+
+        for (std::size_t m = 0; m <= 5 && m <= n + 1; ++m) {
+            std::string pat = random_mixed_case(m, seed);
+            std::size_t expected = naive_find(fold(a), fold(pat));
+            for (FindFoldFn find : finds) CHECK(find(bytes(a), bytes(pat)) == expected);
+        }
+        if (n >= 4) {
+            std::string pat = b.substr(n / 3, n / 4 + 2);
+            std::size_t expected = naive_find(fold(a), fold(pat));
+            for (FindFoldFn find : finds) CHECK(find(bytes(a), bytes(pat)) == expected);
+        }
+    }
+    // 0xC1 / 0xE1 不是字母, 不与 A / a 相等
+    CHECK_FALSE(search::equal_ignore_ascii_case(bytes("\xc1"), bytes("\xe1")));
+    CHECK_FALSE(search::equal_ignore_ascii_case(bytes("@"), bytes("`")));
+    CHECK(search::find_ignore_ascii_case(bytes("x@y`"), bytes("`")) == 3);
+}
+
+TEST_CASE("find_ignore_ascii_case falls back to Two-Way on adversarial inputs") {
+    std::vector<FindFoldFn> finds = {search::find_ignore_ascii_case, search::detail::find_ignore_ascii_case_scalar};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) finds.push_back(search::detail::find_ignore_ascii_case_sse2);
+    if (__builtin_cpu_supports("avx2")) finds.push_back(search::detail::find_ignore_ascii_case_avx2);
+#endif
+
+    // 大小写交替的 'aA…' 中找 'A…b…a': 折叠后每个起点首末字节都命中, 校验到中间才失配
+    for (std::size_t m : {3, 17, 64, 100, 700}) {
+        std::string pat(m, 'a');
+        pat[0] = 'A';
+        pat[m / 2] = 'b';
+        for (std::size_t at : {std::size_t(knpos), std::size_t(0), std::size_t(9001), std::size_t(20000 - m)}) {
+            std::string hay(20000, 'a');
+            for (std::size_t i = 0; i < hay.size(); i += 2) hay[i] = 'A';
+            if (at != knpos) hay.replace(at, m, fold(pat));
+            INFO("m = " << m << ", at = " << at);
+            std::size_t expected = naive_find(fold(hay), fold(pat));
+            CHECK(expected == (at == knpos ? knpos : at));
+            for (FindFoldFn find : finds) CHECK(find(bytes(hay), bytes(pat)) == expected);
+        }
+    }
+}
@@ -0,0 +1,266 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <doctest/doctest.h>
+#include "../../include/kstring.hpp"
+#include "../../include/segmentation.hpp"
+
+using namespace kstring;
+using unicode::GraphemeBreak;
+using unicode::SentenceBreak;
+using unicode::WordBreak;
+
+namespace {
+struct BreakCase {
+    BreakCase() : text(), breaks(), line() {}
+
+    std::string text;
+    std::vector<std::size_t> breaks; // 字节偏移, 含 0 与末尾
+    std::string line;
+};
+
+ByteSpan bytes(const std::string& s) {
+    return ByteSpan(reinterpret_cast<const Byte*>(s.data()), s.size());
+}
+
+// "÷ 0020 × 0308 ÷" 形式的行, ÷ 为边界, × 为非边界
+std::vector<BreakCase> read_break_tests(const char* path) {
+    std::vector<BreakCase> cases;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string body = line.substr(0, line.find('#'));
+        if (body.find_first_not_of(" \t") == std::string::npos) continue;
+        BreakCase c;
+        c.line = line;
+        std::istringstream ss(body);
+        std::string tok;
+        while (ss >> tok) {
+            if (tok == "\xc3\xb7") {
+                c.breaks.push_back(c.text.size());
+            } else if (tok != "\xc3\x97") {
+                auto enc = utf8::encode(static_cast<CodePoint>(std::stoul(tok, nullptr, 16)));
+                c.text.append(enc.begin(), enc.end());
+            }
+        }
+        cases.push_back(c);
+    }
+    return cases;
+}
+
+std::string str(const KStr& s) {
+    ByteSpan b = s.as_bytes();
+    return std::string(b.begin(), b.end());
+}
+
+typedef std::size_t (*BoundaryFn)(ByteSpan, std::size_t);
+
+std::vector<std::size_t> forward_breaks(const std::string& s, BoundaryFn next = unicode::next_grapheme_boundary) {
+    std::vector<std::size_t> out(1, 0);
+    for (std::size_t pos = 0; pos < s.size();) {
+        pos = next(bytes(s), pos);
+        out.push_back(pos);
+    }
+    return out;
+}
+
+std::vector<std::size_t> reverse_breaks(const std::string& s, BoundaryFn prev = unicode::prev_grapheme_boundary) {
+    std::vector<std::size_t> out(1, s.size());
+    for (std::size_t pos = s.size(); pos > 0;) {
+        pos = prev(bytes(s), pos);
+        out.insert(out.begin(), pos);
+    }
+    return out;
+}
+
+// 对照测试文件: 正向与逆向的切分都要一致, 返回不一致的行数
+std::size_t check_rows(const char* path, std::size_t min_rows, BoundaryFn next, BoundaryFn prev) {
+    auto cases = read_break_tests(path);
+    REQUIRE(cases.size() > min_rows);
+    std::size_t failures = 0;
+    for (const auto& c : cases) {
+        bool ok = forward_breaks(c.text, next) == c.breaks && reverse_breaks(c.text, prev) == c.breaks;
+        if (! ok && ++failures <= 5) MESSAGE(c.line);
+    }
+    return failures;
+}
+
+template <typename Range>
+std::vector<std::string> segments(const Range& range) {
+    std::vector<std::string> out;
+    for (KStr seg : range) out.push_back(str(seg));
+    return out;
+}
+
+
+std::vector<std::string> graphemes(const KStr& s) {
+    std::vector<std::string> out;
+    for (KStr g : s.iter_graphemes()) out.push_back(str(g));
+    return out;
+}
+} // namespace
+
+TEST_CASE("grapheme boundaries match the vendored GraphemeBreakTest rows") {
+    auto cases = read_break_tests("../data/ucd/GraphemeBreakTest.txt");
+    REQUIRE(cases.size() > 900);
+    std::size_t failures = 0;
+    for (const auto& c : cases) {
+        bool ok = forward_breaks(c.text) == c.breaks && reverse_breaks(c.text) == c.breaks &&
+                  unicode::grapheme_count(bytes(c.text)) + 1 == c.breaks.size();
+        if (! ok && ++failures <= 5) MESSAGE(c.line);
+    }
+    CHECK(failures == 0);
+}
+
+TEST_CASE("grapheme properties") {
+    CHECK(unicode::grapheme_break('a') == GraphemeBreak::Other);
+    CHECK(unicode::grapheme_break('\r') == GraphemeBreak::CR);
+    CHECK(unicode::grapheme_break(0x0301) == GraphemeBreak::Extend);
+    CHECK(unicode::grapheme_break(0x200D) == GraphemeBreak::ZWJ);
+    CHECK(unicode::grapheme_break(0x1F1E8) == GraphemeBreak::RegionalIndicator);
+    CHECK(unicode::grapheme_break(0xAC01) == GraphemeBreak::LVT);
+    CHECK(unicode::grapheme_break(0x110000) == GraphemeBreak::Other);
+    CHECK(unicode::is_extended_pictographic(0x1F600));
+    CHECK(unicode::is_extended_pictographic(0x00A9));
+    CHECK(! unicode::is_extended_pictographic('#'));
+
+    // 快速路径的前提: 汉字区间全是 Other, 谚文音节全是 LV / LVT, 都不是 ExtPict
+    std::size_t bad = 0;
+    for (CodePoint cp = 0x3400; cp < 0xA000; ++cp) bad += unicode::grapheme_record(cp) != 0;
+    for (CodePoint cp = 0xAC00; cp <= 0xD7A3; ++cp) {
+        GraphemeBreak g = unicode::grapheme_break(cp);
+        bad += g != GraphemeBreak::LV && g != GraphemeBreak::LVT;
+        bad += unicode::is_extended_pictographic(cp);
+    }
+    CHECK(bad == 0);
+}
+
+TEST_CASE("KStr::iter_graphemes yields views in both directions") {
+    std::string text = "Cafe\xcc\x81 \xe4\xb8\xad\xe6\x96\x87 \xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d"
+                       "\xf0\x9f\x91\xa7 \xf0\x9f\x87\xa8\xf0\x9f\x87\xb3\r\n";
+    KStr s(text.c_str());
+    std::vector<std::string> expect = {"C", "a", "f", "e\xcc\x81", " ", "\xe4\xb8\xad", "\xe6\x96\x87", " ",
+                                       "\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7", " ",
+                                       "\xf0\x9f\x87\xa8\xf0\x9f\x87\xb3", "\r\n"};
+    CHECK(graphemes(s) == expect);
+    CHECK(s.grapheme_count() == expect.size());
+    CHECK(KString(text.c_str()).grapheme_count() == expect.size());
+
+    std::vector<std::string> rev;
+    for (KStr g : s.iter_graphemes_rev()) rev.push_back(str(g));
+    CHECK(std::vector<std::string>(rev.rbegin(), rev.rend()) == expect);
+    CHECK(str(*s.iter_graphemes().reversed().begin()) == "\r\n");
+
+    // 子视图指向原串
+    auto it = s.iter_graphemes().begin();
+    ++it;
+    ++it;
+    ++it;
+    CHECK(it->as_bytes().data() == s.as_bytes().data() + 3);
+
+    // 按字素簇截断, 不拆开组合符号
+    KStr title("re\xcc\x81sume\xcc\x81 and more");
+    std::size_t end = 0;
+    std::size_t n = 0;
+    for (KStr g : title.iter_graphemes()) {
+        if (n++ == 6) break;
+        end += g.byte_size();
+    }
+    CHECK(KStr(title.as_bytes().data(), end) == "re\xcc\x81sume\xcc\x81");
+
+    CHECK(graphemes(KStr("")).empty());
+    CHECK(KStr("").iter_graphemes_rev().begin() == KStr("").iter_graphemes_rev().end());
+}
+
+TEST_CASE("invalid bytes are single-byte clusters") {
+    std::string text = "a\xcc\x81\xff\xcc\x81\xe4\xbd";
+    CHECK(forward_breaks(text) == std::vector<std::size_t>({0, 3, 4, 6, 7, 8}));
+    CHECK(reverse_breaks(text) == forward_breaks(text));
+    CHECK(graphemes(KStr(text.data(), text.size())).size() == 5);
+}
+
+TEST_CASE("word boundaries match the vendored WordBreakTest rows") {
+    CHECK(check_rows("../data/ucd/WordBreakTest.txt", 1200, unicode::next_word_boundary,
+                     unicode::prev_word_boundary) == 0);
+}
+
+TEST_CASE("sentence boundaries match the vendored SentenceBreakTest rows") {
+    CHECK(check_rows("../data/ucd/SentenceBreakTest.txt", 600, unicode::next_sentence_boundary,
+                     unicode::prev_sentence_boundary) == 0);
+}
+
+TEST_CASE("word and sentence properties") {
+    CHECK(unicode::word_break('a') == WordBreak::ALetter);
+    CHECK(unicode::word_break('_') == WordBreak::ExtendNumLet);
+    CHECK(unicode::word_break('\'') == WordBreak::SingleQuote);
+    CHECK(unicode::word_break(0x05D0) == WordBreak::HebrewLetter);
+    CHECK(unicode::word_break(0x30A2) == WordBreak::Katakana);
+    CHECK(unicode::word_break(0x110000) == WordBreak::Other);
+    CHECK(unicode::sentence_break('.') == SentenceBreak::ATerm);
+    CHECK(unicode::sentence_break(0x3002) == SentenceBreak::STerm);
+    CHECK(unicode::sentence_break('A') == SentenceBreak::Upper);
+    CHECK(unicode::sentence_break(0x2029) == SentenceBreak::Sep);
+
+    // 快速路径的前提: 汉字区间的 Word_Break 全是 Other 且不是 ExtPict
+    std::size_t bad = 0;
+    for (CodePoint cp = 0x3400; cp < 0xA000; ++cp) bad += unicode::word_record(cp) != 0;
+    CHECK(bad == 0);
+
+    CHECK(unicode::is_word_like(bytes("x")));
+    CHECK(unicode::is_word_like(bytes("\xe4\xb8\xad")));
+    CHECK(unicode::is_word_like(bytes("\xd9\xa3"))); // ARABIC-INDIC DIGIT THREE
+    CHECK(! unicode::is_word_like(bytes("__")));
+    CHECK(! unicode::is_word_like(bytes(" ,")));
+    CHECK(! unicode::is_word_like(bytes("\xf0\x9f\x98\x80")));
+}
+
+TEST_CASE("KStr word and sentence iterators") {
+    KStr s("Don't panic: \xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 3.14 \xe4\xb8\xad\xe6\x96\x87 "
+           "cafe\xcc\x81, e.g. x_y");
+    std::vector<std::string> words = {"Don't", "panic", "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82",
+                                      "3.14", "\xe4\xb8\xad", "\xe6\x96\x87", "cafe\xcc\x81", "e.g", "x_y"};
+    CHECK(segments(s.iter_words()) == words);
+    CHECK(segments(KString(s).iter_words()) == words);
+    std::vector<std::string> rev = segments(s.iter_words().reversed());
+    CHECK(std::vector<std::string>(rev.rbegin(), rev.rend()) == words);
+
+    std::vector<std::string> bounds = segments(s.iter_word_bounds());
+    std::string joined;
+    for (const auto& b : bounds) joined += b;
+    CHECK(joined == str(s));
+    CHECK(bounds[3] == ":");
+    CHECK(bounds[16] == ".");
+    CHECK(bounds.size() == 19);
+
+    // offset 为原串中的字节偏移, 视图指向原串
+    auto it = s.iter_words().begin();
+    ++it;
+    CHECK(it.offset() == 6);
+    CHECK(it->as_bytes().data() == s.as_bytes().data() + 6);
+    CHECK(*it == "panic");
+
+    KStr text("Mr. Smith arrived. He said \"hi!\" and left.\r\nNext paragraph? 3.5 is a number. etc. and so on");
+    // 默认规则不处理缩写: "Mr. Smith" 与 "hi!\" and" 会断开 (SB11), 后跟小写的 "." 不断开 (SB8)
+    std::vector<std::string> sentences = {"Mr. ", "Smith arrived. ", "He said \"hi!\" ", "and left.\r\n",
+                                          "Next paragraph? ", "3.5 is a number. etc. and so on"};
+    CHECK(segments(text.iter_sentences()) == sentences);
+    rev = segments(text.iter_sentences().reversed());
+    CHECK(std::vector<std::string>(rev.rbegin(), rev.rend()) == sentences);
+
+    CHECK(segments(KStr("").iter_words()).empty());
+    CHECK(segments(KStr("  , ").iter_words()).empty());
+    CHECK(segments(KStr("").iter_sentences()).empty());
+}
+
+TEST_CASE("word and sentence segmentation tolerate invalid bytes") {
+    std::string text = "ab\xff" "cd. \xe4\xbd. X";
+    CHECK(forward_breaks(text, unicode::next_word_boundary) ==
+          std::vector<std::size_t>({0, 2, 3, 5, 6, 7, 8, 9, 10, 11, 12}));
+    CHECK(reverse_breaks(text, unicode::prev_word_boundary) == forward_breaks(text, unicode::next_word_boundary));
+    CHECK(forward_breaks(text, unicode::next_sentence_boundary) == std::vector<std::size_t>({0, 7, 11, 12}));
+    CHECK(reverse_breaks(text, unicode::prev_sentence_boundary) ==
+          forward_breaks(text, unicode::next_sentence_boundary));
+}
@@ -0,0 +1,223 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <string>
+#include <vector>
+#include <doctest/doctest.h>
+#include "../../include/kastring.hpp"
+#include "../../include/kstring.hpp"
+
+using namespace kstring;
+
+namespace {
+std::string str(KStr s) {
+    return std::string(reinterpret_cast<const char*>(s.as_bytes().data()), s.byte_size());
+}
+
+std::string str(KAStr s) {
+    return static_cast<std::string>(s);
+}
+
+template <typename Range>
+std::vector<std::string> collect(const Range& range) {
+    std::vector<std::string> out;
+    for (const auto& part : range) out.push_back(str(part));
+    return out;
+}
+
+template <typename View>
+std::vector<std::string> to_strings(const std::vector<View>& parts) {
+    std::vector<std::string> out;
+    for (const auto& part : parts) out.push_back(str(part));
+    return out;
+}
+
+// std::string 上逐次 find 的对照实现
+std::vector<std::string> naive_split(const std::string& s, const std::string& delim, std::size_t max_splits) {
+    std::vector<std::string> out;
+    std::size_t start = 0;
+    while (max_splits-- > 0) {
+        std::size_t pos = s.find(delim, start);
+        if (pos == std::string::npos) break;
+        out.push_back(s.substr(start, pos - start));
+        start = pos + delim.size();
+    }
+    out.push_back(s.substr(start));
+    return out;
+}
+
+std::vector<std::string> naive_rsplit(const std::string& s, const std::string& delim, std::size_t max_splits) {
+    std::vector<std::string> out;
+    std::size_t end = s.size();
+    while (max_splits-- > 0 && end >= delim.size()) {
+        std::size_t pos = s.rfind(delim, end - delim.size());
+        if (pos == std::string::npos) break;
+        out.push_back(s.substr(pos + delim.size(), end - pos - delim.size()));
+        end = pos;
+    }
+    out.push_back(s.substr(0, end));
+    return out;
+}
+} // namespace
+
+TEST_CASE("split_iter yields the same views as split_count") {
+    KStr s("a,b,,你好,");
+    std::vector<std::string> expected = {"a", "b", "", "你好", ""};
+    CHECK(collect(s.split_iter(",")) == expected);
+    CHECK(to_strings(s.split(",")) == expected);
+
+    std::vector<std::string> limited = {"a", "b", ",你好,"};
+    CHECK(collect(s.split_iter(",", 2)) == limited);
+
+    std::vector<std::string> reversed = {"", "你好", "", "b", "a"};
+    CHECK(collect(s.rsplit_iter(",")) == reversed);
+    CHECK(collect(s.split_iter(",").reversed()) == reversed);
+    CHECK(s.rsplit_iter(",").is_reversed());
+
+    // 视图指向原串
+    KStr first = *s.split_iter(",").begin();
+    CHECK(first.as_bytes().data() == s.as_bytes().data());
+    CHECK(s.rsplit_iter(",", 1).front() == "");
+
+    CHECK_THROWS_AS(s.split_iter(""), std::invalid_argument);
+    CHECK_THROWS_AS(s.rsplit_iter(""), std::invalid_argument);
+}
+
+TEST_CASE("split_iter stops early without scanning the rest") {
+    std::string big = "head|";
+    for (int i = 0; i < 1000; ++i) big += "x|";
+    KStr s(big.c_str());
+    auto range = s.split_iter("|");
+    auto it = range.begin();
+    CHECK(*it == "head");
+    ++it;
+    CHECK(*it == "x");
+    CHECK(it != range.end());
+    std::size_t n = 0;
+    for (auto part : range) n += part.byte_size() == 0;
+    CHECK(n == 1);
+}
+
+TEST_CASE("reverse split follows rsplit for overlapping delimiters") {
+    KStr s("aaaaa");
+    std::vector<std::string> forward = {"", "", "a"};
+    std::vector<std::string> backward = {"", "", "a"};
+    CHECK(collect(s.split_iter("aa")) == forward);
+    CHECK(collect(s.rsplit_iter("aa")) == backward);
+    CHECK(to_strings(s.rsplit("aa")) == backward);
+    CHECK(s.rsplit_once("aa").first == "");
+    CHECK(s.rsplit_once("aa").second == "aaa");
+}
+
+TEST_CASE("split_iter matches naive split on random inputs") {
+    unsigned seed = 3;
+    const char alphabet[] = {'a', 'b', ','};
+    for (int round = 0; round < 300; ++round) {
+        std::string text;
+        seed = seed * 1103515245u + 12345u;
+        std::size_t len = (seed >> 16) % 30;
+        for (std::size_t i = 0; i < len; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            text += alphabet[(seed >> 16) % 3];
+        }
+        std::string delim = round % 3 == 0 ? "," : (round % 3 == 1 ? "a," : "aa");
+        std::size_t limit = round % 4 == 0 ? knpos : static_cast<std::size_t>(round % 5);
+        KStr s(text.c_str());
+        KAStr as(text.c_str());
+        CHECK(collect(s.split_iter(delim.c_str(), limit)) == naive_split(text, delim, limit));
+        CHECK(collect(s.rsplit_iter(delim.c_str(), limit)) == naive_rsplit(text, delim, limit));
+        CHECK(collect(as.split_iter(delim.c_str(), limit)) == naive_split(text, delim, limit));
+        CHECK(collect(as.rsplit_iter(delim.c_str(), limit)) == naive_rsplit(text, delim, limit));
+    }
+}
+
+TEST_CASE("lines_iter handles every terminator in both directions") {
+    KStr s("a\r\nb\rc\n\nd\n");
+    std::vector<std::string> expected = {"a", "b", "c", "", "d"};
+    CHECK(collect(s.lines_iter()) == expected);
+    CHECK(to_strings(s.lines()) == expected);
+    std::vector<std::string> backward(expected.rbegin(), expected.rend());
+    CHECK(collect(s.lines_iter().reversed()) == backward);
+
+    CHECK(collect(KStr("").lines_iter()).empty());
+    std::vector<std::string> one_empty = {""};
+    CHECK(collect(KStr("\n").lines_iter()) == one_empty);
+    CHECK(collect(KStr("\n").lines_iter().reversed()) == one_empty);
+    std::vector<std::string> cr_crlf = {"", ""};
+    CHECK(collect(KStr("\r\r\n").lines_iter()) == cr_crlf);
+    CHECK(collect(KStr("\r\r\n").lines_iter().reversed()) == cr_crlf);
+
+    KAStr as("x\r\ny");
+    std::vector<std::string> xy = {"x", "y"};
+    CHECK(collect(as.lines_iter()) == xy);
+}
+
+TEST_CASE("split_whitespace_iter skips runs of unicode whitespace") {
+    KStr s("  你好　 world\t\n abc ");
+    std::vector<std::string> expected = {"你好", "world", "abc"};
+    CHECK(collect(s.split_whitespace_iter()) == expected);
+    std::vector<std::string> backward = {"abc", "world", "你好"};
+    CHECK(collect(s.split_whitespace_iter().reversed()) == backward);
+    CHECK(collect(KStr("   ").split_whitespace_iter()).empty());
+
+    // 非法字节视为非空白
+    std::string raw = " \xff" "a \xe4\xbd b\xff ";
+    std::vector<std::string> with_invalid = {"\xff" "a", "\xe4\xbd", "b\xff"};
+    CHECK(collect(KStr(raw.c_str()).split_whitespace_iter()) == with_invalid);
+    std::vector<std::string> with_invalid_rev(with_invalid.rbegin(), with_invalid.rend());
+    CHECK(collect(KStr(raw.c_str()).split_whitespace_iter().reversed()) == with_invalid_rev);
+
+    KAStr as("\tfoo  bar\v");
+    std::vector<std::string> foobar = {"foo", "bar"};
+    CHECK(collect(as.split_whitespace_iter()) == foobar);
+}
+
+TEST_CASE("KAStr split_iter with empty delimiter splits every byte") {
+    KAStr s("abc");
+    std::vector<std::string> bytes = {"a", "b", "c"};
+    CHECK(collect(s.split_iter("")) == bytes);
+    std::vector<std::string> limited = {"a", "bc"};
+    CHECK(collect(s.split_iter("", 1)) == limited);
+    std::vector<std::string> rlimited = {"c", "b", "a"};
+    CHECK(collect(s.rsplit_iter("", 2)) == rlimited);
+    CHECK(collect(KAStr("").split_iter("")).empty());
+    CHECK(collect(KAStr("").split_iter(",")).size() == 1);
+}
+
+TEST_CASE("owning strings expose the lazy ranges") {
+    KString s("k1=v1;k2=v2");
+    std::vector<std::string> pairs = {"k1=v1", "k2=v2"};
+    CHECK(collect(s.split_iter(";")) == pairs);
+    CHECK(s.rsplit_iter(";").front() == "k2=v2");
+
+    KAString as("l1\nl2");
+    std::vector<std::string> lines = {"l1", "l2"};
+    CHECK(collect(as.lines_iter()) == lines);
+}
+
+TEST_CASE("split_offsets writes delimiter offsets into a caller buffer") {
+    KStr row("id,名字,,score");
+    std::size_t offs[8];
+    REQUIRE(row.split_offsets(",", offs, 8) == 3);
+    CHECK(offs[0] == 2);
+    CHECK(offs[1] == 9);
+    CHECK(offs[2] == 10);
+
+    // 缓冲写满后从最后一个偏移之后继续
+    REQUIRE(row.split_offsets(",", offs, 2) == 2);
+    REQUIRE(row.split_offsets(",", offs, 2, offs[1] + 1) == 1);
+    CHECK(offs[0] == 10);
+    CHECK_THROWS_AS(row.split_offsets("", offs, 8), std::invalid_argument);
+
+    KAStr line("a::b::::c");
+    REQUIRE(line.split_offsets("::", offs, 8) == 3);
+    CHECK(offs[2] == 6);
+    CHECK(KAString("x;y").split_offsets(";", offs, 8) == 1);
+
+    // 超过一批 (64) 的分割结果与惰性版本一致
+    std::string wide;
+    for (int i = 0; i < 300; ++i) wide += std::to_string(i) + ",";
+    KStr w(wide.c_str());
+    CHECK(to_strings(w.split(",")) == collect(w.split_iter(",")));
+    CHECK(to_strings(w.split_count(",", 100)) == collect(w.split_iter(",", 100)));
+    CHECK(to_strings(KAStr(wide).split_count(",", 130)) == collect(KAStr(wide).split_iter(",", 130)));
+}
@@ -448,6 +448,25 @@ TEST_CASE("SSOBytes(const std::string&)") {
     CHECK(std::string(s.begin(), s.end()) == "world");
 }
 
+TEST_CASE("SSOBytes(std::vector<Byte>&&) adopts the heap buffer") {
+    std::vector<Byte> big(SSOBytes::SSO_CAPACITY + 10, 'x');
+    const Byte* buffer = big.data();
+    SSOBytes heap(std::move(big));
+    CHECK_FALSE(heap.is_sso());
+    CHECK(heap.size() == SSOBytes::SSO_CAPACITY + 10);
+    CHECK(heap.data() == buffer); // 没有拷贝
+
+    // 装得进 SSO 时拷贝, 原 vector 不变
+    std::vector<Byte> small = {'a', 'b', 'c'};
+    SSOBytes sso(std::move(small));
+    CHECK(sso.is_sso());
+    CHECK(std::string(sso.begin(), sso.end()) == "abc");
+    CHECK(small.size() == 3);
+
+    std::vector<Byte> empty;
+    CHECK(SSOBytes(std::move(empty)).empty());
+}
+
 TEST_CASE("shrink_to_fit works for heap mode only") {
     SSOBytes s(std::string('x', SSOBytes::SSO_CAPACITY + 100)); // force heap
     auto old_capacity = s.capacity();
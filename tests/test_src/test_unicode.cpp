@@ -0,0 +1,138 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <doctest/doctest.h>
+#include "../../include/kchar.hpp"
+#include "../../include/kstring.hpp"
+#include "../../include/unicode.hpp"
+
+using namespace kstring;
+using unicode::GeneralCategory;
+
+namespace {
+const char* const GC_NAMES[] = {"Lu", "Ll", "Lt", "Lm", "Lo", "Mn", "Mc", "Me", "Nd", "Nl", "No", "Pc", "Pd", "Ps", "Pe",
+                                "Pi", "Pf", "Po", "Sm", "Sc", "Sk", "So", "Zs", "Zl", "Zp", "Cc", "Cf", "Cs", "Co", "Cn"};
+
+struct UcdRange {
+    CodePoint lo;
+    CodePoint hi;
+    std::string value;
+};
+
+// 读取 data/ucd 下的 "range ; value" 行 (测试在 tests 目录下运行)
+std::vector<UcdRange> read_ucd(const std::string& name) {
+    std::vector<UcdRange> out;
+    std::ifstream in("../data/ucd/" + name);
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::size_t semi = line.find(';');
+        if (semi == std::string::npos) continue;
+        UcdRange r = {0, 0, ""};
+        unsigned lo = 0;
+        unsigned hi = 0;
+        int n = std::sscanf(line.c_str(), "%x..%x", &lo, &hi);
+        r.lo = lo;
+        r.hi = n == 2 ? hi : lo;
+        std::istringstream value(line.substr(semi + 1));
+        value >> r.value;
+        out.push_back(r);
+    }
+    return out;
+}
+
+std::vector<bool> binary_property(const std::string& file, const std::string& prop) {
+    std::vector<bool> out(0x110000, false);
+    for (const auto& r : read_ucd(file)) {
+        if (r.value != prop) continue;
+        for (CodePoint cp = r.lo; cp <= r.hi; ++cp) out[cp] = true;
+    }
+    return out;
+}
+} // namespace
+
+TEST_CASE("property tables agree with the vendored UCD files for every code point") {
+    std::vector<unsigned char> gc(0x110000, static_cast<unsigned char>(GeneralCategory::Cn));
+    auto ranges = read_ucd("DerivedGeneralCategory.txt");
+    REQUIRE(ranges.size() > 1000);
+    for (const auto& r : ranges) {
+        unsigned char id = 0;
+        while (id < 30 && r.value != GC_NAMES[id]) ++id;
+        REQUIRE(id < 30);
+        for (CodePoint cp = r.lo; cp <= r.hi; ++cp) gc[cp] = id;
+    }
+    auto white = binary_property("PropList.txt", "White_Space");
+    auto alpha = binary_property("DerivedCoreProperties.txt", "Alphabetic");
+    auto lower = binary_property("DerivedCoreProperties.txt", "Lowercase");
+    auto upper = binary_property("DerivedCoreProperties.txt", "Uppercase");
+    auto cased = binary_property("DerivedCoreProperties.txt", "Cased");
+    auto ignorable = binary_property("DerivedCoreProperties.txt", "Case_Ignorable");
+
+    std::size_t mismatches = 0;
+    for (CodePoint cp = 0; cp < 0x110000; ++cp) {
+        mismatches += static_cast<unsigned char>(unicode::general_category(cp)) != gc[cp];
+        mismatches += unicode::is_white_space(cp) != white[cp];
+        mismatches += unicode::is_alphabetic(cp) != alpha[cp];
+        mismatches += unicode::is_lowercase(cp) != lower[cp];
+        mismatches += unicode::is_uppercase(cp) != upper[cp];
+        mismatches += unicode::is_cased(cp) != cased[cp];
+        mismatches += unicode::is_case_ignorable(cp) != ignorable[cp];
+    }
+    CHECK(mismatches == 0);
+    CHECK(unicode::general_category(0x110000) == GeneralCategory::Cn);
+    CHECK(std::string(unicode::version()) == "14.0.0");
+}
+
+TEST_CASE("KChar predicates classify non-ASCII scripts") {
+    CHECK(KChar(0x4E2D).is_alpha()); // 中
+    CHECK(KChar(0x4E2D).general_category() == GeneralCategory::Lo);
+    CHECK_FALSE(KChar(0x4E2D).is_upper());
+    CHECK(KChar(0x0416).is_upper()); // Ж
+    CHECK(KChar(0x0436).is_lower()); // ж
+    CHECK(KChar(0x0663).is_digit()); // ٣
+    CHECK(KChar(0xFF19).is_digit()); // ９
+    CHECK(KChar(0x216B).is_numeric()); // Ⅻ
+    CHECK_FALSE(KChar(0x216B).is_digit());
+    CHECK(KChar(0x216B).is_alnum());
+    CHECK(KChar(0x3002).is_punctuation()); // 。
+    CHECK(KChar(0x0085).is_control());
+    CHECK_FALSE(KChar(0x0085).is_printable());
+    CHECK_FALSE(KChar(0x2028).is_printable());
+    CHECK(KChar(0x20AC).is_printable());
+    CHECK(KChar(' ').is_printable());
+    CHECK_FALSE(KChar(0xE000).is_printable()); // 私用区
+
+    // ASCII 版本保持原来的语义
+    CHECK(KChar('7').is_ascii_digit());
+    CHECK_FALSE(KChar(0x0663).is_ascii_digit());
+    CHECK(KChar('q').is_ascii_alpha());
+    CHECK_FALSE(KChar(0x0436).is_ascii_lower());
+}
+
+TEST_CASE("classify gives one mask per char") {
+    std::string text = "Aж9 中\xff。";
+    auto masks = KStr(text.c_str()).char_masks();
+    REQUIRE(masks.size() == 7);
+    CHECK(masks[0] == (unicode::CHAR_LETTER | unicode::CHAR_PRINTABLE | unicode::CHAR_ALPHABETIC |
+                       unicode::CHAR_UPPERCASE | unicode::CHAR_CASED));
+    CHECK((masks[1] & unicode::CHAR_LOWERCASE) != 0);
+    CHECK((masks[2] & unicode::CHAR_DIGIT) != 0);
+    CHECK((masks[3] & unicode::CHAR_WHITE_SPACE) != 0);
+    CHECK((masks[3] & unicode::CHAR_SEPARATOR) != 0);
+    CHECK((masks[4] & unicode::CHAR_ALPHABETIC) != 0);
+    CHECK(masks[5] == unicode::CHAR_INVALID);
+    CHECK((masks[6] & unicode::CHAR_PUNCTUATION) != 0);
+    CHECK(KString(text.c_str()).char_masks() == masks);
+
+    // 按缓冲分批
+    unicode::CharMask buf[3];
+    std::size_t pos = 0;
+    CHECK(unicode::classify(KStr(text.c_str()).as_bytes(), pos, buf, 3) == 3);
+    CHECK(pos == 4);
+    CHECK(buf[2] == masks[2]);
+    CHECK(unicode::classify(ByteSpan()).empty());
+}
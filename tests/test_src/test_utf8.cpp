@@ -335,6 +335,68 @@ TEST_CASE("decode_prev") {
     }
 }
 
+namespace {
+// 改为 DFA 之前的逐步检查实现, 作为 decode_one 结果与 next_pos 的参照
+UTF8Decoded reference_decode_one(const ByteSpan& data, std::size_t pos) {
+    if (pos >= data.size()) return UTF8Decoded::ill(data.size());
+    Byte lead = data[pos];
+    std::size_t len = lead <= 0x7F ? 1 : lead >= 0xC0 && lead <= 0xDF ? 2 : lead >= 0xE0 && lead <= 0xEF ? 3
+                                       : lead >= 0xF0 && lead <= 0xF4 ? 4 : 0;
+    if (len == 0) return UTF8Decoded::ill(pos + 1);
+    if (pos + len > data.size()) return UTF8Decoded::ill(data.size());
+    for (std::size_t i = 1; i < len; ++i) {
+        if ((data[pos + i] & 0xC0) != 0x80) return UTF8Decoded::ill(pos + i);
+    }
+    CodePoint cp = len == 1 ? lead : lead & (0x7Fu >> len);
+    for (std::size_t i = 1; i < len; ++i) cp = (cp << 6) | (data[pos + i] & 0x3Fu);
+    bool bad = utf8_size(cp) != len || is_surrogate_codepoint(cp) || is_overflow_codepoint(cp);
+    if (bad) return UTF8Decoded::ill(pos + len);
+    return UTF8Decoded(cp, pos + len);
+}
+} // namespace
+
+TEST_CASE("decode_one matches the reference decoder on every lead byte and truncation") {
+    // 续字节按 DFA 的类别边界取代表值, 另加 ASCII 与各类首字节
+    const Byte tails[] = {0x00, 0x41, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0,
+                          0xBF, 0xC0, 0xC2, 0xE0, 0xED, 0xF0, 0xF4, 0xFF};
+    std::size_t mismatches = 0;
+    std::size_t checked = 0;
+    for (unsigned lead = 0; lead < 256; ++lead) {
+        for (Byte b1 : tails) {
+            for (Byte b2 : tails) {
+                for (Byte b3 : tails) {
+                    const Byte bytes[] = {static_cast<Byte>(lead), b1, b2, b3};
+                    for (std::size_t len = 1; len <= 4; ++len) {
+                        ByteSpan data(bytes, len);
+                        UTF8Decoded got = decode_one(data, 0);
+                        UTF8Decoded want = reference_decode_one(data, 0);
+                        mismatches += got.ok != want.ok || got.next_pos != want.next_pos ||
+                                       (want.ok && got.codepoint != want.codepoint);
+                        ++checked;
+                    }
+                }
+            }
+        }
+    }
+    CHECK(checked == 256u * 16 * 16 * 16 * 4);
+    CHECK(mismatches == 0);
+
+    // 所有两字节组合
+    for (unsigned a = 0; a < 256; ++a) {
+        for (unsigned b = 0; b < 256; ++b) {
+            const Byte bytes[] = {static_cast<Byte>(a), static_cast<Byte>(b)};
+            UTF8Decoded got = decode_one(ByteSpan(bytes, 2), 0);
+            UTF8Decoded want = reference_decode_one(ByteSpan(bytes, 2), 0);
+            mismatches += got.ok != want.ok || got.next_pos != want.next_pos || got.codepoint != want.codepoint;
+        }
+    }
+    CHECK(mismatches == 0);
+    CHECK(lead_utf8_length(0xC0) == 2);
+    CHECK(lead_utf8_length(0xF4) == 4);
+    CHECK(lead_utf8_length(0xF5) == 0);
+    CHECK(lead_utf8_length(0x80) == 0);
+}
+
 TEST_CASE("decode detail") {
     ByteVec data = {static_cast<Byte>(0xC3), static_cast<Byte>(0xA9)}; // é
     UTF8Decoded decode_result = decode_one(data, 0);
@@ -356,6 +418,117 @@ TEST_CASE("char_count") {
     CHECK(char_count(data) == 3);
 }
 
+TEST_CASE("char_count - malformed input matches decode_one segmentation") {
+    // 每个非法序列计为一个字符, 与逐个 decode_one 的 next_pos 切分一致
+    auto linear_count = [](const ByteSpan& data) {
+        std::size_t count = 0;
+        for (std::size_t pos = 0; pos < data.size(); pos = decode_one(data, pos).next_pos) ++count;
+        return count;
+    };
+
+    std::vector<ByteVec> cases = {
+        {0xFF},
+        {'a', 0x80, 0x80, 'b'},
+        {0xE4, 0xBD},                   // 截断在末尾
+        {0xE4, 0xBD, 'x', 0xE4},        // 截断在中间
+        {0xC0, 0xAF},                   // overlong
+        {0xED, 0xA0, 0x80},             // surrogate
+        {0xF4, 0x90, 0x80, 0x80},       // > U+10FFFF
+        {0xF0, 0x9F, 0x98, 0x81, 0xFE}, // 合法后紧跟非法
+    };
+    // invalid_count 统计同一切分中的非法序列
+    auto linear_invalid = [](const ByteSpan& data) {
+        std::size_t count = 0;
+        for (std::size_t pos = 0; pos < data.size();) {
+            UTF8Decoded d = decode_one(data, pos);
+            count += d.ok ? 0 : 1;
+            pos = d.next_pos;
+        }
+        return count;
+    };
+    for (const auto& c : cases) {
+        CHECK(char_count(c) == linear_count(c));
+        CHECK(invalid_count(c) == linear_invalid(c));
+    }
+
+    // 长合法段中穿插非法字节, 跨越 simdutf 的块边界
+    ByteVec long_data;
+    for (int i = 0; i < 500; ++i) {
+        long_data.insert(long_data.end(), {0xE4, 0xBD, 0xA0, 'a'});
+        if (i % 37 == 0) long_data.push_back(0xFF);
+        if (i % 91 == 0) long_data.insert(long_data.end(), {0xF0, 0x9F});
+    }
+    CHECK(char_count(long_data) == linear_count(long_data));
+    CHECK(invalid_count(long_data) == linear_invalid(long_data));
+    CHECK(invalid_count(ByteVec{'a', 0xE4, 0xBD, 0xA0}) == 0);
+}
+
+TEST_CASE("decode_one_prev walks back through the same split as decode_one") {
+    // 逆向逐个解码的结果应与正向切分的倒序完全一致 (含 ok, 码点与起始位置)
+    auto check_split = [](const ByteVec& data) {
+        std::vector<UTF8Decoded> forward;
+        std::vector<std::size_t> starts;
+        for (std::size_t pos = 0; pos < data.size();) {
+            UTF8Decoded dec = decode_one(data, pos);
+            forward.push_back(dec);
+            starts.push_back(pos);
+            pos = dec.next_pos;
+        }
+        std::size_t i = forward.size();
+        for (std::size_t pos = data.size(); pos > 0;) {
+            UTF8Decoded dec = decode_one_prev(data, pos);
+            if (i == 0) return false;
+            --i;
+            if (dec.ok != forward[i].ok || dec.next_pos != starts[i]) return false;
+            if (dec.ok && dec.codepoint != forward[i].codepoint) return false;
+            pos = dec.next_pos;
+        }
+        return i == 0;
+    };
+
+    const Byte alphabet[] = {0x41, 0x80, 0x9F, 0xA0, 0xBF, 0xC0, 0xC3, 0xE0, 0xE4, 0xED, 0xF0, 0xF4, 0xF5, 0xFF};
+    const std::size_t k = sizeof(alphabet);
+    std::size_t failures = 0;
+    for (std::size_t a = 0; a < k; ++a) {
+        for (std::size_t b = 0; b < k; ++b) {
+            for (std::size_t c = 0; c < k; ++c) {
+                for (std::size_t d = 0; d < k; ++d) {
+                    ByteVec data = {alphabet[a], alphabet[b], alphabet[c], alphabet[d]};
+                    for (std::size_t len = 1; len <= 4; ++len) {
+                        ByteVec prefix(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(len));
+                        failures += ! check_split(prefix);
+                    }
+                }
+            }
+        }
+    }
+    CHECK(failures == 0);
+
+    // 更长的随机串: 合法字符与上述字节混排
+    std::uint32_t seed = 12345;
+    auto next = [&seed]() { return seed = seed * 1103515245u + 12345u, (seed >> 16) & 0x7FFF; };
+    const ByteVec pieces[] = {{0xE4, 0xBD, 0xA0}, {0xF0, 0x9F, 0x98, 0x81}, {0xC3, 0xA9}, {0x61}};
+    for (int round = 0; round < 2000; ++round) {
+        ByteVec data;
+        std::size_t n = next() % 24;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (next() % 2) {
+                const ByteVec& piece = pieces[next() % 4];
+                data.insert(data.end(), piece.begin(), piece.end());
+            } else {
+                data.push_back(alphabet[next() % k]);
+            }
+        }
+        failures += ! check_split(data);
+    }
+    CHECK(failures == 0);
+
+    ByteVec truncated = {'a', 0xF0, 'b'}; // 末尾截断的序列连同其后的 'b' 算作一个
+    UTF8Decoded last = decode_one_prev(truncated, 3);
+    CHECK_FALSE(last.ok);
+    CHECK(last.next_pos == 1);
+}
+
 TEST_CASE("find") {
     ByteVec data = {'a', 0xE4, 0xBD, 0xA0}; // a你
     CHECK(find_codepoint(data, 'a') == 0);
@@ -364,6 +537,55 @@ TEST_CASE("find") {
     CHECK(find_codepoint(data, 0x4F61) == kstring::knpos);
 }
 
+TEST_CASE("find_codepoint - non-ASCII targets and invalid bytes") {
+    // 参照: 按 decode_one 的切分逐个比较
+    auto linear_find = [](const ByteSpan& data, CodePoint target) -> std::size_t {
+        std::size_t index = 0;
+        for (std::size_t pos = 0; pos < data.size(); ++index) {
+            UTF8Decoded dec = decode_one(data, pos);
+            if (dec.ok && dec.codepoint == target) return index;
+            pos = dec.next_pos;
+        }
+        return kstring::knpos;
+    };
+
+    ByteVec text = {0xE4, 0xBD, 0xA0, 0xEF, 0xBC, 0x8C, 0xE5, 0xA5, 0xBD, 0xE3, 0x80, 0x81}; // 你，好、
+    CHECK(find_codepoint(text, 0xFF0C) == 1);
+    CHECK(find_codepoint(text, 0x3001) == 3);
+
+    // 非法字节不再中断查找, 每个非法序列计为一个字符
+    ByteVec dirty = {0xFF, 0xE4, 0xBD, 'x', 0xC0, 0xAF, 0xEF, 0xBC, 0x8C};
+    CHECK(find_codepoint(dirty, 0xFF0C) == 4);
+    CHECK(find_codepoint(dirty, 'x') == 2);
+
+    // 末尾被截断的序列吞掉其后的字节, 其中的匹配不算数
+    CHECK(find_codepoint(ByteVec({'a', 0xF0, 0xC3, 0xA9}), 0xE9) == kstring::knpos);
+    CHECK(find_codepoint(ByteVec({'a', 0xF0, 'b'}), 'b') == kstring::knpos);
+    CHECK(find_codepoint(ByteVec({0xC3, 0xA9, 0xF0}), 0xE9) == 0);
+
+    // 代理区与超出范围的码点不会被解码出来; U+FFFD 只匹配真正编码出的 EF BF BD
+    CHECK(find_codepoint(ByteVec({0xED, 0xA0, 0x80}), 0xD800) == kstring::knpos);
+    CHECK(find_codepoint(ByteVec({0xEF, 0xBF, 0xBD}), 0x110000) == kstring::knpos);
+    CHECK(find_codepoint(ByteVec({0xFF, 0xEF, 0xBF, 0xBD}), kstring::ILL_CODEPOINT) == 1);
+
+    const ByteVec pieces[] = {{0xEF, 0xBC, 0x8C}, {0xE3, 0x80, 0x81}, {0xF0, 0x9F, 0x98, 0x81}, {0xC3, 0xA9},
+                              {'a'},              {0xFF},             {0xE4, 0xBD},             {0x80}, {0xF0}};
+    const CodePoint targets[] = {0xFF0C, 0x3001, 0x1F601, 0xE9, 'a'};
+    std::uint32_t seed = 7;
+    auto next = [&seed]() { return seed = seed * 1103515245u + 12345u, (seed >> 16) & 0x7FFF; };
+    std::size_t mismatches = 0;
+    for (int round = 0; round < 3000; ++round) {
+        ByteVec data;
+        std::size_t n = next() % 40;
+        for (std::size_t i = 0; i < n; ++i) {
+            const ByteVec& piece = pieces[next() % 9];
+            data.insert(data.end(), piece.begin(), piece.end());
+        }
+        for (CodePoint target : targets) mismatches += find_codepoint(data, target) != linear_find(data, target);
+    }
+    CHECK(mismatches == 0);
+}
+
 TEST_CASE("replace_at") {
     ByteVec data = {'a', 0xE4, 0xBD, 0xA0}; // a你
     replace_at(data, 0, 0x4F60);            // 'a' -> '你'
@@ -428,6 +650,275 @@ TEST_CASE("replace_all - diff < 0 (4-byte to 1-byte)") {
     CHECK(data[1] == 'X');
 }
 
+TEST_CASE("replace_all - invalid bytes, growth and truncated tail") {
+    // 非法字节不再中断替换; ， (3 字节) -> ", " (2 字节) 与 -> 😁 (4 字节)
+    ByteVec data = {0xEF, 0xBC, 0x8C, 0xFF, 'a', 0xEF, 0xBC, 0x8C, 0xE4, 0xBD, 'b', 0xEF, 0xBC, 0x8C};
+    ByteVec shrunk = data;
+    replace_all(shrunk, 0xFF0C, ',');
+    CHECK(shrunk == ByteVec({',', 0xFF, 'a', ',', 0xE4, 0xBD, 'b', ','}));
+    ByteVec grown = data;
+    replace_all(grown, 0xFF0C, 0x1F601);
+    CHECK(grown == ByteVec({0xF0, 0x9F, 0x98, 0x81, 0xFF, 'a', 0xF0, 0x9F, 0x98, 0x81, 0xE4, 0xBD, 'b', 0xF0, 0x9F,
+                            0x98, 0x81}));
+    ByteVec same = data;
+    replace_all(same, 0xFF0C, 0x3001); // 、 等长, 原地覆盖
+    CHECK(char_count(same) == char_count(data));
+    CHECK(find_codepoint(same, 0xFF0C) == kstring::knpos);
+    CHECK(find_codepoint(same, 0x3001) == 0);
+
+    // 末尾截断的序列吞掉的字节不参与替换; 非法的 cp_old 不做任何事
+    ByteVec tail = {'a', 0xF0, 'a'};
+    replace_all(tail, 'a', 'b');
+    CHECK(tail == ByteVec({'b', 0xF0, 'a'}));
+    replace_first(tail, 'a', 'c');
+    CHECK(tail == ByteVec({'b', 0xF0, 'a'}));
+    ByteVec surrogate = {0xED, 0xA0, 0x80};
+    replace_all(surrogate, 0xD800, 'x');
+    CHECK(surrogate == ByteVec({0xED, 0xA0, 0x80}));
+
+    // 大量替换只做一次分配与拷贝, 结果与逐个替换一致
+    ByteVec big;
+    ByteVec expected;
+    for (int i = 0; i < 3000; ++i) {
+        big.insert(big.end(), {0xE4, 0xBD, 0xA0, 'x'});
+        expected.insert(expected.end(), {'*', 'x'});
+        if (i % 7 == 0) {
+            big.push_back(0x80);
+            expected.push_back(0x80);
+        }
+    }
+    replace_all(big, 0x4F60, '*');
+    CHECK(big == expected);
+}
+
+TEST_CASE("sanitize matches encode_all(decode_all()) byte for byte") {
+    auto round_trip = [](const ByteVec& data) { return encode_all(decode_all(data)); };
+
+    const ByteVec pieces[] = {{0xE4, 0xBD, 0xA0}, {0xF0, 0x9F, 0x98, 0x81}, {0xC3, 0xA9}, {'a'}, {0xFF},
+                              {0xE4, 0xBD},       {0x80},                   {0xF0},       {0xC0, 0xAF},
+                              {0xED, 0xA0, 0x80}, {0xF4, 0x90, 0x80, 0x80}, {0xEF, 0xBF, 0xBD}};
+    std::uint32_t seed = 99;
+    auto next = [&seed]() { return seed = seed * 1103515245u + 12345u, (seed >> 16) & 0x7FFF; };
+    std::size_t mismatches = 0;
+    for (int round = 0; round < 3000; ++round) {
+        ByteVec data;
+        std::size_t n = next() % 30;
+        for (std::size_t i = 0; i < n; ++i) {
+            const ByteVec& piece = pieces[next() % 12];
+            data.insert(data.end(), piece.begin(), piece.end());
+        }
+        ByteVec expected = round_trip(data);
+        mismatches += sanitize(data) != expected;
+        ByteVec in_place = data;
+        bool changed = sanitize_in_place(in_place);
+        mismatches += in_place != expected || changed != ! is_valid(data);
+        mismatches += ! is_valid(expected);
+    }
+    CHECK(mismatches == 0);
+
+    // 合法输入原样返回, 原地版本不做修改
+    ByteVec valid = {'o', 'k', 0xE4, 0xBD, 0xA0};
+    CHECK(sanitize(valid) == valid);
+    CHECK_FALSE(sanitize_in_place(valid));
+    CHECK(sanitize(ByteVec()).empty());
+
+    // 一个非法序列一个 U+FFFD: E4 BD 是一个截断序列, 80 80 是两个孤立续字节
+    CHECK(sanitize(ByteVec({'a', 0xE4, 0xBD, 'b', 0x80, 0x80})) ==
+          ByteVec({'a', 0xEF, 0xBF, 0xBD, 'b', 0xEF, 0xBF, 0xBD, 0xEF, 0xBF, 0xBD}));
+
+    // 长合法段跨越 simdutf 的块边界
+    ByteVec long_data;
+    for (int i = 0; i < 2000; ++i) {
+        long_data.insert(long_data.end(), {0xE4, 0xBD, 0xA0, 'a', 'b'});
+        if (i % 97 == 0) long_data.insert(long_data.end(), {0xF0, 0x9F});
+    }
+    CHECK(sanitize(long_data) == round_trip(long_data));
+}
+
+TEST_CASE("UTF-16 / Latin-1 transcoding") {
+    auto swap16 = [](std::u16string s) {
+        for (auto& u : s) u = static_cast<char16_t>((u >> 8) | (u << 8));
+        return s;
+    };
+    const bool little = [] {
+        const std::uint16_t probe = 1;
+        return *reinterpret_cast<const Byte*>(&probe) == 1;
+    }();
+    auto as_le = [&](const std::u16string& native) { return little ? native : swap16(native); };
+
+    SUBCASE("valid UTF-8 round trip, both orders") {
+        ByteVec text = {'h', 'i', 0xC3, 0xA9, 0xE4, 0xBD, 0xA0, 0xF0, 0x9F, 0x98, 0x81};
+        std::u16string le;
+        append_utf16(text, le, ErrorMode::Strict);
+        CHECK(le == as_le(u"hi\u00E9\u4F60\U0001F601"));
+        std::u16string be;
+        append_utf16(text, be, ErrorMode::Strict, Utf16Order::BigEndian);
+        CHECK(be == swap16(le));
+
+        ByteVec back;
+        append_from_utf16(le.data(), le.size(), back, ErrorMode::Strict);
+        CHECK(back == text);
+        back.clear();
+        append_from_utf16(be.data(), be.size(), back, ErrorMode::Strict, Utf16Order::BigEndian);
+        CHECK(back == text);
+    }
+
+    SUBCASE("results are appended to out") {
+        std::u16string out = as_le(u"x");
+        append_utf16(ByteVec({'y'}), out);
+        CHECK(out == as_le(u"xy"));
+        ByteVec bytes = {'a'};
+        append_from_latin1(ByteVec({0xE9}), bytes);
+        CHECK(bytes == ByteVec({'a', 0xC3, 0xA9}));
+    }
+
+    SUBCASE("invalid UTF-8: one U+FFFD per sequence, strict leaves out untouched") {
+        ByteVec bad = {'a', 0xE4, 0xBD, 'b', 0x80, 0x80};
+        std::u16string out;
+        append_utf16(bad, out);
+        CHECK(out == as_le(u"a\uFFFDb\uFFFD\uFFFD"));
+
+        std::u16string kept = as_le(u"keep");
+        CHECK_THROWS_AS(append_utf16(bad, kept, ErrorMode::Strict), std::invalid_argument);
+        CHECK(kept == as_le(u"keep"));
+    }
+
+    SUBCASE("unpaired surrogates") {
+        std::u16string wide = as_le(u"a");
+        wide.push_back(as_le(std::u16string(1, static_cast<char16_t>(0xD83D)))[0]); // 高代理后跟 'b'
+        wide += as_le(u"b");
+        wide.push_back(as_le(std::u16string(1, static_cast<char16_t>(0xDE01)))[0]); // 单独的低代理
+        ByteVec out;
+        append_from_utf16(wide.data(), wide.size(), out);
+        CHECK(out == ByteVec({'a', 0xEF, 0xBF, 0xBD, 'b', 0xEF, 0xBF, 0xBD}));
+
+        ByteVec kept = {'k'};
+        CHECK_THROWS_AS(append_from_utf16(wide.data(), wide.size(), kept, ErrorMode::Strict), std::invalid_argument);
+        CHECK(kept == ByteVec({'k'}));
+    }
+
+    SUBCASE("Latin-1") {
+        ByteVec latin1;
+        for (int c = 0; c < 256; ++c) latin1.push_back(static_cast<Byte>(c));
+        ByteVec utf8_text;
+        append_from_latin1(latin1, utf8_text);
+        CHECK(is_valid(utf8_text));
+        CHECK(char_count(utf8_text) == 256);
+        ByteVec back;
+        append_latin1(utf8_text, back, ErrorMode::Strict);
+        CHECK(back == latin1);
+
+        // U+4F60 超出 Latin-1, FF 不是合法 UTF-8
+        ByteVec mixed = {'c', 0xC3, 0xA9, 0xE4, 0xBD, 0xA0, 0xFF, 'z'};
+        ByteVec lossy;
+        append_latin1(mixed, lossy);
+        CHECK(lossy == ByteVec({'c', 0xE9, '?', '?', 'z'}));
+        ByteVec kept;
+        CHECK_THROWS_AS(append_latin1(mixed, kept, ErrorMode::Strict), std::invalid_argument);
+        CHECK(kept.empty());
+    }
+
+    SUBCASE("long input with scattered errors matches decode_all") {
+        ByteVec data;
+        for (int i = 0; i < 3000; ++i) {
+            data.insert(data.end(), {0xE4, 0xBD, 0xA0, 'a', 0xC3, 0xA9});
+            if (i % 89 == 0) data.insert(data.end(), {0xF0, 0x9F});
+        }
+        std::u16string wide;
+        append_utf16(data, wide);
+        ByteVec back;
+        append_from_utf16(wide.data(), wide.size(), back, ErrorMode::Strict);
+        CHECK(back == sanitize(data));
+    }
+}
+
+TEST_CASE("StreamValidator / StreamDecoder match whole-buffer results for any chunking") {
+    const ByteVec pieces[] = {{0xE4, 0xBD, 0xA0}, {0xF0, 0x9F, 0x98, 0x81}, {0xC3, 0xA9}, {'a'}, {0xFF},
+                              {0xE4, 0xBD},       {0x80},                   {0xF0},       {0xC0, 0xAF},
+                              {0xED, 0xA0, 0x80}, {0xF4, 0x90, 0x80, 0x80}, {'b', 'c'}};
+    std::uint32_t seed = 7;
+    auto next = [&seed]() { return seed = seed * 1103515245u + 12345u, (seed >> 16) & 0x7FFF; };
+    std::size_t mismatches = 0;
+    for (int round = 0; round < 3000; ++round) {
+        ByteVec data;
+        std::size_t n = next() % 24;
+        bool clean = next() % 3 == 0; // 三分之一只用合法片段
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t k = clean ? (next() % 4 == 0 ? 11 : next() % 4) : next() % 12;
+            if (clean && k == 1) k = 3;
+            const ByteVec& piece = pieces[k];
+            data.insert(data.end(), piece.begin(), piece.end());
+        }
+
+        StreamValidator validator;
+        StreamDecoder lossy;
+        StreamDecoder strict(ErrorMode::Strict);
+        std::vector<CodePoint> lossy_out;
+        std::vector<CodePoint> strict_out;
+        std::size_t pos = 0;
+        while (pos < data.size()) {
+            std::size_t len = std::min<std::size_t>(next() % 6, data.size() - pos); // 含空块
+            ByteSpan chunk(data.data() + pos, len);
+            validator.feed(chunk);
+            lossy.feed(chunk, lossy_out);
+            strict.feed(chunk, strict_out);
+            pos += len;
+        }
+        bool valid = validator.finish();
+        lossy.finish(lossy_out);
+        strict.finish(strict_out);
+
+        std::size_t bad = first_invalid(data);
+        mismatches += valid != (bad == kstring::knpos);
+        mismatches += validator.error_offset() != bad;
+        mismatches += lossy_out != decode_all(data) || lossy.error_offset() != bad;
+        std::size_t prefix = bad == kstring::knpos ? data.size() : bad;
+        mismatches += strict_out != decode_all(ByteSpan(data.data(), prefix)) || strict.error_offset() != bad;
+        mismatches += validator.bytes_fed() != data.size();
+    }
+    CHECK(mismatches == 0);
+
+    SUBCASE("sequence split across chunks") {
+        StreamDecoder dec;
+        std::vector<CodePoint> out;
+        CHECK(dec.feed(ByteVec({'a', 0xF0, 0x9F}), out));
+        CHECK(out == std::vector<CodePoint>({'a'}));
+        CHECK(dec.feed(ByteVec({0x98}), out));
+        CHECK(dec.feed(ByteVec({0x81, 'b'}), out));
+        CHECK(dec.finish(out));
+        CHECK(out == std::vector<CodePoint>({'a', 0x1F601, 'b'}));
+    }
+
+    SUBCASE("truncated at end of stream, reset") {
+        StreamValidator v;
+        CHECK(v.feed(ByteVec({'a', 'b', 0xE4, 0xBD})));
+        CHECK_FALSE(v.finish());
+        CHECK(v.error_offset() == 2);
+        v.reset();
+        CHECK(v.feed(ByteVec({0xE4, 0xBD, 0xA0})));
+        CHECK(v.finish());
+        CHECK(v.ok());
+    }
+
+    SUBCASE("errors after large valid chunks report global offsets") {
+        ByteVec block;
+        for (int i = 0; i < 20000; ++i) block.insert(block.end(), {0xE4, 0xBD, 0xA0, 'x'});
+        StreamValidator v;
+        StreamDecoder dec(ErrorMode::Strict);
+        std::vector<CodePoint> out;
+        CHECK(v.feed(block));
+        CHECK(dec.feed(block, out));
+        ByteVec broken = {'y', 0xED, 0xA0, 0x80};
+        CHECK_FALSE(v.feed(broken));
+        CHECK_FALSE(dec.feed(broken, out));
+        CHECK(v.error_offset() == block.size() + 1);
+        CHECK(dec.error_offset() == block.size() + 1);
+        CHECK(out.size() == 40001);
+        CHECK_FALSE(dec.feed(ByteVec({'z'}), out));
+        CHECK(out.size() == 40001);
+    }
+}
+
 TEST_CASE("decode_one: valid UTF-8 single characters") {
 
     SUBCASE("ASCII - 'A'") {
@@ -464,6 +955,9 @@ TEST_CASE("is_ascii") {
     ByteVec non_ascii = {0xE4, 0xBD, 0xA0};
     CHECK(is_all_ascii(ascii));
     CHECK_FALSE(is_all_ascii(non_ascii));
+    CHECK(non_ascii_count(ascii) == 0);
+    CHECK(non_ascii_count(non_ascii) == 3);
+    CHECK(non_ascii_count(ByteVec{'a', 0xFF, 'b', 0x80}) == 2);
 }
 
 TEST_CASE("debug_codepoint") {
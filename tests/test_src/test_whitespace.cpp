@@ -0,0 +1,137 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cstring>
+#include <string>
+#include <doctest/doctest.h>
+#include "../../include/kstr.hpp"
+#include "../../include/utf8.hpp"
+#include "../../include/whitespace.hpp"
+
+using namespace kstring;
+
+namespace {
+ByteSpan bytes(const std::string& s) {
+    return ByteSpan(reinterpret_cast<const Byte*>(s.data()), s.size());
+}
+
+// 逐字符解码的对照实现
+std::size_t naive_find(const std::string& s, std::size_t pos, std::size_t& len) {
+    ByteSpan data = bytes(s);
+    while (pos < data.size()) {
+        auto dec = utf8::decode_one(data, pos);
+        if (dec.ok && is_whitespace_codepoint(dec.codepoint)) {
+            len = dec.next_pos - pos;
+            return pos;
+        }
+        pos = dec.next_pos;
+    }
+    return knpos;
+}
+
+std::size_t naive_skip(const std::string& s, std::size_t pos) {
+    std::size_t len = 0;
+    while (naive_find(s, pos, len) == pos) pos += len;
+    return pos < s.size() ? pos : s.size();
+}
+
+// 逆向对照: 正向切分后取最后一个完整落在 [0, end) 中的空白
+std::size_t naive_rfind(const std::string& s, std::size_t end, std::size_t& len) {
+    std::size_t last = knpos;
+    std::size_t pos = 0;
+    std::size_t l = 0;
+    while ((pos = naive_find(s, pos, l)) != knpos && pos + l <= end) {
+        last = pos;
+        len = l;
+        pos += l;
+    }
+    return last;
+}
+
+// 正向切分, 找出紧贴 end 的那段连续空白的起点
+std::size_t naive_rskip(const std::string& s, std::size_t end) {
+    ByteSpan data = bytes(s);
+    std::size_t run_start = 0;
+    std::size_t pos = 0;
+    while (pos < end) {
+        auto dec = utf8::decode_one(data, pos);
+        if (! (dec.ok && is_whitespace_codepoint(dec.codepoint))) run_start = dec.next_pos;
+        pos = dec.next_pos;
+    }
+    return run_start;
+}
+
+std::string random_text(unsigned& seed, std::size_t len) {
+    // 混合 ASCII 空白, 多字节空白, 与其共享首字节的非空白, 以及非法字节
+    static const char* pieces[] = {"a", " ", "\t", "\n", "\xc2\xa0", "\xc2\xa9", "\xe3\x80\x80", "\xe3\x80\x81",
+                                   "\xe2\x80\x83", "\xe2\x80\x8b", "\xe1\x9a\x80", "你", "\xe3\x80", "\xff",
+                                   "\x80", "z"};
+    std::string s;
+    while (s.size() < len) {
+        seed = seed * 1103515245u + 12345u;
+        s += pieces[(seed >> 16) % 16];
+    }
+    return s;
+}
+} // namespace
+
+static_assert(is_whitespace_codepoint(' ') && is_whitespace_codepoint(0x3000), "constexpr whitespace");
+static_assert(! is_whitespace_codepoint('a') && ! is_whitespace_codepoint(0x200B), "constexpr whitespace");
+
+TEST_CASE("is_whitespace_codepoint covers exactly the unicode space set") {
+    const CodePoint spaces[] = {0x09,   0x0A,   0x0B,   0x0C,   0x0D,   0x20,   0xA0,   0x1680, 0x2000,
+                                0x2001, 0x2002, 0x2003, 0x2004, 0x2005, 0x2006, 0x2007, 0x2008, 0x2009,
+                                0x200A, 0x2028, 0x2029, 0x202F, 0x205F, 0x3000};
+    std::size_t count = 0;
+    for (CodePoint cp = 0; cp < 0x11000; ++cp) count += is_whitespace_codepoint(cp);
+    CHECK(count == sizeof(spaces) / sizeof(spaces[0]));
+    for (CodePoint cp : spaces) {
+        CHECK(is_whitespace_codepoint(cp));
+        CHECK(KChar(cp).is_whitespace());
+    }
+    CHECK_FALSE(KChar(0x1C).is_whitespace());
+    CHECK_FALSE(KChar(0x85).is_whitespace());
+}
+
+TEST_CASE("whitespace scanner agrees with per-char decoding") {
+    unsigned seed = 11;
+    for (int round = 0; round < 400; ++round) {
+        seed = seed * 1103515245u + 12345u;
+        std::string s = random_text(seed, (seed >> 16) % 150);
+        ByteSpan data = bytes(s);
+        for (std::size_t pos = 0; pos <= s.size(); pos += 7) {
+            std::size_t len = 0;
+            std::size_t naive_len = 0;
+            std::size_t got = whitespace::find(data, pos, len);
+            std::size_t expected = naive_find(s, pos, naive_len);
+            REQUIRE(got == expected);
+            if (got != knpos) CHECK(len == naive_len);
+
+            got = whitespace::rfind(data, pos, len);
+            expected = naive_rfind(s, pos, naive_len);
+            REQUIRE(got == expected);
+            if (got != knpos) CHECK(len == naive_len);
+        }
+        // skip / rskip 从字符边界开始
+        std::size_t boundary = 0;
+        while (boundary < s.size()) {
+            CHECK(whitespace::skip(data, boundary) == naive_skip(s, boundary));
+            CHECK(whitespace::rskip(data, boundary) == naive_rskip(s, boundary));
+            boundary = utf8::decode_one(data, boundary).next_pos;
+        }
+    }
+}
+
+TEST_CASE("trim uses the bulk scanner on long runs") {
+    std::string pad(70, ' ');
+    std::string s = pad + "\xe3\x80\x80\t核心\xc2\xa0内容" + "\xc2\xa0\n" + pad;
+    KStr k(s.c_str());
+    CHECK(k.trim() == "核心\xc2\xa0内容");
+    CHECK(k.trim_start().as_bytes().data() == k.as_bytes().data() + 74);
+    CHECK(KStr(pad.c_str()).trim().byte_size() == 0);
+    CHECK(KStr(pad.c_str()).trim_end().byte_size() == 0);
+
+    // 非法字节不是空白, 也不会把后面的空白吞掉
+    std::string raw = " \xe3\x80" "\xe3\x80\x80";
+    CHECK(KStr(raw.c_str()).trim().byte_size() == 2);
+    CHECK(std::strlen(whitespace::simd_backend()) > 0);
+}
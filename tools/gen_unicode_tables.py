@@ -0,0 +1,364 @@
+#!/usr/bin/env python3
+"""
+由 data/ucd 下的 UCD 文件生成 Unicode 属性表 (make unicode):
+    include/unicode_tables.hpp  常量与表声明
+    src/unicode_tables.cpp      表数据
+
+每个属性表都是两级表: STAGE1[cp >> SHIFT] 给出块号, STAGE2[(块号 << SHIFT) | (cp & MASK)] 给出值,
+内容相同的块只保存一份, 查一次最多两次访存. SHIFT 取使总字节数最小的值.
+"""
+
+import os
+import re
+import sys
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+UCD_DIR = os.path.join(ROOT, 'data', 'ucd')
+HEADER_OUT = os.path.join(ROOT, 'include', 'unicode_tables.hpp')
+SOURCE_OUT = os.path.join(ROOT, 'src', 'unicode_tables.cpp')
+
+MAX_CP = 0x110000
+
+# 与 unicode::GeneralCategory 的顺序一致
+GC_ORDER = ['Lu', 'Ll', 'Lt', 'Lm', 'Lo', 'Mn', 'Mc', 'Me', 'Nd', 'Nl', 'No', 'Pc', 'Pd', 'Ps', 'Pe', 'Pi', 'Pf', 'Po',
+            'Sm', 'Sc', 'Sk', 'So', 'Zs', 'Zl', 'Zp', 'Cc', 'Cf', 'Cs', 'Co', 'Cn']
+
+# 属性记录中的二元属性位 (低 5 位为 General_Category), (常量名, 文件, 属性名)
+PROP_FLAGS = [
+    ('PROP_WHITE_SPACE', 'PropList.txt', 'White_Space'),
+    ('PROP_ALPHABETIC', 'DerivedCoreProperties.txt', 'Alphabetic'),
+    ('PROP_LOWERCASE', 'DerivedCoreProperties.txt', 'Lowercase'),
+    ('PROP_UPPERCASE', 'DerivedCoreProperties.txt', 'Uppercase'),
+    ('PROP_CASED', 'DerivedCoreProperties.txt', 'Cased'),
+    ('PROP_CASE_IGNORABLE', 'DerivedCoreProperties.txt', 'Case_Ignorable'),
+]
+PROP_FLAG_SHIFT = 5
+
+# 与 unicode::GraphemeBreak 的顺序一致; 第 4 位为 Extended_Pictographic
+GCB_ORDER = ['Other', 'CR', 'LF', 'Control', 'Extend', 'ZWJ', 'Regional_Indicator', 'Prepend', 'SpacingMark', 'L', 'V',
+             'T', 'LV', 'LVT']
+GCB_EXTENDED_PICTOGRAPHIC = 0x10
+
+# 与 unicode::WordBreak 的顺序一致; 第 5 位为 Extended_Pictographic
+WB_ORDER = ['Other', 'CR', 'LF', 'Newline', 'Extend', 'ZWJ', 'Regional_Indicator', 'Format', 'Katakana', 'Hebrew_Letter',
+            'ALetter', 'Single_Quote', 'Double_Quote', 'MidNumLet', 'MidLetter', 'MidNum', 'Numeric', 'ExtendNumLet',
+            'WSegSpace']
+WB_EXTENDED_PICTOGRAPHIC = 0x20
+
+# 与 unicode::SentenceBreak 的顺序一致
+SB_ORDER = ['Other', 'CR', 'LF', 'Extend', 'Sep', 'Format', 'Sp', 'Lower', 'Upper', 'OLetter', 'Numeric', 'ATerm',
+            'SContinue', 'STerm', 'Close']
+
+# 规范化记录中的 quick check 位, (常量名, 属性名, 值)
+NORM_FLAGS = [
+    ('NORM_NFD_NO', 'NFD_QC', 'N'),
+    ('NORM_NFKD_NO', 'NFKD_QC', 'N'),
+    ('NORM_NFC_NO', 'NFC_QC', 'N'),
+    ('NORM_NFC_MAYBE', 'NFC_QC', 'M'),
+    ('NORM_NFKC_NO', 'NFKC_QC', 'N'),
+    ('NORM_NFKC_MAYBE', 'NFKC_QC', 'M'),
+]
+
+
+def parse_ucd(name):
+    """逐行给出 (lo, hi, [字段...]), 忽略注释与空行"""
+    with open(os.path.join(UCD_DIR, name), encoding='utf-8') as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            fields = [x.strip() for x in line.split(';')]
+            bounds = fields[0].split('..')
+            lo = int(bounds[0], 16)
+            hi = int(bounds[-1], 16)
+            yield lo, hi, fields[1:]
+
+
+def ucd_version():
+    with open(os.path.join(UCD_DIR, 'DerivedGeneralCategory.txt'), encoding='utf-8') as f:
+        m = re.search(r'-(\d+)\.(\d+)\.(\d+)\.txt', f.readline())
+    if not m:
+        sys.exit('cannot find the Unicode version in DerivedGeneralCategory.txt')
+    return tuple(int(x) for x in m.groups())
+
+
+def binary_property(name, prop):
+    out = set()
+    for lo, hi, fields in parse_ucd(name):
+        if fields[0] == prop:
+            out.update(range(lo, hi + 1))
+    if not out:
+        sys.exit('property %s not found in %s' % (prop, name))
+    return out
+
+
+def build_properties():
+    values = [GC_ORDER.index('Cn')] * MAX_CP
+    for lo, hi, fields in parse_ucd('DerivedGeneralCategory.txt'):
+        gc = GC_ORDER.index(fields[0])
+        for cp in range(lo, hi + 1):
+            values[cp] = gc
+    for bit, (_, name, prop) in enumerate(PROP_FLAGS):
+        flag = 1 << (PROP_FLAG_SHIFT + bit)
+        for cp in binary_property(name, prop):
+            values[cp] |= flag
+    return values
+
+
+def build_case():
+    """返回 (每个码点的记录号, 记录列表, CASE_SPECIAL); 记录 0 表示没有任何映射"""
+    simple = {}
+    for cp, _, fields in parse_ucd('UnicodeData.txt'):
+        # fields[11..13] 为 UnicodeData 的 Uppercase / Lowercase / Titlecase_Mapping
+        deltas = tuple((int(f, 16) - cp) if f else 0 for f in fields[11:14])
+        if any(deltas):
+            simple[cp] = deltas
+    full = {}
+    for cp, _, fields in parse_ucd('SpecialCasing.txt'):
+        # 带条件 (Final_Sigma 或语言) 的映射由运行时或调用方处理, 这里只收无条件映射
+        if len(fields) > 3 and fields[3]:
+            continue
+        lower, title, upper = ([int(x, 16) for x in f.split()] for f in fields[:3])
+        full[cp] = (upper, lower, title)
+
+    special = [0]
+    special_offsets = {}
+
+    def special_offset(cp, chars, simple_delta):
+        if chars == [cp + simple_delta]:
+            return 0
+        key = tuple(chars)
+        if key not in special_offsets:
+            special_offsets[key] = len(special)
+            special.extend([len(chars)] + chars)
+        return special_offsets[key]
+
+    records = [(0, 0, 0, 0, 0, 0)]
+    record_ids = {records[0]: 0}
+    values = [0] * MAX_CP
+    for cp in sorted(set(simple) | set(full)):
+        deltas = simple.get(cp, (0, 0, 0))
+        offsets = (0, 0, 0)
+        if cp in full:
+            offsets = tuple(special_offset(cp, full[cp][i], deltas[i]) for i in range(3))
+        record = deltas + offsets
+        if record not in record_ids:
+            record_ids[record] = len(records)
+            records.append(record)
+        values[cp] = record_ids[record]
+    return values, records, special
+
+
+def build_norm():
+    """返回 (每个码点的记录号, 记录列表, DECOMP 池, 组合对列表); 记录 0 为 ccc 0 且没有分解的字符"""
+    ccc = {}
+    canonical = {}
+    compat = {}
+    for cp, _, fields in parse_ucd('UnicodeData.txt'):
+        # fields[2] 为 Canonical_Combining_Class, fields[4] 为分解映射, 带 <tag> 的是兼容分解
+        if fields[2] and int(fields[2]):
+            ccc[cp] = int(fields[2])
+        if fields[4]:
+            parts = fields[4].split()
+            if parts[0].startswith('<'):
+                compat[cp] = [int(x, 16) for x in parts[1:]]
+            else:
+                canonical[cp] = [int(x, 16) for x in parts]
+
+    def expand(cp, with_compat):
+        mapping = canonical.get(cp) or (compat.get(cp) if with_compat else None)
+        if mapping is None:
+            return [cp]
+        return [c for m in mapping for c in expand(m, with_compat)]
+
+    flags = {}
+    excluded = binary_property('DerivedNormalizationProps.txt', 'Full_Composition_Exclusion')
+    for bit, (_, prop, value) in enumerate(NORM_FLAGS):
+        for lo, hi, fields in parse_ucd('DerivedNormalizationProps.txt'):
+            if fields[0] == prop and fields[1] == value:
+                for cp in range(lo, hi + 1):
+                    flags[cp] = flags.get(cp, 0) | (1 << bit)
+
+    pool = [0]
+    pool_offsets = {}
+
+    def pool_offset(chars):
+        key = tuple(chars)
+        if key not in pool_offsets:
+            pool_offsets[key] = len(pool)
+            pool.extend([len(chars)] + chars)
+        return pool_offsets[key]
+
+    records = [(0, 0, 0, 0)]
+    record_ids = {records[0]: 0}
+    values = [0] * MAX_CP
+    for cp in sorted(set(ccc) | set(canonical) | set(compat) | set(flags)):
+        canon_off = pool_offset(expand(cp, False)) if cp in canonical else 0
+        full = expand(cp, True)
+        compat_off = 0
+        if cp in compat or (cp in canonical and full != expand(cp, False)):
+            compat_off = pool_offset(full)
+        record = (ccc.get(cp, 0), flags.get(cp, 0), canon_off, compat_off)
+        if record not in record_ids:
+            record_ids[record] = len(records)
+            records.append(record)
+        values[cp] = record_ids[record]
+
+    # 主组合: 两个码点的规范分解且不在 Full_Composition_Exclusion 中
+    pairs = sorted((m[0], m[1], cp) for cp, m in canonical.items() if len(m) == 2 and cp not in excluded)
+    return values, records, pool, pairs
+
+
+def build_break(name, order, pict_flag=0):
+    """*BreakProperty.txt 的取值 (order 中的下标), pict_flag 非 0 时并入 Extended_Pictographic 位"""
+    values = [0] * MAX_CP
+    for lo, hi, fields in parse_ucd(name):
+        value = order.index(fields[0])
+        for cp in range(lo, hi + 1):
+            values[cp] = value
+    if pict_flag:
+        for cp in binary_property('emoji-data.txt', 'Extended_Pictographic'):
+            values[cp] |= pict_flag
+    return values
+
+
+def two_stage(values):
+    """返回 (shift, stage1, stage2), 选总字节数最小的块大小"""
+    best = None
+    for shift in range(4, 11):
+        size = 1 << shift
+        blocks = {}
+        stage1 = []
+        stage2 = []
+        for start in range(0, len(values), size):
+            block = tuple(values[start:start + size])
+            if block not in blocks:
+                blocks[block] = len(blocks)
+                stage2.extend(block)
+            stage1.append(blocks[block])
+        cost = len(stage1) * (1 if len(blocks) <= 0x100 else 2) + len(stage2) * element_size(stage2)
+        if best is None or cost < best[0]:
+            best = (cost, shift, stage1, stage2)
+    return best[1], best[2], best[3]
+
+
+def element_size(values):
+    top = max(values)
+    return 1 if top <= 0xFF else (2 if top <= 0xFFFF else 4)
+
+
+def ctype(values):
+    return {1: 'std::uint8_t', 2: 'std::uint16_t', 4: 'std::uint32_t'}[element_size(values)]
+
+
+def format_array(values, per_line=16):
+    width = len('0x%X' % max(values))
+    lines = []
+    for i in range(0, len(values), per_line):
+        chunk = values[i:i + per_line]
+        lines.append('    ' + ', '.join(('0x%0*X' % (width - 2, v)) for v in chunk) + ',')
+    return '\n'.join(lines)
+
+
+class Table:
+    def __init__(self, prefix, values, comment):
+        self.prefix = prefix
+        self.comment = comment
+        self.shift, self.stage1, self.stage2 = two_stage(values)
+
+    def declare(self):
+        return ('// %s\n'
+                'enum : unsigned {\n    %s_SHIFT = %d\n};\n'
+                'extern const %s %s_STAGE1[%d];\n'
+                'extern const %s %s_STAGE2[%d];\n') % (
+                    self.comment, self.prefix, self.shift, ctype(self.stage1), self.prefix, len(self.stage1),
+                    ctype(self.stage2), self.prefix, len(self.stage2))
+
+    def define(self):
+        return ('const %s %s_STAGE1[%d] = {\n%s\n};\n\n'
+                'const %s %s_STAGE2[%d] = {\n%s\n};\n') % (
+                    ctype(self.stage1), self.prefix, len(self.stage1), format_array(self.stage1),
+                    ctype(self.stage2), self.prefix, len(self.stage2), format_array(self.stage2))
+
+    def size(self):
+        return len(self.stage1) * element_size(self.stage1) + len(self.stage2) * element_size(self.stage2)
+
+
+def format_records(records):
+    return '\n'.join('    {%s},' % ', '.join(str(x) for x in r) for r in records)
+
+
+def format_pairs(pairs):
+    return '\n'.join('    {0x%04X, 0x%04X, 0x%04X},' % p for p in pairs)
+
+
+GENERATED_NOTE = '// 由 tools/gen_unicode_tables.py 根据 data/ucd 生成, 请勿手工修改 (make unicode)\n'
+
+
+def main():
+    version = ucd_version()
+    case_values, case_records, case_special = build_case()
+    norm_values, norm_records, decomp, pairs = build_norm()
+    tables = [Table('PROP', build_properties(), '属性记录: 低 5 位为 General_Category, 其余为 PROP_* 二元属性'),
+              Table('CASE', case_values, '大小写映射: 值为 CASE_RECORDS 的下标, 0 表示没有映射'),
+              Table('NORM', norm_values, '规范化: 值为 NORM_RECORDS 的下标, 0 表示 ccc 为 0, 没有分解且 quick check 全为 Yes'),
+              Table('GCB', build_break('GraphemeBreakProperty.txt', GCB_ORDER, GCB_EXTENDED_PICTOGRAPHIC),
+                    '字素簇: 低 4 位为 Grapheme_Cluster_Break, 另有 Extended_Pictographic 位'),
+              Table('WB', build_break('WordBreakProperty.txt', WB_ORDER, WB_EXTENDED_PICTOGRAPHIC),
+                    '词: 低 5 位为 Word_Break, 另有 Extended_Pictographic 位'),
+              Table('SB', build_break('SentenceBreakProperty.txt', SB_ORDER), '句: Sentence_Break')]
+
+    flags = ',\n'.join('    %s = 1u << %d' % (name, PROP_FLAG_SHIFT + i) for i, (name, _, _) in enumerate(PROP_FLAGS))
+    header = [GENERATED_NOTE, '#pragma once\n\n#include <cstdint>\n\n',
+              'namespace kstring {\nnamespace unicode {\nnamespace tables {\n',
+              'enum : unsigned {\n    UNICODE_VERSION_MAJOR = %d,\n    UNICODE_VERSION_MINOR = %d,\n'
+              '    UNICODE_VERSION_UPDATE = %d\n};\n\n' % version,
+              'enum : unsigned {\n    GC_COUNT = %d,\n    GCB_COUNT = %d,\n    WB_COUNT = %d,\n    SB_COUNT = %d\n};\n\n' %
+              (len(GC_ORDER), len(GCB_ORDER), len(WB_ORDER), len(SB_ORDER)),
+              'enum : std::uint8_t {\n    GCB_BITS = 0x0F,\n    GCB_EXTENDED_PICTOGRAPHIC = 0x%02X,\n'
+              '    WB_BITS = 0x1F,\n    WB_EXTENDED_PICTOGRAPHIC = 0x%02X\n};\n\n' %
+              (GCB_EXTENDED_PICTOGRAPHIC, WB_EXTENDED_PICTOGRAPHIC),
+              'enum : std::uint16_t {\n    PROP_GC_BITS = 0x1F,\n%s\n};\n\n' % flags]
+    header.append('\n'.join(t.declare() for t in tables))
+    header.append('\n// 简单映射存为与原码点的差值; full_* 为完整映射在 CASE_SPECIAL 中的偏移 (长度, 码点...), 0 表示同简单映射\n'
+                  'struct CaseRecord {\n    std::int32_t upper;\n    std::int32_t lower;\n    std::int32_t title;\n'
+                  '    std::uint16_t full_upper;\n    std::uint16_t full_lower;\n    std::uint16_t full_title;\n};\n\n'
+                  'extern const CaseRecord CASE_RECORDS[%d];\n'
+                  'extern const std::uint32_t CASE_SPECIAL[%d];\n' % (len(case_records), len(case_special)))
+    norm_flags = ',\n'.join('    %s = 1u << %d' % (name, i) for i, (name, _, _) in enumerate(NORM_FLAGS))
+    header.append('\nenum : std::uint8_t {\n%s\n};\n\n' % norm_flags)
+    header.append('// canonical / compat 为完全展开后的分解在 DECOMP 中的偏移 (长度, 码点...);\n'
+                  '// canonical 为 0 表示没有规范分解, compat 为 0 表示兼容分解同规范分解. 谚文音节按算法分解, 不在表中\n'
+                  'struct NormRecord {\n    std::uint8_t ccc;\n    std::uint8_t flags;\n'
+                  '    std::uint16_t canonical;\n    std::uint16_t compat;\n};\n\n'
+                  'extern const NormRecord NORM_RECORDS[%d];\n'
+                  'extern const std::uint32_t DECOMP[%d];\n\n'
+                  '// 主组合 (first, second) -> composite, 按 (first, second) 升序\n'
+                  'struct CompositionPair {\n    std::uint32_t first;\n    std::uint32_t second;\n'
+                  '    std::uint32_t composite;\n};\n\n'
+                  'extern const CompositionPair COMPOSITIONS[%d];\n' % (len(norm_records), len(decomp), len(pairs)))
+    header.append('} // namespace tables\n} // namespace unicode\n} // namespace kstring\n')
+
+    source = [GENERATED_NOTE, '#include "unicode_tables.hpp"\n\n',
+              'namespace kstring {\nnamespace unicode {\nnamespace tables {\n']
+    source.append('\n'.join(t.define() for t in tables))
+    source.append('\nconst CaseRecord CASE_RECORDS[%d] = {\n%s\n};\n\n' % (len(case_records), format_records(case_records)))
+    source.append('const std::uint32_t CASE_SPECIAL[%d] = {\n%s\n};\n' % (len(case_special), format_array(case_special)))
+    source.append('\nconst NormRecord NORM_RECORDS[%d] = {\n%s\n};\n\n' % (len(norm_records), format_records(norm_records)))
+    source.append('const std::uint32_t DECOMP[%d] = {\n%s\n};\n\n' % (len(decomp), format_array(decomp)))
+    source.append('const CompositionPair COMPOSITIONS[%d] = {\n%s\n};\n' % (len(pairs), format_pairs(pairs)))
+    source.append('} // namespace tables\n} // namespace unicode\n} // namespace kstring\n')
+
+    with open(HEADER_OUT, 'w', encoding='utf-8') as f:
+        f.write(''.join(header))
+    with open(SOURCE_OUT, 'w', encoding='utf-8') as f:
+        f.write(''.join(source))
+    for t in tables:
+        print('%s: shift %d, %d bytes' % (t.prefix, t.shift, t.size()))
+    print('CASE_RECORDS: %d records, CASE_SPECIAL: %d entries' % (len(case_records), len(case_special)))
+    print('NORM_RECORDS: %d records, DECOMP: %d entries, COMPOSITIONS: %d pairs' % (len(norm_records), len(decomp),
+                                                                                    len(pairs)))
+
+
+if __name__ == '__main__':
+    main()